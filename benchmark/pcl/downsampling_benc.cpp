@@ -6,7 +6,9 @@
 
 #include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <cpp-toolbox/pcl/filters/farthest_point_sampling.hpp>
 #include <cpp-toolbox/pcl/filters/random_downsampling.hpp>
+#include <cpp-toolbox/pcl/filters/uniform_grid_subsampling.hpp>
 #include <cpp-toolbox/pcl/filters/voxel_grid_downsampling.hpp>
 #include <cpp-toolbox/types/minmax.hpp>
 #include <cpp-toolbox/types/point.hpp>
@@ -15,7 +17,9 @@
 #include <cpp-toolbox/utils/random.hpp>
 #include <cpp-toolbox/utils/timer.hpp>
 
+using toolbox::pcl::farthest_point_sampling_t;
 using toolbox::pcl::random_downsampling_t;
+using toolbox::pcl::uniform_grid_subsampling_t;
 using toolbox::pcl::voxel_grid_downsampling_t;
 using toolbox::types::generate_random_points_parallel;
 using toolbox::types::minmax_t;
@@ -90,6 +94,22 @@ TEST_CASE("Downsampling Filters Benchmark", "[benchmark][pcl]")
       filter.enable_parallel(true);
       return filter.filter().size();
     };
+    BENCHMARK("Parallel Random Downsampling Indices")
+    {
+      filter.set_seed(7);
+      filter.enable_parallel(true);
+      return filter.filter_indices().size();
+    };
+    BENCHMARK("Parallel Stratified Random Downsampling Indices")
+    {
+      filter.set_seed(7);
+      filter.set_mode(random_downsampling_t<float>::sampling_mode_t::stratified);
+      filter.set_stratum_size(2.0F);
+      filter.enable_parallel(true);
+      const auto size = filter.filter_indices().size();
+      filter.set_mode(random_downsampling_t<float>::sampling_mode_t::uniform);
+      return size;
+    };
   }
 
   SECTION("Benchmark Voxel Grid Downsampling")
@@ -106,6 +126,62 @@ TEST_CASE("Downsampling Filters Benchmark", "[benchmark][pcl]")
       filter.enable_parallel(true);
       return filter.filter().size();
     };
+
+    filter.set_engine(voxel_grid_downsampling_t<float>::engine_t::sort);
+    BENCHMARK("Serial Voxel Grid Downsampling (sort engine)")
+    {
+      filter.enable_parallel(false);
+      return filter.filter().size();
+    };
+    BENCHMARK("Parallel Voxel Grid Downsampling (sort engine)")
+    {
+      filter.enable_parallel(true);
+      return filter.filter().size();
+    };
+  }
+
+  SECTION("Benchmark Uniform Grid Subsampling")
+  {
+    uniform_grid_subsampling_t<float> filter(0.5F);
+    filter.set_input(cloud);
+    BENCHMARK("Serial Uniform Grid Subsampling")
+    {
+      filter.enable_parallel(false);
+      return filter.filter().size();
+    };
+    BENCHMARK("Parallel Uniform Grid Subsampling")
+    {
+      filter.enable_parallel(true);
+      return filter.filter().size();
+    };
+  }
+
+  SECTION("Benchmark Farthest Point Sampling")
+  {
+    // 精确FPS每次选择都遍历全部点，使用较小的子集 / Exact FPS scans every point per
+    // pick, so use a smaller subset
+    auto subset = std::make_shared<point_cloud_t<float>>();
+    subset->points.assign(cloud->points.begin(), cloud->points.begin() + 100000);
+
+    farthest_point_sampling_t<float> filter(1024);
+    filter.set_input(subset);
+    BENCHMARK("Serial Farthest Point Sampling")
+    {
+      filter.enable_parallel(false);
+      filter.enable_grid_acceleration(false);
+      return filter.filter_indices().size();
+    };
+    BENCHMARK("Parallel Farthest Point Sampling")
+    {
+      filter.enable_parallel(true);
+      filter.enable_grid_acceleration(false);
+      return filter.filter_indices().size();
+    };
+    BENCHMARK("Grid Farthest Point Sampling")
+    {
+      filter.enable_grid_acceleration(true);
+      return filter.filter_indices().size();
+    };
   }
 
   // --- Timing Table ---
@@ -149,6 +225,23 @@ TEST_CASE("Downsampling Filters Benchmark", "[benchmark][pcl]")
     voxel_filter.enable_parallel(true);
     double voxel_parallel = measure([&]() { voxel_filter.filter(); });
 
+    voxel_filter.set_engine(voxel_grid_downsampling_t<float>::engine_t::sort);
+    voxel_filter.enable_parallel(false);
+    double voxel_sort_serial = measure([&]() { voxel_filter.filter(); });
+
+    voxel_filter.enable_parallel(true);
+    double voxel_sort_parallel = measure([&]() { voxel_filter.filter(); });
+
+    // Measure uniform grid subsampling
+    uniform_grid_subsampling_t<float> grid_filter(0.5F);
+    grid_filter.set_input(cloud);
+
+    grid_filter.enable_parallel(false);
+    double grid_serial = measure([&]() { grid_filter.filter(); });
+
+    grid_filter.enable_parallel(true);
+    double grid_parallel = measure([&]() { grid_filter.filter(); });
+
     // Create and display the results table
     toolbox::utils::table_t table;
     table.set_headers({"Benchmark", "Serial (ms)", "Parallel (ms)", "Speedup"});
@@ -189,6 +282,10 @@ TEST_CASE("Downsampling Filters Benchmark", "[benchmark][pcl]")
 
     add_row("Random Downsampling", random_serial, random_parallel);
     add_row("Voxel Grid Downsampling", voxel_serial, voxel_parallel);
+    add_row("Voxel Grid Downsampling (sort engine)",
+            voxel_sort_serial,
+            voxel_sort_parallel);
+    add_row("Uniform Grid Subsampling", grid_serial, grid_parallel);
 
     std::cout << table << "\n";
 
@@ -196,5 +293,9 @@ TEST_CASE("Downsampling Filters Benchmark", "[benchmark][pcl]")
     REQUIRE(random_parallel > 0.0);
     REQUIRE(voxel_serial > 0.0);
     REQUIRE(voxel_parallel > 0.0);
+    REQUIRE(voxel_sort_serial > 0.0);
+    REQUIRE(voxel_sort_parallel > 0.0);
+    REQUIRE(grid_serial > 0.0);
+    REQUIRE(grid_parallel > 0.0);
   }
 }
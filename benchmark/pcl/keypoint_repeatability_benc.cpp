@@ -0,0 +1,391 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cpp-toolbox/io/formats/kitti.hpp>
+#include <cpp-toolbox/io/formats/pcd.hpp>
+#include <cpp-toolbox/pcl/features/features.hpp>
+#include <cpp-toolbox/pcl/filters/voxel_grid_downsampling.hpp>
+#include <cpp-toolbox/pcl/knn/kdtree.hpp>
+#include <cpp-toolbox/types/point_utils.hpp>
+#include <cpp-toolbox/utils/random.hpp>
+#include <cpp-toolbox/utils/timer.hpp>
+
+#include <Eigen/Geometry>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 基准测试数据目录 / Benchmark data directory
+#ifndef TEST_DATA_DIR
+#define TEST_DATA_DIR "test/data"
+#endif
+
+using namespace toolbox::pcl;
+using namespace toolbox::types;
+using namespace toolbox::utils;
+
+namespace
+{
+
+using data_type = float;
+using cloud_type = point_cloud_t<data_type>;
+using indices_vector = std::vector<std::size_t>;
+
+// 每个数据集做的随机刚体变换次数 / Random rigid transforms per data set
+constexpr std::size_t k_num_trials = 3;
+// 变换后关键点离目标关键点不超过该倍数的分辨率即算重复 / A transformed keypoint
+// within this many resolutions of a target keypoint counts as repeated
+constexpr data_type k_repeat_tolerance = 2.0f;
+// 每轴高斯噪声的标准差，以分辨率为单位 / Per-axis Gaussian noise sigma in resolutions
+constexpr data_type k_noise_sigma = 0.1f;
+
+/**
+ * @brief 数据集，分辨率是降采样的体素边长或原始点间距 / A data set; the resolution
+ * is the downsampling voxel edge or the native point spacing
+ */
+struct dataset_t
+{
+  std::string name;
+  cloud_type cloud;
+  data_type resolution = 0;
+};
+
+struct stage_times_t
+{
+  double input_ms = 0;  ///< set_input复制点云 / set_input copying the cloud
+  double index_ms = 0;  ///< set_knn建立KD树 / set_knn building the KD-tree
+  double detect_ms = 0;  ///< extract / extract
+
+  [[nodiscard]] double total_ms() const { return input_ms + index_ms + detect_ms; }
+};
+
+using detector_fn =
+    std::function<indices_vector(const cloud_type&, data_type, bool, stage_times_t&)>;
+
+struct detector_entry_t
+{
+  std::string name;
+  detector_fn run;
+};
+
+template<typename Task>
+double time_ms(Task&& task)
+{
+  stop_watch_timer_t timer;
+  timer.start();
+  task();
+  timer.stop();
+  return timer.elapsed_time_ms();
+}
+
+/**
+ * @brief 按阶段计时运行一个检测器，半径都以分辨率为单位配置 / Run one detector with
+ * per-stage timing; all radii are configured in resolutions
+ */
+template<typename Extractor, typename Configure>
+detector_fn make_detector(Configure configure)
+{
+  return [configure](const cloud_type& cloud,
+                     data_type resolution,
+                     bool parallel,
+                     stage_times_t& times)
+  {
+    Extractor extractor;
+    kdtree_t<data_type> kdtree;
+    times.input_ms = time_ms([&] { extractor.set_input(cloud); });
+    times.index_ms = time_ms([&] { extractor.set_knn(kdtree); });
+    configure(extractor, resolution);
+    extractor.enable_parallel(parallel);
+    indices_vector keypoints;
+    times.detect_ms = time_ms([&] { keypoints = extractor.extract(); });
+    return keypoints;
+  };
+}
+
+std::vector<detector_entry_t> make_detectors()
+{
+  using kd = kdtree_t<data_type>;
+  std::vector<detector_entry_t> detectors;
+  detectors.push_back({"iss",
+                       make_detector<iss_keypoint_extractor_t<data_type, kd>>(
+                           [](auto& e, data_type r)
+                           {
+                             e.set_search_radius(6 * r);
+                             e.set_salient_radius(6 * r);
+                             e.set_non_maxima_radius(4 * r);
+                           })});
+  detectors.push_back({"harris3d",
+                       make_detector<harris3d_keypoint_extractor_t<data_type, kd>>(
+                           [](auto& e, data_type r)
+                           {
+                             e.set_search_radius(6 * r);
+                             e.set_suppression_radius(4 * r);
+                             e.set_threshold(0.0f);
+                           })});
+  detectors.push_back({"sift3d",
+                       make_detector<sift3d_keypoint_extractor_t<data_type, kd>>(
+                           [](auto& e, data_type r)
+                           {
+                             e.set_base_scale(r);
+                             e.set_num_scales(5);
+                             e.set_contrast_threshold(0.1f);
+                           })});
+  detectors.push_back(
+      {"sift3d_voxel_pyramid",
+       make_detector<sift3d_keypoint_extractor_t<data_type, kd>>(
+           [](auto& e, data_type r)
+           {
+             using mode = typename std::decay_t<decltype(e)>::scale_space_mode;
+             e.set_base_scale(r);
+             e.set_num_scales(5);
+             e.set_contrast_threshold(0.1f);
+             e.set_scale_space_mode(mode::voxel_pyramid);
+           })});
+  detectors.push_back({"curvature",
+                       make_detector<curvature_keypoint_extractor_t<data_type, kd>>(
+                           [](auto& e, data_type r)
+                           {
+                             e.set_search_radius(6 * r);
+                             e.set_non_maxima_radius(4 * r);
+                           })});
+  detectors.push_back({"agast",
+                       make_detector<agast_keypoint_extractor_t<data_type, kd>>(
+                           [](auto& e, data_type r)
+                           {
+                             e.set_pattern_radius(4 * r);
+                             e.set_non_maxima_radius(4 * r);
+                           })});
+  detectors.push_back({"susan",
+                       make_detector<susan_keypoint_extractor_t<data_type, kd>>(
+                           [](auto& e, data_type r)
+                           {
+                             e.set_search_radius(6 * r);
+                             e.set_non_maxima_radius(4 * r);
+                           })});
+  detectors.push_back({"mls",
+                       make_detector<mls_keypoint_extractor_t<data_type, kd>>(
+                           [](auto& e, data_type r)
+                           {
+                             e.set_search_radius(6 * r);
+                             e.set_non_maxima_radius(4 * r);
+                           })});
+  return detectors;
+}
+
+std::vector<dataset_t> load_datasets()
+{
+  std::vector<dataset_t> datasets;
+  auto add = [&datasets](const std::string& name,
+                         std::unique_ptr<cloud_type> cloud,
+                         data_type resolution,
+                         bool downsample)
+  {
+    if (!cloud || cloud->empty()) {
+      std::cerr << "keypoint benchmark: skipping " << name << ", cannot load it\n";
+      return;
+    }
+    if (!downsample) {
+      datasets.push_back({name, std::move(*cloud), resolution});
+      return;
+    }
+    voxel_grid_downsampling_t<data_type> downsampling(resolution);
+    downsampling.set_input(*cloud);
+    datasets.push_back({name, downsampling.filter(), resolution});
+  };
+
+  // bunny.pcd只有约400个点，点间距约0.01，直接使用 / bunny.pcd has about 400 points
+  // spaced about 0.01 apart and is used as is
+  const std::string data_dir = TEST_DATA_DIR;
+  add("bunny", toolbox::io::read_pcd<data_type>(data_dir + "/bunny.pcd"), 0.01f, false);
+  add("kitti_000000",
+      toolbox::io::read_kitti_bin<data_type>(data_dir + "/000000.bin"),
+      0.2f,
+      true);
+  add("kitti_000002",
+      toolbox::io::read_kitti_bin<data_type>(data_dir + "/000002.bin"),
+      0.2f,
+      true);
+  return datasets;
+}
+
+/**
+ * @brief 固定种子的随机刚体变换，旋转不超过30度，平移不超过点云尺寸的20%
+ * / Seeded random rigid transform rotating at most 30 degrees and translating at
+ * most 20% of the cloud extent
+ */
+Eigen::Matrix4f make_transform(random_t& rng, data_type extent)
+{
+  Eigen::Vector3f axis(rng.gauss<data_type>(0, 1), rng.gauss<data_type>(0, 1),
+                       rng.gauss<data_type>(0, 1));
+  axis.normalize();
+  const data_type angle = rng.uniform<data_type>(0, static_cast<data_type>(M_PI / 6));
+  Eigen::Matrix4f transform = Eigen::Matrix4f::Identity();
+  transform.block<3, 3>(0, 0) = Eigen::AngleAxisf(angle, axis).toRotationMatrix();
+  for (int axis_idx = 0; axis_idx < 3; ++axis_idx) {
+    transform(axis_idx, 3) = rng.uniform<data_type>(-0.2f * extent, 0.2f * extent);
+  }
+  return transform;
+}
+
+/**
+ * @brief 同一批点经过变换并加噪声，点的对应关系不变 / The same points transformed and
+ * perturbed, so point correspondences are kept
+ */
+cloud_type make_target(const cloud_type& source,
+                       const Eigen::Matrix4f& transform,
+                       data_type noise_sigma,
+                       random_t& rng)
+{
+  cloud_type target = transform_point_cloud(source, transform);
+  for (auto& p : target.points) {
+    p.x += rng.gauss<data_type>(0, noise_sigma);
+    p.y += rng.gauss<data_type>(0, noise_sigma);
+    p.z += rng.gauss<data_type>(0, noise_sigma);
+  }
+  return target;
+}
+
+/**
+ * @brief 变换后落在某个目标关键点容差内的源关键点数 / Number of source keypoints
+ * that land within the tolerance of a target keypoint after the transform
+ */
+std::size_t count_repeated(const cloud_type& source,
+                           const indices_vector& source_keypoints,
+                           const cloud_type& target,
+                           const indices_vector& target_keypoints,
+                           const Eigen::Matrix4f& transform,
+                           data_type tolerance)
+{
+  if (source_keypoints.empty() || target_keypoints.empty()) {
+    return 0;
+  }
+  std::vector<point_t<data_type>> target_points;
+  target_points.reserve(target_keypoints.size());
+  for (auto idx : target_keypoints) {
+    target_points.push_back(target.points[idx]);
+  }
+  kdtree_t<data_type> kdtree;
+  kdtree.set_input(target_points);
+
+  std::size_t repeated = 0;
+  std::vector<std::size_t> nearest;
+  std::vector<data_type> distances;
+  for (auto idx : source_keypoints) {
+    const auto& p = source.points[idx];
+    const Eigen::Vector4f q = transform * Eigen::Vector4f(p.x, p.y, p.z, 1.0f);
+    kdtree.kneighbors(point_t<data_type>(q.x(), q.y(), q.z()), 1, nearest, distances);
+    if (!distances.empty() && distances.front() <= tolerance) {
+      ++repeated;
+    }
+  }
+  return repeated;
+}
+
+data_type cloud_extent(const cloud_type& cloud)
+{
+  auto min_pt = cloud.points.front();
+  auto max_pt = cloud.points.front();
+  for (const auto& p : cloud.points) {
+    min_pt.x = std::min(min_pt.x, p.x);
+    min_pt.y = std::min(min_pt.y, p.y);
+    min_pt.z = std::min(min_pt.z, p.z);
+    max_pt.x = std::max(max_pt.x, p.x);
+    max_pt.y = std::max(max_pt.y, p.y);
+    max_pt.z = std::max(max_pt.z, p.z);
+  }
+  return std::max({max_pt.x - min_pt.x, max_pt.y - min_pt.y, max_pt.z - min_pt.z});
+}
+
+}  // namespace
+
+/**
+ * 每行CSV对应一个(数据集, 检测器, 并行与否, 变换)组合，可以直接diff或导入表格比较两次
+ * 运行；设置环境变量CPP_TOOLBOX_KEYPOINT_BENCH_CSV时写入该文件，否则写到标准输出。
+ * Every CSV row is one (data set, detector, parallel, transform) combination and
+ * can be diffed or loaded into a spreadsheet to compare runs; the rows go to the
+ * file named by the CPP_TOOLBOX_KEYPOINT_BENCH_CSV environment variable, or to
+ * standard output when it is unset.
+ *
+ * repeatability = repeated / source_keypoints；时间是目标点云上那次运行的阶段耗时，
+ * points_per_second按三个阶段的总时间计算。
+ * repeatability = repeated / source_keypoints; times are the stages of the run on
+ * the target cloud, and points_per_second uses the total of the three stages.
+ */
+TEST_CASE("关键点重复率与吞吐量 / Keypoint repeatability and throughput",
+          "[benchmark][pcl][features][repeatability]")
+{
+  const auto datasets = load_datasets();
+  const auto detectors = make_detectors();
+  REQUIRE(!datasets.empty());
+
+  std::ostringstream csv;
+  csv << "dataset,detector,parallel,trial,points,resolution,source_keypoints,"
+         "target_keypoints,repeated,repeatability,input_ms,index_ms,detect_ms,"
+         "points_per_second\n";
+
+  for (const auto& dataset : datasets) {
+    const data_type extent = cloud_extent(dataset.cloud);
+
+    // 所有检测器共用同一组变换 / All detectors share the same transforms
+    std::vector<Eigen::Matrix4f> transforms;
+    std::vector<cloud_type> targets;
+    random_t rng(42);
+    for (std::size_t trial = 0; trial < k_num_trials; ++trial) {
+      transforms.push_back(make_transform(rng, extent));
+      targets.push_back(make_target(
+          dataset.cloud, transforms.back(), k_noise_sigma * dataset.resolution, rng));
+    }
+
+    for (const auto& detector : detectors) {
+      for (bool parallel : {false, true}) {
+        stage_times_t source_times;
+        const auto source_keypoints =
+            detector.run(dataset.cloud, dataset.resolution, parallel, source_times);
+
+        for (std::size_t trial = 0; trial < k_num_trials; ++trial) {
+          stage_times_t times;
+          const auto target_keypoints =
+              detector.run(targets[trial], dataset.resolution, parallel, times);
+          const std::size_t repeated = count_repeated(dataset.cloud,
+                                                      source_keypoints,
+                                                      targets[trial],
+                                                      target_keypoints,
+                                                      transforms[trial],
+                                                      k_repeat_tolerance * dataset.resolution);
+          const double repeatability = source_keypoints.empty()
+              ? 0.0
+              : static_cast<double>(repeated) / static_cast<double>(source_keypoints.size());
+          CHECK(repeated <= source_keypoints.size());
+
+          csv << dataset.name << ',' << detector.name << ',' << (parallel ? 1 : 0) << ','
+              << trial << ',' << dataset.cloud.size() << ',' << dataset.resolution << ','
+              << source_keypoints.size() << ',' << target_keypoints.size() << ',' << repeated
+              << ',' << std::fixed << std::setprecision(4) << repeatability << ','
+              << std::setprecision(3) << times.input_ms << ',' << times.index_ms << ','
+              << times.detect_ms << ',' << std::setprecision(0)
+              << static_cast<double>(dataset.cloud.size()) * 1000.0
+                  / std::max(times.total_ms(), 1e-3)
+              << '\n'
+              << std::defaultfloat << std::setprecision(6);
+        }
+      }
+    }
+  }
+
+  if (const char* path = std::getenv("CPP_TOOLBOX_KEYPOINT_BENCH_CSV")) {
+    std::ofstream file(path, std::ios::trunc);
+    REQUIRE(file.good());
+    file << csv.str();
+  } else {
+    std::cout << csv.str();
+  }
+}
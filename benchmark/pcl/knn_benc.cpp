@@ -90,6 +90,54 @@ TEST_CASE("KNN Benchmark - Setup Time", "[pcl][knn][benchmark]")
   }
 }
 
+TEST_CASE("KNN Benchmark - KDTree Build Throughput", "[pcl][knn][benchmark]")
+{
+  using scalar_t = float;
+
+  std::vector<std::size_t> cloud_sizes = {100000, 1000000};
+
+  for (auto cloud_size : cloud_sizes)
+  {
+    auto cloud = generate_benchmark_cloud<scalar_t>(cloud_size);
+
+    BENCHMARK("KDTree Serial Build - " + std::to_string(cloud_size) + " points")
+    {
+      kdtree_t<scalar_t> knn;
+      knn.enable_parallel(false);
+      return knn.set_input(cloud);
+    };
+
+    BENCHMARK("KDTree Parallel Build - " + std::to_string(cloud_size) + " points")
+    {
+      kdtree_t<scalar_t> knn;
+      knn.enable_parallel(true);
+      return knn.set_input(cloud);
+    };
+
+    // 以每秒构建的点数报告吞吐量 / Report throughput as points built per second
+    for (const bool parallel : {false, true})
+    {
+      constexpr int repeats = 3;
+      double total_ms = 0.0;
+      for (int r = 0; r < repeats; ++r)
+      {
+        kdtree_t<scalar_t> knn;
+        knn.enable_parallel(parallel);
+        toolbox::utils::stop_watch_timer_t timer;
+        timer.start();
+        knn.set_input(cloud);
+        timer.stop();
+        total_ms += timer.elapsed_time_ms();
+      }
+      const double mean_ms = total_ms / repeats;
+      std::cout << "KDTree " << (parallel ? "parallel" : "serial") << " build, " << cloud_size
+                << " points: " << std::fixed << std::setprecision(2) << mean_ms << " ms, "
+                << std::setprecision(2) << (static_cast<double>(cloud_size) / mean_ms / 1000.0)
+                << " Mpts/s" << std::endl;
+    }
+  }
+}
+
 TEST_CASE("KNN Benchmark - K-Neighbors Query", "[pcl][knn][benchmark]")
 {
   using scalar_t = float;
@@ -391,4 +439,45 @@ TEST_CASE("KNN Benchmark - KDTree Fallback for Metrics", "[pcl][knn][benchmark]"
       kdtree->kneighbors(query, k, indices, distances);
     }
   };
-}
\ No newline at end of file
+}
+
+TEST_CASE("KNN Benchmark - Batch Queries", "[pcl][knn][benchmark]")
+{
+  using scalar_t = float;
+
+  const std::size_t cloud_size = 50000;
+  const std::size_t num_queries = 1000;
+  const std::size_t k = 10;
+
+  auto cloud = generate_benchmark_cloud<scalar_t>(cloud_size);
+  auto queries = generate_query_points<scalar_t>(num_queries);
+
+  auto bfknn = std::make_unique<bfknn_t<scalar_t>>();
+  auto bfknn_parallel = std::make_unique<bfknn_parallel_t<scalar_t>>();
+  bfknn->set_input(cloud.points);
+  bfknn_parallel->set_input(cloud.points);
+
+  BENCHMARK("BruteForce Per-Query Loop - " + std::to_string(num_queries) + " queries")
+  {
+    std::vector<std::size_t> indices;
+    std::vector<scalar_t> distances;
+    for (const auto& query : queries)
+    {
+      bfknn->kneighbors(query, k, indices, distances);
+    }
+  };
+
+  BENCHMARK("BruteForce Tiled Batch - " + std::to_string(num_queries) + " queries")
+  {
+    std::vector<std::vector<std::size_t>> indices;
+    std::vector<std::vector<scalar_t>> distances;
+    return bfknn->kneighbors_batch(queries, k, indices, distances);
+  };
+
+  BENCHMARK("BruteForce Parallel Tiled Batch - " + std::to_string(num_queries) + " queries")
+  {
+    std::vector<std::vector<std::size_t>> indices;
+    std::vector<std::vector<scalar_t>> distances;
+    return bfknn_parallel->kneighbors_batch(queries, k, indices, distances);
+  };
+}
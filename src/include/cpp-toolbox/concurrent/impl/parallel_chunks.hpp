@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cpp-toolbox/base/thread_pool_singleton.hpp>
+
+// 分块执行只依赖线程池，TBB和原生后端共用同一实现
+// Chunked execution only relies on the thread pool, so both backends share it
+
+namespace toolbox::concurrent
+{
+
+// 声明 default_pool 函数
+inline base::thread_pool_singleton_t& default_pool();
+
+inline std::size_t parallel_chunk_count(std::size_t count, std::size_t threshold)
+{
+  if (count <= threshold) {
+    return 1;
+  }
+  return std::max<std::size_t>(1, default_pool().get_thread_count());
+}
+
+template<typename Function>
+void parallel_for_chunks(std::size_t count, std::size_t threshold, Function&& task)
+{
+  constexpr bool with_chunk =
+      std::is_invocable_v<Function&, std::size_t, std::size_t, std::size_t>;
+  auto run = [&task](std::size_t chunk, std::size_t begin, std::size_t end)
+  {
+    if constexpr (with_chunk) {
+      task(chunk, begin, end);
+    } else {
+      task(begin, end);
+    }
+  };
+
+  const std::size_t num_chunks = parallel_chunk_count(count, threshold);
+  if (num_chunks == 1) {
+    run(0, 0, count);
+    return;
+  }
+
+  // 每块都会执行（可能为空），按块的缓冲区因此总被写入
+  // Every chunk runs, possibly empty, so per-chunk buffers are always written
+  const std::size_t chunk_size = (count + num_chunks - 1) / num_chunks;
+  auto& pool = default_pool();
+  std::vector<std::future<void>> futures;
+  futures.reserve(num_chunks);
+  for (std::size_t c = 0; c < num_chunks; ++c) {
+    const std::size_t begin = std::min(c * chunk_size, count);
+    const std::size_t end = std::min(begin + chunk_size, count);
+    futures.emplace_back(pool.submit([&run, c, begin, end]() { run(c, begin, end); }));
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+}
+
+inline std::size_t parallel_chunk_count(std::size_t count, std::size_t threshold, bool enabled)
+{
+  return enabled ? parallel_chunk_count(count, threshold) : 1;
+}
+
+template<typename Function>
+void parallel_for_chunks(std::size_t count,
+                         std::size_t threshold,
+                         bool enabled,
+                         Function&& task)
+{
+  parallel_for_chunks(count,
+                      enabled ? threshold : std::numeric_limits<std::size_t>::max(),
+                      std::forward<Function>(task));
+}
+
+}  // namespace toolbox::concurrent
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <future>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <cpp-toolbox/base/thread_pool_singleton.hpp>
+
+// 基数排序只依赖线程池，TBB和原生后端共用同一实现
+// Radix sort only relies on the thread pool, so both backends share it
+
+namespace toolbox::concurrent
+{
+
+// 声明 default_pool 函数
+inline base::thread_pool_singleton_t& default_pool();
+
+template<typename Key, typename Value>
+void parallel_radix_sort_pairs(std::vector<Key>& keys,
+                               std::vector<Value>& values,
+                               unsigned key_bits,
+                               bool parallel)
+{
+  static_assert(std::is_integral_v<Key> && std::is_unsigned_v<Key>,
+                "parallel_radix_sort_pairs requires unsigned integer keys");
+
+  if (keys.size() != values.size()) {
+    throw std::invalid_argument(
+        "parallel_radix_sort_pairs: keys and values must have the same size");
+  }
+  const size_t total_size = keys.size();
+  if (total_size <= 1) {
+    return;
+  }
+
+  constexpr unsigned kRadixBits = 8;
+  constexpr size_t kBuckets = size_t {1} << kRadixBits;
+  constexpr size_t kMinChunkSize = 16384;  // 小块的调度开销大于收益
+  key_bits = std::min<unsigned>(key_bits, sizeof(Key) * 8);
+
+  auto& pool = default_pool();
+  const size_t max_tasks = parallel ? std::max<size_t>(1, pool.get_thread_count()) : 1;
+  size_t num_tasks =
+      std::clamp<size_t>(total_size / kMinChunkSize, 1, max_tasks);
+  const size_t chunk_size = (total_size + num_tasks - 1) / num_tasks;
+  num_tasks = (total_size + chunk_size - 1) / chunk_size;
+
+  // 第t块的第b个桶位于 histograms[t * kBuckets + b]
+  std::vector<size_t> histograms(num_tasks * kBuckets);
+  std::vector<Key> key_buffer(total_size);
+  std::vector<Value> value_buffer(total_size);
+
+  auto run_tasks = [&](auto&& task)
+  {
+    if (num_tasks == 1) {
+      task(0, 0, total_size);
+      return;
+    }
+    std::vector<std::future<void>> futures;
+    futures.reserve(num_tasks);
+    for (size_t t = 0; t < num_tasks; ++t) {
+      const size_t start_idx = t * chunk_size;
+      const size_t end_idx = std::min(start_idx + chunk_size, total_size);
+      futures.emplace_back(pool.submit([&task, t, start_idx, end_idx]()
+                                       { task(t, start_idx, end_idx); }));
+    }
+    for (auto& fut : futures) {
+      fut.get();
+    }
+  };
+
+  for (unsigned shift = 0; shift < key_bits; shift += kRadixBits) {
+    run_tasks(
+        [&](size_t t, size_t start_idx, size_t end_idx)
+        {
+          size_t* histogram = histograms.data() + t * kBuckets;
+          std::fill(histogram, histogram + kBuckets, 0);
+          for (size_t i = start_idx; i < end_idx; ++i) {
+            ++histogram[(keys[i] >> shift) & (kBuckets - 1)];
+          }
+        });
+
+    // 所有键在这一位上相同时排列不变
+    bool single_bucket = false;
+    for (size_t b = 0; b < kBuckets && !single_bucket; ++b) {
+      size_t bucket_total = 0;
+      for (size_t t = 0; t < num_tasks; ++t) {
+        bucket_total += histograms[t * kBuckets + b];
+      }
+      single_bucket = bucket_total == total_size;
+    }
+    if (single_bucket) {
+      continue;
+    }
+
+    // 桶优先、块次之的前缀和保证排序稳定
+    size_t offset = 0;
+    for (size_t b = 0; b < kBuckets; ++b) {
+      for (size_t t = 0; t < num_tasks; ++t) {
+        const size_t count = histograms[t * kBuckets + b];
+        histograms[t * kBuckets + b] = offset;
+        offset += count;
+      }
+    }
+
+    run_tasks(
+        [&](size_t t, size_t start_idx, size_t end_idx)
+        {
+          size_t* positions = histograms.data() + t * kBuckets;
+          for (size_t i = start_idx; i < end_idx; ++i) {
+            const size_t dest = positions[(keys[i] >> shift) & (kBuckets - 1)]++;
+            key_buffer[dest] = keys[i];
+            value_buffer[dest] = std::move(values[i]);
+          }
+        });
+
+    keys.swap(key_buffer);
+    values.swap(value_buffer);
+  }
+}
+
+}  // namespace toolbox::concurrent
@@ -104,6 +104,86 @@ CPP_TOOLBOX_EXPORT void parallel_for_each(const std::array<T, N>& arr,
   parallel_for_each(arr.cbegin(), arr.cend(), std::move(func));
 }
 
+//--------------------------------------------------------------------------
+// parallel_for_chunks
+//--------------------------------------------------------------------------
+
+/**
+ * @brief parallel_for_chunks使用的块数/Number of chunks parallel_for_chunks uses
+ * @param count 元素数/Number of elements
+ * @param threshold 元素数不超过此值时只有一块/At most this many elements give a
+ * single chunk
+ * @return 超过阈值时为线程池的线程数，否则为1/The pool's thread count above the
+ * threshold, 1 otherwise
+ */
+CPP_TOOLBOX_EXPORT inline std::size_t parallel_chunk_count(std::size_t count,
+                                                           std::size_t threshold);
+
+/**
+ * @brief 把[0, count)按块在默认线程池上执行/Runs [0, count) in chunks on the
+ * default thread pool
+ * @details 块数由parallel_chunk_count给出，只有一块时直接在调用线程上执行；task以
+ * (begin, end)或(chunk, begin, end)调用，后者便于写入按块分配的缓冲区/The chunk
+ * count comes from parallel_chunk_count and a single chunk runs on the calling
+ * thread; task is called as (begin, end) or (chunk, begin, end), the latter for
+ * writing into per-chunk buffers
+ * @tparam Function 可调用对象类型/Callable type
+ * @param count 元素数/Number of elements
+ * @param threshold 元素数不超过此值时串行执行，传入count即强制串行/At most this
+ * many elements run serially; passing count forces a serial run
+ * @param task 处理一块的函数/Function processing one chunk
+ *
+ * @code{.cpp}
+ * std::vector<float> values(100000);
+ * parallel_for_chunks(values.size(), 1024, [&](std::size_t begin, std::size_t end) {
+ *   for (std::size_t i = begin; i < end; ++i) {
+ *     values[i] = std::sqrt(static_cast<float>(i));
+ *   }
+ * });
+ * @endcode
+ */
+template<typename Function>
+CPP_TOOLBOX_EXPORT void parallel_for_chunks(std::size_t count,
+                                            std::size_t threshold,
+                                            Function&& task);
+
+/**
+ * @brief 可关闭并行的parallel_chunk_count/parallel_chunk_count that can be
+ * switched off
+ * @param enabled 为false时总是一块/Always a single chunk when false
+ */
+CPP_TOOLBOX_EXPORT inline std::size_t parallel_chunk_count(std::size_t count,
+                                                           std::size_t threshold,
+                                                           bool enabled);
+
+/**
+ * @brief 可关闭并行的parallel_for_chunks/parallel_for_chunks that can be switched
+ * off
+ * @details enabled通常是调用者的enable_parallel开关。task自身会向线程池提交并等待
+ * 任务时（例如在线程池上搜索的KNN）也应传入false：嵌套提交会让线程池的工作线程互相
+ * 等待，线程全部阻塞时任务永远不会执行/enabled is usually the caller's
+ * enable_parallel switch. Pass false as well when the task itself submits to the
+ * pool and waits (e.g. a KNN searcher that runs on the pool): nested submissions
+ * leave pool workers waiting on each other, and once every worker blocks the
+ * inner tasks never run
+ * @param count 元素数/Number of elements
+ * @param threshold 元素数不超过此值时串行执行/At most this many elements run
+ * serially
+ * @param enabled 为false时在调用线程上串行执行/Runs serially on the calling
+ * thread when false
+ * @param task 处理一块的函数/Function processing one chunk
+ *
+ * @code{.cpp}
+ * parallel_for_chunks(cloud.size(), 1024, m_enable_parallel,
+ *                     [&](std::size_t begin, std::size_t end) { process(begin, end); });
+ * @endcode
+ */
+template<typename Function>
+CPP_TOOLBOX_EXPORT void parallel_for_chunks(std::size_t count,
+                                            std::size_t threshold,
+                                            bool enabled,
+                                            Function&& task);
+
 //--------------------------------------------------------------------------
 // parallel_transform
 //--------------------------------------------------------------------------
@@ -369,6 +449,43 @@ CPP_TOOLBOX_EXPORT void parallel_tim_sort(RandomIt begin,
                                           RandomIt end,
                                           Compare comp = Compare());
 
+//--------------------------------------------------------------------------
+// parallel_radix_sort_pairs
+//--------------------------------------------------------------------------
+
+/**
+ * @brief 按无符号整数键并行基数排序键值对（稳定）/Parallel stable radix sort of
+ * key-value pairs by unsigned integer key
+ * @details LSD基数排序，每轮8位；各块在线程池上并行统计直方图和分发，所有键在某一位上相同的轮次
+ * 会被跳过/LSD radix sort with 8-bit digits; chunks build histograms and scatter
+ * in parallel on the thread pool, and passes where every key shares the digit
+ * are skipped
+ * @tparam Key 无符号整数键类型/Unsigned integer key type
+ * @tparam Value 值类型/Value type
+ * @param keys 待排序的键，排序后原地更新/Keys to sort, updated in place
+ * @param values 与键一一对应的值，随键一起移动/Values paired with the keys, moved
+ * along with them
+ * @param key_bits 键的有效位数，键值小于2^key_bits时可减少轮数/Number of
+ * significant key bits, fewer passes when all keys are below 2^key_bits
+ * @param parallel 为false时在调用线程上串行排序，结果相同/Sorts serially on the
+ * calling thread when false, with the same result
+ * @throws std::invalid_argument 键和值的数量不同时/When keys and values differ in
+ * size
+ *
+ * @code{.cpp}
+ * std::vector<std::uint64_t> keys = {5, 1, 5, 0};
+ * std::vector<std::size_t> values = {0, 1, 2, 3};
+ * parallel_radix_sort_pairs(keys, values);
+ * // keys = {0, 1, 5, 5}, values = {3, 1, 0, 2}
+ * @endcode
+ */
+template<typename Key, typename Value>
+CPP_TOOLBOX_EXPORT void parallel_radix_sort_pairs(
+    std::vector<Key>& keys,
+    std::vector<Value>& values,
+    unsigned key_bits = sizeof(Key) * 8,
+    bool parallel = true);
+
 }  // namespace toolbox::concurrent
 
 // 包含实现文件
@@ -376,4 +493,7 @@ CPP_TOOLBOX_EXPORT void parallel_tim_sort(RandomIt begin,
 #  include "impl/parallel_tbb.hpp"
 #else
 #  include "impl/parallel_raw.hpp"
-#endif
\ No newline at end of file
+#endif
+
+#include "impl/parallel_chunks.hpp"
+#include "impl/parallel_radix_sort.hpp"
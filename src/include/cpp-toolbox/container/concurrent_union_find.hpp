@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include <cpp-toolbox/cpp-toolbox_export.hpp>
+
+namespace toolbox::container
+{
+
+/**
+ * @brief 无锁并查集 / Lock-free union-find
+ *
+ * 父指针数组由原子变量组成，多个线程可以同时调用unite()和find()。合并时总是把较大的根挂到
+ * 较小的根下并用CAS提交，因此不会形成环，每个集合的根都是其中最小的元素；查找时用CAS做路径
+ * 减半。所有合并完成后，结果与合并顺序无关。
+ * The parent array consists of atomics, so several threads may call unite()
+ * and find() concurrently. A union always hangs the larger root below the
+ * smaller one and commits with a CAS, which rules out cycles and makes the
+ * root of every set its smallest element; find() halves paths with CAS. Once
+ * all unions are done the result does not depend on their order.
+ *
+ * @code
+ * concurrent_union_find_t sets(num_points);
+ * // 在多个线程中 / From several threads
+ * sets.unite(a, b);
+ * // 合并结束后 / After the unions
+ * const bool same = sets.find(a) == sets.find(c);
+ * @endcode
+ */
+class CPP_TOOLBOX_EXPORT concurrent_union_find_t
+{
+public:
+  concurrent_union_find_t() = default;
+
+  explicit concurrent_union_find_t(std::size_t size) { reset(size); }
+
+  concurrent_union_find_t(const concurrent_union_find_t&) = delete;
+  concurrent_union_find_t& operator=(const concurrent_union_find_t&) = delete;
+  concurrent_union_find_t(concurrent_union_find_t&&) noexcept = default;
+  concurrent_union_find_t& operator=(concurrent_union_find_t&&) noexcept = default;
+  ~concurrent_union_find_t() = default;
+
+  /**
+   * @brief 重置为size个单元素集合，不能与其他操作并发 / Reset to size singleton sets,
+   * must not run concurrently with other calls
+   */
+  void reset(std::size_t size)
+  {
+    if (size != m_size) {
+      m_parent = std::make_unique<std::atomic<std::size_t>[]>(size);
+      m_size = size;
+    }
+    for (std::size_t i = 0; i < size; ++i) {
+      m_parent[i].store(i, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief 查找x所在集合的根 / Find the root of the set containing x
+   */
+  std::size_t find(std::size_t x) noexcept
+  {
+    while (true) {
+      std::size_t parent = m_parent[x].load(std::memory_order_acquire);
+      if (parent == x) {
+        return x;
+      }
+      const std::size_t grandparent = m_parent[parent].load(std::memory_order_acquire);
+      if (parent != grandparent) {
+        // 路径减半，失败说明其他线程已经改过，无需重试 / Path halving; a failure means
+        // another thread already moved it, no retry needed
+        m_parent[x].compare_exchange_weak(
+            parent, grandparent, std::memory_order_release, std::memory_order_relaxed);
+      }
+      x = grandparent;
+    }
+  }
+
+  /**
+   * @brief 合并a和b所在的集合 / Merge the sets containing a and b
+   * @return 两者原先是否属于不同集合 / Whether they were in different sets
+   */
+  bool unite(std::size_t a, std::size_t b) noexcept
+  {
+    while (true) {
+      a = find(a);
+      b = find(b);
+      if (a == b) {
+        return false;
+      }
+      if (a < b) {
+        std::swap(a, b);
+      }
+      // a为较大的根，只有它仍是根时才挂到b下 / a is the larger root and is linked below
+      // b only while it is still a root
+      std::size_t expected = a;
+      if (m_parent[a].compare_exchange_strong(
+              expected, b, std::memory_order_acq_rel, std::memory_order_acquire))
+      {
+        return true;
+      }
+    }
+  }
+
+  /**
+   * @brief 判断a和b是否在同一集合，并发合并时结果只代表某一时刻 / Whether a and b are in
+   * the same set; under concurrent unions this is a snapshot
+   */
+  bool same(std::size_t a, std::size_t b) noexcept
+  {
+    while (true) {
+      a = find(a);
+      b = find(b);
+      if (a == b) {
+        return true;
+      }
+      // a仍是根说明两者在检查时确实不同 / If a is still a root they really differed
+      if (m_parent[a].load(std::memory_order_acquire) == a) {
+        return false;
+      }
+    }
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+
+private:
+  std::unique_ptr<std::atomic<std::size_t>[]> m_parent;
+  std::size_t m_size = 0;
+};
+
+}  // namespace toolbox::container
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace toolbox::metrics::batch
+{
+
+/**
+ * @brief 一对多距离内核 / One-to-many distance kernels
+ *
+ * 数据按行优先连续存放（count×dim）。每次处理tile个数据点，每个点一个累加器，
+ * 对维度的循环在所有累加器上同时推进，编译器可以把tile展开为向量寄存器。
+ * Data is stored contiguously in row-major order (count×dim). Each step handles
+ * tile data points with one accumulator per point; the loop over dimensions advances
+ * all accumulators together so the compiler can map the tile onto vector registers.
+ */
+inline constexpr std::size_t tile = 8;
+
+/**
+ * @brief 通用的分块累加框架 / Generic tiled accumulation skeleton
+ * @param accumulate acc = accumulate(acc, q, x)
+ * @param finalize 把累加值转换为距离 / Converts an accumulated value to a distance
+ */
+template<typename T, typename Accumulate, typename Finalize>
+inline void accumulate_one_to_many(const T* query,
+                                   const T* data,
+                                   std::size_t count,
+                                   std::size_t dim,
+                                   T* out,
+                                   Accumulate accumulate,
+                                   Finalize finalize)
+{
+  std::size_t i = 0;
+  for (; i + tile <= count; i += tile) {
+    T acc[tile] = {};
+    const T* rows = data + i * dim;
+    for (std::size_t d = 0; d < dim; ++d) {
+      const T q = query[d];
+      for (std::size_t lane = 0; lane < tile; ++lane) {
+        acc[lane] = accumulate(acc[lane], q, rows[lane * dim + d]);
+      }
+    }
+    for (std::size_t lane = 0; lane < tile; ++lane) {
+      out[i + lane] = finalize(acc[lane]);
+    }
+  }
+  for (; i < count; ++i) {
+    T acc {};
+    const T* row = data + i * dim;
+    for (std::size_t d = 0; d < dim; ++d) {
+      acc = accumulate(acc, query[d], row[d]);
+    }
+    out[i] = finalize(acc);
+  }
+}
+
+template<typename T>
+inline void l2_one_to_many(const T* query, const T* data, std::size_t count, std::size_t dim, T* out)
+{
+  accumulate_one_to_many(
+      query, data, count, dim, out,
+      [](T acc, T q, T x) {
+        const T diff = x - q;
+        return acc + diff * diff;
+      },
+      [](T acc) { return std::sqrt(acc); });
+}
+
+template<typename T>
+inline void squared_l2_one_to_many(const T* query, const T* data, std::size_t count, std::size_t dim, T* out)
+{
+  accumulate_one_to_many(
+      query, data, count, dim, out,
+      [](T acc, T q, T x) {
+        const T diff = x - q;
+        return acc + diff * diff;
+      },
+      [](T acc) { return acc; });
+}
+
+template<typename T>
+inline void l1_one_to_many(const T* query, const T* data, std::size_t count, std::size_t dim, T* out)
+{
+  accumulate_one_to_many(
+      query, data, count, dim, out,
+      [](T acc, T q, T x) { return acc + std::abs(x - q); },
+      [](T acc) { return acc; });
+}
+
+template<typename T>
+inline void linf_one_to_many(const T* query, const T* data, std::size_t count, std::size_t dim, T* out)
+{
+  accumulate_one_to_many(
+      query, data, count, dim, out,
+      [](T acc, T q, T x) { return std::max(acc, std::abs(x - q)); },
+      [](T acc) { return acc; });
+}
+
+template<typename T>
+inline void chi_squared_one_to_many(const T* query, const T* data, std::size_t count, std::size_t dim, T* out)
+{
+  accumulate_one_to_many(
+      query, data, count, dim, out,
+      [](T acc, T q, T x) {
+        const T denominator = q + x;
+        const T diff = q - x;
+        return denominator > std::numeric_limits<T>::epsilon() ? acc + (diff * diff) / denominator
+                                                               : acc;
+      },
+      [](T acc) { return acc * T(0.5); });
+}
+
+/**
+ * @brief 余弦距离，复用查询范数和可选的预计算数据范数 / Cosine distance reusing the query norm
+ * and optional precomputed data norms
+ * @param data_norms 每个数据点的L2范数，为nullptr时现场计算 / L2 norm of each data point,
+ * computed on the fly when nullptr
+ */
+template<typename T>
+inline void cosine_one_to_many(const T* query,
+                               const T* data,
+                               std::size_t count,
+                               std::size_t dim,
+                               T* out,
+                               const T* data_norms = nullptr)
+{
+  T query_norm {};
+  for (std::size_t d = 0; d < dim; ++d) {
+    query_norm += query[d] * query[d];
+  }
+  query_norm = std::sqrt(query_norm);
+
+  // 先把点积写入out / Write dot products into out first
+  accumulate_one_to_many(
+      query, data, count, dim, out,
+      [](T acc, T q, T x) { return acc + q * x; },
+      [](T acc) { return acc; });
+
+  for (std::size_t i = 0; i < count; ++i) {
+    T data_norm;
+    if (data_norms) {
+      data_norm = data_norms[i];
+    } else {
+      const T* row = data + i * dim;
+      data_norm = T(0);
+      for (std::size_t d = 0; d < dim; ++d) {
+        data_norm += row[d] * row[d];
+      }
+      data_norm = std::sqrt(data_norm);
+    }
+
+    if (query_norm < std::numeric_limits<T>::epsilon() ||
+        data_norm < std::numeric_limits<T>::epsilon()) {
+      out[i] = T(1);  // Maximum distance for zero vectors
+      continue;
+    }
+    const T similarity = std::max(T(-1), std::min(T(1), out[i] / (query_norm * data_norm)));
+    out[i] = T(1) - similarity;
+  }
+}
+
+/**
+ * @brief 计算每行的L2范数 / Compute the L2 norm of every row
+ */
+template<typename T>
+inline std::vector<T> row_norms(const T* data, std::size_t count, std::size_t dim)
+{
+  std::vector<T> norms(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    const T* row = data + i * dim;
+    T sum {};
+    for (std::size_t d = 0; d < dim; ++d) {
+      sum += row[d] * row[d];
+    }
+    norms[i] = std::sqrt(sum);
+  }
+  return norms;
+}
+
+}  // namespace toolbox::metrics::batch
@@ -2,12 +2,14 @@
 
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <functional>
 #include <stdexcept>
 #include <vector>
 
 #include <cpp-toolbox/metrics/base_metric.hpp>
+#include <cpp-toolbox/metrics/batch_metric_kernels.hpp>
 #include <cpp-toolbox/metrics/metric_traits.hpp>
 #include <cpp-toolbox/metrics/vector_metrics.hpp>
 #include <cpp-toolbox/metrics/histogram_metrics.hpp>
@@ -29,6 +31,32 @@ public:
   
   virtual T distance(const T* a, const T* b, std::size_t size) const = 0;
   virtual T squared_distance(const T* a, const T* b, std::size_t size) const = 0;
+
+  // One-to-many: out[i] = distance(query, data + i * dim), data is row-major count x dim.
+  // A single virtual call covers the whole batch.
+  virtual void distance_batch(const T* query,
+                              const T* data,
+                              std::size_t count,
+                              std::size_t dim,
+                              T* out) const
+  {
+    for (std::size_t i = 0; i < count; ++i) {
+      out[i] = distance(query, data + i * dim, dim);
+    }
+  }
+
+  // Many-to-many: out[q * count + i] = distance(queries + q * dim, data + i * dim)
+  virtual void distance_matrix(const T* queries,
+                               std::size_t num_queries,
+                               const T* data,
+                               std::size_t count,
+                               std::size_t dim,
+                               T* out) const
+  {
+    for (std::size_t q = 0; q < num_queries; ++q) {
+      distance_batch(queries + q * dim, data, count, dim, out + q * count);
+    }
+  }
   
   // Container interface
   template<typename Container>
@@ -63,6 +91,51 @@ public:
     return metric_.squared_distance(a, b, size);
   }
 
+  // Known metrics dispatch to the tiled kernels, others loop over the statically bound metric
+  void distance_batch(const T* query,
+                      const T* data,
+                      std::size_t count,
+                      std::size_t dim,
+                      T* out) const override
+  {
+    if constexpr (std::is_same_v<MetricType, L2Metric<T>>) {
+      batch::l2_one_to_many(query, data, count, dim, out);
+    } else if constexpr (std::is_same_v<MetricType, L1Metric<T>>) {
+      batch::l1_one_to_many(query, data, count, dim, out);
+    } else if constexpr (std::is_same_v<MetricType, LinfMetric<T>>) {
+      batch::linf_one_to_many(query, data, count, dim, out);
+    } else if constexpr (std::is_same_v<MetricType, CosineMetric<T>>) {
+      batch::cosine_one_to_many(query, data, count, dim, out);
+    } else if constexpr (std::is_same_v<MetricType, ChiSquaredMetric<T>>) {
+      batch::chi_squared_one_to_many(query, data, count, dim, out);
+    } else {
+      for (std::size_t i = 0; i < count; ++i) {
+        out[i] = metric_.distance(query, data + i * dim, dim);
+      }
+    }
+  }
+
+  void distance_matrix(const T* queries,
+                       std::size_t num_queries,
+                       const T* data,
+                       std::size_t count,
+                       std::size_t dim,
+                       T* out) const override
+  {
+    if constexpr (std::is_same_v<MetricType, CosineMetric<T>>) {
+      // Data norms are shared by every query
+      const auto data_norms = batch::row_norms(data, count, dim);
+      for (std::size_t q = 0; q < num_queries; ++q) {
+        batch::cosine_one_to_many(queries + q * dim, data, count, dim, out + q * count,
+                                  data_norms.data());
+      }
+    } else {
+      for (std::size_t q = 0; q < num_queries; ++q) {
+        distance_batch(queries + q * dim, data, count, dim, out + q * count);
+      }
+    }
+  }
+
 private:
   MetricType metric_;
 };
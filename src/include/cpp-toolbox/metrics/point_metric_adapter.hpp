@@ -23,6 +23,25 @@ public:
   {
     return m_metric->squared_distance(a, b, size);
   }
+
+  void distance_batch(const T* query,
+                      const T* data,
+                      std::size_t count,
+                      std::size_t dim,
+                      T* out) const override
+  {
+    m_metric->distance_batch(query, data, count, dim, out);
+  }
+
+  void distance_matrix(const T* queries,
+                       std::size_t num_queries,
+                       const T* data,
+                       std::size_t count,
+                       std::size_t dim,
+                       T* out) const override
+  {
+    m_metric->distance_matrix(queries, num_queries, data, count, dim, out);
+  }
   
   // Adapter method for point types
   T operator()(const toolbox::types::point_t<T>& a, 
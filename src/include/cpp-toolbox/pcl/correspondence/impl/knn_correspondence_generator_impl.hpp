@@ -104,6 +104,11 @@ void knn_correspondence_generator_t<DataType, Signature, KNN>::perform_mutual_ve
     dst_to_src[corr.dst_idx] = corr.src_idx;
   }
   
+  // 源描述子的KNN只构建一次（HNSW等索引的构建开销不可忽略）
+  // Build the KNN over source descriptors once (index construction, e.g. HNSW, is not free)
+  auto src_knn = std::make_shared<KNN>();
+  src_knn->set_input(*this->m_src_descriptors);
+
   // 对每个目标描述子执行反向搜索 / Perform reverse search for each target descriptor
   for (const auto& forward_corr : forward_corrs) {
     // 获取目标描述子在源描述子集中的索引 / Get target descriptor's index in source descriptor set
@@ -115,10 +120,6 @@ void knn_correspondence_generator_t<DataType, Signature, KNN>::perform_mutual_ve
       }
     }
     
-    // 临时创建一个只包含源描述子的KNN / Temporarily create a KNN with only source descriptors
-    auto src_knn = std::make_shared<KNN>();
-    src_knn->set_input(*this->m_src_descriptors);
-    
     // 查找最近的源描述子 / Find nearest source descriptor
     std::vector<std::size_t> indices;
     std::vector<typename Signature::data_type> distances;
@@ -7,6 +7,7 @@
 #include <cpp-toolbox/cpp-toolbox_export.hpp>
 #include <cpp-toolbox/pcl/descriptors/base_descriptor_extractor.hpp>
 #include <cpp-toolbox/pcl/knn/kdtree.hpp>
+#include <cpp-toolbox/pcl/knn/neighborhood_graph.hpp>
 #include <cpp-toolbox/pcl/norm/pca_norm.hpp>
 #include <cpp-toolbox/metrics/vector_metrics.hpp>
 
@@ -115,11 +116,21 @@ public:
    */
   std::size_t set_search_radius(data_type radius);
 
+  /**
+   * @brief Get the search radius for neighbor search
+   */
+  [[nodiscard]] data_type get_search_radius() const noexcept { return m_search_radius; }
+
   /**
    * @brief Set the maximum number of neighbors to consider
    */
   std::size_t set_num_neighbors(std::size_t num_neighbors);
 
+  /**
+   * @brief Get the maximum number of neighbors to consider
+   */
+  [[nodiscard]] std::size_t get_num_neighbors() const noexcept { return m_num_neighbors; }
+
   /**
    * @brief Set the point cloud normals (optional, will be computed if not
    * provided)
@@ -131,6 +142,15 @@ public:
    */
   void enable_parallel_impl(bool enable);
 
+  /**
+   * @brief Use a precomputed neighborhood graph instead of radius searches
+   *
+   * Rows are cut to the search radius and the neighbor limit, so build the graph with a
+   * radius of at least set_search_radius(). When no normals are given the same graph is
+   * reused for normal estimation.
+   */
+  void set_neighborhood_graph(const neighborhood_graph_t<data_type>& graph);
+
   /**
    * @brief Compute descriptors for given keypoints
    */
@@ -143,6 +163,25 @@ public:
       const std::vector<std::size_t>& keypoint_indices,
       std::unique_ptr<std::vector<signature_type>>& descriptors) const;
 
+  /**
+   * @brief Batch FPFH from precomputed normals and a neighborhood graph
+   *
+   * Marks the union of the keypoints and their neighbors, computes the SPFH of each of
+   * those points exactly once, in parallel, into one flat row-major array, and then
+   * accumulates every FPFH from contiguous 33-bin rows in a loop the compiler can
+   * vectorize. It runs no normal estimation and no KNN search. Graph rows are cut to the
+   * search radius and the neighbor limit, and the descriptors equal those of the cached
+   * compute() path. compute() takes this path itself whenever a graph is set and the
+   * keypoints are not sparse enough for direct computation.
+   *
+   * @return false when the graph, the normals or a keypoint index does not fit the cloud
+   */
+  bool compute_batch(const point_cloud& cloud,
+                     const point_cloud& normals,
+                     const neighborhood_graph_t<data_type>& graph,
+                     const std::vector<std::size_t>& keypoint_indices,
+                     std::vector<signature_type>& descriptors) const;
+
 private:
   struct spfh_signature_t
   {
@@ -270,6 +309,14 @@ private:
                                     std::vector<bool>& spfh_computed,
                                     signature_type& fpfh) const;
 
+  /**
+   * @brief Radius neighbors of a cloud point, capped at m_num_neighbors
+   */
+  void find_neighbors(const point_cloud& cloud,
+                      std::size_t index,
+                      std::vector<std::size_t>& indices,
+                      std::vector<data_type>& distances) const;
+
   void compute_pair_features(const point_t<data_type>& p1,
                              const point_t<data_type>& n1,
                              const point_t<data_type>& p2,
@@ -289,6 +336,7 @@ private:
   point_cloud_ptr m_cloud;
   point_cloud_ptr m_normals;
   knn_type* m_knn = nullptr;
+  const neighborhood_graph_t<data_type>* m_graph = nullptr;
 };
 
 }  // namespace toolbox::pcl
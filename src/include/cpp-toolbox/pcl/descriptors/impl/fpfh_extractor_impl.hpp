@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <iostream>
 #include <cpp-toolbox/concurrent/parallel.hpp>
+#include <cpp-toolbox/logger/thread_logger.hpp>
 
 namespace toolbox::pcl
 {
@@ -63,14 +64,50 @@ void fpfh_extractor_t<DataType, KNN>::enable_parallel_impl(bool enable)
   m_enable_parallel = enable;
 }
 
+template<typename DataType, typename KNN>
+void fpfh_extractor_t<DataType, KNN>::set_neighborhood_graph(
+    const neighborhood_graph_t<data_type>& graph)
+{
+  m_graph = &graph;
+}
+
+template<typename DataType, typename KNN>
+void fpfh_extractor_t<DataType, KNN>::find_neighbors(const point_cloud& cloud,
+                                                     std::size_t index,
+                                                     std::vector<std::size_t>& indices,
+                                                     std::vector<data_type>& distances) const
+{
+  if (m_graph)
+  {
+    // 图中的行已按距离排序，取半径内的前m_num_neighbors个 / Graph rows are sorted, take the
+    // first m_num_neighbors within the radius
+    m_graph->neighbors(index, m_search_radius, m_num_neighbors, indices, distances);
+    return;
+  }
+
+  m_knn->radius_neighbors(cloud.points[index], m_search_radius, indices, distances);
+  if (indices.size() > m_num_neighbors)
+  {
+    indices.resize(m_num_neighbors);
+    distances.resize(m_num_neighbors);
+  }
+}
+
 template<typename DataType, typename KNN>
 void fpfh_extractor_t<DataType, KNN>::compute_impl(
     const point_cloud& cloud,
     const std::vector<std::size_t>& keypoint_indices,
     std::vector<signature_type>& descriptors) const
 {
-  if (!m_knn || keypoint_indices.empty())
+  if ((!m_knn && !m_graph) || keypoint_indices.empty())
+  {
+    descriptors.clear();
+    return;
+  }
+  if (m_graph && m_graph->size() != cloud.size())
   {
+    LOG_ERROR_S << "fpfh_extractor_t: Neighborhood graph has " << m_graph->size()
+                << " rows but the cloud has " << cloud.size() << " points";
     descriptors.clear();
     return;
   }
@@ -83,7 +120,14 @@ void fpfh_extractor_t<DataType, KNN>::compute_impl(
     normals->points.resize(cloud.size());
     pca_norm_extractor_t<data_type, knn_type> norm_extractor;
     norm_extractor.set_input(cloud);
-    norm_extractor.set_knn(*m_knn);
+    if (m_graph)
+    {
+      norm_extractor.set_neighborhood_graph(*m_graph);
+    }
+    else
+    {
+      norm_extractor.set_knn(*m_knn);
+    }
     norm_extractor.set_num_neighbors(m_num_neighbors);
     norm_extractor.enable_parallel(m_enable_parallel);
     norm_extractor.extract(normals);
@@ -112,11 +156,7 @@ void fpfh_extractor_t<DataType, KNN>::compute_impl(
         temp_indices.clear();
         temp_distances.clear();
         
-        m_knn->radius_neighbors(cloud.points[keypoint_idx], m_search_radius, temp_indices, temp_distances);
-        if (temp_indices.size() > m_num_neighbors) {
-          temp_indices.resize(m_num_neighbors);
-          temp_distances.resize(m_num_neighbors);
-        }
+        find_neighbors(cloud, keypoint_idx, temp_indices, temp_distances);
         
         // 直接计算FPFH，不预计算SPFH / Compute FPFH directly without pre-computing SPFH
         compute_fpfh_direct(cloud, *normals, keypoint_idx, temp_indices, temp_distances, descriptors[i]);
@@ -134,11 +174,7 @@ void fpfh_extractor_t<DataType, KNN>::compute_impl(
         temp_distances.reserve(m_num_neighbors);
         
         std::size_t keypoint_idx = keypoint_indices[i];
-        m_knn->radius_neighbors(cloud.points[keypoint_idx], m_search_radius, temp_indices, temp_distances);
-        if (temp_indices.size() > m_num_neighbors) {
-          temp_indices.resize(m_num_neighbors);
-          temp_distances.resize(m_num_neighbors);
-        }
+        find_neighbors(cloud, keypoint_idx, temp_indices, temp_distances);
         compute_fpfh_direct(cloud, *normals, keypoint_idx, temp_indices, temp_distances, descriptors[i]);
       });
     } else {
@@ -147,6 +183,14 @@ void fpfh_extractor_t<DataType, KNN>::compute_impl(
     return;
   }
   
+  // 有近邻图时每个SPFH只算一次，扁平数组，无需加锁 / With a graph every SPFH is computed
+  // once into a flat array, without any locking
+  if (m_graph)
+  {
+    compute_batch(cloud, *normals, *m_graph, keypoint_indices, descriptors);
+    return;
+  }
+
   // std::cout << "[FPFH] Using optimized caching strategy\n";
   // 高密度情况使用优化的缓存策硅 / High density case uses optimized caching strategy
   
@@ -170,22 +214,14 @@ void fpfh_extractor_t<DataType, KNN>::compute_impl(
     toolbox::concurrent::parallel_for_each(indices.begin(), indices.end(),
                                           [&](std::size_t i) {
       std::size_t keypoint_idx = keypoint_indices[i];
-      m_knn->radius_neighbors(cloud.points[keypoint_idx], m_search_radius,
-                             keypoint_neighbor_indices[i], keypoint_neighbor_distances[i]);
-      if (keypoint_neighbor_indices[i].size() > m_num_neighbors) {
-        keypoint_neighbor_indices[i].resize(m_num_neighbors);
-        keypoint_neighbor_distances[i].resize(m_num_neighbors);
-      }
+      find_neighbors(cloud, keypoint_idx, keypoint_neighbor_indices[i],
+                     keypoint_neighbor_distances[i]);
     });
   } else {
     for (std::size_t i = 0; i < keypoint_indices.size(); ++i) {
       std::size_t keypoint_idx = keypoint_indices[i];
-      m_knn->radius_neighbors(cloud.points[keypoint_idx], m_search_radius,
-                             keypoint_neighbor_indices[i], keypoint_neighbor_distances[i]);
-      if (keypoint_neighbor_indices[i].size() > m_num_neighbors) {
-        keypoint_neighbor_indices[i].resize(m_num_neighbors);
-        keypoint_neighbor_distances[i].resize(m_num_neighbors);
-      }
+      find_neighbors(cloud, keypoint_idx, keypoint_neighbor_indices[i],
+                     keypoint_neighbor_distances[i]);
     }
   }
   
@@ -221,12 +257,8 @@ void fpfh_extractor_t<DataType, KNN>::compute_impl(
         
         // 检查是否已缓存邻居 / Check if neighbors are already cached
         if (!all_neighbors[point_idx].computed) {
-          m_knn->radius_neighbors(cloud.points[point_idx], m_search_radius,
-                                 all_neighbors[point_idx].indices, all_neighbors[point_idx].distances);
-          if (all_neighbors[point_idx].indices.size() > m_num_neighbors) {
-            all_neighbors[point_idx].indices.resize(m_num_neighbors);
-            all_neighbors[point_idx].distances.resize(m_num_neighbors);
-          }
+          find_neighbors(cloud, point_idx, all_neighbors[point_idx].indices,
+                         all_neighbors[point_idx].distances);
           all_neighbors[point_idx].computed = true;
         }
         
@@ -245,12 +277,8 @@ void fpfh_extractor_t<DataType, KNN>::compute_impl(
         std::size_t point_idx = points_to_precompute[i];
         
         if (!all_neighbors[point_idx].computed) {
-          m_knn->radius_neighbors(cloud.points[point_idx], m_search_radius,
-                                 all_neighbors[point_idx].indices, all_neighbors[point_idx].distances);
-          if (all_neighbors[point_idx].indices.size() > m_num_neighbors) {
-            all_neighbors[point_idx].indices.resize(m_num_neighbors);
-            all_neighbors[point_idx].distances.resize(m_num_neighbors);
-          }
+          find_neighbors(cloud, point_idx, all_neighbors[point_idx].indices,
+                         all_neighbors[point_idx].distances);
           all_neighbors[point_idx].computed = true;
         }
         
@@ -329,6 +357,160 @@ void fpfh_extractor_t<DataType, KNN>::compute_impl(
   compute_impl(cloud, keypoint_indices, *descriptors);
 }
 
+template<typename DataType, typename KNN>
+bool fpfh_extractor_t<DataType, KNN>::compute_batch(
+    const point_cloud& cloud,
+    const point_cloud& normals,
+    const neighborhood_graph_t<data_type>& graph,
+    const std::vector<std::size_t>& keypoint_indices,
+    std::vector<signature_type>& descriptors) const
+{
+  constexpr std::size_t k_bins = signature_type::HISTOGRAM_SIZE;
+  constexpr std::size_t k_no_row = static_cast<std::size_t>(-1);
+  const std::size_t num_points = cloud.size();
+
+  descriptors.clear();
+  if (graph.size() != num_points || normals.size() != num_points)
+  {
+    LOG_ERROR_S << "fpfh_extractor_t: Graph with " << graph.size() << " rows and "
+                << normals.size() << " normals given for " << num_points << " points";
+    return false;
+  }
+  for (std::size_t keypoint_idx : keypoint_indices)
+  {
+    if (keypoint_idx >= num_points)
+    {
+      LOG_ERROR_S << "fpfh_extractor_t: Keypoint index " << keypoint_idx
+                  << " is out of range for " << num_points << " points";
+      return false;
+    }
+  }
+
+  // 步骤1：关键点及其邻居的并集，按点序分配SPFH行 / Step 1: the union of the keypoints and
+  // their neighbors, given SPFH rows in point order
+  std::vector<std::size_t> rows(num_points, k_no_row);
+  for (std::size_t keypoint_idx : keypoint_indices)
+  {
+    rows[keypoint_idx] = 0;
+    const auto range = graph.neighbors(keypoint_idx, m_search_radius, m_num_neighbors);
+    for (std::size_t n = 0; n < range.size; ++n)
+    {
+      rows[range.indices[n]] = 0;
+    }
+  }
+  std::vector<std::size_t> spfh_points;
+  spfh_points.reserve(num_points);
+  for (std::size_t i = 0; i < num_points; ++i)
+  {
+    if (rows[i] != k_no_row)
+    {
+      rows[i] = spfh_points.size();
+      spfh_points.push_back(i);
+    }
+  }
+
+  // 步骤2：每个点的SPFH只计算一次 / Step 2: the SPFH of every point, exactly once
+  std::vector<data_type> spfh(spfh_points.size() * k_bins, DataType(0));
+  auto compute_row = [&](std::size_t r) {
+    const std::size_t index = spfh_points[r];
+    data_type* histogram = spfh.data() + r * k_bins;
+    const auto& p1 = cloud.points[index];
+    const auto& n1 = normals.points[index];
+    const auto range = graph.neighbors(index, m_search_radius, m_num_neighbors);
+
+    std::size_t valid_neighbors = 0;
+    for (std::size_t n = 0; n < range.size; ++n)
+    {
+      const std::size_t neighbor_idx = range.indices[n];
+      if (neighbor_idx == index) continue;
+
+      data_type f1, f2, f3;
+      compute_pair_features(
+          p1, n1, cloud.points[neighbor_idx], normals.points[neighbor_idx], f1, f2, f3);
+      histogram[compute_bin_index(f1, DataType(-1), DataType(1), 11)] += DataType(1);
+      histogram[11 + compute_bin_index(f2, DataType(-1), DataType(1), 11)] += DataType(1);
+      histogram[22 + compute_bin_index(f3, DataType(-M_PI), DataType(M_PI), 11)] += DataType(1);
+      ++valid_neighbors;
+    }
+
+    if (valid_neighbors > 0)
+    {
+      const data_type norm_factor = DataType(1) / static_cast<data_type>(valid_neighbors);
+      for (std::size_t b = 0; b < k_bins; ++b)
+      {
+        histogram[b] *= norm_factor;
+      }
+    }
+  };
+
+  // 步骤3：按距离倒数加权累加连续的33维行 / Step 3: accumulate contiguous 33-bin rows
+  // weighted by inverse distance
+  descriptors.resize(keypoint_indices.size());
+  auto compute_descriptor = [&](std::size_t k) {
+    const std::size_t index = keypoint_indices[k];
+    auto& histogram = descriptors[k].histogram;
+    const auto range = graph.neighbors(index, m_search_radius, m_num_neighbors);
+    if (range.size == 0)
+    {
+      std::fill(histogram.begin(), histogram.end(), DataType(0));
+      return;
+    }
+
+    const data_type* own = spfh.data() + rows[index] * k_bins;
+    std::copy(own, own + k_bins, histogram.begin());
+    data_type weight_sum = DataType(0);
+    for (std::size_t n = 0; n < range.size; ++n)
+    {
+      const std::size_t neighbor_idx = range.indices[n];
+      if (neighbor_idx == index) continue;
+
+      const data_type weight = DataType(1) / (range.distances[n] + DataType(1e-6));
+      weight_sum += weight;
+      const data_type* row = spfh.data() + rows[neighbor_idx] * k_bins;
+      for (std::size_t b = 0; b < k_bins; ++b)
+      {
+        histogram[b] += weight * row[b];
+      }
+    }
+
+    if (weight_sum > DataType(0))
+    {
+      const data_type norm_factor = DataType(1) / (DataType(1) + weight_sum);
+      for (std::size_t b = 0; b < k_bins; ++b)
+      {
+        histogram[b] *= norm_factor;
+      }
+    }
+  };
+
+  // 每行和每个描述子的工作量相近，按连续块划分 / Rows and descriptors cost about the
+  // same each, so they are split into contiguous chunks
+  constexpr std::size_t k_parallel_threshold = 64;
+  toolbox::concurrent::parallel_for_chunks(
+      spfh_points.size(),
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t begin, std::size_t end)
+      {
+        for (std::size_t r = begin; r < end; ++r)
+        {
+          compute_row(r);
+        }
+      });
+  toolbox::concurrent::parallel_for_chunks(
+      keypoint_indices.size(),
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t begin, std::size_t end)
+      {
+        for (std::size_t k = begin; k < end; ++k)
+        {
+          compute_descriptor(k);
+        }
+      });
+  return true;
+}
+
 template<typename DataType, typename KNN>
 void fpfh_extractor_t<DataType, KNN>::compute_spfh(
     const point_cloud& cloud,
@@ -457,14 +639,7 @@ void fpfh_extractor_t<DataType, KNN>::compute_fpfh_feature(
   // Get neighbors
   std::vector<std::size_t> neighbor_indices;
   std::vector<data_type> neighbor_distances;
-  m_knn->radius_neighbors(cloud.points[index], m_search_radius, neighbor_indices, neighbor_distances);
-  
-  // Limit to m_num_neighbors
-  if (neighbor_indices.size() > m_num_neighbors)
-  {
-    neighbor_indices.resize(m_num_neighbors);
-    neighbor_distances.resize(m_num_neighbors);
-  }
+  find_neighbors(cloud, index, neighbor_indices, neighbor_distances);
 
   if (neighbor_indices.empty()) return;
 
@@ -644,12 +819,7 @@ void fpfh_extractor_t<DataType, KNN>::compute_fpfh_direct(
     // 计算邻居的邻居特征（简化版） / Compute neighbor's neighbor features (simplified)
     std::vector<std::size_t> nn_indices;
     std::vector<data_type> nn_distances;
-    m_knn->radius_neighbors(p2, m_search_radius, nn_indices, nn_distances);
-    
-    if (nn_indices.size() > m_num_neighbors) {
-      nn_indices.resize(m_num_neighbors);
-      nn_distances.resize(m_num_neighbors);
-    }
+    find_neighbors(cloud, neighbor_idx, nn_indices, nn_distances);
     
     for (std::size_t nn_idx : nn_indices)
     {
@@ -727,14 +897,8 @@ void fpfh_extractor_t<DataType, KNN>::compute_fpfh_feature_adaptive(
       // 检查是否有缓存的邻居信息 / Check if we have cached neighbor info
       if (!all_neighbors[neighbor_idx].computed)
       {
-        m_knn->radius_neighbors(cloud.points[neighbor_idx], m_search_radius,
-                               all_neighbors[neighbor_idx].indices,
-                               all_neighbors[neighbor_idx].distances);
-        if (all_neighbors[neighbor_idx].indices.size() > m_num_neighbors)
-        {
-          all_neighbors[neighbor_idx].indices.resize(m_num_neighbors);
-          all_neighbors[neighbor_idx].distances.resize(m_num_neighbors);
-        }
+        find_neighbors(cloud, neighbor_idx, all_neighbors[neighbor_idx].indices,
+                       all_neighbors[neighbor_idx].distances);
         all_neighbors[neighbor_idx].computed = true;
       }
       
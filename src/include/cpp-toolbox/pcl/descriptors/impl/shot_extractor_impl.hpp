@@ -3,6 +3,7 @@
 #include <cpp-toolbox/pcl/descriptors/shot_extractor.hpp>
 #include <numeric>
 #include <cpp-toolbox/concurrent/parallel.hpp>
+#include <cpp-toolbox/logger/thread_logger.hpp>
 #include <Eigen/Dense>
 #include <Eigen/Eigenvalues>
 
@@ -62,17 +63,53 @@ void shot_extractor_t<DataType, KNN>::enable_parallel_impl(bool enable)
   m_enable_parallel = enable;
 }
 
+template<typename DataType, typename KNN>
+void shot_extractor_t<DataType, KNN>::set_neighborhood_graph(
+    const neighborhood_graph_t<data_type>& graph)
+{
+  m_graph = &graph;
+}
+
+template<typename DataType, typename KNN>
+void shot_extractor_t<DataType, KNN>::find_neighbors(const point_cloud& cloud,
+                                                     std::size_t index,
+                                                     std::vector<std::size_t>& indices,
+                                                     std::vector<data_type>& distances) const
+{
+  if (m_graph)
+  {
+    // 图中的行已按距离排序，取半径内的前m_num_neighbors个 / Graph rows are sorted, take the
+    // first m_num_neighbors within the radius
+    m_graph->neighbors(index, m_search_radius, m_num_neighbors, indices, distances);
+    return;
+  }
+
+  m_knn->radius_neighbors(cloud.points[index], m_search_radius, indices, distances);
+  if (indices.size() > m_num_neighbors)
+  {
+    indices.resize(m_num_neighbors);
+    distances.resize(m_num_neighbors);
+  }
+}
+
 template<typename DataType, typename KNN>
 void shot_extractor_t<DataType, KNN>::compute_impl(
     const point_cloud& cloud,
     const std::vector<std::size_t>& keypoint_indices,
     std::vector<signature_type>& descriptors) const
 {
-  if (!m_knn || keypoint_indices.empty())
+  if ((!m_knn && !m_graph) || keypoint_indices.empty())
   {
     descriptors.clear();
     return;
   }
+  if (m_graph && m_graph->size() != cloud.size())
+  {
+    LOG_ERROR_S << "shot_extractor_t: Neighborhood graph has " << m_graph->size()
+                << " rows but the cloud has " << cloud.size() << " points";
+    descriptors.clear();
+    return;
+  }
 
   // Compute normals if not provided
   point_cloud_ptr normals = m_normals;
@@ -82,7 +119,14 @@ void shot_extractor_t<DataType, KNN>::compute_impl(
     normals->points.resize(cloud.size());
     pca_norm_extractor_t<data_type, knn_type> norm_extractor;
     norm_extractor.set_input(cloud);
-    norm_extractor.set_knn(*m_knn);
+    if (m_graph)
+    {
+      norm_extractor.set_neighborhood_graph(*m_graph);
+    }
+    else
+    {
+      norm_extractor.set_knn(*m_knn);
+    }
     norm_extractor.set_num_neighbors(m_num_neighbors);
     norm_extractor.enable_parallel(m_enable_parallel);
     norm_extractor.extract(normals);
@@ -98,14 +142,7 @@ void shot_extractor_t<DataType, KNN>::compute_impl(
       // Get neighbors
       std::vector<std::size_t> neighbor_indices;
       std::vector<data_type> neighbor_distances;
-      m_knn->radius_neighbors(cloud.points[keypoint_idx], m_search_radius, neighbor_indices, neighbor_distances);
-      
-      // Limit to m_num_neighbors
-      if (neighbor_indices.size() > m_num_neighbors)
-      {
-        neighbor_indices.resize(m_num_neighbors);
-        neighbor_distances.resize(m_num_neighbors);
-      }
+      find_neighbors(cloud, keypoint_idx, neighbor_indices, neighbor_distances);
       
       if (neighbor_indices.size() < 5)  // Need enough neighbors for robust LRF
       {
@@ -136,14 +173,7 @@ void shot_extractor_t<DataType, KNN>::compute_impl(
       // Get neighbors
       std::vector<std::size_t> neighbor_indices;
       std::vector<data_type> neighbor_distances;
-      m_knn->radius_neighbors(cloud.points[keypoint_idx], m_search_radius, neighbor_indices, neighbor_distances);
-      
-      // Limit to m_num_neighbors
-      if (neighbor_indices.size() > m_num_neighbors)
-      {
-        neighbor_indices.resize(m_num_neighbors);
-        neighbor_distances.resize(m_num_neighbors);
-      }
+      find_neighbors(cloud, keypoint_idx, neighbor_indices, neighbor_distances);
       
       if (neighbor_indices.size() < 5)  // Need enough neighbors for robust LRF
       {
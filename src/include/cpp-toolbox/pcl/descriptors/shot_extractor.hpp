@@ -8,6 +8,7 @@
 #include <cpp-toolbox/math/matrix.hpp>
 #include <cpp-toolbox/pcl/descriptors/base_descriptor_extractor.hpp>
 #include <cpp-toolbox/pcl/knn/kdtree.hpp>
+#include <cpp-toolbox/pcl/knn/neighborhood_graph.hpp>
 #include <cpp-toolbox/pcl/norm/pca_norm.hpp>
 #include <cpp-toolbox/metrics/vector_metrics.hpp>
 
@@ -116,11 +117,21 @@ public:
    */
   std::size_t set_search_radius(data_type radius);
 
+  /**
+   * @brief Get the search radius for neighbor search
+   */
+  [[nodiscard]] data_type get_search_radius() const noexcept { return m_search_radius; }
+
   /**
    * @brief Set the maximum number of neighbors to consider
    */
   std::size_t set_num_neighbors(std::size_t num_neighbors);
 
+  /**
+   * @brief Get the maximum number of neighbors to consider
+   */
+  [[nodiscard]] std::size_t get_num_neighbors() const noexcept { return m_num_neighbors; }
+
   /**
    * @brief Set the point cloud normals (optional, will be computed if not
    * provided)
@@ -132,6 +143,15 @@ public:
    */
   void enable_parallel_impl(bool enable);
 
+  /**
+   * @brief Use a precomputed neighborhood graph instead of radius searches
+   *
+   * Rows are cut to the search radius and the neighbor limit, so build the graph with a
+   * radius of at least set_search_radius(). When no normals are given the same graph is
+   * reused for normal estimation.
+   */
+  void set_neighborhood_graph(const neighborhood_graph_t<data_type>& graph);
+
   /**
    * @brief Compute descriptors for given keypoints
    */
@@ -152,6 +172,14 @@ private:
     point_t<data_type> z_axis;
   };
 
+  /**
+   * @brief Radius neighbors of a cloud point, capped at m_num_neighbors
+   */
+  void find_neighbors(const point_cloud& cloud,
+                      std::size_t index,
+                      std::vector<std::size_t>& indices,
+                      std::vector<data_type>& distances) const;
+
   void compute_local_reference_frame(
       const point_cloud& cloud,
       const point_cloud& normals,
@@ -186,6 +214,7 @@ private:
   point_cloud_ptr m_cloud;
   point_cloud_ptr m_normals;
   knn_type* m_knn = nullptr;
+  const neighborhood_graph_t<data_type>* m_graph = nullptr;
 };
 
 }  // namespace toolbox::pcl
@@ -2,6 +2,7 @@
 
 #include <cpp-toolbox/cpp-toolbox_export.hpp>
 #include <cpp-toolbox/pcl/features/base_feature_extractor.hpp>
+#include <cpp-toolbox/pcl/features/grid_nms.hpp>
 #include <cpp-toolbox/pcl/knn/kdtree.hpp>
 #include <cpp-toolbox/pcl/knn/bfknn_parallel.hpp>
 #include <cpp-toolbox/types/point.hpp>
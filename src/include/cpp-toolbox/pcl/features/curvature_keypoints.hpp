@@ -2,6 +2,8 @@
 
 #include <cpp-toolbox/cpp-toolbox_export.hpp>
 #include <cpp-toolbox/pcl/features/base_feature_extractor.hpp>
+#include <cpp-toolbox/pcl/features/grid_nms.hpp>
+#include <cpp-toolbox/pcl/features/local_geometry_cache.hpp>
 #include <cpp-toolbox/pcl/knn/kdtree.hpp>
 #include <cpp-toolbox/pcl/knn/bfknn_parallel.hpp>
 #include <cpp-toolbox/metrics/vector_metrics.hpp>
@@ -124,6 +126,15 @@ public:
    */
   void set_non_maxima_radius(data_type radius) { m_non_maxima_radius = radius; }
 
+  /**
+   * @brief 使用共享的局部几何缓存 / Use a shared local geometry cache
+   * @param cache 以输入点云填充的缓存 / Cache filled from the input cloud
+   *
+   * @details 曲率直接取缓存的特征值，缓存的邻域代替搜索半径 / Curvatures take the cached
+   * eigenvalues and the cache's neighborhoods replace the search radius
+   */
+  void set_geometry_cache(const local_geometry_cache_t<data_type>& cache) { m_cache = &cache; }
+
   /**
    * @brief 获取曲率阈值 / Get curvature threshold
    * @return 当前的曲率阈值 / Current curvature threshold
@@ -196,6 +207,7 @@ private:
   
   point_cloud_ptr m_cloud;                                     ///< 输入点云 / Input point cloud
   knn_type* m_knn = nullptr;                                   ///< KNN算法指针 / KNN algorithm pointer
+  const local_geometry_cache_t<data_type>* m_cache = nullptr;  ///< 共享的局部几何缓存 / Shared local geometry cache
 
   /**
    * @brief 并行处理阈值，点数超过此值时启用并行 / Parallel processing threshold, enable parallel when point count exceeds this value
@@ -16,6 +16,10 @@
 #include <cpp-toolbox/pcl/features/susan_keypoints.hpp>
 #include <cpp-toolbox/pcl/features/agast_keypoints.hpp>
 #include <cpp-toolbox/pcl/features/mls_keypoints.hpp>
+#include <cpp-toolbox/pcl/features/local_geometry_cache.hpp>
+#include <cpp-toolbox/pcl/features/grid_nms.hpp>
+#include <cpp-toolbox/pcl/features/voxel_pyramid.hpp>
+#include <cpp-toolbox/pcl/features/keypoint_descriptor_extractor.hpp>
 #include <cpp-toolbox/pcl/knn/kdtree.hpp>
 #include <cpp-toolbox/pcl/knn/bfknn.hpp>
 #include <cpp-toolbox/pcl/knn/bfknn_parallel.hpp>
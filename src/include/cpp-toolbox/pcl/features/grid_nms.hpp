@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <cpp-toolbox/cpp-toolbox_export.hpp>
+#include <cpp-toolbox/types/point.hpp>
+
+namespace toolbox::pcl
+{
+
+/**
+ * @brief 基于体素网格的非极大值抑制 / Grid-based non-maximum suppression
+ *
+ * 候选点i被保留，当且仅当抑制半径内（含边界）没有其他点j的得分严格大于i的得分。点按边长
+ * 等于半径的体素分桶（并行基数排序），每个体素只与周围27个体素比较，因此代价与点数成线性，
+ * 不需要任何KNN搜索。体素按块在线程池上并行处理，输出按点索引升序，与线程数无关。
+ * A candidate i is kept if and only if no other point j within the suppression
+ * radius (inclusive) scores strictly higher than i. Points are binned into voxels
+ * whose edge equals the radius (by a parallel radix sort), and every voxel is
+ * compared against its 27 surrounding voxels only, so the cost is linear in the
+ * number of points and needs no KNN searches. Voxels are processed in parallel
+ * chunks on the thread pool, and the output is in ascending point order
+ * regardless of the thread count.
+ *
+ * 不参与竞争的点（例如响应无效的点）得分设为k_no_score；求局部最小值时对得分取负。
+ * 坐标非有限的点既不参与竞争也不会被保留。
+ * Points that must not compete (e.g. points with invalid responses) score
+ * k_no_score; negate the scores to find local minima instead. Points with
+ * non-finite coordinates neither compete nor are kept.
+ *
+ * @tparam DataType 数据类型（如float或double） / Data type (e.g., float or double)
+ *
+ * @code
+ * std::vector<float> scores(cloud.size());
+ * std::vector<std::uint8_t> candidates(cloud.size());
+ * for (std::size_t i = 0; i < cloud.size(); ++i) {
+ *   scores[i] = responses[i].valid ? responses[i].value : grid_nms_t<float>::k_no_score;
+ *   candidates[i] = responses[i].valid && responses[i].value > threshold;
+ * }
+ *
+ * grid_nms_t<float> nms(0.5f);
+ * nms.enable_parallel(true);
+ * auto keypoints = nms.suppress(cloud.points, scores, candidates);
+ * @endcode
+ */
+template<typename DataType>
+class CPP_TOOLBOX_EXPORT grid_nms_t
+{
+public:
+  using data_type = DataType;
+  using point_type = toolbox::types::point_t<data_type>;
+  using indices_vector = std::vector<std::size_t>;
+
+  /// 不参与竞争的得分 / Score of points that do not compete
+  static constexpr data_type k_no_score = std::numeric_limits<data_type>::lowest();
+
+  grid_nms_t() = default;
+  explicit grid_nms_t(data_type radius) : m_radius(radius) {}
+
+  /// 抑制半径，不大于0时保留全部候选点 / Suppression radius; all candidates are kept
+  /// when it is not positive
+  void set_radius(data_type radius) { m_radius = radius; }
+  [[nodiscard]] data_type get_radius() const noexcept { return m_radius; }
+
+  void enable_parallel(bool enable) { m_enable_parallel = enable; }
+
+  /**
+   * @brief 执行非极大值抑制 / Run non-maximum suppression
+   * @param points 点坐标 / Point coordinates
+   * @param scores 每个点的得分，越大越强 / Score of every point, larger is stronger
+   * @param candidates 非零表示该点是候选点 / Non-zero marks a candidate point
+   * @return 保留的候选点索引，升序 / Indices of the kept candidates, ascending
+   */
+  indices_vector suppress(const std::vector<point_type>& points,
+                          const std::vector<data_type>& scores,
+                          const std::vector<std::uint8_t>& candidates) const;
+
+private:
+  data_type m_radius = data_type(0);
+  bool m_enable_parallel = false;
+
+  /// 并行处理的最少元素数 / Minimum number of elements to run in parallel
+  static constexpr std::size_t k_parallel_threshold = 2048;
+};
+
+}  // namespace toolbox::pcl
+
+#include <cpp-toolbox/pcl/features/impl/grid_nms_impl.hpp>
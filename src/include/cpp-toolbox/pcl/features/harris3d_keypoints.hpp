@@ -2,6 +2,8 @@
 
 #include <cpp-toolbox/cpp-toolbox_export.hpp>
 #include <cpp-toolbox/pcl/features/base_feature_extractor.hpp>
+#include <cpp-toolbox/pcl/features/grid_nms.hpp>
+#include <cpp-toolbox/pcl/features/local_geometry_cache.hpp>
 #include <cpp-toolbox/pcl/knn/kdtree.hpp>
 #include <cpp-toolbox/pcl/knn/bfknn_parallel.hpp>
 #include <cpp-toolbox/metrics/vector_metrics.hpp>
@@ -134,6 +136,16 @@ public:
    */
   void set_num_neighbors(std::size_t num_neighbors) { m_num_neighbors = num_neighbors; }
 
+  /**
+   * @brief 使用共享的局部几何缓存 / Use a shared local geometry cache
+   * @param cache 以输入点云填充的缓存 / Cache filled from the input cloud
+   *
+   * @details 局部坐标系和结构张量的邻居都取自缓存，num_neighbors不再起作用 / Both the
+   * local frame and the structure tensor neighbors come from the cache and
+   * num_neighbors no longer applies
+   */
+  void set_geometry_cache(const local_geometry_cache_t<data_type>& cache) { m_cache = &cache; }
+
   /**
    * @brief 获取Harris响应阈值 / Get Harris response threshold
    * @return 当前的Harris响应阈值 / Current Harris response threshold
@@ -207,6 +219,7 @@ private:
   
   point_cloud_ptr m_cloud;                                       ///< 输入点云 / Input point cloud
   knn_type* m_knn = nullptr;                                     ///< KNN算法指针 / KNN algorithm pointer
+  const local_geometry_cache_t<data_type>* m_cache = nullptr;    ///< 共享的局部几何缓存 / Shared local geometry cache
 
   /**
    * @brief 并行处理阈值 / Parallel processing threshold
@@ -240,42 +240,21 @@ agast_keypoint_extractor_t<DataType, KNN>::apply_non_maxima_suppression(
     return {};
   }
 
-  indices_vector keypoints;
+  // Detected points compete; those with a positive score are candidates
   const std::size_t num_points = m_cloud->size();
-
+  std::vector<data_type> scores(num_points, grid_nms_t<data_type>::k_no_score);
+  std::vector<std::uint8_t> candidates(num_points, 0);
   for (std::size_t i = 0; i < num_points; ++i) {
     const auto& current_response = agast_responses[i];
-    
-    // Skip non-keypoints
-    if (!current_response.is_keypoint || current_response.score <= 0) {
-      continue;
-    }
-
-    // Find neighbors within non-maxima suppression radius
-    const auto& query_point = m_cloud->points[i];
-    std::vector<std::size_t> neighbor_indices;
-    std::vector<data_type> neighbor_distances;
-    
-    m_knn->radius_neighbors(query_point, m_non_maxima_radius, neighbor_indices, neighbor_distances);
-
-    // Check if current point is local maximum
-    bool is_local_maximum = true;
-    for (const auto& neighbor_idx : neighbor_indices) {
-      if (neighbor_idx != i && neighbor_idx < agast_responses.size()) {
-        if (agast_responses[neighbor_idx].is_keypoint && 
-            agast_responses[neighbor_idx].score > current_response.score) {
-          is_local_maximum = false;
-          break;
-        }
-      }
-    }
-
-    if (is_local_maximum) {
-      keypoints.push_back(i);
+    if (current_response.is_keypoint) {
+      scores[i] = current_response.score;
+      candidates[i] = current_response.score > 0 ? 1 : 0;
     }
   }
 
-  return keypoints;
+  grid_nms_t<data_type> nms(m_non_maxima_radius);
+  nms.enable_parallel(m_enable_parallel);
+  return nms.suppress(m_cloud->points, scores, candidates);
 }
 
 template<typename DataType, typename KNN>
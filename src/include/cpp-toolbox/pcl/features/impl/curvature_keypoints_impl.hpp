@@ -1,9 +1,8 @@
 #pragma once
 
 #include <cpp-toolbox/base/thread_pool_singleton.hpp>
+#include <cpp-toolbox/pcl/norm/batch_pca.hpp>
 #include <cpp-toolbox/types/point.hpp>
-#include <Eigen/Dense>
-#include <Eigen/Eigenvalues>
 #include <algorithm>
 #include <cmath>
 #include <future>
@@ -53,57 +52,41 @@ template<typename DataType, typename KNN>
 typename curvature_keypoint_extractor_t<DataType, KNN>::CurvatureInfo
 curvature_keypoint_extractor_t<DataType, KNN>::compute_curvature(std::size_t point_idx)
 {
-  if (!m_cloud || !m_knn || point_idx >= m_cloud->size()) {
+  if (!m_cloud || (!m_knn && !m_cache) || point_idx >= m_cloud->size()) {
     return CurvatureInfo{0, 0, 0, 0, 0};
   }
 
-  const auto& query_point = m_cloud->points[point_idx];
-  std::vector<std::size_t> neighbor_indices;
-  std::vector<data_type> neighbor_distances;
-
-  // 在半径内查找邻居点 / Find neighbors within radius
-  m_knn->radius_neighbors(query_point, m_search_radius, neighbor_indices, neighbor_distances);
+  pca_result_t<data_type> pca_result;
+  if (m_cache) {
+    // 特征值取自共享缓存 / Eigenvalues come from the shared cache
+    pca_result = (*m_cache)[point_idx];
+    if (pca_result.num_points < m_min_neighbors) {
+      return CurvatureInfo{0, 0, 0, 0, 0};
+    }
+  } else {
+    const auto& query_point = m_cloud->points[point_idx];
+    std::vector<std::size_t> neighbor_indices;
+    std::vector<data_type> neighbor_distances;
 
-  if (neighbor_indices.size() < m_min_neighbors) {
-    return CurvatureInfo{0, 0, 0, 0, 0};
-  }
+    // 在半径内查找邻居点 / Find neighbors within radius
+    m_knn->radius_neighbors(query_point, m_search_radius, neighbor_indices, neighbor_distances);
 
-  // 计算协方差矩阵 / Compute covariance matrix
-  Eigen::Vector3d centroid(0, 0, 0);
-  for (const auto& idx : neighbor_indices) {
-    const auto& p = m_cloud->points[idx];
-    centroid += Eigen::Vector3d(static_cast<double>(p.x), 
-                               static_cast<double>(p.y), 
-                               static_cast<double>(p.z));
-  }
-  centroid /= static_cast<double>(neighbor_indices.size());
+    if (neighbor_indices.size() < m_min_neighbors) {
+      return CurvatureInfo{0, 0, 0, 0, 0};
+    }
 
-  Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
-  for (const auto& idx : neighbor_indices) {
-    const auto& p = m_cloud->points[idx];
-    Eigen::Vector3d point_vec(static_cast<double>(p.x), 
-                             static_cast<double>(p.y), 
-                             static_cast<double>(p.z));
-    Eigen::Vector3d diff = point_vec - centroid;
-    covariance += diff * diff.transpose();
+    // 协方差特征值由批量PCA内核给出，按升序排列 / Covariance eigenvalues come from the
+    // batch PCA kernel in ascending order
+    const batch_pca_t<data_type> pca(m_cloud->points);
+    pca_result = pca.compute(neighbor_indices);
   }
-  covariance /= static_cast<double>(neighbor_indices.size() - 1);
-
-  // 计算特征值和特征向量 / Compute eigenvalues and eigenvectors
-  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigen_solver(covariance);
-  if (eigen_solver.info() != Eigen::Success) {
+  if (!pca_result.valid) {
     return CurvatureInfo{0, 0, 0, 0, 0};
   }
 
-  const Eigen::Vector3d& eigenvalues = eigen_solver.eigenvalues();
-  
-  // 按降序排序特征值：λ0 >= λ1 >= λ2 / Sort eigenvalues in descending order: λ0 >= λ1 >= λ2
-  std::vector<double> sorted_eigenvals = {eigenvalues(2), eigenvalues(1), eigenvalues(0)};
-  std::sort(sorted_eigenvals.rbegin(), sorted_eigenvals.rend());
-
-  const double lambda0 = sorted_eigenvals[0];
-  const double lambda1 = sorted_eigenvals[1];
-  const double lambda2 = sorted_eigenvals[2];
+  const double lambda0 = static_cast<double>(pca_result.eigenvalues[2]);
+  const double lambda1 = static_cast<double>(pca_result.eigenvalues[1]);
+  const double lambda2 = static_cast<double>(pca_result.eigenvalues[0]);
 
   // 避免除零 / Avoid division by zero
   const double eigensum = lambda0 + lambda1 + lambda2;
@@ -192,48 +175,29 @@ curvature_keypoint_extractor_t<DataType, KNN>::apply_non_maxima_suppression(
     return {};
   }
 
-  indices_vector keypoints;
+  // 所有点都参与竞争，曲率达到阈值的点是候选点 / Every point competes and points
+  // reaching the curvature threshold are candidates
   const std::size_t num_points = m_cloud->size();
-
+  std::vector<data_type> scores(num_points);
+  std::vector<std::uint8_t> candidates(num_points, 0);
   for (std::size_t i = 0; i < num_points; ++i) {
-    const auto& current_curvature = curvatures[i];
-    
-    // 跳过低曲率的点 / Skip points with low curvature
-    if (current_curvature.curvature_magnitude < m_curvature_threshold) {
-      continue;
-    }
-
-    // 在非极大值抑制半径内查找邻居 / Find neighbors within non-maxima suppression radius
-    const auto& query_point = m_cloud->points[i];
-    std::vector<std::size_t> neighbor_indices;
-    std::vector<data_type> neighbor_distances;
-    
-    m_knn->radius_neighbors(query_point, m_non_maxima_radius, neighbor_indices, neighbor_distances);
-
-    // 检查当前点是否为局部最大值 / Check if current point is local maximum
-    bool is_local_maximum = true;
-    for (const auto& neighbor_idx : neighbor_indices) {
-      if (neighbor_idx != i && neighbor_idx < curvatures.size()) {
-        if (curvatures[neighbor_idx].curvature_magnitude > current_curvature.curvature_magnitude) {
-          is_local_maximum = false;
-          break;
-        }
-      }
-    }
-
-    if (is_local_maximum) {
-      keypoints.push_back(i);
-    }
+    scores[i] = curvatures[i].curvature_magnitude;
+    candidates[i] = curvatures[i].curvature_magnitude >= m_curvature_threshold ? 1 : 0;
   }
 
-  return keypoints;
+  grid_nms_t<data_type> nms(m_non_maxima_radius);
+  nms.enable_parallel(m_enable_parallel);
+  return nms.suppress(m_cloud->points, scores, candidates);
 }
 
 template<typename DataType, typename KNN>
 typename curvature_keypoint_extractor_t<DataType, KNN>::indices_vector
 curvature_keypoint_extractor_t<DataType, KNN>::extract_impl()
 {
-  if (!m_cloud || !m_knn) {
+  if (!m_cloud || (!m_knn && !m_cache)) {
+    return {};
+  }
+  if (m_cache && m_cache->size() != m_cloud->size()) {
     return {};
   }
 
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <cpp-toolbox/concurrent/parallel.hpp>
+#include <cpp-toolbox/logger/thread_logger.hpp>
+
+namespace toolbox::pcl
+{
+
+template<typename DataType>
+typename grid_nms_t<DataType>::indices_vector grid_nms_t<DataType>::suppress(
+    const std::vector<point_type>& points,
+    const std::vector<data_type>& scores,
+    const std::vector<std::uint8_t>& candidates) const
+{
+  const std::size_t num_points = points.size();
+  if (scores.size() != num_points || candidates.size() != num_points) {
+    LOG_ERROR_S << "grid_nms_t: " << num_points << " points, " << scores.size()
+                << " scores and " << candidates.size() << " candidate flags given";
+    return {};
+  }
+
+  auto is_finite = [&points](std::size_t i)
+  {
+    const auto& p = points[i];
+    return std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z);
+  };
+
+  indices_vector keypoints;
+  if (!(m_radius > data_type(0))) {
+    for (std::size_t i = 0; i < num_points; ++i) {
+      if (candidates[i] && is_finite(i)) {
+        keypoints.push_back(i);
+      }
+    }
+    return keypoints;
+  }
+
+  // 1. 只有候选点和参与竞争的点进入网格 / Only candidates and competing points enter
+  // the grid
+  std::vector<std::size_t> members;
+  members.reserve(num_points);
+  double min_x = std::numeric_limits<double>::max();
+  double min_y = std::numeric_limits<double>::max();
+  double min_z = std::numeric_limits<double>::max();
+  for (std::size_t i = 0; i < num_points; ++i) {
+    if ((candidates[i] || scores[i] > k_no_score) && is_finite(i)) {
+      members.push_back(i);
+      min_x = std::min(min_x, static_cast<double>(points[i].x));
+      min_y = std::min(min_y, static_cast<double>(points[i].y));
+      min_z = std::min(min_z, static_cast<double>(points[i].z));
+    }
+  }
+  if (members.empty()) {
+    return keypoints;
+  }
+
+  // 2. 体素坐标按轴截断到21位，单调截断保持相邻关系 / Voxel coordinates are capped at
+  // 21 bits per axis; the monotone cap preserves adjacency
+  constexpr std::uint64_t k_axis_max = (std::uint64_t(1) << 21) - 1;
+  const double inv_radius = 1.0 / static_cast<double>(m_radius);
+  const std::size_t num_members = members.size();
+  std::vector<std::uint64_t> coords(num_members * 3);
+  auto to_cell = [&](double value, double origin)
+  {
+    const double cell = std::floor((value - origin) * inv_radius);
+    return static_cast<std::uint64_t>(std::min(cell, static_cast<double>(k_axis_max)));
+  };
+  toolbox::concurrent::parallel_for_chunks(
+      num_members,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t m = start_idx; m < end_idx; ++m) {
+          const auto& p = points[members[m]];
+          coords[3 * m] = to_cell(static_cast<double>(p.x), min_x);
+          coords[3 * m + 1] = to_cell(static_cast<double>(p.y), min_y);
+          coords[3 * m + 2] = to_cell(static_cast<double>(p.z), min_z);
+        }
+      });
+
+  std::uint64_t max_cell[3] = {0, 0, 0};
+  for (std::size_t m = 0; m < num_members; ++m) {
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+      max_cell[axis] = std::max(max_cell[axis], coords[3 * m + axis]);
+    }
+  }
+  auto bit_width = [](std::uint64_t value)
+  {
+    unsigned bits = 0;
+    while (value > 0) {
+      ++bits;
+      value >>= 1U;
+    }
+    return bits;
+  };
+  const unsigned bits_x = bit_width(max_cell[0]);
+  const unsigned bits_y = bit_width(max_cell[1]);
+  const unsigned key_bits = std::max(1U, bits_x + bits_y + bit_width(max_cell[2]));
+  auto pack = [bits_x, bits_y](std::uint64_t x, std::uint64_t y, std::uint64_t z)
+  { return (z << (bits_x + bits_y)) | (y << bits_x) | x; };
+
+  std::vector<std::uint64_t> keys(num_members);
+  toolbox::concurrent::parallel_for_chunks(
+      num_members,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t m = start_idx; m < end_idx; ++m) {
+          keys[m] = pack(coords[3 * m], coords[3 * m + 1], coords[3 * m + 2]);
+        }
+      });
+
+  // 3. 稳定排序后每个体素是一段连续的点，段内保持点索引升序 / After the stable sort
+  // every voxel is one contiguous run of points in ascending point order
+  toolbox::concurrent::parallel_radix_sort_pairs(keys, members, key_bits, m_enable_parallel);
+  std::vector<std::uint64_t> cell_keys;
+  std::vector<std::size_t> cell_starts;
+  for (std::size_t m = 0; m < num_members; ++m) {
+    if (m == 0 || keys[m] != keys[m - 1]) {
+      cell_keys.push_back(keys[m]);
+      cell_starts.push_back(m);
+    }
+  }
+  const std::size_t num_cells = cell_keys.size();
+  cell_starts.push_back(num_members);
+
+  // 4. 每个体素与周围27个体素比较；x方向相邻的3个体素键连续，只需9次二分查找
+  // Every voxel is compared with its 27 neighbors; the 3 voxels adjacent along x
+  // have consecutive keys, so 9 binary searches suffice
+  const std::uint64_t mask_x = (std::uint64_t(1) << bits_x) - 1;
+  const std::uint64_t mask_y = (std::uint64_t(1) << bits_y) - 1;
+  const data_type radius_sq = m_radius * m_radius;
+  std::vector<std::uint8_t> keep(num_points, 0);
+  toolbox::concurrent::parallel_for_chunks(
+      num_cells,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_cell, std::size_t end_cell)
+      {
+        std::vector<std::size_t> neighbor_cells;
+        for (std::size_t c = start_cell; c < end_cell; ++c) {
+          const std::uint64_t key = cell_keys[c];
+          const std::uint64_t cx = key & mask_x;
+          const std::uint64_t cy = (key >> bits_x) & mask_y;
+          const std::uint64_t cz = key >> (bits_x + bits_y);
+
+          neighbor_cells.clear();
+          const std::uint64_t x0 = cx > 0 ? cx - 1 : 0;
+          const std::uint64_t x1 = std::min(cx + 1, max_cell[0]);
+          for (std::uint64_t z = cz > 0 ? cz - 1 : 0; z <= std::min(cz + 1, max_cell[2]); ++z) {
+            for (std::uint64_t y = cy > 0 ? cy - 1 : 0; y <= std::min(cy + 1, max_cell[1]); ++y)
+            {
+              const std::uint64_t first = pack(x0, y, z);
+              const std::uint64_t last = pack(x1, y, z);
+              auto it = std::lower_bound(cell_keys.begin(), cell_keys.end(), first);
+              for (; it != cell_keys.end() && *it <= last; ++it) {
+                neighbor_cells.push_back(static_cast<std::size_t>(it - cell_keys.begin()));
+              }
+            }
+          }
+
+          for (std::size_t m = cell_starts[c]; m < cell_starts[c + 1]; ++m) {
+            const std::size_t i = members[m];
+            if (!candidates[i]) {
+              continue;
+            }
+            const data_type score = scores[i];
+            const auto& p = points[i];
+            bool is_maximum = true;
+            for (const std::size_t neighbor_cell : neighbor_cells) {
+              for (std::size_t n = cell_starts[neighbor_cell];
+                   n < cell_starts[neighbor_cell + 1] && is_maximum;
+                   ++n)
+              {
+                const std::size_t j = members[n];
+                if (j == i || !(scores[j] > score)) {
+                  continue;
+                }
+                const data_type dx = points[j].x - p.x;
+                const data_type dy = points[j].y - p.y;
+                const data_type dz = points[j].z - p.z;
+                is_maximum = dx * dx + dy * dy + dz * dz > radius_sq;
+              }
+              if (!is_maximum) {
+                break;
+              }
+            }
+            keep[i] = is_maximum ? 1 : 0;
+          }
+        }
+      });
+
+  for (std::size_t i = 0; i < num_points; ++i) {
+    if (keep[i]) {
+      keypoints.push_back(i);
+    }
+  }
+  return keypoints;
+}
+
+}  // namespace toolbox::pcl
@@ -1,9 +1,9 @@
 #pragma once
 
 #include <cpp-toolbox/base/thread_pool_singleton.hpp>
+#include <cpp-toolbox/pcl/norm/batch_pca.hpp>
 #include <cpp-toolbox/types/point.hpp>
 #include <Eigen/Dense>
-#include <Eigen/Eigenvalues>
 #include <algorithm>
 #include <cmath>
 #include <future>
@@ -55,67 +55,47 @@ template<typename DataType, typename KNN>
 typename harris3d_keypoint_extractor_t<DataType, KNN>::Harris3DInfo
 harris3d_keypoint_extractor_t<DataType, KNN>::compute_harris3d_response(std::size_t point_idx)
 {
-  if (!m_cloud || !m_knn || point_idx >= m_cloud->size()) {
+  if (!m_cloud || (!m_knn && !m_cache) || point_idx >= m_cloud->size()) {
     return Harris3DInfo{0, false};
   }
 
-  const auto& query_point = m_cloud->points[point_idx];
   std::vector<std::size_t> neighbor_indices;
-  std::vector<data_type> neighbor_distances;
-  
-  // Find k nearest neighbors
-  m_knn->kneighbors(query_point, m_num_neighbors, neighbor_indices, neighbor_distances);
-  
-  if (neighbor_indices.size() < 3) {
-    return Harris3DInfo{0, false};
-  }
-  
-  // Compute centroid
-  Eigen::Vector3d centroid(0, 0, 0);
-  for (const auto& idx : neighbor_indices) {
-    const auto& p = m_cloud->points[idx];
-    centroid += Eigen::Vector3d(static_cast<double>(p.x), 
-                               static_cast<double>(p.y), 
-                               static_cast<double>(p.z));
-  }
-  centroid /= static_cast<double>(neighbor_indices.size());
-  
-  // Compute covariance matrix
-  Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
-  for (const auto& idx : neighbor_indices) {
-    const auto& p = m_cloud->points[idx];
-    Eigen::Vector3d point_vec(static_cast<double>(p.x), 
-                             static_cast<double>(p.y), 
-                             static_cast<double>(p.z));
-    Eigen::Vector3d diff = point_vec - centroid;
-    covariance += diff * diff.transpose();
+  pca_result_t<data_type> pca_result;
+  if (m_cache) {
+    // Neighborhood and local frame come straight from the shared cache
+    const auto row = m_cache->neighbors(point_idx);
+    if (row.size < 3) {
+      return Harris3DInfo{0, false};
+    }
+    neighbor_indices.assign(row.indices, row.indices + row.size);
+    pca_result = (*m_cache)[point_idx];
+  } else {
+    const auto& query_point = m_cloud->points[point_idx];
+    std::vector<data_type> neighbor_distances;
+
+    // Find k nearest neighbors
+    m_knn->kneighbors(query_point, m_num_neighbors, neighbor_indices, neighbor_distances);
+
+    if (neighbor_indices.size() < 3) {
+      return Harris3DInfo{0, false};
+    }
+
+    // Local frame from the batch PCA kernel: eigenvectors come in ascending eigenvalue order
+    const batch_pca_t<data_type> pca(m_cloud->points);
+    pca_result = pca.compute(neighbor_indices);
   }
-  covariance /= static_cast<double>(neighbor_indices.size() - 1);
-  
-  // Compute eigenvalues and eigenvectors
-  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigen_solver(covariance);
-  if (eigen_solver.info() != Eigen::Success) {
+  if (!pca_result.valid) {
     return Harris3DInfo{0, false};
   }
-  
-  const Eigen::Vector3d& eigenvalues = eigen_solver.eigenvalues();
-  const Eigen::Matrix3d& eigenvectors = eigen_solver.eigenvectors();
-  
-  // Sort eigenvalues to get normal direction (smallest eigenvalue)
-  std::vector<std::pair<double, int>> sorted_eigenvals;
-  for (int j = 0; j < 3; ++j) {
-    sorted_eigenvals.emplace_back(eigenvalues(j), j);
-  }
-  std::sort(sorted_eigenvals.begin(), sorted_eigenvals.end());
-  
-  // Get normal and tangent vectors
-  const int normal_idx = sorted_eigenvals[0].second;
-  const int tangent1_idx = sorted_eigenvals[1].second;
-  const int tangent2_idx = sorted_eigenvals[2].second;
-  
-  const Eigen::Vector3d normal = eigenvectors.col(normal_idx);
-  const Eigen::Vector3d tangent1 = eigenvectors.col(tangent1_idx);
-  const Eigen::Vector3d tangent2 = eigenvectors.col(tangent2_idx);
+
+  auto to_vector = [](const point_t<data_type>& p) {
+    return Eigen::Vector3d(static_cast<double>(p.x),
+                           static_cast<double>(p.y),
+                           static_cast<double>(p.z));
+  };
+  const Eigen::Vector3d centroid = to_vector(pca_result.centroid);
+  const Eigen::Vector3d tangent1 = to_vector(pca_result.eigenvectors[1]);
+  const Eigen::Vector3d tangent2 = to_vector(pca_result.eigenvectors[2]);
   
   // Project points onto tangent plane and compute 2D structure tensor
   Eigen::Matrix2d structure_tensor = Eigen::Matrix2d::Zero();
@@ -212,49 +192,31 @@ harris3d_keypoint_extractor_t<DataType, KNN>::apply_non_maxima_suppression(
     return {};
   }
 
-  indices_vector keypoints;
+  // Valid points compete; those reaching the threshold are candidates
   const std::size_t num_points = m_cloud->size();
-
+  std::vector<data_type> scores(num_points, grid_nms_t<data_type>::k_no_score);
+  std::vector<std::uint8_t> candidates(num_points, 0);
   for (std::size_t i = 0; i < num_points; ++i) {
     const auto& current_response = harris_responses[i];
-    
-    // Skip invalid points or those below threshold
-    if (!current_response.is_valid || current_response.harris_response < m_threshold) {
-      continue;
-    }
-
-    // Find neighbors within suppression radius
-    const auto& query_point = m_cloud->points[i];
-    std::vector<std::size_t> neighbor_indices;
-    std::vector<data_type> neighbor_distances;
-    
-    m_knn->radius_neighbors(query_point, m_suppression_radius, neighbor_indices, neighbor_distances);
-
-    // Check if current point is local maximum
-    bool is_local_maximum = true;
-    for (const auto& neighbor_idx : neighbor_indices) {
-      if (neighbor_idx != i && neighbor_idx < harris_responses.size()) {
-        if (harris_responses[neighbor_idx].is_valid && 
-            harris_responses[neighbor_idx].harris_response > current_response.harris_response) {
-          is_local_maximum = false;
-          break;
-        }
-      }
-    }
-
-    if (is_local_maximum) {
-      keypoints.push_back(i);
+    if (current_response.is_valid) {
+      scores[i] = current_response.harris_response;
+      candidates[i] = current_response.harris_response >= m_threshold ? 1 : 0;
     }
   }
 
-  return keypoints;
+  grid_nms_t<data_type> nms(m_suppression_radius);
+  nms.enable_parallel(m_enable_parallel);
+  return nms.suppress(m_cloud->points, scores, candidates);
 }
 
 template<typename DataType, typename KNN>
 typename harris3d_keypoint_extractor_t<DataType, KNN>::indices_vector
 harris3d_keypoint_extractor_t<DataType, KNN>::extract_impl()
 {
-  if (!m_cloud || !m_knn) {
+  if (!m_cloud || (!m_knn && !m_cache)) {
+    return {};
+  }
+  if (m_cache && m_cache->size() != m_cloud->size()) {
     return {};
   }
 
@@ -1,9 +1,8 @@
 #pragma once
 
 #include <cpp-toolbox/base/thread_pool_singleton.hpp>
+#include <cpp-toolbox/pcl/norm/batch_pca.hpp>
 #include <cpp-toolbox/types/point.hpp>
-#include <Eigen/Dense>
-#include <Eigen/Eigenvalues>
 #include <algorithm>
 #include <cmath>
 #include <future>
@@ -49,74 +48,79 @@ void iss_keypoint_extractor_t<DataType, KNN>::enable_parallel_impl(bool enable)
   m_enable_parallel = enable;
 }
 
+template<typename DataType, typename KNN>
+void iss_keypoint_extractor_t<DataType, KNN>::find_neighbors(std::size_t point_idx,
+                                                            data_type radius,
+                                                            std::vector<std::size_t>& indices,
+                                                            std::vector<data_type>& distances)
+{
+  if (m_graph) {
+    m_graph->neighbors(point_idx, radius, 0, indices, distances);
+  } else {
+    m_knn->radius_neighbors(m_cloud->points[point_idx], radius, indices, distances);
+  }
+}
+
 template<typename DataType, typename KNN>
 typename iss_keypoint_extractor_t<DataType, KNN>::ISSInfo
 iss_keypoint_extractor_t<DataType, KNN>::compute_iss_response(std::size_t point_idx)
 {
-  if (!m_cloud || !m_knn || point_idx >= m_cloud->size()) {
+  if (!m_cloud || (!m_knn && !m_graph && !m_cache) || point_idx >= m_cloud->size()) {
     return ISSInfo{0, 0, 0, 0, false};
   }
 
   const auto& query_point = m_cloud->points[point_idx];
-  std::vector<std::size_t> neighbor_indices;
-  std::vector<data_type> neighbor_distances;
-
-  // 在显著性半径内查找邻居 / Find neighbors within salient radius
-  m_knn->radius_neighbors(query_point, m_salient_radius, neighbor_indices, neighbor_distances);
-
-  if (neighbor_indices.size() < m_min_neighbors) {
-    return ISSInfo{0, 0, 0, 0, false};
-  }
+  pca_result_t<data_type> pca_result;
+  if (m_cache) {
+    pca_result = (*m_cache)[point_idx];
+    if (pca_result.num_points < m_min_neighbors) {
+      return ISSInfo{0, 0, 0, 0, false};
+    }
+  } else {
+    std::vector<std::size_t> neighbor_indices;
+    std::vector<data_type> neighbor_distances;
 
-  // 基于距离计算权重函数 / Compute weight function based on distance
-  auto compute_weight = [this](data_type distance) -> double {
-    if (distance >= m_salient_radius) return 0.0;
-    const double ratio = static_cast<double>(distance) / static_cast<double>(m_salient_radius);
-    return 1.0 - ratio;  // 线性权重函数 / Linear weight function
-  };
+    // 在显著性半径内查找邻居 / Find neighbors within salient radius
+    find_neighbors(point_idx, m_salient_radius, neighbor_indices, neighbor_distances);
 
-  // 计算加权散布矩阵 / Compute weighted scatter matrix
-  Eigen::Matrix3d scatter_matrix = Eigen::Matrix3d::Zero();
-  double total_weight = 0.0;
+    if (neighbor_indices.size() < m_min_neighbors) {
+      return ISSInfo{0, 0, 0, 0, false};
+    }
 
-  for (std::size_t i = 0; i < neighbor_indices.size(); ++i) {
-    const auto& neighbor_point = m_cloud->points[neighbor_indices[i]];
-    const double weight = compute_weight(neighbor_distances[i]);
-    
-    if (weight > 0.0) {
-      // 从查询点到邻居的向量 / Vector from query point to neighbor
-      Eigen::Vector3d diff(
-        static_cast<double>(neighbor_point.x - query_point.x),
-        static_cast<double>(neighbor_point.y - query_point.y),
-        static_cast<double>(neighbor_point.z - query_point.z)
-      );
-      
-      scatter_matrix += weight * (diff * diff.transpose());
+    // 基于距离计算权重函数 / Compute weight function based on distance
+    auto compute_weight = [this](data_type distance) -> double {
+      if (distance >= m_salient_radius) return 0.0;
+      const double ratio = static_cast<double>(distance) / static_cast<double>(m_salient_radius);
+      return 1.0 - ratio;  // 线性权重函数 / Linear weight function
+    };
+
+    // 加权散布矩阵以查询点为中心，由批量PCA内核求解 / The weighted scatter matrix is
+    // centered at the query point and solved by the batch PCA kernel
+    std::vector<data_type> weights(neighbor_indices.size());
+    double total_weight = 0.0;
+    for (std::size_t i = 0; i < neighbor_indices.size(); ++i) {
+      const double weight = compute_weight(neighbor_distances[i]);
+      weights[i] = static_cast<data_type>(weight);
       total_weight += weight;
     }
-  }
 
-  if (total_weight < 1e-10) {
-    return ISSInfo{0, 0, 0, 0, false};
-  }
-
-  scatter_matrix /= total_weight;
+    if (total_weight < 1e-10) {
+      return ISSInfo{0, 0, 0, 0, false};
+    }
 
-  // 计算特征值 / Compute eigenvalues
-  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigen_solver(scatter_matrix);
-  if (eigen_solver.info() != Eigen::Success) {
+    batch_pca_t<data_type> pca(m_cloud->points);
+    pca.set_min_points(1);
+    pca_result = pca.compute(neighbor_indices, weights, query_point);
+  }
+  if (!pca_result.valid) {
     return ISSInfo{0, 0, 0, 0, false};
   }
 
-  const Eigen::Vector3d& eigenvalues = eigen_solver.eigenvalues();
-  
-  // 按降序排序特征值：λ1 >= λ2 >= λ3 / Sort eigenvalues in descending order: λ1 >= λ2 >= λ3
-  std::vector<double> sorted_eigenvals = {eigenvalues(2), eigenvalues(1), eigenvalues(0)};
-  std::sort(sorted_eigenvals.rbegin(), sorted_eigenvals.rend());
-
-  const double lambda1 = sorted_eigenvals[0];
-  const double lambda2 = sorted_eigenvals[1];
-  const double lambda3 = sorted_eigenvals[2];
+  // 结果按升序排列，映射为λ1 >= λ2 >= λ3 / Results are ascending, map them to
+  // λ1 >= λ2 >= λ3
+  const double lambda1 = static_cast<double>(pca_result.eigenvalues[2]);
+  const double lambda2 = static_cast<double>(pca_result.eigenvalues[1]);
+  const double lambda3 = static_cast<double>(pca_result.eigenvalues[0]);
 
   // 检查ISS准则 / Check ISS criteria
   bool is_valid = true;
@@ -210,49 +214,34 @@ iss_keypoint_extractor_t<DataType, KNN>::apply_non_maxima_suppression(
     return {};
   }
 
-  indices_vector keypoints;
+  // 有效点参与竞争，显著性为正的有效点是候选点 / Valid points compete and valid points
+  // with positive saliency are candidates
   const std::size_t num_points = m_cloud->size();
-
+  std::vector<data_type> scores(num_points, grid_nms_t<data_type>::k_no_score);
+  std::vector<std::uint8_t> candidates(num_points, 0);
   for (std::size_t i = 0; i < num_points; ++i) {
     const auto& current_iss = iss_responses[i];
-    
-    // 跳过无效的点 / Skip invalid points
-    if (!current_iss.is_valid || current_iss.saliency <= 0) {
-      continue;
-    }
-
-    // 在非极大值抑制半径内查找邻居 / Find neighbors within non-maxima suppression radius
-    const auto& query_point = m_cloud->points[i];
-    std::vector<std::size_t> neighbor_indices;
-    std::vector<data_type> neighbor_distances;
-    
-    m_knn->radius_neighbors(query_point, m_non_maxima_radius, neighbor_indices, neighbor_distances);
-
-    // 检查当前点是否为局部最大值 / Check if current point is local maximum
-    bool is_local_maximum = true;
-    for (const auto& neighbor_idx : neighbor_indices) {
-      if (neighbor_idx != i && neighbor_idx < iss_responses.size()) {
-        const auto& neighbor_iss = iss_responses[neighbor_idx];
-        if (neighbor_iss.is_valid && neighbor_iss.saliency > current_iss.saliency) {
-          is_local_maximum = false;
-          break;
-        }
-      }
-    }
-
-    if (is_local_maximum) {
-      keypoints.push_back(i);
+    if (current_iss.is_valid) {
+      scores[i] = current_iss.saliency;
+      candidates[i] = current_iss.saliency > 0 ? 1 : 0;
     }
   }
 
-  return keypoints;
+  grid_nms_t<data_type> nms(m_non_maxima_radius);
+  nms.enable_parallel(m_enable_parallel);
+  return nms.suppress(m_cloud->points, scores, candidates);
 }
 
 template<typename DataType, typename KNN>
 typename iss_keypoint_extractor_t<DataType, KNN>::indices_vector
 iss_keypoint_extractor_t<DataType, KNN>::extract_impl()
 {
-  if (!m_cloud || !m_knn) {
+  if (!m_cloud || (!m_knn && !m_graph && !m_cache)) {
+    return {};
+  }
+  if ((m_graph && m_graph->size() != m_cloud->size())
+      || (m_cache && m_cache->size() != m_cloud->size()))
+  {
     return {};
   }
 
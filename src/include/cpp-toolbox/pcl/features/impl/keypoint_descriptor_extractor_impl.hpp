@@ -0,0 +1,110 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <cpp-toolbox/logger/thread_logger.hpp>
+
+namespace toolbox::pcl
+{
+
+template<typename Detector, typename Descriptor>
+template<typename Derived, typename Element, typename Metric>
+bool keypoint_descriptor_extractor_t<Detector, Descriptor>::extract(
+    base_knn_generic_t<Derived, Element, Metric>& knn,
+    const point_cloud& cloud,
+    indices_vector& keypoints,
+    std::vector<signature_type>& descriptors)
+{
+  keypoints.clear();
+  descriptors.clear();
+  if (!(m_search_radius > data_type(0))) {
+    LOG_ERROR_S << "keypoint_descriptor_extractor_t: Invalid search radius " << m_search_radius;
+    return false;
+  }
+
+  constexpr bool graph_detector =
+      detail::accepts_neighborhood_graph<Detector, neighborhood_graph_t<data_type>>::value;
+  const auto detector_radius = detail::detector_radius(m_detector);
+  if constexpr (graph_detector) {
+    if (detector_radius > m_search_radius) {
+      LOG_ERROR_S << "keypoint_descriptor_extractor_t: Detector radius " << detector_radius
+                  << " exceeds the shared search radius " << m_search_radius;
+      return false;
+    }
+    // 检测器读取半径内的全部邻居，截断的行会改变结果 / The detector reads every
+    // neighbor within its radius, so capped rows would change its result
+    if (m_max_neighbors != 0) {
+      LOG_ERROR_S << "keypoint_descriptor_extractor_t: The detector needs uncapped rows, "
+                     "got a neighbor limit of "
+                  << m_max_neighbors;
+      return false;
+    }
+  } else if (detector_radius != m_search_radius) {
+    LOG_WARN_S << "keypoint_descriptor_extractor_t: Detector radius " << detector_radius
+               << " is replaced by the shared search radius " << m_search_radius;
+  }
+
+  // 描述子把行截断到自己的半径和邻居数，共享的行必须覆盖两者 / The descriptor cuts rows
+  // to its own radius and neighbor count, so the shared rows must cover both
+  const auto descriptor_radius = m_descriptor.get_search_radius();
+  if (descriptor_radius > m_search_radius) {
+    LOG_ERROR_S << "keypoint_descriptor_extractor_t: Descriptor radius " << descriptor_radius
+                << " exceeds the shared search radius " << m_search_radius;
+    return false;
+  }
+  const std::size_t descriptor_neighbors = m_descriptor.get_num_neighbors();
+  if (m_max_neighbors != 0 && m_max_neighbors < descriptor_neighbors) {
+    LOG_ERROR_S << "keypoint_descriptor_extractor_t: Neighbor limit " << m_max_neighbors
+                << " is below the descriptor's " << descriptor_neighbors << " neighbors";
+    return false;
+  }
+
+  // 1. 唯一的一次邻域搜索和PCA / The one neighborhood search and PCA
+  if (!m_cache.build_radius(knn, cloud, m_search_radius, m_max_neighbors, m_enable_parallel)) {
+    return false;
+  }
+
+  // 2. 法线取自缓存的特征向量，与pca_norm_extractor_t一致，邻居不足时为(0, 0, 1)
+  // Normals come from the cached eigenvectors; as in pca_norm_extractor_t, too few
+  // neighbors give (0, 0, 1)
+  m_normals = std::make_shared<point_cloud>();
+  m_normals->points.resize(cloud.size());
+  for (std::size_t i = 0; i < cloud.size(); ++i) {
+    m_normals->points[i] =
+        m_cache[i].valid ? m_cache[i].normal() : toolbox::types::point_t<data_type>(0, 0, 1);
+  }
+
+  // 3. 检测器读取近邻图（按自己的半径截断）或缓存，不再搜索 / The detector reads the
+  // graph (cut to its own radius) or the cache instead of searching
+  m_detector.set_input(cloud);
+  if constexpr (graph_detector) {
+    m_detector.set_neighborhood_graph(m_cache.graph());
+  } else {
+    m_detector.set_geometry_cache(m_cache);
+  }
+  m_detector.enable_parallel(m_enable_parallel);
+  keypoints = m_detector.extract();
+  if (keypoints.empty()) {
+    return true;
+  }
+
+  // 4. 描述子读取同一近邻图和共享法线 / The descriptor reads the same graph and the
+  // shared normals
+  m_descriptor.set_neighborhood_graph(m_cache.graph());
+  if constexpr (detail::accepts_normals<Descriptor, point_cloud_ptr>::value) {
+    m_descriptor.set_normals(m_normals);
+  }
+  m_descriptor.enable_parallel(m_enable_parallel);
+  m_descriptor.compute(cloud, keypoints, descriptors);
+  if (descriptors.size() != keypoints.size()) {
+    LOG_ERROR_S << "keypoint_descriptor_extractor_t: " << descriptors.size()
+                << " descriptors computed for " << keypoints.size() << " keypoints";
+    keypoints.clear();
+    descriptors.clear();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace toolbox::pcl
@@ -1,10 +1,14 @@
 #pragma once
 
 #include <cpp-toolbox/base/thread_pool_singleton.hpp>
+#include <cpp-toolbox/concurrent/parallel.hpp>
+#include <cpp-toolbox/logger/thread_logger.hpp>
 #include <cpp-toolbox/types/point.hpp>
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <future>
+#include <limits>
 #include <vector>
 
 namespace toolbox::pcl
@@ -191,27 +195,28 @@ std::vector<uint8_t> loam_feature_extractor_t<DataType, KNN>::classify_features(
   return labels;
 }
 
+template<typename DataType, typename KNN>
+std::vector<uint8_t> loam_feature_extractor_t<DataType, KNN>::compute_labels()
+{
+  if (m_mode == curvature_mode::scan_line) {
+    return classify_scan_lines();
+  }
+  return classify_features(compute_curvatures());
+}
+
 template<typename DataType, typename KNN>
 typename loam_feature_extractor_t<DataType, KNN>::indices_vector
 loam_feature_extractor_t<DataType, KNN>::extract_impl()
 {
-  if (!m_cloud || !m_knn) {
+  if (!m_cloud || (m_mode == curvature_mode::knn && !m_knn)) {
     return {};
   }
 
-  // Compute curvatures
-  auto curvatures = compute_curvatures();
-  
   // Get all feature indices (both edge and planar)
+  const auto labels = compute_labels();
   indices_vector feature_indices;
-  
-  for (std::size_t i = 0; i < curvatures.size(); ++i) {
-    if (!curvatures[i].is_valid) continue;
-    
-    const data_type curvature = curvatures[i].curvature;
-    if (curvature < m_curvature_threshold) continue;
-    
-    if (curvature > m_edge_threshold || curvature < m_planar_threshold) {
+  for (std::size_t i = 0; i < labels.size(); ++i) {
+    if (static_cast<feature_label>(labels[i]) != feature_label::none) {
       feature_indices.push_back(i);
     }
   }
@@ -229,7 +234,7 @@ template<typename DataType, typename KNN>
 typename loam_feature_extractor_t<DataType, KNN>::point_cloud
 loam_feature_extractor_t<DataType, KNN>::extract_keypoints_impl()
 {
-  if (!m_cloud || !m_knn) {
+  if (!m_cloud || (m_mode == curvature_mode::knn && !m_knn)) {
     return point_cloud{};
   }
 
@@ -259,22 +264,386 @@ loam_feature_extractor_t<DataType, KNN>::extract_labeled_cloud()
 {
   loam_result result;
   
-  if (!m_cloud || !m_knn) {
+  if (!m_cloud || (m_mode == curvature_mode::knn && !m_knn)) {
+    return result;
+  }
+
+  // Classify features
+  result.labels = compute_labels();
+  if (result.labels.size() != m_cloud->size()) {
+    result.labels.clear();
     return result;
   }
 
   // Copy the cloud
   result.cloud = *m_cloud;
   
-  // Compute curvatures
-  auto curvatures = compute_curvatures();
-  
-  // Classify features
-  result.labels = classify_features(curvatures);
-  
   return result;
 }
 
+// Scan-line mode
+
+template<typename DataType, typename KNN>
+std::size_t loam_feature_extractor_t<DataType, KNN>::set_scan_rings(
+    std::vector<std::uint16_t> rings, std::vector<data_type> azimuths)
+{
+  m_rings = std::move(rings);
+  m_azimuths = std::move(azimuths);
+  m_mode = curvature_mode::scan_line;
+
+  std::size_t num_rings = 0;
+  for (const auto ring : m_rings) {
+    if (ring != std::numeric_limits<std::uint16_t>::max()) {
+      num_rings = std::max<std::size_t>(num_rings, static_cast<std::size_t>(ring) + 1);
+    }
+  }
+  return num_rings;
+}
+
+template<typename DataType, typename KNN>
+void loam_feature_extractor_t<DataType, KNN>::set_ring_layout(std::size_t num_rings,
+                                                              data_type fov_up_deg,
+                                                              data_type fov_down_deg)
+{
+  m_num_rings = num_rings;
+  m_fov_up_deg = fov_up_deg;
+  m_fov_down_deg = fov_down_deg;
+  m_rings.clear();
+  m_mode = curvature_mode::scan_line;
+}
+
+template<typename DataType, typename KNN>
+void loam_feature_extractor_t<DataType, KNN>::assign_rings(std::vector<std::uint16_t>& rings,
+                                                           std::vector<data_type>& keys,
+                                                           std::size_t& num_rings) const
+{
+  constexpr std::uint16_t k_no_ring = std::numeric_limits<std::uint16_t>::max();
+  const auto& points = m_cloud->points;
+  const std::size_t num_points = points.size();
+  const bool given_rings = !m_rings.empty();
+  const bool given_azimuths = !m_azimuths.empty();
+  rings.resize(num_points);
+  keys.resize(num_points);
+  std::vector<data_type> tangents(num_points);
+
+  // 线边界仰角的正切，升序；在正切空间的均匀桶里查表，每个点通常只需一次比较 /
+  // Tangents of the ring boundaries, ascending; a table over uniform buckets in
+  // tangent space leaves usually a single comparison per point
+  std::vector<data_type> boundaries;
+  std::vector<std::uint16_t> bucket_rings;
+  data_type bucket_origin = 0;
+  data_type bucket_scale = 0;
+  if (given_rings) {
+    num_rings = 0;
+    for (const auto ring : m_rings) {
+      if (ring != k_no_ring) {
+        num_rings = std::max<std::size_t>(num_rings, static_cast<std::size_t>(ring) + 1);
+      }
+    }
+  } else {
+    num_rings = m_num_rings;
+    constexpr double k_deg_to_rad = 3.14159265358979323846 / 180.0;
+    const double step =
+        (static_cast<double>(m_fov_up_deg) - static_cast<double>(m_fov_down_deg))
+        / static_cast<double>(num_rings);
+    for (std::size_t k = num_rings - 1; k >= 1; --k) {
+      const double elevation =
+          static_cast<double>(m_fov_up_deg) - static_cast<double>(k) * step;
+      boundaries.push_back(static_cast<data_type>(std::tan(elevation * k_deg_to_rad)));
+    }
+    const double low = std::tan(static_cast<double>(m_fov_down_deg) * k_deg_to_rad);
+    const double high = std::tan(static_cast<double>(m_fov_up_deg) * k_deg_to_rad);
+    const std::size_t num_buckets = 4 * num_rings;
+    bucket_origin = static_cast<data_type>(low);
+    bucket_scale = static_cast<data_type>(static_cast<double>(num_buckets) / (high - low));
+    bucket_rings.resize(num_buckets);
+    for (std::size_t b = 0; b < num_buckets; ++b) {
+      // 桶下沿以下的边界数 / Boundaries below the lower edge of the bucket
+      const auto edge = static_cast<data_type>(
+          low + (high - low) * static_cast<double>(b) / static_cast<double>(num_buckets));
+      bucket_rings[b] = static_cast<std::uint16_t>(
+          std::upper_bound(boundaries.begin(), boundaries.end(), edge) - boundaries.begin());
+    }
+  }
+
+  toolbox::concurrent::parallel_for_chunks(
+      num_points,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        // 先算仰角正切和方位键（无分支，可向量化），再查线号 / Elevation tangents and
+        // azimuth keys first (branch-free, vectorizable), ring lookup second
+        for (std::size_t i = start_idx; i < end_idx; ++i) {
+          const auto& p = points[i];
+          const data_type ax = std::abs(p.x);
+          const data_type ay = std::abs(p.y);
+          const data_type horizontal = std::sqrt(p.x * p.x + p.y * p.y);
+          // 菱形角，与atan2同序但不需要三角函数 / Diamond angle, ordered like atan2
+          // without trigonometry
+          const data_type a = ay / (ax + ay);
+          const data_type diamond = p.x >= 0 ? (p.y >= 0 ? a : 4 - a) : (p.y >= 0 ? 2 - a : 2 + a);
+          keys[i] = given_azimuths ? m_azimuths[i] : diamond;
+          tangents[i] = p.z / horizontal;
+        }
+        for (std::size_t i = start_idx; i < end_idx; ++i) {
+          const data_type tangent = tangents[i];
+          if (!std::isfinite(tangent) || !std::isfinite(keys[i])) {
+            rings[i] = k_no_ring;
+            continue;
+          }
+          if (given_rings) {
+            rings[i] = m_rings[i];
+            continue;
+          }
+          const data_type position = (tangent - bucket_origin) * bucket_scale;
+          std::size_t below = 0;
+          if (position >= data_type(bucket_rings.size())) {
+            below = boundaries.size();
+          } else if (position > data_type(0)) {
+            below = bucket_rings[static_cast<std::size_t>(position)];
+            while (below < boundaries.size() && boundaries[below] <= tangent) {
+              ++below;
+            }
+          }
+          rings[i] = static_cast<std::uint16_t>(boundaries.size() - below);
+        }
+      });
+}
+
+template<typename DataType, typename KNN>
+void loam_feature_extractor_t<DataType, KNN>::classify_ring(std::size_t* order,
+                                                            std::size_t count,
+                                                            const std::vector<data_type>& keys,
+                                                            std::vector<uint8_t>& labels) const
+{
+  const std::size_t half = std::max<std::size_t>(1, m_num_scan_neighbors / 2);
+  if (count < 2 * half + 1) {
+    return;
+  }
+
+  // 线内顺序统一为从最小方位键开始的升序，结果与输入顺序无关。扫描顺序通常已按方位角
+  // 循环单调，只需反转或旋转；由仰角推断线号时，一条线由几个激光器各自有序的片段拼成，
+  // 用自然归并排序合并，代价为O(n log 片段数) / The order within a ring is always
+  // ascending from the smallest azimuth key, so the result does not depend on the input
+  // order. Scan order is usually cyclically monotone already and only needs a reversal or
+  // a rotation; with rings inferred from elevation a ring is a concatenation of sorted
+  // runs from a few lasers, which a natural merge sort merges in O(n log runs)
+  std::size_t ascents = 0;
+  std::size_t descents = 0;
+  for (std::size_t k = 1; k < count; ++k) {
+    const data_type a = keys[order[k - 1]];
+    const data_type b = keys[order[k]];
+    ascents += b > a ? 1 : 0;
+    descents += b < a ? 1 : 0;
+  }
+  if (descents > ascents) {
+    std::reverse(order, order + count);
+    std::swap(ascents, descents);
+  }
+  auto before = [&keys](std::size_t a, std::size_t b) { return keys[a] < keys[b]; };
+  if (descents == 1) {
+    std::size_t wrap = 1;
+    while (!before(order[wrap], order[wrap - 1])) {
+      ++wrap;
+    }
+    std::rotate(order, order + wrap, order + count);
+  } else if (descents > 1) {
+    std::vector<std::size_t> runs {0};
+    for (std::size_t k = 1; k < count; ++k) {
+      if (before(order[k], order[k - 1])) {
+        runs.push_back(k);
+      }
+    }
+    runs.push_back(count);
+    while (runs.size() > 2) {
+      std::size_t kept = 0;
+      for (std::size_t r = 0; r + 2 < runs.size(); r += 2) {
+        std::inplace_merge(order + runs[r], order + runs[r + 1], order + runs[r + 2], before);
+        runs[kept++] = runs[r];
+      }
+      if (runs.size() % 2 == 0) {
+        // 奇数个片段时最后一段原样保留 / The last run stays as is for an odd count
+        runs[kept++] = runs[runs.size() - 2];
+      }
+      runs[kept++] = count;
+      runs.resize(kept);
+    }
+  }
+
+  const auto& points = m_cloud->points;
+  std::vector<data_type> xs(count);
+  std::vector<data_type> ys(count);
+  std::vector<data_type> zs(count);
+  std::vector<data_type> depths(count);
+  for (std::size_t k = 0; k < count; ++k) {
+    const auto& p = points[order[k]];
+    xs[k] = p.x;
+    ys[k] = p.y;
+    zs[k] = p.z;
+    depths[k] = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+  }
+
+  // 遮挡边界远侧的点不稳定，不参与选择 / Points on the far side of an occlusion
+  // boundary are unstable and never picked
+  constexpr data_type k_occlusion_ratio = static_cast<data_type>(0.1);
+  std::vector<uint8_t> blocked(count, 0);
+  for (std::size_t k = 0; k + 1 < count; ++k) {
+    const data_type da = depths[k];
+    const data_type db = depths[k + 1];
+    if (std::abs(da - db) <= k_occlusion_ratio * std::min(da, db)) {
+      continue;
+    }
+    if (da > db) {
+      std::fill(blocked.begin() + static_cast<std::ptrdiff_t>(k + 1 > half ? k + 1 - half : 0),
+                blocked.begin() + static_cast<std::ptrdiff_t>(k + 1),
+                uint8_t(1));
+    } else {
+      std::fill(blocked.begin() + static_cast<std::ptrdiff_t>(k + 1),
+                blocked.begin() + static_cast<std::ptrdiff_t>(std::min(count, k + 1 + half)),
+                uint8_t(1));
+    }
+  }
+
+  // 与KNN模式相同的曲率 |Σ(X_j - X_i)| / (k |X_i|)，邻居为线上前后各half个点，
+  // 窗口和沿线滑动更新 / The same curvature as the KNN mode, |Σ(X_j - X_i)| / (k |X_i|),
+  // over half points on each side along the ring, with window sums sliding along it
+  std::vector<data_type> curvatures(count, data_type(0));
+  const double window = static_cast<double>(2 * half);
+  double sx = 0.0;
+  double sy = 0.0;
+  double sz = 0.0;
+  for (std::size_t j = 0; j < 2 * half; ++j) {
+    sx += static_cast<double>(xs[j]);
+    sy += static_cast<double>(ys[j]);
+    sz += static_cast<double>(zs[j]);
+  }
+  for (std::size_t k = half; k + half < count; ++k) {
+    sx += static_cast<double>(xs[k + half]);
+    sy += static_cast<double>(ys[k + half]);
+    sz += static_cast<double>(zs[k + half]);
+    const double dx = sx - (window + 1.0) * static_cast<double>(xs[k]);
+    const double dy = sy - (window + 1.0) * static_cast<double>(ys[k]);
+    const double dz = sz - (window + 1.0) * static_cast<double>(zs[k]);
+    sx -= static_cast<double>(xs[k - half]);
+    sy -= static_cast<double>(ys[k - half]);
+    sz -= static_cast<double>(zs[k - half]);
+    if (!(depths[k] > data_type(1e-6))) {
+      blocked[k] = 1;
+      continue;
+    }
+    curvatures[k] = static_cast<data_type>(std::sqrt(dx * dx + dy * dy + dz * dz)
+                                           / (window * static_cast<double>(depths[k])));
+  }
+
+  auto suppress = [&](std::size_t k)
+  {
+    std::fill(blocked.begin() + static_cast<std::ptrdiff_t>(k - half),
+              blocked.begin() + static_cast<std::ptrdiff_t>(k + half + 1),
+              uint8_t(1));
+  };
+
+  const std::size_t num_sectors = std::max<std::size_t>(1, m_num_sectors);
+  const std::size_t span = count - 2 * half;
+  for (std::size_t s = 0; s < num_sectors; ++s) {
+    const std::size_t begin = half + span * s / num_sectors;
+    const std::size_t end = half + span * (s + 1) / num_sectors;
+
+    // 曲率最大的边缘点 / Sharpest edges
+    for (std::size_t pick = 0; pick < m_max_edges_per_sector; ++pick) {
+      std::size_t best = count;
+      data_type best_curvature = std::max(m_edge_threshold, m_curvature_threshold);
+      for (std::size_t k = begin; k < end; ++k) {
+        if (!blocked[k] && curvatures[k] > best_curvature) {
+          best = k;
+          best_curvature = curvatures[k];
+        }
+      }
+      if (best == count) {
+        break;
+      }
+      labels[order[best]] = static_cast<uint8_t>(feature_label::edge);
+      suppress(best);
+    }
+
+    // 曲率最小的平面点 / Flattest planar points
+    for (std::size_t pick = 0; pick < m_max_planar_per_sector; ++pick) {
+      std::size_t best = count;
+      data_type best_curvature = m_planar_threshold;
+      for (std::size_t k = begin; k < end; ++k) {
+        if (!blocked[k] && curvatures[k] >= m_curvature_threshold
+            && curvatures[k] < best_curvature)
+        {
+          best = k;
+          best_curvature = curvatures[k];
+        }
+      }
+      if (best == count) {
+        break;
+      }
+      labels[order[best]] = static_cast<uint8_t>(feature_label::planar);
+      suppress(best);
+    }
+  }
+}
+
+template<typename DataType, typename KNN>
+std::vector<uint8_t> loam_feature_extractor_t<DataType, KNN>::classify_scan_lines()
+{
+  const std::size_t num_points = m_cloud->size();
+  if ((!m_rings.empty() && m_rings.size() != num_points)
+      || (!m_azimuths.empty() && m_azimuths.size() != num_points))
+  {
+    LOG_ERROR_S << "loam_feature_extractor_t: " << m_rings.size() << " rings and "
+                << m_azimuths.size() << " azimuths given for " << num_points << " points";
+    return {};
+  }
+  if (m_rings.empty() && (m_num_rings == 0 || m_num_rings >= std::numeric_limits<std::uint16_t>::max()
+                          || !(m_fov_up_deg > m_fov_down_deg)))
+  {
+    LOG_ERROR_S << "loam_feature_extractor_t: Invalid ring layout " << m_num_rings << ", fov ["
+                << m_fov_down_deg << ", " << m_fov_up_deg << "]";
+    return {};
+  }
+
+  std::vector<std::uint16_t> rings;
+  std::vector<data_type> keys;
+  std::size_t num_rings = 0;
+  assign_rings(rings, keys, num_rings);
+
+  // 按线号的稳定计数排序，线内保持扫描顺序 / Stable counting sort by ring, keeping
+  // the scan order within every ring
+  std::vector<std::size_t> offsets(num_rings + 1, 0);
+  for (const auto ring : rings) {
+    if (ring < num_rings) {
+      ++offsets[ring + 1];
+    }
+  }
+  for (std::size_t r = 0; r < num_rings; ++r) {
+    offsets[r + 1] += offsets[r];
+  }
+  std::vector<std::size_t> order(offsets[num_rings]);
+  std::vector<std::size_t> cursor(offsets.begin(), offsets.end() - 1);
+  for (std::size_t i = 0; i < num_points; ++i) {
+    if (rings[i] < num_rings) {
+      order[cursor[rings[i]]++] = i;
+    }
+  }
+
+  std::vector<uint8_t> labels(num_points, static_cast<uint8_t>(feature_label::none));
+  toolbox::concurrent::parallel_for_chunks(
+      num_rings,
+      1,
+      m_enable_parallel,
+      [&](std::size_t start_ring, std::size_t end_ring)
+      {
+        for (std::size_t r = start_ring; r < end_ring; ++r) {
+          classify_ring(order.data() + offsets[r], offsets[r + 1] - offsets[r], keys, labels);
+        }
+      });
+  return labels;
+}
+
 // Static utility methods
 
 template<typename DataType, typename KNN>
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+
+#include <cpp-toolbox/logger/thread_logger.hpp>
+
+namespace toolbox::pcl
+{
+
+template<typename DataType>
+template<typename Derived, typename Element, typename Metric>
+bool local_geometry_cache_t<DataType>::build_radius(
+    base_knn_generic_t<Derived, Element, Metric>& knn,
+    const point_cloud& cloud,
+    data_type radius,
+    std::size_t max_neighbors,
+    bool parallel)
+{
+  clear();
+  if (!m_graph.build_radius(knn, cloud.points, radius, max_neighbors, parallel)) {
+    return false;
+  }
+  m_max_neighbors = max_neighbors;
+  return compute(cloud, parallel);
+}
+
+template<typename DataType>
+template<typename Derived, typename Element, typename Metric>
+bool local_geometry_cache_t<DataType>::build_knn(
+    base_knn_generic_t<Derived, Element, Metric>& knn,
+    const point_cloud& cloud,
+    std::size_t num_neighbors,
+    bool parallel)
+{
+  clear();
+  if (!m_graph.build_knn(knn, cloud.points, num_neighbors, parallel)) {
+    return false;
+  }
+  m_max_neighbors = num_neighbors;
+  return compute(cloud, parallel);
+}
+
+template<typename DataType>
+bool local_geometry_cache_t<DataType>::build(const point_cloud& cloud,
+                                             const graph_type& graph,
+                                             std::size_t max_neighbors,
+                                             bool parallel)
+{
+  clear();
+  if (graph.size() != cloud.size()) {
+    LOG_ERROR_S << "local_geometry_cache_t: Graph has " << graph.size()
+                << " rows but the cloud has " << cloud.size() << " points";
+    return false;
+  }
+  m_graph = graph;
+  m_max_neighbors = max_neighbors;
+  return compute(cloud, parallel);
+}
+
+template<typename DataType>
+bool local_geometry_cache_t<DataType>::compute(const point_cloud& cloud, bool parallel)
+{
+  if (m_graph.size() != cloud.size()) {
+    clear();
+    return false;
+  }
+  batch_pca_t<data_type> pca(cloud.points);
+  pca.set_precision(m_precision);
+  m_results = pca.compute(m_graph, m_max_neighbors, parallel);
+  return true;
+}
+
+template<typename DataType>
+void local_geometry_cache_t<DataType>::clear()
+{
+  m_graph.clear();
+  m_results.clear();
+  m_max_neighbors = 0;
+}
+
+template<typename DataType>
+typename local_geometry_cache_t<DataType>::neighbor_range_t
+local_geometry_cache_t<DataType>::neighbors(std::size_t i) const noexcept
+{
+  // K近邻图的半径为0，只按数量截断 / K-nearest graphs have radius 0 and are only
+  // capped by count
+  neighbor_range_t row = m_graph.is_radius_graph()
+      ? m_graph.neighbors(i, m_graph.radius(), m_max_neighbors)
+      : m_graph.neighbors(i);
+  if (m_max_neighbors > 0) {
+    row.size = std::min(row.size, m_max_neighbors);
+  }
+  return row;
+}
+
+template<typename DataType>
+symmetric3_t<DataType> local_geometry_cache_t<DataType>::covariance(std::size_t i) const
+{
+  // C = Σ λ_k v_k v_kᵀ
+  const auto& result = m_results[i];
+  symmetric3_t<data_type> c {};
+  for (std::size_t k = 0; k < 3; ++k) {
+    const data_type l = result.eigenvalues[k];
+    const auto& v = result.eigenvectors[k];
+    c.xx += l * v.x * v.x;
+    c.xy += l * v.x * v.y;
+    c.xz += l * v.x * v.z;
+    c.yy += l * v.y * v.y;
+    c.yz += l * v.y * v.z;
+    c.zz += l * v.z * v.z;
+  }
+  return c;
+}
+
+}  // namespace toolbox::pcl
@@ -347,84 +347,25 @@ mls_keypoint_extractor_t<DataType, KNN>::apply_non_maxima_suppression(
     return {};
   }
 
-  indices_vector keypoints;
+  // Valid points compete with the combined score (variation + curvature); those
+  // exceeding either threshold are candidates
   const std::size_t num_points = m_cloud->size();
-
-  // Debug: Count valid results
-  std::size_t valid_count = 0;
-  data_type max_variation = 0;
-  data_type max_curvature = 0;
-  
-  for (const auto& result : mls_results) {
-    if (result.valid) {
-      valid_count++;
-      max_variation = std::max(max_variation, result.variation);
-      max_curvature = std::max(max_curvature, result.curvature);
-    }
-  }
-  
-  // Debug output (uncomment for debugging)
-  // std::cout << "MLS Debug: valid=" << valid_count << "/" << num_points 
-  //           << " max_var=" << max_variation << " max_curv=" << max_curvature
-  //           << " thresh_var=" << m_variation_threshold << " thresh_curv=" << m_curvature_threshold << std::endl;
-
+  std::vector<data_type> scores(num_points, grid_nms_t<data_type>::k_no_score);
+  std::vector<std::uint8_t> candidates(num_points, 0);
   for (std::size_t i = 0; i < num_points; ++i) {
     const auto& current_result = mls_results[i];
-    
-    // Skip invalid points
     if (!current_result.valid) {
       continue;
     }
-    
-    // Check thresholds
-    bool is_keypoint = false;
-    
-    if (current_result.variation > m_variation_threshold) {
-      is_keypoint = true;
-    }
-    
-    if (m_compute_curvatures && current_result.curvature > m_curvature_threshold) {
-      is_keypoint = true;
-    }
-    
-    if (!is_keypoint) {
-      continue;
-    }
-
-    // Find neighbors within non-maxima suppression radius
-    const auto& query_point = m_cloud->points[i];
-    std::vector<std::size_t> neighbor_indices;
-    std::vector<data_type> neighbor_distances;
-    
-    m_knn->radius_neighbors(query_point, m_non_maxima_radius, neighbor_indices, neighbor_distances);
-
-    // Check if current point is local maximum
-    bool is_local_maximum = true;
-    
-    // Use combined score (variation + curvature)
-    const data_type current_score = current_result.variation + 
-                                   (m_compute_curvatures ? current_result.curvature : 0);
-    
-    for (const auto& neighbor_idx : neighbor_indices) {
-      if (neighbor_idx != i && neighbor_idx < mls_results.size()) {
-        const auto& neighbor_result = mls_results[neighbor_idx];
-        if (neighbor_result.valid) {
-          const data_type neighbor_score = neighbor_result.variation + 
-                                         (m_compute_curvatures ? neighbor_result.curvature : 0);
-          if (neighbor_score > current_score) {
-            is_local_maximum = false;
-            break;
-          }
-        }
-      }
-    }
-
-    if (is_local_maximum) {
-      keypoints.push_back(i);
-    }
+    scores[i] = current_result.variation + (m_compute_curvatures ? current_result.curvature : 0);
+    const bool is_keypoint = current_result.variation > m_variation_threshold
+        || (m_compute_curvatures && current_result.curvature > m_curvature_threshold);
+    candidates[i] = is_keypoint ? 1 : 0;
   }
 
-  return keypoints;
+  grid_nms_t<data_type> nms(m_non_maxima_radius);
+  nms.enable_parallel(m_enable_parallel);
+  return nms.suppress(m_cloud->points, scores, candidates);
 }
 
 template<typename DataType, typename KNN>
@@ -1,12 +1,13 @@
 #pragma once
 
 #include <cpp-toolbox/base/thread_pool_singleton.hpp>
+#include <cpp-toolbox/concurrent/parallel.hpp>
+#include <cpp-toolbox/pcl/norm/batch_pca.hpp>
 #include <cpp-toolbox/types/point.hpp>
-#include <Eigen/Dense>
-#include <Eigen/Eigenvalues>
 #include <algorithm>
 #include <cmath>
 #include <future>
+#include <memory>
 #include <vector>
 
 namespace toolbox::pcl
@@ -112,6 +113,11 @@ sift3d_keypoint_extractor_t<DataType, KNN>::build_scale_space()
     scale_level.resize(num_points, 0.0);
   }
 
+  if (m_scale_space_mode == scale_space_mode::voxel_pyramid) {
+    build_pyramid_scale_space(scale_space);
+    return scale_space;
+  }
+
   if (m_enable_parallel && num_points > k_parallel_threshold) {
     // Parallel computation
     const std::size_t num_threads = toolbox::base::thread_pool_singleton_t::instance().get_thread_count();
@@ -145,6 +151,77 @@ sift3d_keypoint_extractor_t<DataType, KNN>::build_scale_space()
   return scale_space;
 }
 
+template<typename DataType, typename KNN>
+void sift3d_keypoint_extractor_t<DataType, KNN>::build_pyramid_scale_space(
+    std::vector<std::vector<data_type>>& scale_space)
+{
+  if (m_num_scales == 0 || !(m_base_scale > 0) || !(m_pyramid_voxel_ratio > 0)) {
+    return;
+  }
+
+  // Scale s runs on the level whose voxel edge is ratio * base_scale * 2^l <= ratio * sigma_s,
+  // so the 3 * sigma window always spans about the same number of voxels
+  std::vector<std::size_t> scale_levels(m_num_scales, 0);
+  for (std::size_t scale_idx = 0; scale_idx < m_num_scales; ++scale_idx) {
+    const double octave = static_cast<double>(scale_idx) * std::log2(static_cast<double>(m_scale_factor));
+    scale_levels[scale_idx] = octave >= 1.0 ? std::min<std::size_t>(static_cast<std::size_t>(octave), 20) : 0;
+  }
+  const std::size_t num_levels = *std::max_element(scale_levels.begin(), scale_levels.end()) + 1;
+
+  voxel_pyramid_t<data_type> pyramid;
+  pyramid.enable_parallel(m_enable_parallel);
+  if (!pyramid.build(m_cloud->points, m_base_scale * m_pyramid_voxel_ratio, num_levels)) {
+    return;
+  }
+
+  std::vector<std::unique_ptr<kdtree_t<data_type>>> level_trees(num_levels);
+  std::vector<data_type> voxel_dog;
+  for (std::size_t scale_idx = 0; scale_idx < m_num_scales; ++scale_idx) {
+    const std::size_t level_idx = scale_levels[scale_idx];
+    const auto& level = pyramid.level(level_idx);
+    if (level.size() == 0) {
+      continue;
+    }
+    if (!level_trees[level_idx]) {
+      level_trees[level_idx] = std::make_unique<kdtree_t<data_type>>();
+      level_trees[level_idx]->set_input(level.centroids);
+    }
+    auto& tree = *level_trees[level_idx];
+
+    const data_type current_scale = m_base_scale * std::pow(m_scale_factor, scale_idx);
+    const data_type sigma_prev = current_scale / m_scale_factor;
+    const data_type inv_current = static_cast<data_type>(0.5) / (current_scale * current_scale);
+    const data_type inv_prev = static_cast<data_type>(0.5) / (sigma_prev * sigma_prev);
+
+    // Difference of Gaussians of the voxel densities, weighted by the points per voxel
+    voxel_dog.assign(level.size(), data_type(0));
+    toolbox::concurrent::parallel_for_chunks(
+        level.size(),
+        k_parallel_threshold,
+        m_enable_parallel,
+        [&](std::size_t start_idx, std::size_t end_idx)
+        {
+          std::vector<std::size_t> neighbor_indices;
+          std::vector<data_type> neighbor_distances;
+          for (std::size_t v = start_idx; v < end_idx; ++v) {
+            tree.radius_neighbors(
+                level.centroids[v], current_scale * 3, neighbor_indices, neighbor_distances);
+            double total_weight = 0.0;
+            double dog = 0.0;
+            for (std::size_t j = 0; j < neighbor_indices.size(); ++j) {
+              const data_type w = level.weights[neighbor_indices[j]];
+              const data_type dist_sq = neighbor_distances[j] * neighbor_distances[j];
+              total_weight += static_cast<double>(w);
+              dog += static_cast<double>(
+                  w * (std::exp(-dist_sq * inv_current) - std::exp(-dist_sq * inv_prev)));
+            }
+            voxel_dog[v] = total_weight < 3.0 ? data_type(0) : static_cast<data_type>(dog);
+          }
+        });
+    pyramid.interpolate(level_idx, voxel_dog, m_cloud->points, scale_space[scale_idx]);
+  }
+}
+
 template<typename DataType, typename KNN>
 std::vector<typename sift3d_keypoint_extractor_t<DataType, KNN>::ScaleSpacePoint>
 sift3d_keypoint_extractor_t<DataType, KNN>::find_scale_space_extrema(
@@ -152,50 +229,32 @@ sift3d_keypoint_extractor_t<DataType, KNN>::find_scale_space_extrema(
 {
   const std::size_t num_points = m_cloud->size();
   std::vector<ScaleSpacePoint> extrema;
-  
-  // Check for extrema across scales (excluding first and last scale)
-  for (std::size_t scale_idx = 1; scale_idx < m_num_scales - 1; ++scale_idx) {
+
+  // Check for extrema across scales (excluding first and last scale), then keep the
+  // spatial extrema within the scale radius through grid suppression; minima are
+  // maxima of the negated responses
+  std::vector<std::uint8_t> maxima(num_points);
+  std::vector<std::uint8_t> minima(num_points);
+  std::vector<data_type> negated(num_points);
+  for (std::size_t scale_idx = 1; scale_idx + 1 < m_num_scales; ++scale_idx) {
+    const auto& current = scale_space[scale_idx];
+    const auto& prev = scale_space[scale_idx - 1];
+    const auto& next = scale_space[scale_idx + 1];
     for (std::size_t point_idx = 0; point_idx < num_points; ++point_idx) {
-      const data_type current_value = scale_space[scale_idx][point_idx];
-      
-      // Check if it's a local extremum across scales
-      const data_type prev_scale_value = scale_space[scale_idx - 1][point_idx];
-      const data_type next_scale_value = scale_space[scale_idx + 1][point_idx];
-      
-      bool is_max = (current_value > prev_scale_value) && (current_value > next_scale_value);
-      bool is_min = (current_value < prev_scale_value) && (current_value < next_scale_value);
-      
-      if (!is_max && !is_min) {
-        continue;
-      }
-      
-      // Check spatial neighbors at the same scale
-      const auto& query_point = m_cloud->points[point_idx];
-      std::vector<std::size_t> neighbor_indices;
-      std::vector<data_type> neighbor_distances;
-      
-      const data_type search_radius = m_base_scale * std::pow(m_scale_factor, scale_idx);
-      m_knn->radius_neighbors(query_point, search_radius, neighbor_indices, neighbor_distances);
-      
-      bool is_spatial_extremum = true;
-      for (const auto& neighbor_idx : neighbor_indices) {
-        if (neighbor_idx == point_idx) continue;
-        
-        const data_type neighbor_value = scale_space[scale_idx][neighbor_idx];
-        
-        if (is_max && neighbor_value > current_value) {
-          is_spatial_extremum = false;
-          break;
-        }
-        if (is_min && neighbor_value < current_value) {
-          is_spatial_extremum = false;
-          break;
-        }
-      }
-      
-      if (is_spatial_extremum && std::abs(current_value) > m_contrast_threshold) {
-        extrema.push_back(ScaleSpacePoint{point_idx, scale_idx, current_value, true});
-      }
+      const data_type value = current[point_idx];
+      const bool contrast = std::abs(value) > m_contrast_threshold;
+      maxima[point_idx] = contrast && value > prev[point_idx] && value > next[point_idx];
+      minima[point_idx] = contrast && value < prev[point_idx] && value < next[point_idx];
+      negated[point_idx] = -value;
+    }
+
+    grid_nms_t<data_type> nms(m_base_scale * std::pow(m_scale_factor, scale_idx));
+    nms.enable_parallel(m_enable_parallel);
+    for (const auto point_idx : nms.suppress(m_cloud->points, current, maxima)) {
+      extrema.push_back(ScaleSpacePoint{point_idx, scale_idx, current[point_idx], true});
+    }
+    for (const auto point_idx : nms.suppress(m_cloud->points, negated, minima)) {
+      extrema.push_back(ScaleSpacePoint{point_idx, scale_idx, current[point_idx], true});
     }
   }
   
@@ -230,54 +289,28 @@ sift3d_keypoint_extractor_t<DataType, KNN>::remove_edge_responses(
 {
   indices_vector final_keypoints;
   
+  const batch_pca_t<data_type> pca(m_cloud->points);
   for (const auto& point_idx : keypoint_indices) {
-    const auto& query_point = m_cloud->points[point_idx];
-    
-    // Find local neighborhood
-    std::vector<std::size_t> neighbor_indices;
-    std::vector<data_type> neighbor_distances;
-    
-    m_knn->kneighbors(query_point, m_num_neighbors, neighbor_indices, neighbor_distances);
-    
-    if (neighbor_indices.size() < 3) {
-      continue;
-    }
-    
-    // Compute local structure tensor
-    Eigen::Vector3d centroid(0, 0, 0);
-    for (const auto& idx : neighbor_indices) {
-      const auto& p = m_cloud->points[idx];
-      centroid += Eigen::Vector3d(static_cast<double>(p.x), 
-                                 static_cast<double>(p.y), 
-                                 static_cast<double>(p.z));
-    }
-    centroid /= static_cast<double>(neighbor_indices.size());
-    
-    Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
-    for (const auto& idx : neighbor_indices) {
-      const auto& p = m_cloud->points[idx];
-      Eigen::Vector3d point_vec(static_cast<double>(p.x), 
-                               static_cast<double>(p.y), 
-                               static_cast<double>(p.z));
-      Eigen::Vector3d diff = point_vec - centroid;
-      covariance += diff * diff.transpose();
+    pca_result_t<data_type> pca_result;
+    if (m_cache) {
+      pca_result = (*m_cache)[point_idx];
+    } else {
+      // Find local neighborhood
+      std::vector<std::size_t> neighbor_indices;
+      std::vector<data_type> neighbor_distances;
+
+      m_knn->kneighbors(
+          m_cloud->points[point_idx], m_num_neighbors, neighbor_indices, neighbor_distances);
+
+      // Local covariance eigenvalues from the batch PCA kernel, in ascending order
+      pca_result = pca.compute(neighbor_indices);
     }
-    covariance /= static_cast<double>(neighbor_indices.size() - 1);
-    
-    // Compute eigenvalues
-    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigen_solver(covariance);
-    if (eigen_solver.info() != Eigen::Success) {
+    if (!pca_result.valid) {
       continue;
     }
-    
-    const Eigen::Vector3d& eigenvalues = eigen_solver.eigenvalues();
-    
-    // Sort eigenvalues in descending order
-    std::vector<double> sorted_eigenvals = {eigenvalues(2), eigenvalues(1), eigenvalues(0)};
-    std::sort(sorted_eigenvals.rbegin(), sorted_eigenvals.rend());
-    
-    const double lambda_max = sorted_eigenvals[0];
-    const double lambda_min = sorted_eigenvals[2];
+
+    const double lambda_max = static_cast<double>(pca_result.eigenvalues[2]);
+    const double lambda_min = static_cast<double>(pca_result.eigenvalues[0]);
     
     // Edge response test: ratio of largest to smallest eigenvalue
     if (lambda_min > 1e-10) {
@@ -299,6 +332,9 @@ sift3d_keypoint_extractor_t<DataType, KNN>::extract_impl()
   if (!m_cloud || !m_knn) {
     return {};
   }
+  if (m_cache && m_cache->size() != m_cloud->size()) {
+    return {};
+  }
 
   // Step 1: Build scale space
   auto scale_space = build_scale_space();
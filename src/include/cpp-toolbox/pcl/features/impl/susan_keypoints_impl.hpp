@@ -234,42 +234,22 @@ susan_keypoint_extractor_t<DataType, KNN>::apply_non_maxima_suppression(
     return {};
   }
 
-  indices_vector keypoints;
+  // Lower SUSAN values indicate features, so local minima are found on negated scores.
+  // Valid points compete; those not above the threshold are candidates
   const std::size_t num_points = m_cloud->size();
-
+  std::vector<data_type> scores(num_points, grid_nms_t<data_type>::k_no_score);
+  std::vector<std::uint8_t> candidates(num_points, 0);
   for (std::size_t i = 0; i < num_points; ++i) {
     const auto& current_response = susan_responses[i];
-    
-    // Skip invalid points or those above threshold (high SUSAN value means flat region)
-    if (!current_response.is_valid || current_response.susan_value > m_susan_threshold) {
-      continue;
-    }
-
-    // Find neighbors within non-maxima suppression radius
-    const auto& query_point = m_cloud->points[i];
-    std::vector<std::size_t> neighbor_indices;
-    std::vector<data_type> neighbor_distances;
-    
-    m_knn->radius_neighbors(query_point, m_non_maxima_radius, neighbor_indices, neighbor_distances);
-
-    // Check if current point is local minimum (for SUSAN, lower values indicate features)
-    bool is_local_minimum = true;
-    for (const auto& neighbor_idx : neighbor_indices) {
-      if (neighbor_idx != i && neighbor_idx < susan_responses.size()) {
-        if (susan_responses[neighbor_idx].is_valid && 
-            susan_responses[neighbor_idx].susan_value < current_response.susan_value) {
-          is_local_minimum = false;
-          break;
-        }
-      }
-    }
-
-    if (is_local_minimum) {
-      keypoints.push_back(i);
+    if (current_response.is_valid) {
+      scores[i] = -current_response.susan_value;
+      candidates[i] = current_response.susan_value <= m_susan_threshold ? 1 : 0;
     }
   }
 
-  return keypoints;
+  grid_nms_t<data_type> nms(m_non_maxima_radius);
+  nms.enable_parallel(m_enable_parallel);
+  return nms.suppress(m_cloud->points, scores, candidates);
 }
 
 template<typename DataType, typename KNN>
@@ -0,0 +1,317 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include <cpp-toolbox/concurrent/parallel.hpp>
+#include <cpp-toolbox/logger/thread_logger.hpp>
+
+namespace toolbox::pcl
+{
+
+namespace detail
+{
+
+/// 每轴21位的体素坐标键 / Voxel coordinate key with 21 bits per axis
+inline std::uint64_t pack_pyramid_key(std::uint64_t x, std::uint64_t y, std::uint64_t z) noexcept
+{
+  return (z << 42U) | (y << 21U) | x;
+}
+
+inline void unpack_pyramid_key(std::uint64_t key, std::uint64_t cell[3]) noexcept
+{
+  constexpr std::uint64_t k_mask = (std::uint64_t(1) << 21U) - 1;
+  cell[0] = key & k_mask;
+  cell[1] = (key >> 21U) & k_mask;
+  cell[2] = key >> 42U;
+}
+
+}  // namespace detail
+
+template<typename DataType>
+void voxel_pyramid_t<DataType>::clear()
+{
+  m_levels.clear();
+  m_point_voxels.clear();
+  m_origin[0] = m_origin[1] = m_origin[2] = 0.0;
+  m_base_voxel_size = 0.0;
+  m_num_points = 0;
+}
+
+template<typename DataType>
+bool voxel_pyramid_t<DataType>::base_cell(const point_type& p, std::uint64_t cell[3]) const
+{
+  constexpr double k_axis_max = static_cast<double>((std::uint64_t(1) << k_axis_bits) - 1);
+  const double coords[3] = {
+      static_cast<double>(p.x), static_cast<double>(p.y), static_cast<double>(p.z)};
+  for (std::size_t axis = 0; axis < 3; ++axis) {
+    if (!std::isfinite(coords[axis])) {
+      return false;
+    }
+    const double c = std::floor((coords[axis] - m_origin[axis]) / m_base_voxel_size);
+    cell[axis] = static_cast<std::uint64_t>(std::clamp(c, 0.0, k_axis_max));
+  }
+  return true;
+}
+
+template<typename DataType>
+template<typename Position, typename Weight>
+void voxel_pyramid_t<DataType>::aggregate(const std::vector<std::uint64_t>& keys,
+                                          const std::vector<std::size_t>& members,
+                                          Position position,
+                                          Weight weight,
+                                          level_t& level,
+                                          std::vector<std::size_t>& owners) const
+{
+  std::vector<std::size_t> starts;
+  level.keys.clear();
+  for (std::size_t m = 0; m < keys.size(); ++m) {
+    if (m == 0 || keys[m] != keys[m - 1]) {
+      level.keys.push_back(keys[m]);
+      starts.push_back(m);
+    }
+  }
+  starts.push_back(keys.size());
+
+  const std::size_t num_voxels = level.keys.size();
+  level.centroids.resize(num_voxels);
+  level.weights.resize(num_voxels);
+  toolbox::concurrent::parallel_for_chunks(
+      num_voxels,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t v = start_idx; v < end_idx; ++v) {
+          double sum_w = 0.0;
+          double sum_x = 0.0;
+          double sum_y = 0.0;
+          double sum_z = 0.0;
+          for (std::size_t m = starts[v]; m < starts[v + 1]; ++m) {
+            const auto& p = position(members[m]);
+            const double w = static_cast<double>(weight(members[m]));
+            sum_w += w;
+            sum_x += w * static_cast<double>(p.x);
+            sum_y += w * static_cast<double>(p.y);
+            sum_z += w * static_cast<double>(p.z);
+          }
+          level.centroids[v] = point_type(static_cast<data_type>(sum_x / sum_w),
+                                          static_cast<data_type>(sum_y / sum_w),
+                                          static_cast<data_type>(sum_z / sum_w));
+          level.weights[v] = static_cast<data_type>(sum_w);
+          for (std::size_t m = starts[v]; m < starts[v + 1]; ++m) {
+            owners[members[m]] = v;
+          }
+        }
+      });
+}
+
+template<typename DataType>
+bool voxel_pyramid_t<DataType>::build(const std::vector<point_type>& points,
+                                      data_type base_voxel_size,
+                                      std::size_t num_levels)
+{
+  clear();
+  if (!(base_voxel_size > data_type(0)) || num_levels == 0) {
+    LOG_ERROR_S << "voxel_pyramid_t: Invalid voxel size " << base_voxel_size << " or "
+                << num_levels << " levels";
+    return false;
+  }
+  if (num_levels > k_axis_bits) {
+    LOG_ERROR_S << "voxel_pyramid_t: At most " << k_axis_bits << " levels are supported";
+    return false;
+  }
+
+  m_base_voxel_size = static_cast<double>(base_voxel_size);
+  m_num_points = points.size();
+  m_levels.resize(num_levels);
+  for (std::size_t l = 0; l < num_levels; ++l) {
+    m_levels[l].voxel_size = static_cast<data_type>(std::ldexp(m_base_voxel_size, static_cast<int>(l)));
+  }
+
+  // 网格原点取有限点的最小坐标 / The grid origin is the minimum over the finite points
+  double lower[3] = {std::numeric_limits<double>::max(),
+                     std::numeric_limits<double>::max(),
+                     std::numeric_limits<double>::max()};
+  for (const auto& p : points) {
+    if (std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z)) {
+      lower[0] = std::min(lower[0], static_cast<double>(p.x));
+      lower[1] = std::min(lower[1], static_cast<double>(p.y));
+      lower[2] = std::min(lower[2], static_cast<double>(p.z));
+    }
+  }
+  if (lower[0] == std::numeric_limits<double>::max()) {
+    return true;
+  }
+  std::copy(lower, lower + 3, m_origin);
+
+  // 第0层由点聚合 / Level 0 aggregates the points
+  m_point_voxels.assign(points.size(), k_no_voxel);
+  std::vector<std::uint64_t> keys(points.size());
+  std::vector<std::uint8_t> placed(points.size(), 0);
+  toolbox::concurrent::parallel_for_chunks(
+      points.size(),
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        std::uint64_t cell[3];
+        for (std::size_t i = start_idx; i < end_idx; ++i) {
+          if (base_cell(points[i], cell)) {
+            keys[i] = detail::pack_pyramid_key(cell[0], cell[1], cell[2]);
+            placed[i] = 1;
+          }
+        }
+      });
+  std::vector<std::size_t> members;
+  members.reserve(points.size());
+  std::size_t num_placed = 0;
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    if (placed[i]) {
+      keys[num_placed++] = keys[i];
+      members.push_back(i);
+    }
+  }
+  keys.resize(num_placed);
+  toolbox::concurrent::parallel_radix_sort_pairs(
+      keys, members, 3 * k_axis_bits, m_enable_parallel);
+  aggregate(
+      keys,
+      members,
+      [&points](std::size_t i) -> const point_type& { return points[i]; },
+      [](std::size_t) { return data_type(1); },
+      m_levels[0],
+      m_point_voxels);
+
+  // 其余各层由下一层的体素聚合，坐标右移一位即父体素 / Every further level aggregates
+  // the voxels below; shifting the coordinates by one bit gives the parent voxel
+  for (std::size_t l = 1; l < num_levels; ++l) {
+    level_t& below = m_levels[l - 1];
+    keys.resize(below.size());
+    members.resize(below.size());
+    std::iota(members.begin(), members.end(), std::size_t(0));
+    toolbox::concurrent::parallel_for_chunks(
+        below.size(),
+        k_parallel_threshold,
+        m_enable_parallel,
+        [&](std::size_t start_idx, std::size_t end_idx)
+        {
+          std::uint64_t cell[3];
+          for (std::size_t v = start_idx; v < end_idx; ++v) {
+            detail::unpack_pyramid_key(below.keys[v], cell);
+            keys[v] = detail::pack_pyramid_key(cell[0] >> 1U, cell[1] >> 1U, cell[2] >> 1U);
+          }
+        });
+    toolbox::concurrent::parallel_radix_sort_pairs(
+      keys, members, 3 * k_axis_bits, m_enable_parallel);
+    below.parents.assign(below.size(), k_no_voxel);
+    aggregate(
+        keys,
+        members,
+        [&below](std::size_t v) -> const point_type& { return below.centroids[v]; },
+        [&below](std::size_t v) { return below.weights[v]; },
+        m_levels[l],
+        below.parents);
+  }
+  return true;
+}
+
+template<typename DataType>
+bool voxel_pyramid_t<DataType>::interpolate(std::size_t l,
+                                            const std::vector<data_type>& values,
+                                            const std::vector<point_type>& points,
+                                            std::vector<data_type>& output) const
+{
+  if (l >= m_levels.size() || values.size() != m_levels[l].size()
+      || points.size() != m_num_points)
+  {
+    LOG_ERROR_S << "voxel_pyramid_t: Cannot interpolate " << values.size()
+                << " values of level " << l << " onto " << points.size() << " points";
+    return false;
+  }
+
+  const level_t& level = m_levels[l];
+  const double voxel_size = static_cast<double>(level.voxel_size);
+  const double inv_support_sq = 0.25 / (voxel_size * voxel_size);
+  const std::uint64_t cell_max = ((std::uint64_t(1) << k_axis_bits) - 1) >> l;
+
+  // 1. 每个体素的27邻域，x方向相邻的体素键连续，每个体素9次二分查找 / The 27-voxel
+  // neighborhood of every voxel; keys adjacent along x are consecutive, so each voxel
+  // needs 9 binary searches
+  const std::size_t num_voxels = level.size();
+  std::vector<std::size_t> counts(num_voxels, 0);
+  std::vector<std::size_t> adjacent(num_voxels * 27);
+  toolbox::concurrent::parallel_for_chunks(
+      num_voxels,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        std::uint64_t cell[3];
+        for (std::size_t v = start_idx; v < end_idx; ++v) {
+          detail::unpack_pyramid_key(level.keys[v], cell);
+          const std::uint64_t x0 = cell[0] > 0 ? cell[0] - 1 : 0;
+          const std::uint64_t x1 = std::min(cell[0] + 1, cell_max);
+          std::size_t count = 0;
+          for (std::uint64_t z = cell[2] > 0 ? cell[2] - 1 : 0;
+               z <= std::min(cell[2] + 1, cell_max);
+               ++z)
+          {
+            for (std::uint64_t y = cell[1] > 0 ? cell[1] - 1 : 0;
+                 y <= std::min(cell[1] + 1, cell_max);
+                 ++y)
+            {
+              const std::uint64_t last = detail::pack_pyramid_key(x1, y, z);
+              auto it = std::lower_bound(
+                  level.keys.begin(), level.keys.end(), detail::pack_pyramid_key(x0, y, z));
+              for (; it != level.keys.end() && *it <= last; ++it) {
+                adjacent[27 * v + count++] = static_cast<std::size_t>(it - level.keys.begin());
+              }
+            }
+          }
+          counts[v] = count;
+        }
+      });
+
+  // 2. 每个点沿parents找到所在体素，对相邻体素按核加权 / Every point follows the
+  // parents to its voxel and weights the adjacent voxels by the kernel
+  output.assign(points.size(), data_type(0));
+  toolbox::concurrent::parallel_for_chunks(
+      points.size(),
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t i = start_idx; i < end_idx; ++i) {
+          std::size_t v = m_point_voxels[i];
+          for (std::size_t k = 0; k < l && v != k_no_voxel; ++k) {
+            v = m_levels[k].parents[v];
+          }
+          if (v == k_no_voxel) {
+            continue;
+          }
+          const auto& p = points[i];
+          double sum_k = 0.0;
+          double sum_v = 0.0;
+          for (std::size_t a = 27 * v; a < 27 * v + counts[v]; ++a) {
+            const std::size_t u = adjacent[a];
+            const auto& c = level.centroids[u];
+            const double dx = static_cast<double>(c.x) - static_cast<double>(p.x);
+            const double dy = static_cast<double>(c.y) - static_cast<double>(p.y);
+            const double dz = static_cast<double>(c.z) - static_cast<double>(p.z);
+            const double t =
+                std::max(0.0, 1.0 - (dx * dx + dy * dy + dz * dz) * inv_support_sq);
+            const double k = t * t;
+            sum_k += k;
+            sum_v += k * static_cast<double>(values[u]);
+          }
+          output[i] = sum_k > 0.0 ? static_cast<data_type>(sum_v / sum_k) : data_type(0);
+        }
+      });
+  return true;
+}
+
+}  // namespace toolbox::pcl
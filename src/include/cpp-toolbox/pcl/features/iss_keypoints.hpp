@@ -2,8 +2,11 @@
 
 #include <cpp-toolbox/cpp-toolbox_export.hpp>
 #include <cpp-toolbox/pcl/features/base_feature_extractor.hpp>
+#include <cpp-toolbox/pcl/features/grid_nms.hpp>
 #include <cpp-toolbox/pcl/knn/kdtree.hpp>
 #include <cpp-toolbox/pcl/knn/bfknn_parallel.hpp>
+#include <cpp-toolbox/pcl/features/local_geometry_cache.hpp>
+#include <cpp-toolbox/pcl/knn/neighborhood_graph.hpp>
 #include <cpp-toolbox/metrics/vector_metrics.hpp>
 
 namespace toolbox::pcl
@@ -138,6 +141,27 @@ public:
    */
   void set_min_neighbors(std::size_t min_neighbors) { m_min_neighbors = min_neighbors; }
 
+  /**
+   * @brief 使用预计算的近邻图代替半径搜索 / Use a precomputed neighborhood graph instead of radius searches
+   * @param graph 以输入点云为查询建立的近邻图 / Neighborhood graph built with the input cloud as queries
+   *
+   * @details 显著性只读取图中半径内的前缀，因此建图半径应不小于salient_radius；非极大值
+   * 抑制使用体素网格，不读取近邻图 / Saliency only reads the in-radius prefix of each
+   * row, so the graph radius should be at least salient_radius; non-maxima
+   * suppression runs on a voxel grid and does not read the graph
+   */
+  void set_neighborhood_graph(const neighborhood_graph_t<data_type>& graph) { m_graph = &graph; }
+
+  /**
+   * @brief 使用共享的局部几何缓存 / Use a shared local geometry cache
+   * @param cache 以输入点云填充的缓存 / Cache filled from the input cloud
+   *
+   * @details 显著性直接取缓存中不加权协方差的特征值，不再做半径搜索和特征分解 / Saliency
+   * takes the eigenvalues of the unweighted covariance straight from the cache,
+   * without radius searches or eigen decompositions
+   */
+  void set_geometry_cache(const local_geometry_cache_t<data_type>& cache) { m_cache = &cache; }
+
   /**
    * @brief 获取显著性半径 / Get saliency radius
    * @return 当前的显著性半径 / Current saliency radius
@@ -213,6 +237,14 @@ private:
                         std::size_t start_idx, 
                         std::size_t end_idx);
 
+  /**
+   * @brief 查找点的半径邻居，优先使用近邻图 / Find radius neighbors of a point, preferring the graph
+   */
+  void find_neighbors(std::size_t point_idx,
+                      data_type radius,
+                      std::vector<std::size_t>& indices,
+                      std::vector<data_type>& distances);
+
   // 成员变量 / Member variables
   bool m_enable_parallel = false;                               ///< 是否启用并行处理 / Whether to enable parallel processing
   data_type m_salient_radius = static_cast<data_type>(1.0);    ///< 显著性半径 / Saliency radius
@@ -223,6 +255,8 @@ private:
   
   point_cloud_ptr m_cloud;                                      ///< 输入点云 / Input point cloud
   knn_type* m_knn = nullptr;                                    ///< KNN算法指针 / KNN algorithm pointer
+  const neighborhood_graph_t<data_type>* m_graph = nullptr;    ///< 预计算的近邻图 / Precomputed neighborhood graph
+  const local_geometry_cache_t<data_type>* m_cache = nullptr;  ///< 共享的局部几何缓存 / Shared local geometry cache
 
   /**
    * @brief 并行处理阈值 / Parallel processing threshold
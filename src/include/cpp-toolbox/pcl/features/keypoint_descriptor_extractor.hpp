@@ -0,0 +1,215 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cpp-toolbox/cpp-toolbox_export.hpp>
+#include <cpp-toolbox/pcl/features/local_geometry_cache.hpp>
+#include <cpp-toolbox/pcl/knn/base_knn.hpp>
+#include <cpp-toolbox/pcl/knn/neighborhood_graph.hpp>
+#include <cpp-toolbox/types/point.hpp>
+
+namespace toolbox::pcl
+{
+
+namespace detail
+{
+
+template<typename T, typename Cache, typename = void>
+struct accepts_geometry_cache : std::false_type
+{
+};
+
+template<typename T, typename Cache>
+struct accepts_geometry_cache<
+    T,
+    Cache,
+    std::void_t<decltype(std::declval<T&>().set_geometry_cache(std::declval<const Cache&>()))>>
+    : std::true_type
+{
+};
+
+template<typename T, typename Graph, typename = void>
+struct accepts_neighborhood_graph : std::false_type
+{
+};
+
+template<typename T, typename Graph>
+struct accepts_neighborhood_graph<
+    T,
+    Graph,
+    std::void_t<decltype(std::declval<T&>().set_neighborhood_graph(std::declval<const Graph&>()))>>
+    : std::true_type
+{
+};
+
+template<typename T, typename CloudPtr, typename = void>
+struct accepts_normals : std::false_type
+{
+};
+
+template<typename T, typename CloudPtr>
+struct accepts_normals<
+    T,
+    CloudPtr,
+    std::void_t<decltype(std::declval<T&>().set_normals(std::declval<const CloudPtr&>()))>>
+    : std::true_type
+{
+};
+
+template<typename T, typename = void>
+struct has_salient_radius : std::false_type
+{
+};
+
+template<typename T>
+struct has_salient_radius<T, std::void_t<decltype(std::declval<const T&>().get_salient_radius())>>
+    : std::true_type
+{
+};
+
+/// 检测器单独运行时的邻域半径 / Neighborhood radius of the detector when run on its own
+template<typename Detector>
+auto detector_radius(const Detector& detector)
+{
+  if constexpr (has_salient_radius<Detector>::value) {
+    return detector.get_salient_radius();
+  } else {
+    return detector.get_search_radius();
+  }
+}
+
+}  // namespace detail
+
+/**
+ * @brief 共享一次邻域搜索的关键点加描述子提取器 / Keypoint plus descriptor extractor
+ * sharing one neighborhood pass
+ *
+ * 先检测关键点再在关键点处计算描述子时，两个阶段会在同样的点周围重复同样的邻域搜索。本类
+ * 对每个候选点只做一次半径搜索和PCA（local_geometry_cache_t，按块并行），然后检测器读取
+ * 缓存的近邻图（或几何），描述子读取同一近邻图中的邻居和由缓存特征向量得到的法线，两个
+ * 阶段都不再做KNN搜索，也没有第二次法线估计。
+ * Detecting keypoints and then describing them repeats the same neighborhood
+ * searches around the same points in both stages. This class runs one radius
+ * search and PCA per candidate point (local_geometry_cache_t, in parallel
+ * chunks); the detector then reads the cached neighborhood graph (or geometry)
+ * and the descriptor reads its neighbors from the same graph and its normals
+ * from the cached eigenvectors, so neither stage searches a KNN again and
+ * normals are not estimated a second time.
+ *
+ * 接受近邻图的检测器（ISS）和所有描述子（FPFH、SHOT）把图的行截断到各自的半径和邻居上限，
+ * 结果与单独运行相同。因此共享半径不能小于检测器（ISS为salient_radius）和描述子的半径，
+ * 共享的邻居上限不能小于描述子的邻居数，ISS还要求不设邻居上限，否则extract失败。
+ * 只接受几何缓存的检测器（Harris3D、曲率、SIFT3D）直接使用共享半径下的
+ * 邻域和PCA，自己的搜索半径或邻居数不再起作用；两者不同时会给出警告。
+ * Detectors that accept a neighborhood graph (ISS) and all descriptors (FPFH,
+ * SHOT) cut graph rows to their own radius and neighbor limit and so match a
+ * standalone run. The shared radius must therefore cover both the detector's
+ * radius (salient_radius for ISS) and the descriptor's, a shared neighbor limit
+ * must not be below the descriptor's neighbor count, and ISS needs uncapped rows;
+ * otherwise extract fails. Detectors that only accept the
+ * geometry cache (Harris3D, curvature, SIFT3D) use the neighborhoods and PCA at
+ * the shared radius and their own search radius or neighbor count no longer
+ * applies; a warning is logged when the two radii differ.
+ *
+ * @tparam Detector 关键点检测器类型 / Keypoint detector type
+ * @tparam Descriptor 描述子提取器类型 / Descriptor extractor type
+ *
+ * @code
+ * iss_keypoint_extractor_t<float> iss;
+ * iss.set_salient_radius(0.5f);
+ * iss.set_threshold21(0.975f);
+ * fpfh_extractor_t<float> fpfh;
+ * fpfh.set_search_radius(0.5f);
+ *
+ * kdtree_t<float> kdtree;
+ * kdtree.set_input(cloud.points);
+ *
+ * keypoint_descriptor_extractor_t fused(iss, fpfh);
+ * fused.set_search_radius(0.5f);
+ * fused.enable_parallel(true);
+ *
+ * std::vector<std::size_t> keypoints;
+ * std::vector<fpfh_signature_t<float>> descriptors;
+ * fused.extract(kdtree, cloud, keypoints, descriptors);
+ * @endcode
+ *
+ * @note 检测器和描述子保存指向本对象内部缓存的指针，本对象须比它们之后的使用活得更久；
+ * 需要缓存之外邻域的检测器（SIFT3D的尺度空间）仍使用自己的KNN / The detector and the
+ * descriptor keep pointers into this object's cache, so it must outlive their
+ * further use; detectors needing neighborhoods beyond the cache (the SIFT3D scale
+ * space) keep using their own KNN
+ */
+template<typename Detector, typename Descriptor>
+class CPP_TOOLBOX_EXPORT keypoint_descriptor_extractor_t
+{
+public:
+  using data_type = typename Detector::data_type;
+  using signature_type = typename Descriptor::signature_type;
+  using point_cloud = toolbox::types::point_cloud_t<data_type>;
+  using point_cloud_ptr = std::shared_ptr<point_cloud>;
+  using indices_vector = std::vector<std::size_t>;
+  using cache_type = local_geometry_cache_t<data_type>;
+
+  static_assert(detail::accepts_geometry_cache<Detector, cache_type>::value
+                    || detail::accepts_neighborhood_graph<Detector,
+                                                          neighborhood_graph_t<data_type>>::value,
+                "The detector must accept a geometry cache or a neighborhood graph");
+  static_assert(
+      detail::accepts_neighborhood_graph<Descriptor, neighborhood_graph_t<data_type>>::value,
+      "The descriptor must accept a neighborhood graph");
+
+  keypoint_descriptor_extractor_t(Detector& detector, Descriptor& descriptor)
+      : m_detector(detector), m_descriptor(descriptor)
+  {
+  }
+
+  /// 共享邻域的半径 / Radius of the shared neighborhoods
+  void set_search_radius(data_type radius) { m_search_radius = radius; }
+  [[nodiscard]] data_type get_search_radius() const noexcept { return m_search_radius; }
+
+  /// 每点最多的邻居数，0表示不限制 / Neighbors per point at most, 0 for no limit
+  void set_max_neighbors(std::size_t max_neighbors) { m_max_neighbors = max_neighbors; }
+  [[nodiscard]] std::size_t get_max_neighbors() const noexcept { return m_max_neighbors; }
+
+  /// 同时作用于邻域搜索、检测器和描述子 / Applies to the neighborhood pass, the detector
+  /// and the descriptor
+  void enable_parallel(bool enable) { m_enable_parallel = enable; }
+
+  /**
+   * @brief 检测关键点并计算其描述子 / Detect keypoints and compute their descriptors
+   * @param knn 已设置输入为cloud的KNN搜索器 / KNN searcher with cloud as its input
+   * @param cloud 点云 / Point cloud
+   * @param keypoints [out] 关键点索引 / Keypoint indices
+   * @param descriptors [out] 与keypoints一一对应的描述子 / Descriptors matching keypoints
+   * one to one
+   * @return 是否成功 / Whether successful
+   */
+  template<typename Derived, typename Element, typename Metric>
+  bool extract(base_knn_generic_t<Derived, Element, Metric>& knn,
+               const point_cloud& cloud,
+               indices_vector& keypoints,
+               std::vector<signature_type>& descriptors);
+
+  /// 最近一次提取的共享几何 / Shared geometry of the latest extraction
+  [[nodiscard]] const cache_type& geometry_cache() const noexcept { return m_cache; }
+
+  /// 由共享几何得到的法线 / Normals derived from the shared geometry
+  [[nodiscard]] const point_cloud_ptr& normals() const noexcept { return m_normals; }
+
+private:
+  Detector& m_detector;
+  Descriptor& m_descriptor;
+  cache_type m_cache;
+  point_cloud_ptr m_normals;
+  data_type m_search_radius = data_type(0);
+  std::size_t m_max_neighbors = 0;
+  bool m_enable_parallel = false;
+};
+
+}  // namespace toolbox::pcl
+
+#include <cpp-toolbox/pcl/features/impl/keypoint_descriptor_extractor_impl.hpp>
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstdint>
+#include <limits>
+#include <vector>
+
 #include <cpp-toolbox/cpp-toolbox_export.hpp>
 #include <cpp-toolbox/pcl/features/base_feature_extractor.hpp>
 #include <cpp-toolbox/pcl/knn/kdtree.hpp>
@@ -16,6 +20,30 @@ namespace toolbox::pcl
  * @tparam KNN 最近邻搜索算法类型，默认使用 kdtree_generic_t / K-nearest neighbor search algorithm type, defaults to kdtree_generic_t
  * 
  * @details LOAM特征提取器专门用于激光雷达点云，提取边缘点和平面点特征，常用于SLAM应用 / LOAM feature extractor is designed for LiDAR point clouds, extracting edge and planar features commonly used in SLAM applications
+ *
+ * 支持两种曲率模式 / Two curvature modes are supported:
+ * - knn: 每个点用KNN邻域计算曲率并按阈值分类 / Curvature from the KNN
+ *   neighborhood of every point, classified by thresholds
+ * - scan_line: 原始LOAM的扫描线模式。点按线号分组、按方位角排序，曲率在每条线上用滑动窗口
+ *   计算，每条线分成若干扇区，每个扇区选取曲率最大的边缘点和最小的平面点，并抑制已选点
+ *   的窗口邻居。不需要空间索引，复杂度O(N)，各条线并行处理 / The scan-line mode of the
+ *   original LOAM. Points are grouped by ring and ordered by azimuth, curvature comes from
+ *   a sliding window along every ring, and every ring is split into sectors that each
+ *   pick the sharpest edges and flattest planar points while suppressing the window
+ *   neighbors of picked points. No spatial index is needed, the cost is O(N), and rings
+ *   are processed in parallel
+ *
+ * @code
+ * // KITTI .bin没有线号，由仰角推断 / KITTI .bin has no rings, infer them from elevation
+ * loam_feature_extractor_t<float> loam;
+ * loam.set_input(scan);
+ * loam.set_ring_layout(64, 2.0f, -24.8f);  // HDL-64E
+ * loam.enable_parallel(true);
+ * auto result = loam.extract_labeled_cloud();
+ *
+ * // 驱动给出的线号和方位角 / Rings and azimuths from the driver
+ * loam.set_scan_rings(rings, azimuths);
+ * @endcode
  */
 template<typename DataType, 
          typename KNN = kdtree_generic_t<point_t<DataType>, toolbox::metrics::L2Metric<DataType>>>
@@ -41,6 +69,12 @@ public:
     planar = 2   // Planar point
   };
   
+  // Curvature computation mode
+  enum class curvature_mode : uint8_t {
+    knn = 0,       // KNN neighborhood of every point
+    scan_line = 1  // Sliding window along every ring
+  };
+
   // Result structure containing both point cloud and labels
   struct loam_result {
     point_cloud cloud;
@@ -75,6 +109,48 @@ public:
   [[nodiscard]] data_type get_curvature_threshold() const { return m_curvature_threshold; }
   [[nodiscard]] std::size_t get_num_scan_neighbors() const { return m_num_scan_neighbors; }
 
+  /**
+   * @brief 设置曲率模式 / Set the curvature mode
+   * @param mode 曲率模式 / Curvature mode
+   */
+  void set_curvature_mode(curvature_mode mode) { m_mode = mode; }
+  [[nodiscard]] curvature_mode get_curvature_mode() const { return m_mode; }
+
+  /**
+   * @brief 设置每个点的线号和方位角，并切换到扫描线模式 / Set the ring and azimuth of
+   * every point and switch to the scan-line mode
+   * @param rings 每个点的线号 / Ring of every point
+   * @param azimuths 每个点的方位角（弧度），为空时由坐标计算 / Azimuth of every point in
+   * radians, computed from the coordinates when empty
+   * @return 线数 / Number of rings
+   */
+  std::size_t set_scan_rings(std::vector<std::uint16_t> rings,
+                             std::vector<data_type> azimuths = {});
+
+  /**
+   * @brief 设置由仰角推断线号的均匀线束布局，并切换到扫描线模式 / Set the uniform beam
+   * layout used to infer rings from elevation and switch to the scan-line mode
+   * @param num_rings 线数 / Number of rings
+   * @param fov_up_deg 视场上边界（度） / Upper edge of the field of view in degrees
+   * @param fov_down_deg 视场下边界（度） / Lower edge of the field of view in degrees
+   *
+   * 默认是KITTI的HDL-64E：64线，2.0到-24.8度。会清除set_scan_rings给出的线号。
+   * Defaults to the HDL-64E of KITTI: 64 rings from 2.0 to -24.8 degrees. Clears the
+   * rings given by set_scan_rings.
+   */
+  void set_ring_layout(std::size_t num_rings, data_type fov_up_deg, data_type fov_down_deg);
+
+  /// 每条线的扇区数，默认6 / Sectors per ring, 6 by default
+  void set_num_sectors(std::size_t num) { m_num_sectors = num; }
+  /// 每个扇区最多的边缘点数，默认2 / Maximum edges per sector, 2 by default
+  void set_max_edges_per_sector(std::size_t num) { m_max_edges_per_sector = num; }
+  /// 每个扇区最多的平面点数，默认4 / Maximum planar points per sector, 4 by default
+  void set_max_planar_per_sector(std::size_t num) { m_max_planar_per_sector = num; }
+
+  [[nodiscard]] std::size_t get_num_sectors() const { return m_num_sectors; }
+  [[nodiscard]] std::size_t get_max_edges_per_sector() const { return m_max_edges_per_sector; }
+  [[nodiscard]] std::size_t get_max_planar_per_sector() const { return m_max_planar_per_sector; }
+
   // Utility methods for extracting specific feature types
   static point_cloud extract_edge_points(const loam_result& result);
   static point_cloud extract_planar_points(const loam_result& result);
@@ -98,6 +174,17 @@ private:
                                std::size_t start_idx, 
                                std::size_t end_idx);
   std::vector<uint8_t> classify_features(const std::vector<CurvatureInfo>& curvatures);
+  std::vector<uint8_t> compute_labels();
+
+  // Scan-line mode
+  std::vector<uint8_t> classify_scan_lines();
+  void assign_rings(std::vector<std::uint16_t>& rings,
+                    std::vector<data_type>& keys,
+                    std::size_t& num_rings) const;
+  void classify_ring(std::size_t* order,
+                     std::size_t count,
+                     const std::vector<data_type>& keys,
+                     std::vector<uint8_t>& labels) const;
 
   // Member variables
   bool m_enable_parallel = false;
@@ -105,6 +192,16 @@ private:
   data_type m_planar_threshold = static_cast<data_type>(0.1);    // Low curvature threshold  
   data_type m_curvature_threshold = static_cast<data_type>(0.001); // Minimum curvature
   std::size_t m_num_scan_neighbors = 10;  // Number of neighbors for curvature computation
+
+  curvature_mode m_mode = curvature_mode::knn;
+  std::vector<std::uint16_t> m_rings;       // Per-point rings, inferred when empty
+  std::vector<data_type> m_azimuths;        // Per-point azimuths, computed when empty
+  std::size_t m_num_rings = 64;
+  data_type m_fov_up_deg = static_cast<data_type>(2.0);
+  data_type m_fov_down_deg = static_cast<data_type>(-24.8);
+  std::size_t m_num_sectors = 6;
+  std::size_t m_max_edges_per_sector = 2;
+  std::size_t m_max_planar_per_sector = 4;
   
   point_cloud_ptr m_cloud;
   knn_type* m_knn = nullptr;
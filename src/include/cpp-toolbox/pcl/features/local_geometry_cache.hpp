@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <cpp-toolbox/cpp-toolbox_export.hpp>
+#include <cpp-toolbox/pcl/knn/base_knn.hpp>
+#include <cpp-toolbox/pcl/knn/neighborhood_graph.hpp>
+#include <cpp-toolbox/pcl/norm/batch_pca.hpp>
+#include <cpp-toolbox/types/point.hpp>
+
+namespace toolbox::pcl
+{
+
+/**
+ * @brief 每点局部几何的缓存 / Per-point local geometry cache
+ *
+ * 对点云的每个点只做一次近邻搜索、协方差和特征分解（批量PCA内核，按块并行），之后ISS、
+ * Harris3D、SIFT3D和曲率关键点都直接读取缓存，而不是各自重复同样的工作。同一检测器换不同
+ * 阈值多次运行时也只需填充一次。缓存保存近邻图、每点的质心、升序特征值、特征向量和邻居
+ * 数，协方差由特征分解重建。
+ * Runs the neighbor search, covariance and eigen decomposition once per point of a
+ * cloud (batch PCA kernel, in parallel chunks); ISS, Harris3D, SIFT3D and curvature
+ * keypoints then read the cache instead of each repeating the same work. Running one
+ * detector repeatedly with different thresholds fills it only once as well. The
+ * cache keeps the neighborhood graph and, per point, the centroid, ascending
+ * eigenvalues, eigenvectors and neighbor count; covariances are rebuilt from the
+ * eigen decomposition.
+ *
+ * @tparam DataType 数据类型（如float或double） / Data type (e.g., float or double)
+ *
+ * @code
+ * kdtree_t<float> kdtree;
+ * kdtree.set_input(cloud.points);
+ *
+ * local_geometry_cache_t<float> cache;
+ * cache.build_radius(kdtree, cloud, 0.1f);
+ *
+ * iss_keypoint_extractor_t<float> iss;
+ * iss.set_input(cloud);
+ * iss.set_geometry_cache(cache);
+ * auto iss_keypoints = iss.extract();
+ *
+ * curvature_keypoint_extractor_t<float> curvature;
+ * curvature.set_input(cloud);
+ * curvature.set_geometry_cache(cache);
+ * auto curvature_keypoints = curvature.extract();
+ * @endcode
+ *
+ * @note 使用缓存的检测器以缓存的邻域代替自己的邻域参数（半径或邻居数），ISS也改用不加权的
+ * 协方差；缓存的行必须与检测器的输入点一一对应 / Detectors using the cache take its
+ * neighborhoods in place of their own neighborhood parameters (radius or neighbor
+ * count), and ISS switches to the unweighted covariance; the cache rows must match
+ * the detector's input points one to one
+ */
+template<typename DataType>
+class CPP_TOOLBOX_EXPORT local_geometry_cache_t
+{
+public:
+  using data_type = DataType;
+  using point_cloud = toolbox::types::point_cloud_t<data_type>;
+  using graph_type = neighborhood_graph_t<data_type>;
+  using neighbor_range_t = typename graph_type::neighbor_range_t;
+  using result_type = pca_result_t<data_type>;
+
+  local_geometry_cache_t() = default;
+
+  /// PCA计算精度，默认double / PCA precision, double by default
+  void set_precision(pca_precision_t precision) { m_precision = precision; }
+  [[nodiscard]] pca_precision_t get_precision() const noexcept { return m_precision; }
+
+  /**
+   * @brief 用半径邻域填充缓存 / Fill the cache with radius neighborhoods
+   * @param knn 已设置输入为cloud的KNN搜索器 / KNN searcher with cloud as its input
+   * @param cloud 点云 / Point cloud
+   * @param radius 邻域半径 / Neighborhood radius
+   * @param max_neighbors 每点最多的邻居数，0表示不限制 / Neighbors per point at most,
+   * 0 for no limit
+   * @param parallel 是否并行 / Whether to run in parallel
+   * @return 是否成功 / Whether successful
+   */
+  template<typename Derived, typename Element, typename Metric>
+  bool build_radius(base_knn_generic_t<Derived, Element, Metric>& knn,
+                    const point_cloud& cloud,
+                    data_type radius,
+                    std::size_t max_neighbors = 0,
+                    bool parallel = true);
+
+  /**
+   * @brief 用K近邻填充缓存 / Fill the cache with K-nearest neighborhoods
+   * @param knn 已设置输入为cloud的KNN搜索器 / KNN searcher with cloud as its input
+   * @param cloud 点云 / Point cloud
+   * @param num_neighbors 每点的邻居数 / Neighbors per point
+   * @param parallel 是否并行 / Whether to run in parallel
+   * @return 是否成功 / Whether successful
+   */
+  template<typename Derived, typename Element, typename Metric>
+  bool build_knn(base_knn_generic_t<Derived, Element, Metric>& knn,
+                 const point_cloud& cloud,
+                 std::size_t num_neighbors,
+                 bool parallel = true);
+
+  /**
+   * @brief 用已有的近邻图填充缓存 / Fill the cache from an existing neighborhood graph
+   * @param cloud 点云 / Point cloud
+   * @param graph 以cloud为查询建立的近邻图，会被复制 / Graph built with cloud as the
+   * queries, copied into the cache
+   * @param max_neighbors 每行取最近的邻居数，0表示整行 / Nearest neighbors used per
+   * row, 0 for the whole row
+   * @param parallel 是否并行 / Whether to run in parallel
+   * @return 是否成功 / Whether successful
+   */
+  bool build(const point_cloud& cloud,
+             const graph_type& graph,
+             std::size_t max_neighbors = 0,
+             bool parallel = true);
+
+  void clear();
+
+  [[nodiscard]] std::size_t size() const noexcept { return m_results.size(); }
+  [[nodiscard]] bool empty() const noexcept { return m_results.empty(); }
+
+  /// 点i的PCA结果 / PCA result of point i
+  [[nodiscard]] const result_type& operator[](std::size_t i) const noexcept
+  {
+    return m_results[i];
+  }
+  [[nodiscard]] const std::vector<result_type>& results() const noexcept { return m_results; }
+
+  /// 点i邻域的点数 / Number of points in the neighborhood of point i
+  [[nodiscard]] std::size_t num_neighbors(std::size_t i) const noexcept
+  {
+    return m_results[i].num_points;
+  }
+
+  /// 由特征分解重建的点i的协方差 / Covariance of point i rebuilt from its eigen
+  /// decomposition
+  [[nodiscard]] symmetric3_t<data_type> covariance(std::size_t i) const;
+
+  /// 点i参与计算的邻居，按距离升序 / Neighbors of point i used in the computation,
+  /// by ascending distance
+  [[nodiscard]] neighbor_range_t neighbors(std::size_t i) const noexcept;
+
+  /**
+   * @brief 把点i在半径内的邻居复制到向量中 / Copy the neighbors of point i within a
+   * radius into vectors
+   *
+   * 只能返回图中已有的邻居，半径超过建图半径时结果会被截断 / Only neighbors already in
+   * the graph can be returned, so radii beyond the build radius are truncated
+   */
+  bool radius_neighbors(std::size_t i,
+                        data_type radius,
+                        std::vector<std::size_t>& indices,
+                        std::vector<data_type>& distances) const
+  {
+    return m_graph.neighbors(i, radius, 0, indices, distances);
+  }
+
+  [[nodiscard]] const graph_type& graph() const noexcept { return m_graph; }
+  /// 邻域半径，K近邻缓存为0 / Neighborhood radius, 0 for K-nearest caches
+  [[nodiscard]] data_type radius() const noexcept { return m_graph.radius(); }
+  /// 每点使用的邻居上限，0表示不限制 / Per-point neighbor cap, 0 means unlimited
+  [[nodiscard]] std::size_t max_neighbors() const noexcept { return m_max_neighbors; }
+
+private:
+  /// 对当前近邻图计算PCA / Run the PCA over the current graph
+  bool compute(const point_cloud& cloud, bool parallel);
+
+  graph_type m_graph;
+  std::vector<result_type> m_results;
+  std::size_t m_max_neighbors = 0;
+  pca_precision_t m_precision = pca_precision_t::double_precision;
+};
+
+}  // namespace toolbox::pcl
+
+#include <cpp-toolbox/pcl/features/impl/local_geometry_cache_impl.hpp>
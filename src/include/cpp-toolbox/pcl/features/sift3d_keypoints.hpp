@@ -1,7 +1,12 @@
 #pragma once
 
+#include <limits>
+
 #include <cpp-toolbox/cpp-toolbox_export.hpp>
 #include <cpp-toolbox/pcl/features/base_feature_extractor.hpp>
+#include <cpp-toolbox/pcl/features/grid_nms.hpp>
+#include <cpp-toolbox/pcl/features/local_geometry_cache.hpp>
+#include <cpp-toolbox/pcl/features/voxel_pyramid.hpp>
 #include <cpp-toolbox/pcl/knn/kdtree.hpp>
 #include <cpp-toolbox/pcl/knn/bfknn_parallel.hpp>
 #include <cpp-toolbox/metrics/vector_metrics.hpp>
@@ -16,6 +21,16 @@ namespace toolbox::pcl
  * @tparam KNN 最近邻搜索算法类型，默认使用 kdtree_generic_t / K-nearest neighbor search algorithm type, defaults to kdtree_generic_t
  * 
  * @details SIFT 3D是经典SIFT算法在3D点云中的扩展，通过多尺度空间分析检测尺度不变的关键点 / SIFT 3D extends the classic SIFT algorithm to 3D point clouds, detecting scale-invariant keypoints through multi-scale space analysis
+ *
+ * 默认对每个点做3 * sigma的半径搜索来构建尺度空间。设置 scale_space_mode::voxel_pyramid
+ * 后，每个尺度在体素边长约为 pyramid_voxel_ratio * sigma 的层上计算DoG，再插值回原始点，
+ * 因此每个倍频程的代价大致相同，不再随尺度的立方增长；关键点与半径模式相近但不完全相同。
+ * By default the scale space comes from a 3 * sigma radius search around every
+ * point. With scale_space_mode::voxel_pyramid every scale instead evaluates its
+ * DoG on the level whose voxel edge is about pyramid_voxel_ratio * sigma and
+ * interpolates the result back to the original points, so every octave costs
+ * about the same instead of growing with the cube of the scale; its keypoints
+ * are close to, but not identical with, the radius mode's.
  */
 template<typename DataType, 
          typename KNN = kdtree_generic_t<point_t<DataType>, toolbox::metrics::L2Metric<DataType>>>
@@ -34,6 +49,14 @@ public:
   using point_cloud_ptr = typename base_type::point_cloud_ptr;
   using indices_vector = typename base_type::indices_vector;
 
+  /**
+   * @brief 尺度空间的计算方式 / How the scale space is computed
+   */
+  enum class scale_space_mode : uint8_t {
+    radius_search = 0,  // Radius search of 3 * sigma around every point
+    voxel_pyramid = 1   // Per-scale level of a voxel pyramid, interpolated back
+  };
+
   sift3d_keypoint_extractor_t() = default;
 
   // Implementation methods for CRTP
@@ -55,6 +78,12 @@ public:
   void set_contrast_threshold(data_type threshold) { m_contrast_threshold = threshold; }
   void set_edge_threshold(data_type threshold) { m_edge_threshold = threshold; }
   void set_num_neighbors(std::size_t num_neighbors) { m_num_neighbors = num_neighbors; }
+  void set_scale_space_mode(scale_space_mode mode) { m_scale_space_mode = mode; }
+  // Voxel edge of each scale's pyramid level relative to its sigma, 1 by default
+  void set_pyramid_voxel_ratio(data_type ratio) { m_pyramid_voxel_ratio = ratio; }
+
+  // The edge response test reads the cached eigenvalues instead of its own k-neighborhoods
+  void set_geometry_cache(const local_geometry_cache_t<data_type>& cache) { m_cache = &cache; }
 
   [[nodiscard]] std::size_t get_num_scales() const { return m_num_scales; }
   [[nodiscard]] data_type get_base_scale() const { return m_base_scale; }
@@ -62,6 +91,8 @@ public:
   [[nodiscard]] data_type get_contrast_threshold() const { return m_contrast_threshold; }
   [[nodiscard]] data_type get_edge_threshold() const { return m_edge_threshold; }
   [[nodiscard]] std::size_t get_num_neighbors() const { return m_num_neighbors; }
+  [[nodiscard]] scale_space_mode get_scale_space_mode() const { return m_scale_space_mode; }
+  [[nodiscard]] data_type get_pyramid_voxel_ratio() const { return m_pyramid_voxel_ratio; }
 
 private:
   struct ScaleSpacePoint
@@ -74,13 +105,13 @@ private:
 
   // Core computation methods
   std::vector<std::vector<data_type>> build_scale_space();
+  void build_pyramid_scale_space(std::vector<std::vector<data_type>>& scale_space);
   std::vector<ScaleSpacePoint> find_scale_space_extrema(const std::vector<std::vector<data_type>>& scale_space);
   indices_vector refine_keypoints(const std::vector<ScaleSpacePoint>& extrema);
   indices_vector remove_edge_responses(const indices_vector& keypoint_indices);
   void compute_scale_space_range(std::vector<std::vector<data_type>>& scale_space,
                                 std::size_t start_idx,
                                 std::size_t end_idx);
-
   // Member variables
   bool m_enable_parallel = false;
   std::size_t m_num_scales = 5;
@@ -89,9 +120,12 @@ private:
   data_type m_contrast_threshold = static_cast<data_type>(0.03);
   data_type m_edge_threshold = static_cast<data_type>(10.0);
   std::size_t m_num_neighbors = 20;
+  scale_space_mode m_scale_space_mode = scale_space_mode::radius_search;
+  data_type m_pyramid_voxel_ratio = static_cast<data_type>(1);
   
   point_cloud_ptr m_cloud;
   knn_type* m_knn = nullptr;
+  const local_geometry_cache_t<data_type>* m_cache = nullptr;
 
   // Parallel processing threshold
   static constexpr std::size_t k_parallel_threshold = 1000;
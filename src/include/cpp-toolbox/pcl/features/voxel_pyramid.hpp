@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <cpp-toolbox/cpp-toolbox_export.hpp>
+#include <cpp-toolbox/types/point.hpp>
+
+namespace toolbox::pcl
+{
+
+/**
+ * @brief 多分辨率体素金字塔 / Multi-resolution voxel pyramid
+ *
+ * 第0层把输入点按边长base_voxel_size的体素聚合为加权质心（权重为点数），之后每层体素边长
+ * 加倍，由上一层的体素聚合而成，因此各层网格严格嵌套，建塔总代价约为O(N)。在粗层上计算的
+ * 每体素结果可以用interpolate插值回输入点，使大尺度的计算量不再随尺度的立方增长。
+ * Level 0 aggregates the input points into weighted centroids of voxels with edge
+ * base_voxel_size (weights are point counts); every further level doubles the
+ * voxel edge and is aggregated from the voxels of the level below, so the grids
+ * nest exactly and building the whole pyramid costs about O(N). Per-voxel results
+ * computed on a coarse level can be interpolated back to the input points with
+ * interpolate, so large-scale computations no longer grow with the cube of the
+ * scale.
+ *
+ * 体素按坐标键基数排序，同一层内体素顺序确定，与线程数无关。坐标非有限的点不进入金字塔，
+ * 插值结果为0。
+ * Voxels are radix sorted by their coordinate keys, so the voxel order within a
+ * level is deterministic regardless of the thread count. Points with non-finite
+ * coordinates stay out of the pyramid and interpolate to 0.
+ *
+ * @tparam DataType 数据类型（如float或double） / Data type (e.g., float or double)
+ *
+ * @code
+ * voxel_pyramid_t<float> pyramid;
+ * pyramid.enable_parallel(true);
+ * pyramid.build(cloud.points, 0.05f, 4);
+ *
+ * const auto& level = pyramid.level(2);  // 0.2的体素 / 0.2 voxels
+ * std::vector<float> values(level.size());
+ * // ... 对level.centroids计算values / compute values on level.centroids
+ * std::vector<float> per_point;
+ * pyramid.interpolate(2, values, cloud.points, per_point);
+ * @endcode
+ */
+template<typename DataType>
+class CPP_TOOLBOX_EXPORT voxel_pyramid_t
+{
+public:
+  using data_type = DataType;
+  using point_type = toolbox::types::point_t<data_type>;
+
+  /**
+   * @brief 金字塔的一层 / One level of the pyramid
+   */
+  struct level_t
+  {
+    data_type voxel_size = data_type(0);  ///< 体素边长 / Voxel edge length
+    std::vector<point_type> centroids;  ///< 体素内点的质心 / Centroid of the points in each voxel
+    std::vector<data_type> weights;  ///< 体素内的点数 / Number of points in each voxel
+    std::vector<std::uint64_t> keys;  ///< 升序的体素坐标键 / Ascending voxel coordinate keys
+    /// 上一层中包含该体素的体素，最顶层为空 / Voxel of the next level containing each
+    /// voxel, empty on the top level
+    std::vector<std::size_t> parents;
+
+    [[nodiscard]] std::size_t size() const noexcept { return centroids.size(); }
+  };
+
+  voxel_pyramid_t() = default;
+
+  void enable_parallel(bool enable) { m_enable_parallel = enable; }
+
+  /**
+   * @brief 建立金字塔 / Build the pyramid
+   * @param points 输入点 / Input points
+   * @param base_voxel_size 第0层的体素边长 / Voxel edge of level 0
+   * @param num_levels 层数，第l层体素边长为base_voxel_size * 2^l / Number of levels;
+   * level l has voxels of edge base_voxel_size * 2^l
+   * @return 是否成功 / Whether successful
+   */
+  bool build(const std::vector<point_type>& points,
+             data_type base_voxel_size,
+             std::size_t num_levels);
+
+  void clear();
+
+  [[nodiscard]] std::size_t num_levels() const noexcept { return m_levels.size(); }
+  [[nodiscard]] bool empty() const noexcept { return m_levels.empty(); }
+  [[nodiscard]] const level_t& level(std::size_t l) const noexcept { return m_levels[l]; }
+
+  /**
+   * @brief 把一层的每体素值插值回点 / Interpolate per-voxel values of a level back
+   * to points
+   *
+   * 每个点取所在体素及其26个相邻体素的值，按到质心距离的核(1 - d^2 / (2v)^2)^2加权平均，
+   * v为体素边长；核是紧支撑的多项式，不需要exp。相邻体素按体素而不是按点查找一次，点沿
+   * parents找到自己在该层的体素。
+   * Every point averages the values of its voxel and the 26 adjacent voxels,
+   * weighted by the kernel (1 - d^2 / (2v)^2)^2 of the distance to their centroids,
+   * v being the voxel edge; the kernel is a compactly supported polynomial that
+   * needs no exp. Adjacent voxels are looked up once per voxel rather than per
+   * point, and points follow the parents to their voxel on the level.
+   *
+   * @param l 层号 / Level index
+   * @param values 该层每个体素的值 / Value of every voxel of the level
+   * @param points 建塔时的输入点 / The points the pyramid was built from
+   * @param output 每个点的插值结果 / Interpolated value of every point
+   * @return 是否成功 / Whether successful
+   */
+  bool interpolate(std::size_t l,
+                   const std::vector<data_type>& values,
+                   const std::vector<point_type>& points,
+                   std::vector<data_type>& output) const;
+
+private:
+  /// 点在第0层的体素坐标，无法落入网格时返回false / Voxel coordinates of a point on
+  /// level 0, false when it cannot be placed on the grid
+  bool base_cell(const point_type& p, std::uint64_t cell[3]) const;
+
+  /// 把排序后的(键, 成员)聚合为一层，owners记录每个成员所属的体素 / Aggregate sorted
+  /// (key, member) pairs into a level; owners records the voxel of every member
+  template<typename Position, typename Weight>
+  void aggregate(const std::vector<std::uint64_t>& keys,
+                 const std::vector<std::size_t>& members,
+                 Position position,
+                 Weight weight,
+                 level_t& level,
+                 std::vector<std::size_t>& owners) const;
+
+  std::vector<level_t> m_levels;
+  /// 每个点在第0层的体素，未放入网格的点为k_no_voxel / Level-0 voxel of every point,
+  /// k_no_voxel for points left off the grid
+  std::vector<std::size_t> m_point_voxels;
+  double m_origin[3] = {0.0, 0.0, 0.0};
+  double m_base_voxel_size = 0.0;
+  std::size_t m_num_points = 0;
+  bool m_enable_parallel = false;
+
+  /// 每轴坐标的位数 / Bits per axis coordinate
+  static constexpr unsigned k_axis_bits = 21;
+  static constexpr std::size_t k_parallel_threshold = 4096;
+  static constexpr std::size_t k_no_voxel = static_cast<std::size_t>(-1);
+};
+
+}  // namespace toolbox::pcl
+
+#include <cpp-toolbox/pcl/features/impl/voxel_pyramid_impl.hpp>
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <cpp-toolbox/cpp-toolbox_export.hpp>
+#include <cpp-toolbox/pcl/filters/filters.hpp>
+#include <cpp-toolbox/types/point.hpp>
+
+namespace toolbox::pcl
+{
+
+/**
+ * @brief 有向包围盒裁剪滤波器 / Oriented crop-box filter
+ *
+ * 保留位于盒子内的点。盒子在自身坐标系中由[min, max]描述，盒子到点云坐标系的位姿由4x4变换给出，
+ * 因此可以表示任意朝向的盒子。每个点先变换到盒子坐标系再做无分支的区间判断，得到的掩码并行压缩
+ * 为索引。
+ * Keeps the points inside a box. The box is [min, max] in its own frame and a
+ * 4x4 transform gives its pose in the cloud frame, so any orientation can be
+ * expressed. Each point is moved into the box frame and tested with branch-free
+ * range checks, and the resulting mask is compacted into indices in parallel.
+ *
+ * @tparam DataType 数据类型（如float或double） / Data type (e.g., float or double)
+ *
+ * @code
+ * crop_box_t<float> crop(point_t<float>(-10, -10, -2), point_t<float>(10, 10, 5));
+ * Eigen::Matrix4f pose = Eigen::Matrix4f::Identity();
+ * pose.block<3, 3>(0, 0) = yaw_rotation;  // 盒子朝向 / Box orientation
+ * crop.set_transform(pose);
+ * crop.set_input(cloud);
+ * auto roi = crop.filter();
+ * auto roi_indices = crop.filter_indices();
+ * @endcode
+ */
+template<typename DataType>
+class CPP_TOOLBOX_EXPORT crop_box_t : public filter_t<crop_box_t<DataType>, DataType>
+{
+public:
+  using data_type = DataType;
+  using base_type = filter_t<crop_box_t<DataType>, DataType>;
+  using point_cloud = toolbox::types::point_cloud_t<data_type>;
+  using point_cloud_ptr =
+      std::shared_ptr<toolbox::types::point_cloud_t<data_type>>;
+  using transform_t = Eigen::Matrix<data_type, 4, 4>;
+
+  crop_box_t() = default;
+  crop_box_t(const toolbox::types::point_t<data_type>& min_point,
+             const toolbox::types::point_t<data_type>& max_point)
+      : m_min(min_point), m_max(max_point)
+  {
+  }
+  ~crop_box_t() = default;
+
+public:
+  crop_box_t(const crop_box_t&) = delete;
+  crop_box_t& operator=(const crop_box_t&) = delete;
+  crop_box_t(crop_box_t&&) = delete;
+  crop_box_t& operator=(crop_box_t&&) = delete;
+
+  std::size_t set_input_impl(const point_cloud& cloud);
+  std::size_t set_input_impl(const point_cloud_ptr& cloud);
+  void enable_parallel_impl(bool enable);
+  point_cloud filter_impl();
+  void filter_impl(point_cloud_ptr output);
+
+  /**
+   * @brief 只计算保留点的索引，按输入顺序排列 / Compute only the kept indices, in input
+   * order
+   */
+  std::vector<std::size_t> filter_indices();
+
+  void set_min(const toolbox::types::point_t<data_type>& min_point) { m_min = min_point; }
+  void set_max(const toolbox::types::point_t<data_type>& max_point) { m_max = max_point; }
+  [[nodiscard]] const toolbox::types::point_t<data_type>& get_min() const noexcept
+  {
+    return m_min;
+  }
+  [[nodiscard]] const toolbox::types::point_t<data_type>& get_max() const noexcept
+  {
+    return m_max;
+  }
+
+  /**
+   * @brief 设置盒子到点云坐标系的位姿 / Set the pose of the box in the cloud frame
+   */
+  void set_transform(const transform_t& box_pose) { m_box_pose = box_pose; }
+  [[nodiscard]] const transform_t& get_transform() const noexcept { return m_box_pose; }
+
+  /**
+   * @brief 反转结果，只保留盒子外的点 / Invert the result and keep the points outside
+   */
+  void set_negative(bool negative) { m_negative = negative; }
+
+private:
+  toolbox::types::point_t<data_type> m_min {data_type(-1), data_type(-1), data_type(-1)};
+  toolbox::types::point_t<data_type> m_max {data_type(1), data_type(1), data_type(1)};
+  transform_t m_box_pose = transform_t::Identity();
+  bool m_negative = false;
+  bool m_enable_parallel = false;
+  point_cloud_ptr m_cloud;
+};
+
+}  // namespace toolbox::pcl
+
+#include <cpp-toolbox/pcl/filters/impl/crop_box_impl.hpp>
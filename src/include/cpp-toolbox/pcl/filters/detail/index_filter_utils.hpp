@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <cpp-toolbox/concurrent/parallel.hpp>
+#include <cpp-toolbox/types/point.hpp>
+
+namespace toolbox::pcl::detail
+{
+
+/**
+ * @brief 按索引复制点及其法线、颜色 / Copy points with their normals and colors by index
+ */
+template<typename DataType>
+void copy_cloud_indices(const toolbox::types::point_cloud_t<DataType>& cloud,
+                        const std::vector<std::size_t>& indices,
+                        toolbox::types::point_cloud_t<DataType>& output)
+{
+  const bool has_normals = cloud.normals.size() == cloud.size();
+  const bool has_colors = cloud.colors.size() == cloud.size();
+  output.clear();
+  output.points.resize(indices.size());
+  if (has_normals) {
+    output.normals.resize(indices.size());
+  }
+  if (has_colors) {
+    output.colors.resize(indices.size());
+  }
+  output.intensity = cloud.intensity;
+
+  for (std::size_t i = 0; i < indices.size(); ++i) {
+    output.points[i] = cloud.points[indices[i]];
+    if (has_normals) {
+      output.normals[i] = cloud.normals[indices[i]];
+    }
+    if (has_colors) {
+      output.colors[i] = cloud.colors[indices[i]];
+    }
+  }
+}
+
+/**
+ * @brief 计算掩码并压缩为索引列表 / Compute a mask and compact it into an index list
+ *
+ * 每块先由compute_mask(begin, end, mask)写出0/1掩码并统计数量，再按块前缀和并行写出索引，
+ * 结果保持输入顺序。掩码循环不含分支时编译器可以向量化。
+ * Every chunk first writes a 0/1 mask through compute_mask(begin, end, mask) and
+ * counts it, then the indices are written in parallel at prefix-summed chunk
+ * offsets, keeping input order. Branch-free mask loops let the compiler
+ * vectorize them.
+ *
+ * @param count 元素数量 / Number of elements
+ * @param parallel 是否在线程池上分块执行 / Whether to run chunks on the thread pool
+ * @param negative 为true时保留掩码为0的元素 / Keep elements whose mask is 0 when true
+ * @param compute_mask compute_mask(begin, end, std::uint8_t* mask)，mask指向begin处
+ * / mask points at element begin
+ */
+template<typename ComputeMask>
+std::vector<std::size_t> compact_mask_indices(std::size_t count,
+                                              bool parallel,
+                                              bool negative,
+                                              ComputeMask compute_mask)
+{
+  constexpr std::size_t k_parallel_threshold = 16384;
+  std::vector<std::uint8_t> mask(count);
+
+  const std::size_t num_chunks =
+      toolbox::concurrent::parallel_chunk_count(count, k_parallel_threshold, parallel);
+  const std::uint8_t keep_value = negative ? 0 : 1;
+  std::vector<std::size_t> chunk_counts(num_chunks, 0);
+
+  toolbox::concurrent::parallel_for_chunks(
+      count,
+      k_parallel_threshold,
+      parallel,
+      [&](std::size_t c, std::size_t start_idx, std::size_t end_idx)
+      {
+        compute_mask(start_idx, end_idx, mask.data() + start_idx);
+        std::size_t kept = 0;
+        for (std::size_t i = start_idx; i < end_idx; ++i) {
+          kept += static_cast<std::size_t>(mask[i] == keep_value);
+        }
+        chunk_counts[c] = kept;
+      });
+
+  std::vector<std::size_t> chunk_offsets(num_chunks, 0);
+  std::size_t total = 0;
+  for (std::size_t c = 0; c < num_chunks; ++c) {
+    chunk_offsets[c] = total;
+    total += chunk_counts[c];
+  }
+
+  std::vector<std::size_t> indices(total);
+  toolbox::concurrent::parallel_for_chunks(
+      count,
+      k_parallel_threshold,
+      parallel,
+      [&](std::size_t c, std::size_t start_idx, std::size_t end_idx)
+      {
+        std::size_t out = chunk_offsets[c];
+        for (std::size_t i = start_idx; i < end_idx; ++i) {
+          if (mask[i] == keep_value) {
+            indices[out++] = i;
+          }
+        }
+      });
+  return indices;
+}
+
+}  // namespace toolbox::pcl::detail
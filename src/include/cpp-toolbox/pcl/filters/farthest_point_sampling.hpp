@@ -0,0 +1,151 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <cpp-toolbox/pcl/filters/filters.hpp>
+#include <cpp-toolbox/types/point.hpp>
+
+namespace toolbox::pcl
+{
+
+/**
+ * @brief 最远点采样滤波器 / Farthest point sampling filter
+ *
+ * 每次选择距离已选点集最远的点，得到固定数量且空间分布均匀的采样，常用于学习模型的定长输入
+ * 和关键点候选。内部以SoA方式保存坐标，并维护每个点到已选点集的最小平方距离数组。
+ * Repeatedly picks the point farthest from the already selected set, producing a fixed
+ * number of evenly spread samples, e.g. fixed-size inputs for learning models or keypoint
+ * candidates. Coordinates are kept as SoA and a min-squared-distance array to the
+ * selected set is updated after every pick.
+ *
+ * - 精确模式：每轮O(N)的更新+求最大值，大点云时在线程池上分块归约 / Exact mode: an O(N)
+ *   update + argmax per pick, reduced in chunks on the thread pool for large clouds
+ * - 网格加速模式：点按网格单元分桶，只更新离新点足够近、可能变化的单元，单元最大值用堆维护
+ *   / Grid mode: points are bucketed by grid cell, only cells close enough to the new
+ *   sample to change are updated, and per-cell maxima live in a heap
+ *
+ * @tparam DataType 数据类型（如float或double） / Data type (e.g., float or double)
+ *
+ * @code
+ * farthest_point_sampling_t<float> fps(1024);
+ * fps.set_input(cloud);
+ * fps.enable_parallel(true);
+ * auto sampled = fps.filter();
+ * const auto& indices = fps.sampled_indices();  // 原点云中的索引 / Indices in the input cloud
+ *
+ * // 大点云使用网格加速 / Grid acceleration for large clouds
+ * fps.enable_grid_acceleration(true);
+ * auto candidates = fps.filter_indices();
+ * @endcode
+ */
+template<typename DataType>
+class CPP_TOOLBOX_EXPORT farthest_point_sampling_t
+    : public filter_t<farthest_point_sampling_t<DataType>, DataType>
+{
+public:
+  using data_type = DataType;
+  using base_type = filter_t<farthest_point_sampling_t<DataType>, DataType>;
+  using point_cloud = toolbox::types::point_cloud_t<data_type>;
+  using point_cloud_ptr =
+      std::shared_ptr<toolbox::types::point_cloud_t<data_type>>;
+
+  explicit farthest_point_sampling_t(std::size_t num_samples)
+      : m_num_samples(num_samples)
+  {
+  }
+  ~farthest_point_sampling_t() = default;
+
+public:
+  farthest_point_sampling_t(const farthest_point_sampling_t&) = delete;
+  farthest_point_sampling_t& operator=(const farthest_point_sampling_t&) =
+      delete;
+  farthest_point_sampling_t(farthest_point_sampling_t&&) = delete;
+  farthest_point_sampling_t& operator=(farthest_point_sampling_t&&) = delete;
+
+  std::size_t set_input_impl(const point_cloud& cloud);
+  std::size_t set_input_impl(const point_cloud_ptr& cloud);
+  void enable_parallel_impl(bool enable);
+  point_cloud filter_impl();
+  void filter_impl(point_cloud_ptr output);
+
+  /**
+   * @brief 只计算采样索引 / Compute only the sampled indices
+   * @return 按选择顺序排列的输入点索引 / Input point indices in selection order
+   */
+  std::vector<std::size_t> filter_indices();
+
+  /**
+   * @brief 上一次采样的索引 / Indices of the last sampling run
+   */
+  [[nodiscard]] const std::vector<std::size_t>& sampled_indices() const noexcept
+  {
+    return m_sampled_indices;
+  }
+
+  void set_num_samples(std::size_t num_samples) { m_num_samples = num_samples; }
+  [[nodiscard]] std::size_t get_num_samples() const noexcept { return m_num_samples; }
+
+  /**
+   * @brief 设置第一个采样点 / Set the first sampled point
+   * @param index 输入点云中的索引，越界时使用0 / Index in the input cloud, 0 when out of range
+   */
+  void set_start_index(std::size_t index) { m_start_index = index; }
+
+  /**
+   * @brief 启用网格加速 / Enable grid acceleration
+   * @param enable 是否启用 / Whether to enable
+   * @param cell_size 网格单元边长，0表示按点数自动选择 / Grid cell edge length, 0 picks one
+   * from the point count
+   *
+   * @note 剪枝只跳过不可能变化的单元，因此采样结果与精确模式一致（距离完全相等时的选择可能不同）；
+   * 对空间分布较均匀的大点云，总代价接近O(N log N) / Pruning only skips cells that cannot
+   * change, so the samples match exact mode (except how exact ties are broken); for large,
+   * reasonably spread clouds the total cost approaches O(N log N)
+   */
+  void enable_grid_acceleration(bool enable, float cell_size = 0.0F)
+  {
+    m_use_grid = enable;
+    m_cell_size = cell_size;
+  }
+
+private:
+  /// 把坐标复制为SoA / Copy coordinates into SoA arrays
+  void load_coordinates();
+
+  void sample_exact(std::size_t sample_count);
+  void sample_grid(std::size_t sample_count);
+
+  /**
+   * @brief 用新采样点更新[begin, end)的最小距离并返回其中的最大值位置 / Update the min
+   * distances of [begin, end) with the new sample and return the argmax of the range
+   */
+  std::pair<data_type, std::size_t> update_range(std::size_t begin,
+                                                 std::size_t end,
+                                                 data_type px,
+                                                 data_type py,
+                                                 data_type pz);
+
+  void copy_output(point_cloud_ptr output) const;
+
+  std::size_t m_num_samples = 0;
+  std::size_t m_start_index = 0;
+  bool m_enable_parallel = false;
+  bool m_use_grid = false;
+  float m_cell_size = 0.0F;
+  point_cloud_ptr m_cloud;
+
+  // 工作数组 / Working arrays
+  std::vector<data_type> m_xs;
+  std::vector<data_type> m_ys;
+  std::vector<data_type> m_zs;
+  std::vector<data_type> m_min_distances;
+  std::vector<std::size_t> m_sampled_indices;
+
+  static constexpr std::size_t k_parallel_threshold = 32768;
+  static constexpr std::size_t k_points_per_cell = 32;
+};
+
+}  // namespace toolbox::pcl
+
+#include <cpp-toolbox/pcl/filters/impl/farthest_point_sampling_impl.hpp>
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <cpp-toolbox/cpp-toolbox_export.hpp>
+#include <cpp-toolbox/pcl/filters/filters.hpp>
+#include <cpp-toolbox/types/point.hpp>
+
+namespace toolbox::pcl
+{
+
+/**
+ * @brief 视锥体滤波器 / Frustum filter
+ *
+ * 保留位于相机视锥体内的点。相机坐标系约定x轴朝前、y轴朝左、z轴朝上；点在相机坐标系下满足
+ * near ≤ x ≤ far、|y| ≤ x·tan(hfov/2)、|z| ≤ x·tan(vfov/2)即在视锥内。每个点只需一次仿射变换
+ * 和几次比较，掩码循环不含分支，结果并行压缩为索引。
+ * Keeps the points inside a camera frustum. The camera frame looks along +x
+ * with y to the left and z up; a point in that frame is inside when
+ * near ≤ x ≤ far, |y| ≤ x·tan(hfov/2) and |z| ≤ x·tan(vfov/2). Each point
+ * costs one affine transform and a few comparisons in a branch-free mask loop,
+ * and the result is compacted into indices in parallel.
+ *
+ * @tparam DataType 数据类型（如float或double） / Data type (e.g., float or double)
+ *
+ * @code
+ * frustum_filter_t<float> frustum;
+ * frustum.set_camera_pose(camera_to_world);
+ * frustum.set_horizontal_fov(90.0f);
+ * frustum.set_vertical_fov(60.0f);
+ * frustum.set_near_plane(0.5f);
+ * frustum.set_far_plane(40.0f);
+ * frustum.set_input(cloud);
+ * auto visible = frustum.filter();
+ * @endcode
+ */
+template<typename DataType>
+class CPP_TOOLBOX_EXPORT frustum_filter_t
+    : public filter_t<frustum_filter_t<DataType>, DataType>
+{
+public:
+  using data_type = DataType;
+  using base_type = filter_t<frustum_filter_t<DataType>, DataType>;
+  using point_cloud = toolbox::types::point_cloud_t<data_type>;
+  using point_cloud_ptr =
+      std::shared_ptr<toolbox::types::point_cloud_t<data_type>>;
+  using transform_t = Eigen::Matrix<data_type, 4, 4>;
+
+  frustum_filter_t() = default;
+  ~frustum_filter_t() = default;
+
+public:
+  frustum_filter_t(const frustum_filter_t&) = delete;
+  frustum_filter_t& operator=(const frustum_filter_t&) = delete;
+  frustum_filter_t(frustum_filter_t&&) = delete;
+  frustum_filter_t& operator=(frustum_filter_t&&) = delete;
+
+  std::size_t set_input_impl(const point_cloud& cloud);
+  std::size_t set_input_impl(const point_cloud_ptr& cloud);
+  void enable_parallel_impl(bool enable);
+  point_cloud filter_impl();
+  void filter_impl(point_cloud_ptr output);
+
+  /**
+   * @brief 只计算保留点的索引，按输入顺序排列 / Compute only the kept indices, in input
+   * order
+   */
+  std::vector<std::size_t> filter_indices();
+
+  /**
+   * @brief 设置相机到点云坐标系的位姿 / Set the camera-to-cloud pose
+   */
+  void set_camera_pose(const transform_t& camera_pose) { m_camera_pose = camera_pose; }
+  [[nodiscard]] const transform_t& get_camera_pose() const noexcept { return m_camera_pose; }
+
+  /// 水平视场角，单位为度 / Horizontal field of view in degrees
+  void set_horizontal_fov(data_type degrees) { m_horizontal_fov = degrees; }
+  [[nodiscard]] data_type get_horizontal_fov() const noexcept { return m_horizontal_fov; }
+  /// 垂直视场角，单位为度 / Vertical field of view in degrees
+  void set_vertical_fov(data_type degrees) { m_vertical_fov = degrees; }
+  [[nodiscard]] data_type get_vertical_fov() const noexcept { return m_vertical_fov; }
+  void set_near_plane(data_type distance) { m_near = distance; }
+  [[nodiscard]] data_type get_near_plane() const noexcept { return m_near; }
+  void set_far_plane(data_type distance) { m_far = distance; }
+  [[nodiscard]] data_type get_far_plane() const noexcept { return m_far; }
+
+  /**
+   * @brief 反转结果，只保留视锥外的点 / Invert the result and keep the points outside
+   */
+  void set_negative(bool negative) { m_negative = negative; }
+
+private:
+  transform_t m_camera_pose = transform_t::Identity();
+  data_type m_horizontal_fov = data_type(60);
+  data_type m_vertical_fov = data_type(60);
+  data_type m_near = data_type(0);
+  data_type m_far = data_type(100);
+  bool m_negative = false;
+  bool m_enable_parallel = false;
+  point_cloud_ptr m_cloud;
+};
+
+}  // namespace toolbox::pcl
+
+#include <cpp-toolbox/pcl/filters/impl/frustum_filter_impl.hpp>
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <cpp-toolbox/cpp-toolbox_export.hpp>
+#include <cpp-toolbox/pcl/filters/filters.hpp>
+#include <cpp-toolbox/types/point.hpp>
+
+namespace toolbox::pcl
+{
+
+/**
+ * @brief 地面分割方法 / Ground segmentation method
+ */
+enum class ground_method_t
+{
+  region_plane,  ///< 按极坐标区域拟合平面 / Plane fit per polar region
+  ray_slope      ///< 沿射线的坡度判断 / Slope test along rays
+};
+
+/**
+ * @brief 激光雷达扫描的地面分割 / Ground segmentation for LiDAR scans
+ *
+ * 点云坐标系以传感器为原点、z轴朝上。支持两种方法：
+ * The cloud frame has the sensor at the origin with z up. Two methods are
+ * available:
+ *
+ * - region_plane：按距离和方位角把平面划分为极坐标区域（Patchwork式的区域划分），每个区域
+ *   取最低点附近的种子，迭代PCA拟合平面，再用法线竖直度和高度检验平面是否为地面。
+ *   region_plane splits the plane into polar regions by range and azimuth, in
+ *   the region-wise style of Patchwork. Each region seeds from its lowest
+ *   points, refines a plane with a few PCA iterations, and accepts it as ground
+ *   only if its normal is upright enough and it lies low enough.
+ * - ray_slope：把点按方位角分到细射线上，沿射线由近到远比较与上一个地面点之间的局部坡度和
+ *   相对传感器的整体坡度。提供线号时沿射线按线号升序排列，因此线号须从最下方（地面上最近）
+ *   的激光线开始编号。
+ *   ray_slope puts points on thin azimuth rays and walks each ray outward,
+ *   checking the local slope to the last ground point and the overall slope
+ *   from the sensor. With ring numbers the ray is ordered by ascending ring,
+ *   so ring 0 must be the lowest beam, the one that hits the ground nearest.
+ *
+ * 两种方法都先用一遍计数排序把点按区域或射线分组，各组在线程池上独立处理，结果为按输入顺序
+ * 排列的地面与非地面索引。filter()返回非地面点。
+ * Both methods first group points by region or ray with a single counting-sort
+ * pass, process the groups independently on the thread pool, and return ground
+ * and non-ground indices in input order. filter() returns the non-ground points.
+ *
+ * @tparam DataType 数据类型（如float或double） / Data type (e.g., float or double)
+ *
+ * @code
+ * ground_segmentation_t<float> ground(ground_method_t::region_plane);
+ * ground.set_sensor_height(1.73f);
+ * ground.enable_parallel(true);
+ * ground.set_input(scan);
+ * std::vector<std::size_t> ground_indices, obstacle_indices;
+ * ground.segment(ground_indices, obstacle_indices);
+ * auto obstacles = ground.filter();
+ * @endcode
+ */
+template<typename DataType>
+class CPP_TOOLBOX_EXPORT ground_segmentation_t
+    : public filter_t<ground_segmentation_t<DataType>, DataType>
+{
+public:
+  using data_type = DataType;
+  using base_type = filter_t<ground_segmentation_t<DataType>, DataType>;
+  using point_cloud = toolbox::types::point_cloud_t<data_type>;
+  using point_cloud_ptr =
+      std::shared_ptr<toolbox::types::point_cloud_t<data_type>>;
+
+  ground_segmentation_t() = default;
+  explicit ground_segmentation_t(ground_method_t method) : m_method(method) {}
+  ~ground_segmentation_t() = default;
+
+public:
+  ground_segmentation_t(const ground_segmentation_t&) = delete;
+  ground_segmentation_t& operator=(const ground_segmentation_t&) = delete;
+  ground_segmentation_t(ground_segmentation_t&&) = delete;
+  ground_segmentation_t& operator=(ground_segmentation_t&&) = delete;
+
+  std::size_t set_input_impl(const point_cloud& cloud);
+  std::size_t set_input_impl(const point_cloud_ptr& cloud);
+  void enable_parallel_impl(bool enable);
+  point_cloud filter_impl();
+  void filter_impl(point_cloud_ptr output);
+
+  /**
+   * @brief 分割地面 / Segment the ground
+   * @param ground 地面点索引 / Ground point indices
+   * @param non_ground 非地面点索引 / Non-ground point indices
+   * @return 参数有效且有输入时返回true / True when the parameters are valid and there
+   * is input
+   */
+  bool segment(std::vector<std::size_t>& ground, std::vector<std::size_t>& non_ground);
+
+  /**
+   * @brief 设置每个点的激光线号，大小须与输入一致 / Set the laser ring of every point,
+   * sized like the input
+   *
+   * 射线法认为线号越大落地越远，即0号为最下方的激光线。线号从上往下编号的雷达需先转换为
+   * (线数 - 1 - 线号)。
+   * ray_slope takes a higher ring to land farther out, so ring 0 is the
+   * lowest beam. For sensors that number rings from the top down, pass
+   * (ring count - 1 - ring) instead.
+   */
+  void set_rings(std::vector<std::uint16_t> rings) { m_rings = std::move(rings); }
+  void clear_rings() { m_rings.clear(); }
+
+  /**
+   * @brief 反转filter()的结果，只保留地面点 / Invert filter() and keep the ground
+   * points
+   */
+  void set_negative(bool negative) { m_negative = negative; }
+
+  void set_method(ground_method_t method) { m_method = method; }
+  [[nodiscard]] ground_method_t get_method() const noexcept { return m_method; }
+
+  /// 传感器离地高度 / Sensor height above the ground
+  void set_sensor_height(data_type height) { m_sensor_height = height; }
+  [[nodiscard]] data_type get_sensor_height() const noexcept { return m_sensor_height; }
+
+  /// 参与分割的水平距离范围，范围外的点为非地面 / Horizontal range taking part in the
+  /// segmentation, points outside it are non-ground
+  void set_range(data_type min_range, data_type max_range)
+  {
+    m_min_range = min_range;
+    m_max_range = max_range;
+  }
+  [[nodiscard]] data_type get_min_range() const noexcept { return m_min_range; }
+  [[nodiscard]] data_type get_max_range() const noexcept { return m_max_range; }
+
+  /// 点到地面平面的最大距离，也是射线法的高度容差 / Maximum point-to-plane distance,
+  /// also the height tolerance of the ray method
+  void set_distance_threshold(data_type threshold) { m_distance_threshold = threshold; }
+  [[nodiscard]] data_type get_distance_threshold() const noexcept
+  {
+    return m_distance_threshold;
+  }
+
+  /// 地面的最大整体坡度，单位为度 / Maximum overall ground slope in degrees
+  void set_max_slope(data_type degrees) { m_max_slope = degrees; }
+  [[nodiscard]] data_type get_max_slope() const noexcept { return m_max_slope; }
+
+  /// 射线法相邻地面点间的最大坡度，单位为度 / Maximum slope between consecutive ground
+  /// points of the ray method, in degrees
+  void set_local_slope(data_type degrees) { m_local_slope = degrees; }
+  [[nodiscard]] data_type get_local_slope() const noexcept { return m_local_slope; }
+
+  /// 区域法的径向和方位划分 / Radial and azimuthal split of the region method
+  void set_region_layout(std::size_t num_radial_bins, std::size_t num_sectors)
+  {
+    m_num_radial_bins = num_radial_bins;
+    m_num_sectors = num_sectors;
+  }
+  [[nodiscard]] std::size_t get_num_radial_bins() const noexcept { return m_num_radial_bins; }
+  [[nodiscard]] std::size_t get_num_sectors() const noexcept { return m_num_sectors; }
+
+  /// 射线法的射线数 / Number of rays of the ray method
+  void set_num_rays(std::size_t num_rays) { m_num_rays = num_rays; }
+  [[nodiscard]] std::size_t get_num_rays() const noexcept { return m_num_rays; }
+
+  /// 种子点相对最低点均值的最大高度 / Maximum seed height above the mean of the lowest
+  /// points
+  void set_seed_height_threshold(data_type threshold) { m_seed_height_threshold = threshold; }
+  [[nodiscard]] data_type get_seed_height_threshold() const noexcept
+  {
+    return m_seed_height_threshold;
+  }
+
+  /// 区域拟合平面所需的最少点数 / Minimum points for a region plane fit
+  void set_min_points_per_region(std::size_t min_points) { m_min_points_per_region = min_points; }
+  [[nodiscard]] std::size_t get_min_points_per_region() const noexcept
+  {
+    return m_min_points_per_region;
+  }
+
+private:
+  bool label_region_plane(std::vector<std::uint8_t>& labels);
+  bool label_ray_slope(std::vector<std::uint8_t>& labels);
+
+  /// 按组号做计数排序，组号等于组数的无效点被丢弃 / Counting-sort points by group,
+  /// invalid points whose group equals the group count are dropped
+  static void group_points(const std::vector<std::uint32_t>& groups,
+                           std::size_t num_groups,
+                           std::vector<std::size_t>& order,
+                           std::vector<std::size_t>& begins);
+
+  ground_method_t m_method = ground_method_t::region_plane;
+  data_type m_sensor_height = data_type(1.73);
+  data_type m_min_range = data_type(2.7);
+  data_type m_max_range = data_type(80);
+  data_type m_distance_threshold = data_type(0.2);
+  data_type m_max_slope = data_type(15);
+  data_type m_local_slope = data_type(10);
+  data_type m_seed_height_threshold = data_type(0.4);
+  std::size_t m_num_radial_bins = 16;
+  std::size_t m_num_sectors = 32;
+  std::size_t m_num_rays = 1024;
+  std::size_t m_min_points_per_region = 10;
+  bool m_negative = false;
+  bool m_enable_parallel = false;
+  std::vector<std::uint16_t> m_rings;
+  point_cloud_ptr m_cloud;
+
+  static constexpr std::size_t k_parallel_threshold = 1024;
+  static constexpr std::size_t k_num_iterations = 3;
+  static constexpr std::size_t k_num_lowest_points = 20;
+};
+
+}  // namespace toolbox::pcl
+
+#include <cpp-toolbox/pcl/filters/impl/ground_segmentation_impl.hpp>
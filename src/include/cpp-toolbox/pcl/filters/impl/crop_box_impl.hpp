@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/LU>
+
+#include <cpp-toolbox/pcl/filters/detail/index_filter_utils.hpp>
+
+namespace toolbox::pcl
+{
+
+template<typename DataType>
+std::size_t crop_box_t<DataType>::set_input_impl(const point_cloud& cloud)
+{
+  m_cloud = std::make_shared<point_cloud>(cloud);
+  return m_cloud->size();
+}
+
+template<typename DataType>
+std::size_t crop_box_t<DataType>::set_input_impl(const point_cloud_ptr& cloud)
+{
+  m_cloud = cloud;
+  return m_cloud ? m_cloud->size() : 0U;
+}
+
+template<typename DataType>
+void crop_box_t<DataType>::enable_parallel_impl(bool enable)
+{
+  m_enable_parallel = enable;
+}
+
+template<typename DataType>
+typename crop_box_t<DataType>::point_cloud crop_box_t<DataType>::filter_impl()
+{
+  auto output = std::make_shared<point_cloud>();
+  filter_impl(output);
+  return *output;
+}
+
+template<typename DataType>
+void crop_box_t<DataType>::filter_impl(point_cloud_ptr output)
+{
+  if (!output) {
+    return;
+  }
+  if (!m_cloud) {
+    output->clear();
+    return;
+  }
+  detail::copy_cloud_indices(*m_cloud, filter_indices(), *output);
+}
+
+template<typename DataType>
+std::vector<std::size_t> crop_box_t<DataType>::filter_indices()
+{
+  if (!m_cloud || m_cloud->empty()) {
+    return {};
+  }
+
+  // 点云到盒子坐标系的变换 / Cloud-to-box transform
+  const transform_t inverse = m_box_pose.inverse();
+  const data_type r00 = inverse(0, 0), r01 = inverse(0, 1), r02 = inverse(0, 2);
+  const data_type r10 = inverse(1, 0), r11 = inverse(1, 1), r12 = inverse(1, 2);
+  const data_type r20 = inverse(2, 0), r21 = inverse(2, 1), r22 = inverse(2, 2);
+  const data_type tx = inverse(0, 3), ty = inverse(1, 3), tz = inverse(2, 3);
+  const data_type min_x = m_min.x, min_y = m_min.y, min_z = m_min.z;
+  const data_type max_x = m_max.x, max_y = m_max.y, max_z = m_max.z;
+  const auto* points = m_cloud->points.data();
+
+  return detail::compact_mask_indices(
+      m_cloud->size(),
+      m_enable_parallel,
+      m_negative,
+      [=](std::size_t begin, std::size_t end, std::uint8_t* mask)
+      {
+        for (std::size_t i = begin; i < end; ++i) {
+          const auto& p = points[i];
+          const data_type x = r00 * p.x + r01 * p.y + r02 * p.z + tx;
+          const data_type y = r10 * p.x + r11 * p.y + r12 * p.z + ty;
+          const data_type z = r20 * p.x + r21 * p.y + r22 * p.z + tz;
+          // 按位与避免短路分支；NaN点比较为假，视为在盒外 / Bitwise and avoids
+          // short-circuit branches; NaN points compare false and count as outside
+          mask[i - begin] = static_cast<std::uint8_t>((x >= min_x) & (x <= max_x)
+                                                      & (y >= min_y) & (y <= max_y)
+                                                      & (z >= min_z) & (z <= max_z));
+        }
+      });
+}
+
+}  // namespace toolbox::pcl
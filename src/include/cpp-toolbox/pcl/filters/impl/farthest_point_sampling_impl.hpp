@@ -0,0 +1,359 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <cpp-toolbox/concurrent/parallel.hpp>
+#include <cpp-toolbox/types/minmax.hpp>
+
+namespace toolbox::pcl
+{
+
+template<typename DataType>
+std::size_t farthest_point_sampling_t<DataType>::set_input_impl(
+    const point_cloud& cloud)
+{
+  m_cloud = std::make_shared<point_cloud>(cloud);
+  return m_cloud->size();
+}
+
+template<typename DataType>
+std::size_t farthest_point_sampling_t<DataType>::set_input_impl(
+    const point_cloud_ptr& cloud)
+{
+  m_cloud = cloud;
+  return m_cloud ? m_cloud->size() : 0U;
+}
+
+template<typename DataType>
+void farthest_point_sampling_t<DataType>::enable_parallel_impl(bool enable)
+{
+  m_enable_parallel = enable;
+}
+
+template<typename DataType>
+typename farthest_point_sampling_t<DataType>::point_cloud
+farthest_point_sampling_t<DataType>::filter_impl()
+{
+  auto output = std::make_shared<point_cloud>();
+  filter_impl(output);
+  return *output;
+}
+
+template<typename DataType>
+void farthest_point_sampling_t<DataType>::filter_impl(point_cloud_ptr output)
+{
+  if (!output)
+    return;
+  filter_indices();
+  copy_output(output);
+}
+
+template<typename DataType>
+std::vector<std::size_t> farthest_point_sampling_t<DataType>::filter_indices()
+{
+  m_sampled_indices.clear();
+  if (!m_cloud || m_cloud->empty() || m_num_samples == 0) {
+    return m_sampled_indices;
+  }
+
+  const std::size_t sample_count = std::min(m_num_samples, m_cloud->size());
+  load_coordinates();
+  if (m_use_grid) {
+    sample_grid(sample_count);
+  } else {
+    sample_exact(sample_count);
+  }
+  return m_sampled_indices;
+}
+
+template<typename DataType>
+void farthest_point_sampling_t<DataType>::load_coordinates()
+{
+  const std::size_t n = m_cloud->size();
+  m_xs.resize(n);
+  m_ys.resize(n);
+  m_zs.resize(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto& p = m_cloud->points[i];
+    m_xs[i] = p.x;
+    m_ys[i] = p.y;
+    m_zs[i] = p.z;
+  }
+  m_min_distances.assign(n, std::numeric_limits<data_type>::max());
+}
+
+template<typename DataType>
+std::pair<DataType, std::size_t> farthest_point_sampling_t<DataType>::update_range(
+    std::size_t begin, std::size_t end, data_type px, data_type py, data_type pz)
+{
+  data_type* min_distances = m_min_distances.data();
+  const data_type* xs = m_xs.data();
+  const data_type* ys = m_ys.data();
+  const data_type* zs = m_zs.data();
+
+  // 无分支的更新循环，编译器可以向量化 / Branch-free update loop the compiler can vectorize
+  for (std::size_t i = begin; i < end; ++i) {
+    const data_type dx = xs[i] - px;
+    const data_type dy = ys[i] - py;
+    const data_type dz = zs[i] - pz;
+    const data_type d = dx * dx + dy * dy + dz * dz;
+    min_distances[i] = std::min(min_distances[i], d);
+  }
+
+  const data_type* best = std::max_element(min_distances + begin, min_distances + end);
+  return {*best, static_cast<std::size_t>(best - min_distances)};
+}
+
+template<typename DataType>
+void farthest_point_sampling_t<DataType>::sample_exact(std::size_t sample_count)
+{
+  const std::size_t n = m_xs.size();
+  std::size_t current = m_start_index < n ? m_start_index : 0;
+  m_sampled_indices.reserve(sample_count);
+
+  // 每块一个最大值，单块时在调用线程上直接更新 / One maximum per chunk; a single chunk
+  // updates straight on the calling thread
+  std::vector<std::pair<data_type, std::size_t>> chunk_best(
+      toolbox::concurrent::parallel_chunk_count(n, k_parallel_threshold, m_enable_parallel));
+
+  while (true) {
+    m_sampled_indices.push_back(current);
+    if (m_sampled_indices.size() == sample_count) {
+      break;
+    }
+
+    const data_type px = m_xs[current];
+    const data_type py = m_ys[current];
+    const data_type pz = m_zs[current];
+
+    toolbox::concurrent::parallel_for_chunks(
+        n,
+        k_parallel_threshold,
+        m_enable_parallel,
+        [&](std::size_t chunk, std::size_t begin, std::size_t end)
+        {
+          chunk_best[chunk] = begin < end ? update_range(begin, end, px, py, pz)
+                                          : std::pair<data_type, std::size_t> {data_type(-1), 0};
+        });
+
+    // 按块顺序归约最大值；平局取较小索引，与串行结果一致 / Reduce the maxima in chunk
+    // order; ties keep the smaller index so results match the serial path
+    std::pair<data_type, std::size_t> best {data_type(-1), 0};
+    for (const auto& candidate : chunk_best) {
+      if (candidate.first > best.first) {
+        best = candidate;
+      }
+    }
+    current = best.second;
+  }
+}
+
+template<typename DataType>
+void farthest_point_sampling_t<DataType>::sample_grid(std::size_t sample_count)
+{
+  const std::size_t n = m_xs.size();
+  const auto bounds = toolbox::types::calculate_minmax(*m_cloud);
+
+  // 选择单元大小，使每个单元平均约k_points_per_cell个点 / Pick a cell size giving about
+  // k_points_per_cell points per cell
+  data_type cell_size = static_cast<data_type>(m_cell_size);
+  if (cell_size <= data_type(0)) {
+    const data_type extents[3] = {bounds.max.x - bounds.min.x,
+                                  bounds.max.y - bounds.min.y,
+                                  bounds.max.z - bounds.min.z};
+    double measure = 1.0;
+    int dims = 0;
+    for (const data_type extent : extents) {
+      if (extent > std::numeric_limits<data_type>::epsilon()) {
+        measure *= static_cast<double>(extent);
+        ++dims;
+      }
+    }
+    const double target_cells =
+        std::max(1.0, static_cast<double>(n) / static_cast<double>(k_points_per_cell));
+    cell_size = dims == 0 ? data_type(1)
+                          : static_cast<data_type>(std::pow(measure / target_cells, 1.0 / dims));
+  }
+
+  constexpr std::int64_t k_max_coord = (std::int64_t(1) << 21) - 1;
+  auto cell_coord = [&](data_type value, data_type origin) {
+    const auto c = static_cast<std::int64_t>(std::floor((value - origin) / cell_size));
+    return std::clamp<std::int64_t>(c, 0, k_max_coord);
+  };
+  auto pack_key = [](std::int64_t ix, std::int64_t iy, std::int64_t iz) {
+    return (static_cast<std::uint64_t>(ix) << 42) | (static_cast<std::uint64_t>(iy) << 21)
+        | static_cast<std::uint64_t>(iz);
+  };
+
+  // 按单元键排序，使每个单元的点连续 / Sort by cell key so each cell is contiguous
+  std::vector<std::pair<std::uint64_t, std::size_t>> keyed(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    keyed[i] = {pack_key(cell_coord(m_xs[i], bounds.min.x),
+                         cell_coord(m_ys[i], bounds.min.y),
+                         cell_coord(m_zs[i], bounds.min.z)),
+                i};
+  }
+  std::sort(keyed.begin(), keyed.end());
+
+  std::vector<std::size_t> order(n);
+  std::vector<std::size_t> position(n);
+  std::vector<data_type> xs(n), ys(n), zs(n);
+  std::vector<std::size_t> cell_begin;
+  std::vector<std::uint64_t> cell_keys;
+  for (std::size_t p = 0; p < n; ++p) {
+    const std::size_t i = keyed[p].second;
+    order[p] = i;
+    position[i] = p;
+    xs[p] = m_xs[i];
+    ys[p] = m_ys[i];
+    zs[p] = m_zs[i];
+    if (p == 0 || keyed[p].first != keyed[p - 1].first) {
+      cell_begin.push_back(p);
+      cell_keys.push_back(keyed[p].first);
+    }
+  }
+  cell_begin.push_back(n);
+  m_xs.swap(xs);
+  m_ys.swap(ys);
+  m_zs.swap(zs);
+
+  const std::size_t num_cells = cell_keys.size();
+  std::unordered_map<std::uint64_t, std::size_t> cell_lookup;
+  cell_lookup.reserve(num_cells);
+  std::vector<data_type> box_min(num_cells * 3, std::numeric_limits<data_type>::max());
+  std::vector<data_type> box_max(num_cells * 3, std::numeric_limits<data_type>::lowest());
+  for (std::size_t c = 0; c < num_cells; ++c) {
+    cell_lookup.emplace(cell_keys[c], c);
+    for (std::size_t p = cell_begin[c]; p < cell_begin[c + 1]; ++p) {
+      box_min[3 * c] = std::min(box_min[3 * c], m_xs[p]);
+      box_min[3 * c + 1] = std::min(box_min[3 * c + 1], m_ys[p]);
+      box_min[3 * c + 2] = std::min(box_min[3 * c + 2], m_zs[p]);
+      box_max[3 * c] = std::max(box_max[3 * c], m_xs[p]);
+      box_max[3 * c + 1] = std::max(box_max[3 * c + 1], m_ys[p]);
+      box_max[3 * c + 2] = std::max(box_max[3 * c + 2], m_zs[p]);
+    }
+  }
+
+  std::vector<data_type> cell_max(num_cells, std::numeric_limits<data_type>::max());
+  std::vector<std::size_t> cell_argmax(num_cells);
+  using heap_entry = std::pair<data_type, std::size_t>;
+  std::priority_queue<heap_entry> heap;
+
+  auto box_distance = [&](std::size_t c, data_type px, data_type py, data_type pz) {
+    const data_type dx = std::max({box_min[3 * c] - px, data_type(0), px - box_max[3 * c]});
+    const data_type dy =
+        std::max({box_min[3 * c + 1] - py, data_type(0), py - box_max[3 * c + 1]});
+    const data_type dz =
+        std::max({box_min[3 * c + 2] - pz, data_type(0), pz - box_max[3 * c + 2]});
+    return dx * dx + dy * dy + dz * dz;
+  };
+
+  auto update_cell = [&](std::size_t c, data_type px, data_type py, data_type pz) {
+    // 单元内最远的点也不会变近时跳过 / Skip cells whose farthest point cannot get closer
+    if (box_distance(c, px, py, pz) >= cell_max[c]) {
+      return;
+    }
+    const auto best = update_range(cell_begin[c], cell_begin[c + 1], px, py, pz);
+    cell_max[c] = best.first;
+    cell_argmax[c] = best.second;
+    heap.emplace(best.first, c);
+  };
+
+  m_sampled_indices.reserve(sample_count);
+  std::size_t current = position[m_start_index < n ? m_start_index : 0];
+  data_type current_distance = std::numeric_limits<data_type>::max();
+
+  while (true) {
+    m_sampled_indices.push_back(order[current]);
+    if (m_sampled_indices.size() == sample_count) {
+      break;
+    }
+
+    const data_type px = m_xs[current];
+    const data_type py = m_ys[current];
+    const data_type pz = m_zs[current];
+
+    // 只有距离小于当前最大最小距离的单元可能变化 / Only cells closer than the current
+    // maximum min-distance can change
+    bool visit_all = current_distance == std::numeric_limits<data_type>::max();
+    std::int64_t lo[3] = {0, 0, 0};
+    std::int64_t hi[3] = {0, 0, 0};
+    if (!visit_all) {
+      const data_type reach = std::sqrt(current_distance);
+      lo[0] = cell_coord(px - reach, bounds.min.x);
+      lo[1] = cell_coord(py - reach, bounds.min.y);
+      lo[2] = cell_coord(pz - reach, bounds.min.z);
+      hi[0] = cell_coord(px + reach, bounds.min.x);
+      hi[1] = cell_coord(py + reach, bounds.min.y);
+      hi[2] = cell_coord(pz + reach, bounds.min.z);
+      const double range_cells = static_cast<double>(hi[0] - lo[0] + 1)
+          * static_cast<double>(hi[1] - lo[1] + 1) * static_cast<double>(hi[2] - lo[2] + 1);
+      visit_all = range_cells >= static_cast<double>(num_cells);
+    }
+
+    if (visit_all) {
+      for (std::size_t c = 0; c < num_cells; ++c) {
+        update_cell(c, px, py, pz);
+      }
+    } else {
+      for (std::int64_t ix = lo[0]; ix <= hi[0]; ++ix) {
+        for (std::int64_t iy = lo[1]; iy <= hi[1]; ++iy) {
+          for (std::int64_t iz = lo[2]; iz <= hi[2]; ++iz) {
+            const auto it = cell_lookup.find(pack_key(ix, iy, iz));
+            if (it != cell_lookup.end()) {
+              update_cell(it->second, px, py, pz);
+            }
+          }
+        }
+      }
+    }
+
+    // 跳过过期的堆条目 / Skip stale heap entries
+    while (!heap.empty() && heap.top().first != cell_max[heap.top().second]) {
+      heap.pop();
+    }
+    if (heap.empty()) {
+      break;
+    }
+    current_distance = heap.top().first;
+    current = cell_argmax[heap.top().second];
+  }
+}
+
+template<typename DataType>
+void farthest_point_sampling_t<DataType>::copy_output(point_cloud_ptr output) const
+{
+  const std::size_t count = m_sampled_indices.size();
+  output->clear();
+  if (count == 0) {
+    return;
+  }
+
+  output->points.resize(count);
+  if (!m_cloud->normals.empty()) {
+    output->normals.resize(count);
+  }
+  if (!m_cloud->colors.empty()) {
+    output->colors.resize(count);
+  }
+  output->intensity = m_cloud->intensity;
+
+  for (std::size_t i = 0; i < count; ++i) {
+    const std::size_t idx = m_sampled_indices[i];
+    output->points[i] = m_cloud->points[idx];
+    if (!m_cloud->normals.empty()) {
+      output->normals[i] = m_cloud->normals[idx];
+    }
+    if (!m_cloud->colors.empty()) {
+      output->colors[i] = m_cloud->colors[idx];
+    }
+  }
+}
+
+}  // namespace toolbox::pcl
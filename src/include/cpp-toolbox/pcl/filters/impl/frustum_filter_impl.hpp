@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/LU>
+
+#include <cpp-toolbox/logger/thread_logger.hpp>
+#include <cpp-toolbox/pcl/filters/detail/index_filter_utils.hpp>
+
+namespace toolbox::pcl
+{
+
+template<typename DataType>
+std::size_t frustum_filter_t<DataType>::set_input_impl(const point_cloud& cloud)
+{
+  m_cloud = std::make_shared<point_cloud>(cloud);
+  return m_cloud->size();
+}
+
+template<typename DataType>
+std::size_t frustum_filter_t<DataType>::set_input_impl(const point_cloud_ptr& cloud)
+{
+  m_cloud = cloud;
+  return m_cloud ? m_cloud->size() : 0U;
+}
+
+template<typename DataType>
+void frustum_filter_t<DataType>::enable_parallel_impl(bool enable)
+{
+  m_enable_parallel = enable;
+}
+
+template<typename DataType>
+typename frustum_filter_t<DataType>::point_cloud frustum_filter_t<DataType>::filter_impl()
+{
+  auto output = std::make_shared<point_cloud>();
+  filter_impl(output);
+  return *output;
+}
+
+template<typename DataType>
+void frustum_filter_t<DataType>::filter_impl(point_cloud_ptr output)
+{
+  if (!output) {
+    return;
+  }
+  if (!m_cloud) {
+    output->clear();
+    return;
+  }
+  detail::copy_cloud_indices(*m_cloud, filter_indices(), *output);
+}
+
+template<typename DataType>
+std::vector<std::size_t> frustum_filter_t<DataType>::filter_indices()
+{
+  if (!m_cloud || m_cloud->empty()) {
+    return {};
+  }
+  if (!(m_horizontal_fov > data_type(0) && m_horizontal_fov < data_type(180))
+      || !(m_vertical_fov > data_type(0) && m_vertical_fov < data_type(180)))
+  {
+    LOG_ERROR_S << "frustum_filter_t: Field of view must be in (0, 180) degrees, got "
+                << m_horizontal_fov << " x " << m_vertical_fov;
+    return {};
+  }
+
+  constexpr double k_half_degree_to_radian = 3.14159265358979323846 / 360.0;
+  const auto tan_half_h = static_cast<data_type>(
+      std::tan(static_cast<double>(m_horizontal_fov) * k_half_degree_to_radian));
+  const auto tan_half_v = static_cast<data_type>(
+      std::tan(static_cast<double>(m_vertical_fov) * k_half_degree_to_radian));
+
+  // 点云到相机坐标系的变换 / Cloud-to-camera transform
+  const transform_t inverse = m_camera_pose.inverse();
+  const data_type r00 = inverse(0, 0), r01 = inverse(0, 1), r02 = inverse(0, 2);
+  const data_type r10 = inverse(1, 0), r11 = inverse(1, 1), r12 = inverse(1, 2);
+  const data_type r20 = inverse(2, 0), r21 = inverse(2, 1), r22 = inverse(2, 2);
+  const data_type tx = inverse(0, 3), ty = inverse(1, 3), tz = inverse(2, 3);
+  const data_type near_plane = m_near;
+  const data_type far_plane = m_far;
+  const auto* points = m_cloud->points.data();
+
+  return detail::compact_mask_indices(
+      m_cloud->size(),
+      m_enable_parallel,
+      m_negative,
+      [=](std::size_t begin, std::size_t end, std::uint8_t* mask)
+      {
+        for (std::size_t i = begin; i < end; ++i) {
+          const auto& p = points[i];
+          const data_type x = r00 * p.x + r01 * p.y + r02 * p.z + tx;
+          const data_type y = r10 * p.x + r11 * p.y + r12 * p.z + ty;
+          const data_type z = r20 * p.x + r21 * p.y + r22 * p.z + tz;
+          mask[i - begin] = static_cast<std::uint8_t>((x >= near_plane) & (x <= far_plane)
+                                                      & (std::abs(y) <= x * tan_half_h)
+                                                      & (std::abs(z) <= x * tan_half_v));
+        }
+      });
+}
+
+}  // namespace toolbox::pcl
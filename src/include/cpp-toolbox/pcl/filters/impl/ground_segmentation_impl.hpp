@@ -0,0 +1,392 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/Eigenvalues>
+
+#include <cpp-toolbox/concurrent/parallel.hpp>
+#include <cpp-toolbox/logger/thread_logger.hpp>
+#include <cpp-toolbox/pcl/filters/detail/index_filter_utils.hpp>
+
+namespace toolbox::pcl
+{
+
+template<typename DataType>
+std::size_t ground_segmentation_t<DataType>::set_input_impl(const point_cloud& cloud)
+{
+  m_cloud = std::make_shared<point_cloud>(cloud);
+  return m_cloud->size();
+}
+
+template<typename DataType>
+std::size_t ground_segmentation_t<DataType>::set_input_impl(const point_cloud_ptr& cloud)
+{
+  m_cloud = cloud;
+  return m_cloud ? m_cloud->size() : 0U;
+}
+
+template<typename DataType>
+void ground_segmentation_t<DataType>::enable_parallel_impl(bool enable)
+{
+  m_enable_parallel = enable;
+}
+
+template<typename DataType>
+typename ground_segmentation_t<DataType>::point_cloud
+ground_segmentation_t<DataType>::filter_impl()
+{
+  auto output = std::make_shared<point_cloud>();
+  filter_impl(output);
+  return *output;
+}
+
+template<typename DataType>
+void ground_segmentation_t<DataType>::filter_impl(point_cloud_ptr output)
+{
+  if (!output) {
+    return;
+  }
+  std::vector<std::size_t> ground;
+  std::vector<std::size_t> non_ground;
+  if (!segment(ground, non_ground)) {
+    output->clear();
+    return;
+  }
+  detail::copy_cloud_indices(*m_cloud, m_negative ? ground : non_ground, *output);
+}
+
+template<typename DataType>
+bool ground_segmentation_t<DataType>::segment(std::vector<std::size_t>& ground,
+                                              std::vector<std::size_t>& non_ground)
+{
+  ground.clear();
+  non_ground.clear();
+  if (!m_cloud || m_cloud->empty()) {
+    return false;
+  }
+  if (!(m_distance_threshold > data_type(0)) || !(m_min_range >= data_type(0))
+      || !(m_max_range > m_min_range))
+  {
+    LOG_ERROR_S << "ground_segmentation_t: Invalid distance threshold or range";
+    return false;
+  }
+  if (m_num_radial_bins == 0 || m_num_sectors == 0 || m_num_rays == 0) {
+    LOG_ERROR_S << "ground_segmentation_t: Region and ray counts must be positive";
+    return false;
+  }
+  if (m_cloud->size() > std::numeric_limits<std::uint32_t>::max()) {
+    LOG_ERROR_S << "ground_segmentation_t: Too many points for 32-bit indices";
+    return false;
+  }
+  if (!m_rings.empty() && m_rings.size() != m_cloud->size()) {
+    LOG_ERROR_S << "ground_segmentation_t: Ring count " << m_rings.size()
+                << " does not match the point count " << m_cloud->size();
+    return false;
+  }
+
+  const std::size_t total_points = m_cloud->size();
+  std::vector<std::uint8_t> labels(total_points, 0);
+  const bool labeled = m_method == ground_method_t::region_plane
+      ? label_region_plane(labels)
+      : label_ray_slope(labels);
+  if (!labeled) {
+    return false;
+  }
+
+  auto copy_labels = [&labels](std::size_t begin, std::size_t end, std::uint8_t* mask)
+  { std::copy(labels.begin() + begin, labels.begin() + end, mask); };
+  ground = detail::compact_mask_indices(total_points, m_enable_parallel, false, copy_labels);
+  non_ground =
+      detail::compact_mask_indices(total_points, m_enable_parallel, true, copy_labels);
+  return true;
+}
+
+template<typename DataType>
+void ground_segmentation_t<DataType>::group_points(const std::vector<std::uint32_t>& groups,
+                                                   std::size_t num_groups,
+                                                   std::vector<std::size_t>& order,
+                                                   std::vector<std::size_t>& begins)
+{
+  begins.assign(num_groups + 2, 0);
+  for (const auto group : groups) {
+    ++begins[group + 1];
+  }
+  for (std::size_t g = 1; g < begins.size(); ++g) {
+    begins[g] += begins[g - 1];
+  }
+  order.resize(begins[num_groups]);
+  std::vector<std::size_t> cursor(begins.begin(),
+                                  begins.begin() + static_cast<std::ptrdiff_t>(num_groups));
+  for (std::size_t i = 0; i < groups.size(); ++i) {
+    if (groups[i] < num_groups) {
+      order[cursor[groups[i]]++] = i;
+    }
+  }
+  begins.resize(num_groups + 1);
+}
+
+template<typename DataType>
+bool ground_segmentation_t<DataType>::label_region_plane(std::vector<std::uint8_t>& labels)
+{
+  const auto& points = m_cloud->points;
+  const std::size_t total_points = points.size();
+  const std::size_t num_regions = m_num_radial_bins * m_num_sectors;
+  const double min_range = static_cast<double>(m_min_range);
+  const double range_span = static_cast<double>(m_max_range) - min_range;
+  constexpr double k_pi = 3.14159265358979323846;
+
+  // 区域号为扇区 * 径向分段数 + 径向分段，无效点的区域号为区域数
+  std::vector<std::uint32_t> regions(total_points);
+  toolbox::concurrent::parallel_for_chunks(
+      total_points,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t i = start_idx; i < end_idx; ++i) {
+          const auto& p = points[i];
+          const double x = static_cast<double>(p.x);
+          const double y = static_cast<double>(p.y);
+          const double range = std::sqrt(x * x + y * y);
+          if (!(range >= min_range && range <= min_range + range_span)
+              || !std::isfinite(static_cast<double>(p.z)))
+          {
+            regions[i] = static_cast<std::uint32_t>(num_regions);
+            continue;
+          }
+          const auto radial = std::min(
+              m_num_radial_bins - 1,
+              static_cast<std::size_t>((range - min_range) / range_span
+                                       * static_cast<double>(m_num_radial_bins)));
+          const auto sector = std::min(
+              m_num_sectors - 1,
+              static_cast<std::size_t>((std::atan2(y, x) + k_pi) / (2.0 * k_pi)
+                                       * static_cast<double>(m_num_sectors)));
+          regions[i] = static_cast<std::uint32_t>(sector * m_num_radial_bins + radial);
+        }
+      });
+
+  std::vector<std::size_t> order;
+  std::vector<std::size_t> region_begins;
+  group_points(regions, num_regions, order, region_begins);
+
+  const double threshold = static_cast<double>(m_distance_threshold);
+  const double sensor_height = static_cast<double>(m_sensor_height);
+  const double tan_slope = std::tan(static_cast<double>(m_max_slope) * k_pi / 180.0);
+  const double min_normal_z = std::cos(static_cast<double>(m_max_slope) * k_pi / 180.0);
+  const double seed_height = static_cast<double>(m_seed_height_threshold);
+
+  toolbox::concurrent::parallel_for_chunks(
+      num_regions,
+      1,
+      m_enable_parallel,
+      [&](std::size_t first_region, std::size_t last_region)
+      {
+        std::vector<double> heights;
+        std::vector<std::size_t> inliers;
+        for (std::size_t region = first_region; region < last_region; ++region) {
+          const std::size_t begin = region_begins[region];
+          const std::size_t end = region_begins[region + 1];
+          const std::size_t count = end - begin;
+          if (count == 0) {
+            continue;
+          }
+
+          // 点太少时只按传感器高度判断 / Too few points for a fit, fall back to the
+          // sensor height
+          if (count < m_min_points_per_region) {
+            for (std::size_t pos = begin; pos < end; ++pos) {
+              const double z = static_cast<double>(points[order[pos]].z);
+              labels[order[pos]] = static_cast<std::uint8_t>(std::abs(z + sensor_height)
+                                                             <= threshold);
+            }
+            continue;
+          }
+
+          // 最低点的平均高度加上阈值作为种子上限 / Seeds lie below the mean of the lowest
+          // points plus a margin
+          heights.clear();
+          for (std::size_t pos = begin; pos < end; ++pos) {
+            heights.push_back(static_cast<double>(points[order[pos]].z));
+          }
+          const std::size_t lowest = std::min(k_num_lowest_points, count);
+          std::nth_element(heights.begin(),
+                           heights.begin() + static_cast<std::ptrdiff_t>(lowest - 1),
+                           heights.end());
+          double lowest_mean = 0.0;
+          for (std::size_t i = 0; i < lowest; ++i) {
+            lowest_mean += heights[i];
+          }
+          lowest_mean /= static_cast<double>(lowest);
+
+          inliers.clear();
+          for (std::size_t pos = begin; pos < end; ++pos) {
+            if (static_cast<double>(points[order[pos]].z) < lowest_mean + seed_height) {
+              inliers.push_back(order[pos]);
+            }
+          }
+
+          Eigen::Vector3d normal = Eigen::Vector3d::UnitZ();
+          Eigen::Vector3d centroid = Eigen::Vector3d::Zero();
+          bool fitted = false;
+          for (std::size_t iteration = 0; iteration < k_num_iterations; ++iteration) {
+            if (inliers.size() < 3) {
+              fitted = false;
+              break;
+            }
+            centroid.setZero();
+            for (const auto idx : inliers) {
+              centroid += Eigen::Vector3d(static_cast<double>(points[idx].x),
+                                          static_cast<double>(points[idx].y),
+                                          static_cast<double>(points[idx].z));
+            }
+            centroid /= static_cast<double>(inliers.size());
+            Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
+            for (const auto idx : inliers) {
+              const Eigen::Vector3d d(static_cast<double>(points[idx].x) - centroid.x(),
+                                      static_cast<double>(points[idx].y) - centroid.y(),
+                                      static_cast<double>(points[idx].z) - centroid.z());
+              covariance.noalias() += d * d.transpose();
+            }
+            Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver(covariance);
+            normal = solver.eigenvectors().col(0);
+            if (normal.z() < 0.0) {
+              normal = -normal;
+            }
+            const double offset = -normal.dot(centroid);
+
+            inliers.clear();
+            for (std::size_t pos = begin; pos < end; ++pos) {
+              const auto& p = points[order[pos]];
+              const double distance = normal.x() * static_cast<double>(p.x)
+                  + normal.y() * static_cast<double>(p.y)
+                  + normal.z() * static_cast<double>(p.z) + offset;
+              if (std::abs(distance) < threshold) {
+                inliers.push_back(order[pos]);
+              }
+            }
+            fitted = true;
+          }
+
+          // 平面须足够水平且不高于传感器下方的坡度包络 / The plane must be upright enough
+          // and not above the slope envelope below the sensor
+          const double center_range = std::hypot(centroid.x(), centroid.y());
+          const bool upright = normal.z() >= min_normal_z;
+          const bool low_enough =
+              centroid.z() <= -sensor_height + center_range * tan_slope + threshold;
+          if (fitted && upright && low_enough) {
+            for (const auto idx : inliers) {
+              labels[idx] = 1;
+            }
+          }
+        }
+      });
+  return true;
+}
+
+template<typename DataType>
+bool ground_segmentation_t<DataType>::label_ray_slope(std::vector<std::uint8_t>& labels)
+{
+  const auto& points = m_cloud->points;
+  const std::size_t total_points = points.size();
+  const std::size_t num_rays = m_num_rays;
+  const double min_range = static_cast<double>(m_min_range);
+  const double max_range = static_cast<double>(m_max_range);
+  const bool use_rings = !m_rings.empty();
+  constexpr double k_pi = 3.14159265358979323846;
+
+  // 射线内按线号或距离由近到远排列 / Within a ray, points are ordered by ring or range
+  std::vector<std::uint32_t> rays(total_points);
+  std::vector<data_type> ranges(total_points);
+  toolbox::concurrent::parallel_for_chunks(
+      total_points,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t i = start_idx; i < end_idx; ++i) {
+          const auto& p = points[i];
+          const double x = static_cast<double>(p.x);
+          const double y = static_cast<double>(p.y);
+          const double range = std::sqrt(x * x + y * y);
+          ranges[i] = static_cast<data_type>(range);
+          if (!(range >= min_range && range <= max_range)
+              || !std::isfinite(static_cast<double>(p.z)))
+          {
+            rays[i] = static_cast<std::uint32_t>(num_rays);
+            continue;
+          }
+          const auto ray = std::min(
+              num_rays - 1,
+              static_cast<std::size_t>((std::atan2(y, x) + k_pi) / (2.0 * k_pi)
+                                       * static_cast<double>(num_rays)));
+          rays[i] = static_cast<std::uint32_t>(ray);
+        }
+      });
+
+  std::vector<std::size_t> order;
+  std::vector<std::size_t> ray_begins;
+  group_points(rays, num_rays, order, ray_begins);
+
+  const double threshold = static_cast<double>(m_distance_threshold);
+  const double sensor_height = static_cast<double>(m_sensor_height);
+  const double tan_general = std::tan(static_cast<double>(m_max_slope) * k_pi / 180.0);
+  const double tan_local = std::tan(static_cast<double>(m_local_slope) * k_pi / 180.0);
+
+  toolbox::concurrent::parallel_for_chunks(
+      num_rays,
+      1,
+      m_enable_parallel,
+      [&](std::size_t first_ray, std::size_t last_ray)
+      {
+        std::vector<std::uint64_t> sort_keys;
+        for (std::size_t ray = first_ray; ray < last_ray; ++ray) {
+          // 键的高32位为线号或毫米距离，低32位为点索引，整数排序即得稳定顺序 / The high
+          // 32 bits hold the ring or the range in millimeters and the low 32 bits the
+          // point index, so a plain integer sort gives a stable order
+          const std::size_t ray_begin = ray_begins[ray];
+          const std::size_t ray_end = ray_begins[ray + 1];
+          sort_keys.resize(ray_end - ray_begin);
+          for (std::size_t pos = ray_begin; pos < ray_end; ++pos) {
+            const std::size_t idx = order[pos];
+            const std::uint64_t along = use_rings
+                ? std::uint64_t {m_rings[idx]}
+                : static_cast<std::uint64_t>(static_cast<double>(ranges[idx]) * 1000.0);
+            sort_keys[pos - ray_begin] = (along << 32U) | static_cast<std::uint64_t>(idx);
+          }
+          std::sort(sort_keys.begin(), sort_keys.end());
+          for (std::size_t pos = ray_begin; pos < ray_end; ++pos) {
+            order[pos] = static_cast<std::size_t>(sort_keys[pos - ray_begin] & 0xFFFFFFFFULL);
+          }
+
+          // 从传感器正下方的地面出发 / Start from the ground right below the sensor
+          double last_range = 0.0;
+          double last_height = -sensor_height;
+          for (std::size_t pos = ray_begins[ray]; pos < ray_begins[ray + 1]; ++pos) {
+            const std::size_t idx = order[pos];
+            const double range = static_cast<double>(ranges[idx]);
+            const double z = static_cast<double>(points[idx].z);
+            // 线号顺序下点可能比上一个地面点更近，此时不允许坡度放宽 / In ring order a
+            // point can be closer than the last ground point, which earns no slope allowance
+            const double local_limit =
+                std::max(0.0, range - last_range) * tan_local + threshold;
+            const double general_limit = range * tan_general + threshold;
+            if (std::abs(z - last_height) <= local_limit
+                && std::abs(z + sensor_height) <= general_limit)
+            {
+              labels[idx] = 1;
+              last_range = range;
+              last_height = z;
+            }
+          }
+        }
+      });
+  return true;
+}
+
+}  // namespace toolbox::pcl
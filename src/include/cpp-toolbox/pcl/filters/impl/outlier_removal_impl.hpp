@@ -0,0 +1,319 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <cpp-toolbox/concurrent/parallel.hpp>
+#include <cpp-toolbox/logger/thread_logger.hpp>
+#include <cpp-toolbox/pcl/filters/detail/index_filter_utils.hpp>
+
+namespace toolbox::pcl
+{
+
+namespace detail
+{
+
+/**
+ * @brief 按块调用kneighbors_batch并把结果交给visit / Run kneighbors_batch in blocks
+ * and hand every result to visit
+ *
+ * 查询按线程分段，每段再切成固定大小的块做批量搜索；每个线程有自己的State，调用者在结束后
+ * 合并。/ Queries are split per thread and each range is searched in fixed-size
+ * blocks; every thread owns a State that the caller merges afterwards.
+ *
+ * @param visit visit(state, query_index, indices, distances)
+ * @return 搜索是否全部成功 / Whether every search succeeded
+ */
+template<typename KNN, typename Element, typename State, typename Visit>
+bool batched_kneighbors(KNN& knn,
+                        const std::vector<Element>& points,
+                        std::size_t num_neighbors,
+                        bool parallel,
+                        std::vector<State>& states,
+                        Visit visit)
+{
+  constexpr std::size_t k_block_size = 256;
+  constexpr std::size_t k_parallel_threshold = 1024;
+  if constexpr (searches_on_thread_pool<KNN>::value) {
+    parallel = parallel && !knn.is_parallel_enabled();
+  }
+
+  using distance_type = typename KNN::distance_type;
+  const std::size_t total_points = points.size();
+  const std::size_t num_tasks =
+      toolbox::concurrent::parallel_chunk_count(total_points, k_parallel_threshold, parallel);
+  states.assign(num_tasks, State {});
+  std::vector<char> succeeded(num_tasks, 1);
+
+  auto process_range = [&](std::size_t task, std::size_t begin, std::size_t end)
+  {
+    std::vector<Element> block;
+    std::vector<std::vector<std::size_t>> indices;
+    std::vector<std::vector<distance_type>> distances;
+    for (std::size_t block_begin = begin; block_begin < end; block_begin += k_block_size) {
+      const std::size_t block_end = std::min(block_begin + k_block_size, end);
+      block.assign(points.begin() + block_begin, points.begin() + block_end);
+      if (!knn.kneighbors_batch(block, num_neighbors, indices, distances)) {
+        succeeded[task] = 0;
+        return;
+      }
+      for (std::size_t j = 0; j < block.size(); ++j) {
+        visit(states[task], block_begin + j, indices[j], distances[j]);
+      }
+    }
+  };
+
+  toolbox::concurrent::parallel_for_chunks(
+      total_points, k_parallel_threshold, parallel, process_range);
+
+  return std::all_of(succeeded.begin(), succeeded.end(), [](char ok) { return ok != 0; });
+}
+
+}  // namespace detail
+
+// ---------------------------------------------------------------------------
+// statistical_outlier_removal_t
+// ---------------------------------------------------------------------------
+
+template<typename DataType, typename KNN>
+std::size_t statistical_outlier_removal_t<DataType, KNN>::set_input_impl(
+    const point_cloud& cloud)
+{
+  return set_input_impl(std::make_shared<point_cloud>(cloud));
+}
+
+template<typename DataType, typename KNN>
+std::size_t statistical_outlier_removal_t<DataType, KNN>::set_input_impl(
+    const point_cloud_ptr& cloud)
+{
+  m_cloud = cloud;
+  if (m_cloud && !m_cloud->empty()) {
+    m_knn.set_input(m_cloud);
+  }
+  return m_cloud ? m_cloud->size() : 0U;
+}
+
+template<typename DataType, typename KNN>
+void statistical_outlier_removal_t<DataType, KNN>::enable_parallel_impl(bool enable)
+{
+  m_enable_parallel = enable;
+}
+
+template<typename DataType, typename KNN>
+typename statistical_outlier_removal_t<DataType, KNN>::point_cloud
+statistical_outlier_removal_t<DataType, KNN>::filter_impl()
+{
+  auto output = std::make_shared<point_cloud>();
+  filter_impl(output);
+  return *output;
+}
+
+template<typename DataType, typename KNN>
+void statistical_outlier_removal_t<DataType, KNN>::filter_impl(point_cloud_ptr output)
+{
+  if (!output) {
+    return;
+  }
+  const auto indices = filter_indices();
+  if (!m_cloud) {
+    output->clear();
+    return;
+  }
+  detail::copy_cloud_indices(*m_cloud, indices, *output);
+}
+
+template<typename DataType, typename KNN>
+std::vector<std::size_t> statistical_outlier_removal_t<DataType, KNN>::filter_indices()
+{
+  if (!m_cloud || m_cloud->empty()) {
+    return {};
+  }
+  if (m_num_neighbors == 0) {
+    LOG_ERROR_S << "statistical_outlier_removal_t: Number of neighbors must be positive";
+    return {};
+  }
+
+  const auto& points = m_cloud->points;
+  const std::size_t total_points = points.size();
+  // 多取一个近邻以跳过点自身 / Query one extra neighbor to skip the point itself
+  const std::size_t query_neighbors = std::min(m_num_neighbors + 1, total_points);
+  const std::size_t max_used = m_num_neighbors;
+
+  // 每个线程累加平均距离的和与平方和 / Each thread accumulates the sum and the sum
+  // of squares of the mean distances
+  struct moments_t
+  {
+    double sum = 0.0;
+    double sum_sq = 0.0;
+  };
+  std::vector<data_type> mean_distances(total_points, data_type(0));
+  std::vector<moments_t> moments;
+
+  const bool searched = detail::batched_kneighbors(
+      m_knn,
+      points,
+      query_neighbors,
+      m_enable_parallel,
+      moments,
+      [&mean_distances, max_used](moments_t& state,
+                                  std::size_t query,
+                                  const std::vector<std::size_t>& indices,
+                                  const auto& distances)
+      {
+        double sum = 0.0;
+        std::size_t used = 0;
+        bool skipped_self = false;
+        for (std::size_t j = 0; j < indices.size() && used < max_used; ++j) {
+          if (!skipped_self && indices[j] == query) {
+            skipped_self = true;
+            continue;
+          }
+          sum += static_cast<double>(distances[j]);
+          ++used;
+        }
+        const double mean = used > 0 ? sum / static_cast<double>(used) : 0.0;
+        mean_distances[query] = static_cast<data_type>(mean);
+        state.sum += mean;
+        state.sum_sq += mean * mean;
+      });
+  if (!searched) {
+    LOG_ERROR_S << "statistical_outlier_removal_t: Neighbor search failed";
+    return {};
+  }
+
+  moments_t total;
+  for (const auto& state : moments) {
+    total.sum += state.sum;
+    total.sum_sq += state.sum_sq;
+  }
+  const auto count = static_cast<double>(total_points);
+  const double mean = total.sum / count;
+  const double variance = total_points > 1
+      ? std::max(0.0, (total.sum_sq - count * mean * mean) / (count - 1.0))
+      : 0.0;
+  m_threshold =
+      static_cast<data_type>(mean + static_cast<double>(m_std_mul) * std::sqrt(variance));
+
+  std::vector<std::size_t> kept;
+  kept.reserve(total_points);
+  for (std::size_t i = 0; i < total_points; ++i) {
+    if ((mean_distances[i] <= m_threshold) != m_negative) {
+      kept.push_back(i);
+    }
+  }
+  return kept;
+}
+
+// ---------------------------------------------------------------------------
+// radius_outlier_removal_t
+// ---------------------------------------------------------------------------
+
+template<typename DataType, typename KNN>
+std::size_t radius_outlier_removal_t<DataType, KNN>::set_input_impl(
+    const point_cloud& cloud)
+{
+  return set_input_impl(std::make_shared<point_cloud>(cloud));
+}
+
+template<typename DataType, typename KNN>
+std::size_t radius_outlier_removal_t<DataType, KNN>::set_input_impl(
+    const point_cloud_ptr& cloud)
+{
+  m_cloud = cloud;
+  if (m_cloud && !m_cloud->empty()) {
+    m_knn.set_input(m_cloud);
+  }
+  return m_cloud ? m_cloud->size() : 0U;
+}
+
+template<typename DataType, typename KNN>
+void radius_outlier_removal_t<DataType, KNN>::enable_parallel_impl(bool enable)
+{
+  m_enable_parallel = enable;
+}
+
+template<typename DataType, typename KNN>
+typename radius_outlier_removal_t<DataType, KNN>::point_cloud
+radius_outlier_removal_t<DataType, KNN>::filter_impl()
+{
+  auto output = std::make_shared<point_cloud>();
+  filter_impl(output);
+  return *output;
+}
+
+template<typename DataType, typename KNN>
+void radius_outlier_removal_t<DataType, KNN>::filter_impl(point_cloud_ptr output)
+{
+  if (!output) {
+    return;
+  }
+  const auto indices = filter_indices();
+  if (!m_cloud) {
+    output->clear();
+    return;
+  }
+  detail::copy_cloud_indices(*m_cloud, indices, *output);
+}
+
+template<typename DataType, typename KNN>
+std::vector<std::size_t> radius_outlier_removal_t<DataType, KNN>::filter_indices()
+{
+  if (!m_cloud || m_cloud->empty()) {
+    return {};
+  }
+  if (!(m_radius > data_type(0))) {
+    LOG_ERROR_S << "radius_outlier_removal_t: Radius must be positive, got " << m_radius;
+    return {};
+  }
+
+  const auto& points = m_cloud->points;
+  const std::size_t total_points = points.size();
+  std::vector<char> inliers(total_points, 0);
+
+  // 点云太小时不可能有足够的邻居 / A cloud this small cannot provide enough neighbors
+  if (m_min_neighbors + 1 <= total_points) {
+    struct no_state_t
+    {
+    };
+    std::vector<no_state_t> states;
+    const std::size_t required = m_min_neighbors + 1;
+    const data_type radius = m_radius;
+
+    // 含自身的第required个最近邻在半径内，等价于半径内至少有min_neighbors个其他点
+    // The required-th nearest neighbor, self included, lies within the radius
+    // exactly when at least min_neighbors other points do
+    const bool searched = detail::batched_kneighbors(
+        m_knn,
+        points,
+        required,
+        m_enable_parallel,
+        states,
+        [&inliers, required, radius](no_state_t& /*state*/,
+                                     std::size_t query,
+                                     const std::vector<std::size_t>& /*indices*/,
+                                     const auto& distances)
+        {
+          if (distances.size() < required) {
+            return;
+          }
+          const auto farthest = *std::max_element(distances.begin(), distances.end());
+          inliers[query] = farthest <= radius ? 1 : 0;
+        });
+    if (!searched) {
+      LOG_ERROR_S << "radius_outlier_removal_t: Neighbor search failed";
+      return {};
+    }
+  }
+
+  std::vector<std::size_t> kept;
+  kept.reserve(total_points);
+  for (std::size_t i = 0; i < total_points; ++i) {
+    if ((inliers[i] != 0) != m_negative) {
+      kept.push_back(i);
+    }
+  }
+  return kept;
+}
+
+}  // namespace toolbox::pcl
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <cpp-toolbox/logger/thread_logger.hpp>
+#include <cpp-toolbox/pcl/filters/detail/index_filter_utils.hpp>
+
+namespace toolbox::pcl
+{
+
+template<typename DataType>
+std::size_t passthrough_t<DataType>::set_input_impl(const point_cloud& cloud)
+{
+  m_cloud = std::make_shared<point_cloud>(cloud);
+  return m_cloud->size();
+}
+
+template<typename DataType>
+std::size_t passthrough_t<DataType>::set_input_impl(const point_cloud_ptr& cloud)
+{
+  m_cloud = cloud;
+  return m_cloud ? m_cloud->size() : 0U;
+}
+
+template<typename DataType>
+void passthrough_t<DataType>::enable_parallel_impl(bool enable)
+{
+  m_enable_parallel = enable;
+}
+
+template<typename DataType>
+typename passthrough_t<DataType>::point_cloud passthrough_t<DataType>::filter_impl()
+{
+  auto output = std::make_shared<point_cloud>();
+  filter_impl(output);
+  return *output;
+}
+
+template<typename DataType>
+void passthrough_t<DataType>::filter_impl(point_cloud_ptr output)
+{
+  if (!output) {
+    return;
+  }
+  if (!m_cloud) {
+    output->clear();
+    return;
+  }
+  detail::copy_cloud_indices(*m_cloud, filter_indices(), *output);
+}
+
+template<typename DataType>
+void passthrough_t<DataType>::set_range(passthrough_field_t field,
+                                        data_type min_value,
+                                        data_type max_value)
+{
+  for (auto& range : m_ranges) {
+    if (range.field == field) {
+      range.min = min_value;
+      range.max = max_value;
+      return;
+    }
+  }
+  m_ranges.push_back(range_t {field, min_value, max_value});
+}
+
+template<typename DataType>
+std::vector<std::size_t> passthrough_t<DataType>::filter_indices()
+{
+  if (!m_cloud || m_cloud->empty()) {
+    return {};
+  }
+
+  const std::size_t total_points = m_cloud->size();
+  // 每个范围解析为一个通道首元素和分量偏移 / Resolve every range to a channel's first
+  // element and a component offset
+  struct resolved_range_t
+  {
+    const toolbox::types::point_t<data_type>* channel;
+    int component;
+    data_type min;
+    data_type max;
+  };
+  std::vector<resolved_range_t> ranges;
+  ranges.reserve(m_ranges.size());
+  for (const auto& range : m_ranges) {
+    const std::vector<toolbox::types::point_t<data_type>>* channel = &m_cloud->points;
+    int component = 0;
+    switch (range.field) {
+      case passthrough_field_t::x: component = 0; break;
+      case passthrough_field_t::y: component = 1; break;
+      case passthrough_field_t::z: component = 2; break;
+      case passthrough_field_t::normal_x: channel = &m_cloud->normals; component = 0; break;
+      case passthrough_field_t::normal_y: channel = &m_cloud->normals; component = 1; break;
+      case passthrough_field_t::normal_z: channel = &m_cloud->normals; component = 2; break;
+      case passthrough_field_t::r: channel = &m_cloud->colors; component = 0; break;
+      case passthrough_field_t::g: channel = &m_cloud->colors; component = 1; break;
+      case passthrough_field_t::b: channel = &m_cloud->colors; component = 2; break;
+    }
+    if (channel->size() != total_points) {
+      LOG_ERROR_S << "passthrough_t: Requested field is missing from the input cloud";
+      return {};
+    }
+    ranges.push_back(resolved_range_t {channel->data(), component, range.min, range.max});
+  }
+
+  return detail::compact_mask_indices(
+      total_points,
+      m_enable_parallel,
+      m_negative,
+      [&ranges](std::size_t begin, std::size_t end, std::uint8_t* mask)
+      {
+        const std::size_t count = end - begin;
+        for (std::size_t i = 0; i < count; ++i) {
+          mask[i] = 1;
+        }
+        // 每个范围单独遍历一次，内层循环不含分支 / One pass per range keeps the inner
+        // loop free of branches
+        for (const auto& range : ranges) {
+          const auto* values = range.channel + begin;
+          const data_type lo = range.min;
+          const data_type hi = range.max;
+          if (range.component == 0) {
+            for (std::size_t i = 0; i < count; ++i) {
+              mask[i] &= static_cast<std::uint8_t>((values[i].x >= lo) & (values[i].x <= hi));
+            }
+          } else if (range.component == 1) {
+            for (std::size_t i = 0; i < count; ++i) {
+              mask[i] &= static_cast<std::uint8_t>((values[i].y >= lo) & (values[i].y <= hi));
+            }
+          } else {
+            for (std::size_t i = 0; i < count; ++i) {
+              mask[i] &= static_cast<std::uint8_t>((values[i].z >= lo) & (values[i].z <= hi));
+            }
+          }
+        }
+      });
+}
+
+}  // namespace toolbox::pcl
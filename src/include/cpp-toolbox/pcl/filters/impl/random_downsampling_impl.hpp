@@ -1,14 +1,104 @@
 #pragma once
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <numeric>
+#include <random>
 #include <vector>
 
 #include <cpp-toolbox/concurrent/parallel.hpp>
+#include <cpp-toolbox/logger/thread_logger.hpp>
+#include <cpp-toolbox/types/minmax.hpp>
 
 namespace toolbox::pcl
 {
 
+namespace detail
+{
+
+/**
+ * @brief 用splitmix64从种子派生独立的随机流种子 / Derive an independent stream seed
+ * from a seed with splitmix64
+ */
+inline std::uint64_t mix_seed(std::uint64_t seed, std::uint64_t stream) noexcept
+{
+  std::uint64_t z = seed + (stream + 1) * 0x9E3779B97F4A7C15ULL;
+  z = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27U)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31U);
+}
+
+/**
+ * @brief 超几何分布抽样：从population个点（其中successes个属于当前块）无放回抽取draws个，
+ * 返回落在当前块中的个数 / Hypergeometric draw: of draws samples taken without
+ * replacement from population points, successes of which lie in the current block,
+ * return how many fall in the block
+ *
+ * 从众数出发向两侧做逆变换，期望步数与标准差成正比 / Inversion starting at the mode and
+ * walking outwards, with an expected step count proportional to the standard deviation
+ */
+template<typename Engine>
+std::size_t hypergeometric_draw(Engine& engine,
+                                std::size_t population,
+                                std::size_t successes,
+                                std::size_t draws)
+{
+  const std::size_t failures = population - successes;
+  const std::size_t lower = draws > failures ? draws - failures : 0;
+  const std::size_t upper = std::min(draws, successes);
+  if (lower == upper) {
+    return lower;
+  }
+
+  const auto N = static_cast<double>(population);
+  const auto K = static_cast<double>(successes);
+  const auto n = static_cast<double>(draws);
+  auto log_choose = [](double a, double b)
+  { return std::lgamma(a + 1.0) - std::lgamma(b + 1.0) - std::lgamma(a - b + 1.0); };
+  // P(x+1) / P(x)
+  auto ratio_up = [&](double x)
+  { return (K - x) * (n - x) / ((x + 1.0) * (N - K - n + x + 1.0)); };
+
+  const auto mode = std::clamp(
+      static_cast<std::size_t>(std::floor((n + 1.0) * (K + 1.0) / (N + 2.0))), lower, upper);
+  const auto m = static_cast<double>(mode);
+  const double p_mode =
+      std::exp(log_choose(K, m) + log_choose(N - K, n - m) - log_choose(N, n));
+
+  double u = std::uniform_real_distribution<double>(0.0, 1.0)(engine) - p_mode;
+  std::size_t below = mode;
+  std::size_t above = mode;
+  double p_below = p_mode;
+  double p_above = p_mode;
+  while (u > 0.0 && (below > lower || above < upper)) {
+    // 下一步取概率较大的一侧 / Step to whichever side is more likely next
+    const double next_below =
+        below > lower ? p_below / ratio_up(static_cast<double>(below - 1)) : 0.0;
+    const double next_above =
+        above < upper ? p_above * ratio_up(static_cast<double>(above)) : 0.0;
+    if (next_above >= next_below) {
+      ++above;
+      p_above = next_above;
+      u -= p_above;
+      if (u <= 0.0) {
+        return above;
+      }
+    } else {
+      --below;
+      p_below = next_below;
+      u -= p_below;
+      if (u <= 0.0) {
+        return below;
+      }
+    }
+  }
+  return mode;
+}
+
+}  // namespace detail
+
 template<typename DataType>
 std::size_t random_downsampling_t<DataType>::set_input_impl(
     const point_cloud& cloud)
@@ -45,55 +135,13 @@ void random_downsampling_t<DataType>::filter_impl(point_cloud_ptr output)
 {
   if (!output)
     return;
-  if (!m_cloud || m_cloud->empty()) {
-    output->clear();
-    return;
-  }
 
-  const std::size_t input_size = m_cloud->size();
-  std::size_t sample_count =
-      static_cast<std::size_t>(std::floor(input_size * m_ration));
-  sample_count = std::min(sample_count, input_size);
-  if (sample_count == 0) {
-    output->clear();
+  const std::vector<std::size_t> indices = filter_indices();
+  output->clear();
+  if (indices.empty()) {
     return;
   }
-
-  // 使用蓄水池采样算法(Reservoir Sampling)代替全数组洗牌
-  std::vector<std::size_t> indices;
-  indices.reserve(sample_count);
-
-  // 如果采样率很高或点云较小，使用传统方法可能更快
-  if (sample_count > input_size / 2 || input_size < 10000) {
-    // 传统方法：生成所有索引并洗牌
-    indices.resize(input_size);
-    std::iota(indices.begin(), indices.end(), 0);
-    toolbox::utils::random_t::instance().shuffle(indices);
-    indices.resize(sample_count);
-  } else {
-    // 蓄水池采样算法
-    auto& rng = toolbox::utils::random_t::instance();
-
-    // 第1步：填充初始蓄水池
-    indices.resize(sample_count);
-    for (std::size_t i = 0; i < sample_count; ++i) {
-      indices[i] = i;
-    }
-
-    // 第2步：处理剩余元素
-    for (std::size_t i = sample_count; i < input_size; ++i) {
-      // 以 k/i 的概率选择第i个元素
-      std::size_t j = rng.random_int<std::size_t>(0, i);
-      if (j < sample_count) {
-        indices[j] = i;
-      }
-    }
-
-    // 可选：打乱结果以避免顺序偏差
-    if (sample_count > 1) {
-      rng.shuffle(indices);
-    }
-  }
+  const std::size_t sample_count = indices.size();
 
   // 预分配输出点云内存
   output->points.resize(sample_count);
@@ -105,8 +153,7 @@ void random_downsampling_t<DataType>::filter_impl(point_cloud_ptr output)
   }
   output->intensity = m_cloud->intensity;
 
-  // 并行处理逻辑保持不变
-  if (m_enable_parallel && sample_count > 1024) {
+  if (m_enable_parallel && sample_count > k_parallel_threshold) {
     toolbox::concurrent::parallel_transform(indices.cbegin(),
                                             indices.cend(),
                                             output->points.begin(),
@@ -140,4 +187,325 @@ void random_downsampling_t<DataType>::filter_impl(point_cloud_ptr output)
   }
 }
 
+template<typename DataType>
+std::vector<std::size_t> random_downsampling_t<DataType>::filter_indices()
+{
+  if (!m_cloud || m_cloud->empty()) {
+    return {};
+  }
+
+  const std::size_t input_size = m_cloud->size();
+  std::size_t sample_count =
+      static_cast<std::size_t>(std::floor(input_size * m_ration));
+  sample_count = std::min(sample_count, input_size);
+  if (sample_count == 0) {
+    return {};
+  }
+
+  // 未固定种子时从全局随机数生成器取一个，全局种子相同则结果相同
+  const std::uint64_t seed = m_has_seed
+      ? m_seed
+      : toolbox::utils::random_t::instance().random_int<std::uint64_t>(
+            0, std::numeric_limits<std::uint64_t>::max());
+
+  if (m_mode == sampling_mode_t::stratified) {
+    return stratified_indices(sample_count, seed);
+  }
+  return uniform_indices(sample_count, seed);
+}
+
+template<typename DataType>
+std::vector<std::size_t> random_downsampling_t<DataType>::uniform_indices(
+    std::size_t sample_count, std::uint64_t seed)
+{
+  const std::size_t input_size = m_cloud->size();
+  if (sample_count == input_size) {
+    std::vector<std::size_t> all(input_size);
+    std::iota(all.begin(), all.end(), 0);
+    return all;
+  }
+
+  // 第1步：主随机流按超几何分布依次确定每块的采样数，总数恰好为sample_count，
+  // 结果等同于在整个点云上无放回的均匀抽样
+  const std::size_t num_blocks = (input_size + k_block_size - 1) / k_block_size;
+  std::vector<std::size_t> block_counts(num_blocks);
+  std::vector<std::size_t> block_offsets(num_blocks + 1, 0);
+  {
+    std::mt19937_64 engine(detail::mix_seed(seed, 0));
+    std::size_t remaining_points = input_size;
+    std::size_t remaining_samples = sample_count;
+    for (std::size_t b = 0; b < num_blocks; ++b) {
+      const std::size_t block_points =
+          std::min(k_block_size, input_size - b * k_block_size);
+      const std::size_t count = detail::hypergeometric_draw(
+          engine, remaining_points, block_points, remaining_samples);
+      block_counts[b] = count;
+      block_offsets[b + 1] = block_offsets[b] + count;
+      remaining_points -= block_points;
+      remaining_samples -= count;
+    }
+  }
+
+  // 第2步：每块用自己的随机流和Floyd算法选择不重复的索引，位图扫描后自然有序
+  std::vector<std::size_t> indices(sample_count);
+  auto process_blocks = [&](std::size_t first_block, std::size_t last_block)
+  {
+    std::vector<std::uint64_t> bitmap((k_block_size + 63) / 64);
+    for (std::size_t b = first_block; b < last_block; ++b) {
+      const std::size_t block_begin = b * k_block_size;
+      const std::size_t block_points = std::min(k_block_size, input_size - block_begin);
+      const std::size_t count = block_counts[b];
+      // 采样过半时改为选出要丢弃的点
+      const bool complement = count > block_points / 2;
+      const std::size_t draws = complement ? block_points - count : count;
+
+      const std::size_t num_words = (block_points + 63) / 64;
+      std::fill(bitmap.begin(), bitmap.begin() + static_cast<std::ptrdiff_t>(num_words), 0);
+      std::mt19937_64 engine(detail::mix_seed(seed, b + 1));
+      for (std::size_t j = block_points - draws; j < block_points; ++j) {
+        std::uniform_int_distribution<std::size_t> dist(0, j);
+        const std::size_t t = dist(engine);
+        const std::uint64_t t_bit = std::uint64_t {1} << (t & 63U);
+        if ((bitmap[t >> 6U] & t_bit) != 0) {
+          bitmap[j >> 6U] |= std::uint64_t {1} << (j & 63U);
+        } else {
+          bitmap[t >> 6U] |= t_bit;
+        }
+      }
+
+      std::size_t out = block_offsets[b];
+      for (std::size_t w = 0; w < num_words; ++w) {
+        std::uint64_t word = complement ? ~bitmap[w] : bitmap[w];
+        const std::size_t word_begin = w * 64;
+        if (block_points - word_begin < 64) {
+          word &= (std::uint64_t {1} << (block_points - word_begin)) - 1;
+        }
+        for (std::size_t bit = 0; word != 0; ++bit, word >>= 1U) {
+          if ((word & 1U) != 0) {
+            indices[out++] = block_begin + word_begin + bit;
+          }
+        }
+      }
+    }
+  };
+
+  // 点数决定是否并行，块按块号分给各线程
+  toolbox::concurrent::parallel_for_chunks(
+      num_blocks,
+      m_enable_parallel && input_size > k_parallel_threshold
+          ? 0
+          : std::numeric_limits<std::size_t>::max(),
+      process_blocks);
+  return indices;
+}
+
+template<typename DataType>
+std::vector<std::size_t> random_downsampling_t<DataType>::stratified_indices(
+    std::size_t sample_count, std::uint64_t seed)
+{
+  if (!(m_stratum_size > 0.0F)) {
+    LOG_ERROR_S << "random_downsampling_t: Stratum size must be positive, got "
+                << m_stratum_size;
+    return {};
+  }
+
+  const auto& points = m_cloud->points;
+  // 点数决定是否并行，之后各步按块执行时不再比较阈值
+  const bool parallel = m_enable_parallel && points.size() > k_parallel_threshold;
+  const auto stratum = static_cast<data_type>(m_stratum_size);
+
+  // 非有限坐标无法分层，先剔除，再由有限点计算单元索引范围
+  std::vector<std::size_t> finite;
+  finite.reserve(points.size());
+  toolbox::types::minmax_t<toolbox::types::point_t<data_type>> bounds;
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    const auto& p = points[i];
+    if (!std::isfinite(p.x) || !std::isfinite(p.y) || !std::isfinite(p.z)) {
+      continue;
+    }
+    finite.push_back(i);
+    bounds += p;
+  }
+  const std::size_t total_points = finite.size();
+  if (total_points < points.size()) {
+    sample_count = std::min(
+        static_cast<std::size_t>(std::floor(total_points * m_ration)), total_points);
+  }
+  if (sample_count == 0) {
+    return {};
+  }
+
+  // 键为相对最小单元的线性索引
+  auto cell_index = [stratum](data_type value)
+  { return static_cast<std::int64_t>(std::floor(value / stratum)); };
+
+  const std::int64_t min_ix = cell_index(bounds.min.x);
+  const std::int64_t min_iy = cell_index(bounds.min.y);
+  const std::int64_t min_iz = cell_index(bounds.min.z);
+  const auto span_x = static_cast<std::uint64_t>(cell_index(bounds.max.x) - min_ix) + 1;
+  const auto span_y = static_cast<std::uint64_t>(cell_index(bounds.max.y) - min_iy) + 1;
+  const auto span_z = static_cast<std::uint64_t>(cell_index(bounds.max.z) - min_iz) + 1;
+
+  constexpr auto k_max_key = std::numeric_limits<std::uint64_t>::max();
+  if (span_y > k_max_key / span_x || span_z > k_max_key / (span_x * span_y)) {
+    LOG_ERROR_S << "random_downsampling_t: Stratum size " << m_stratum_size
+                << " is too small for the extent of the point cloud";
+    return {};
+  }
+
+  unsigned key_bits = 0;
+  for (std::uint64_t max_key = span_x * span_y * span_z - 1; max_key != 0;
+       max_key >>= 1U)
+  {
+    ++key_bits;
+  }
+
+  std::vector<std::uint64_t> keys(total_points);
+  std::vector<std::size_t> order(total_points);
+  toolbox::concurrent::parallel_for_chunks(
+      total_points,
+      0,
+      parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t i = start_idx; i < end_idx; ++i) {
+          const auto& p = points[finite[i]];
+          const auto rx = static_cast<std::uint64_t>(cell_index(p.x) - min_ix);
+          const auto ry = static_cast<std::uint64_t>(cell_index(p.y) - min_iy);
+          const auto rz = static_cast<std::uint64_t>(cell_index(p.z) - min_iz);
+          keys[i] = (rz * span_y + ry) * span_x + rx;
+          order[i] = finite[i];
+        }
+      });
+  toolbox::concurrent::parallel_radix_sort_pairs(keys, order, key_bits, parallel);
+
+  // 在按单元排序的序列上等间距取样，随机起点；每个单元得到按比例份额的向下或向上取整
+  std::mt19937_64 engine(detail::mix_seed(seed, 0));
+  const double offset = std::uniform_real_distribution<double>(0.0, 1.0)(engine);
+  const double step = static_cast<double>(total_points) / static_cast<double>(sample_count);
+  std::vector<std::size_t> indices(sample_count);
+  toolbox::concurrent::parallel_for_chunks(
+      sample_count,
+      0,
+      parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t j = start_idx; j < end_idx; ++j) {
+          const auto position = static_cast<std::size_t>(
+              (static_cast<double>(j) + offset) * step);
+          indices[j] = order[std::min(position, total_points - 1)];
+        }
+      });
+  std::sort(indices.begin(), indices.end());
+  return indices;
+}
+
+// ---------------------------------------------------------------------------
+// reservoir_sampler_t
+// ---------------------------------------------------------------------------
+
+template<typename DataType>
+reservoir_sampler_t<DataType>::reservoir_sampler_t(std::size_t capacity,
+                                                   std::uint64_t seed)
+    : m_capacity(capacity)
+{
+  reset(seed);
+}
+
+template<typename DataType>
+void reservoir_sampler_t<DataType>::reset(std::uint64_t seed)
+{
+  m_engine.seed(detail::mix_seed(seed, 0));
+  m_seen = 0;
+  m_next = 0;
+  m_weight = 1.0;
+  m_has_normals = true;
+  m_has_colors = true;
+  m_sample.clear();
+  m_indices.clear();
+  m_sample.points.reserve(m_capacity);
+  m_indices.reserve(m_capacity);
+}
+
+template<typename DataType>
+void reservoir_sampler_t<DataType>::advance()
+{
+  // Algorithm L：权重按min(U^(1/k))更新，跳过的点数服从几何分布
+  std::uniform_real_distribution<double> dist(0.0, 1.0);
+  const auto k = static_cast<double>(m_capacity);
+  m_weight *= std::exp(std::log(1.0 - dist(m_engine)) / k);
+  double skip = std::floor(std::log(1.0 - dist(m_engine)) / std::log(1.0 - m_weight));
+  // 权重趋近于0时跳过量溢出，此时视为不再接受 / The skip overflows as the weight
+  // approaches 0, meaning nothing more is accepted in practice
+  constexpr double k_max_skip = 1e18;
+  if (!(skip < k_max_skip)) {
+    skip = k_max_skip;
+  }
+  m_next += static_cast<std::size_t>(skip) + 1;
+}
+
+template<typename DataType>
+void reservoir_sampler_t<DataType>::add(const point_cloud& chunk)
+{
+  const std::size_t chunk_size = chunk.size();
+  if (chunk_size == 0) {
+    return;
+  }
+  const bool chunk_normals = chunk.normals.size() == chunk_size;
+  const bool chunk_colors = chunk.colors.size() == chunk_size;
+  if (m_has_normals && !chunk_normals) {
+    m_has_normals = false;
+    m_sample.normals.clear();
+  }
+  if (m_has_colors && !chunk_colors) {
+    m_has_colors = false;
+    m_sample.colors.clear();
+  }
+  m_sample.intensity = chunk.intensity;
+
+  const std::size_t chunk_begin = m_seen;
+
+  // 蓄水池未满时直接追加 / Append while the reservoir is not full
+  for (std::size_t i = 0; i < chunk_size && m_indices.size() < m_capacity; ++i) {
+    m_sample.points.push_back(chunk.points[i]);
+    if (m_has_normals) {
+      m_sample.normals.push_back(chunk.normals[i]);
+    }
+    if (m_has_colors) {
+      m_sample.colors.push_back(chunk.colors[i]);
+    }
+    m_indices.push_back(chunk_begin + i);
+    if (m_indices.size() == m_capacity) {
+      m_next = chunk_begin + i;
+      advance();
+    }
+  }
+
+  if (m_capacity > 0) {
+    const std::size_t chunk_end = chunk_begin + chunk_size;
+    std::uniform_int_distribution<std::size_t> slot_dist(0, m_capacity - 1);
+    while (m_indices.size() == m_capacity && m_next < chunk_end) {
+      const std::size_t local = m_next - chunk_begin;
+      const std::size_t slot = slot_dist(m_engine);
+      m_sample.points[slot] = chunk.points[local];
+      if (m_has_normals) {
+        m_sample.normals[slot] = chunk.normals[local];
+      }
+      if (m_has_colors) {
+        m_sample.colors[slot] = chunk.colors[local];
+      }
+      m_indices[slot] = m_next;
+      advance();
+    }
+  }
+  m_seen += chunk_size;
+}
+
+template<typename DataType>
+typename reservoir_sampler_t<DataType>::point_cloud reservoir_sampler_t<DataType>::sample()
+    const
+{
+  return m_sample;
+}
+
 }  // namespace toolbox::pcl
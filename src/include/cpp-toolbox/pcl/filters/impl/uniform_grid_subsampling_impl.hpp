@@ -0,0 +1,199 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <cpp-toolbox/concurrent/parallel.hpp>
+#include <cpp-toolbox/logger/thread_logger.hpp>
+#include <cpp-toolbox/types/minmax.hpp>
+
+namespace toolbox::pcl
+{
+
+template<typename DataType>
+std::size_t uniform_grid_subsampling_t<DataType>::set_input_impl(
+    const point_cloud& cloud)
+{
+  m_cloud = std::make_shared<point_cloud>(cloud);
+  return m_cloud->size();
+}
+
+template<typename DataType>
+std::size_t uniform_grid_subsampling_t<DataType>::set_input_impl(
+    const point_cloud_ptr& cloud)
+{
+  m_cloud = cloud;
+  return m_cloud ? m_cloud->size() : 0U;
+}
+
+template<typename DataType>
+void uniform_grid_subsampling_t<DataType>::enable_parallel_impl(bool enable)
+{
+  m_enable_parallel = enable;
+}
+
+template<typename DataType>
+typename uniform_grid_subsampling_t<DataType>::point_cloud
+uniform_grid_subsampling_t<DataType>::filter_impl()
+{
+  auto output = std::make_shared<point_cloud>();
+  filter_impl(output);
+  return *output;
+}
+
+template<typename DataType>
+void uniform_grid_subsampling_t<DataType>::filter_impl(point_cloud_ptr output)
+{
+  if (!output) {
+    return;
+  }
+
+  const std::vector<std::size_t> indices = filter_indices();
+  output->clear();
+  if (indices.empty()) {
+    return;
+  }
+
+  const bool has_normals = !m_cloud->normals.empty();
+  const bool has_colors = !m_cloud->colors.empty();
+  output->points.resize(indices.size());
+  if (has_normals) {
+    output->normals.resize(indices.size());
+  }
+  if (has_colors) {
+    output->colors.resize(indices.size());
+  }
+  output->intensity = m_cloud->intensity;
+
+  for (std::size_t i = 0; i < indices.size(); ++i) {
+    output->points[i] = m_cloud->points[indices[i]];
+    if (has_normals) {
+      output->normals[i] = m_cloud->normals[indices[i]];
+    }
+    if (has_colors) {
+      output->colors[i] = m_cloud->colors[indices[i]];
+    }
+  }
+}
+
+template<typename DataType>
+std::vector<std::size_t> uniform_grid_subsampling_t<DataType>::filter_indices()
+{
+  if (!m_cloud || m_cloud->empty()) {
+    return {};
+  }
+  if (!(m_grid_size > 0.0F)) {
+    LOG_ERROR_S << "uniform_grid_subsampling_t: Grid size must be positive, got "
+                << m_grid_size;
+    return {};
+  }
+
+  const auto& points = m_cloud->points;
+  const std::size_t total_points = points.size();
+  // 点数决定是否并行，之后各步按块执行时不再比较阈值
+  const bool parallel = m_enable_parallel && total_points > k_parallel_threshold;
+  const auto grid = static_cast<data_type>(m_grid_size);
+
+  // 计算单元索引范围，键为相对最小单元的线性索引
+  const auto bounds = parallel ? toolbox::types::calculate_minmax_parallel(*m_cloud)
+                               : toolbox::types::calculate_minmax(*m_cloud);
+  auto cell_index = [grid](data_type value)
+  { return static_cast<std::int64_t>(std::floor(value / grid)); };
+
+  const std::int64_t min_ix = cell_index(bounds.min.x);
+  const std::int64_t min_iy = cell_index(bounds.min.y);
+  const std::int64_t min_iz = cell_index(bounds.min.z);
+  const auto span_x = static_cast<std::uint64_t>(cell_index(bounds.max.x) - min_ix) + 1;
+  const auto span_y = static_cast<std::uint64_t>(cell_index(bounds.max.y) - min_iy) + 1;
+  const auto span_z = static_cast<std::uint64_t>(cell_index(bounds.max.z) - min_iz) + 1;
+
+  constexpr auto k_max_key = std::numeric_limits<std::uint64_t>::max();
+  if (span_y > k_max_key / span_x || span_z > k_max_key / (span_x * span_y)) {
+    LOG_ERROR_S << "uniform_grid_subsampling_t: Grid size " << m_grid_size
+                << " is too small for the extent of the point cloud";
+    return {};
+  }
+
+  unsigned key_bits = 0;
+  for (std::uint64_t max_key = span_x * span_y * span_z - 1; max_key != 0;
+       max_key >>= 1U)
+  {
+    ++key_bits;
+  }
+
+  std::vector<std::uint64_t> keys(total_points);
+  std::vector<std::size_t> order(total_points);
+  toolbox::concurrent::parallel_for_chunks(
+      total_points,
+      0,
+      parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t i = start_idx; i < end_idx; ++i) {
+          const auto& p = points[i];
+          const auto rx = static_cast<std::uint64_t>(cell_index(p.x) - min_ix);
+          const auto ry = static_cast<std::uint64_t>(cell_index(p.y) - min_iy);
+          const auto rz = static_cast<std::uint64_t>(cell_index(p.z) - min_iz);
+          keys[i] = (rz * span_y + ry) * span_x + rx;
+          order[i] = i;
+        }
+      });
+
+  // 稳定排序后同一单元的点连续，且保持输入顺序
+  toolbox::concurrent::parallel_radix_sort_pairs(keys, order, key_bits, parallel);
+
+  std::vector<std::size_t> segment_begins;
+  segment_begins.reserve(total_points / 8 + 1);
+  segment_begins.push_back(0);
+  for (std::size_t i = 1; i < total_points; ++i) {
+    if (keys[i] != keys[i - 1]) {
+      segment_begins.push_back(i);
+    }
+  }
+  const std::size_t num_cells = segment_begins.size();
+  segment_begins.push_back(total_points);
+
+  // 分段求距离单元中心最近的点，距离相同时保留输入中靠前的点
+  std::vector<std::size_t> selected(num_cells);
+  toolbox::concurrent::parallel_for_chunks(
+      num_cells,
+      0,
+      parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t cell = start_idx; cell < end_idx; ++cell) {
+          const std::size_t begin = segment_begins[cell];
+          const std::size_t end = segment_begins[cell + 1];
+          const auto& first = points[order[begin]];
+          const data_type half = static_cast<data_type>(0.5);
+          const data_type cx =
+              (static_cast<data_type>(cell_index(first.x)) + half) * grid;
+          const data_type cy =
+              (static_cast<data_type>(cell_index(first.y)) + half) * grid;
+          const data_type cz =
+              (static_cast<data_type>(cell_index(first.z)) + half) * grid;
+
+          std::size_t best = order[begin];
+          data_type best_distance = std::numeric_limits<data_type>::max();
+          for (std::size_t i = begin; i < end; ++i) {
+            const auto& p = points[order[i]];
+            const data_type dx = p.x - cx;
+            const data_type dy = p.y - cy;
+            const data_type dz = p.z - cz;
+            const data_type distance = dx * dx + dy * dy + dz * dz;
+            if (distance < best_distance) {
+              best_distance = distance;
+              best = order[i];
+            }
+          }
+          selected[cell] = best;
+        }
+      });
+
+  return selected;
+}
+
+}  // namespace toolbox::pcl
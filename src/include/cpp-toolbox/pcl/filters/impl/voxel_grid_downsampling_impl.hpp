@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cmath>
+#include <limits>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
@@ -32,6 +33,27 @@ std::size_t voxel_grid_downsampling_t<DataType>::voxel_data_soa_t::add_voxel()
   return idx;
 }
 
+template<typename DataType>
+void voxel_grid_downsampling_t<DataType>::voxel_data_soa_t::resize(
+    std::size_t new_size)
+{
+  const std::size_t old_size = size();
+  sum_x.resize(new_size, 0);
+  sum_y.resize(new_size, 0);
+  sum_z.resize(new_size, 0);
+  sum_nx.resize(new_size, 0);
+  sum_ny.resize(new_size, 0);
+  sum_nz.resize(new_size, 0);
+  sum_r.resize(new_size, 0);
+  sum_g.resize(new_size, 0);
+  sum_b.resize(new_size, 0);
+  counts.resize(new_size, 0);
+  voxel_indices.resize(new_size);
+  for (std::size_t i = old_size; i < new_size; ++i) {
+    voxel_indices[i] = i;
+  }
+}
+
 template<typename DataType>
 std::size_t voxel_grid_downsampling_t<DataType>::voxel_data_soa_t::size() const
 {
@@ -124,20 +146,7 @@ voxel_grid_downsampling_t<DataType>::compute_voxel_key(int ix,
   if (!m_bounds_computed) {
     // 如果边界未计算，使用简单的哈希方法
     // 这不是最优的，但可以作为后备方案
-    constexpr std::uint64_t kBitMask = 0x1FFFFF;  // 21位掩码
-    constexpr int kYShift = 21;
-    constexpr int kZShift = 42;
-
-    // 确保坐标在合理范围内
-    const std::uint64_t x_bits =
-        static_cast<std::uint64_t>(static_cast<std::uint32_t>(ix)) & kBitMask;
-    const std::uint64_t y_bits =
-        static_cast<std::uint64_t>(static_cast<std::uint32_t>(iy)) & kBitMask;
-    const std::uint64_t z_bits =
-        static_cast<std::uint64_t>(static_cast<std::uint32_t>(iz)) & kBitMask;
-
-    return (z_bits << static_cast<unsigned>(kZShift))
-        | (y_bits << static_cast<unsigned>(kYShift)) | x_bits;
+    return pack_voxel_key(ix, iy, iz);
   }
 
   // 使用点云边界计算相对坐标
@@ -154,6 +163,29 @@ voxel_grid_downsampling_t<DataType>::compute_voxel_key(int ix,
       + static_cast<std::uint64_t>(rel_x);
 }
 
+// 实现与边界无关的体素键
+template<typename DataType>
+typename voxel_grid_downsampling_t<DataType>::voxel_key_t
+voxel_grid_downsampling_t<DataType>::pack_voxel_key(int ix,
+                                                    int iy,
+                                                    int iz) noexcept
+{
+  constexpr std::uint64_t kBitMask = 0x1FFFFF;  // 21位掩码
+  constexpr int kYShift = 21;
+  constexpr int kZShift = 42;
+
+  // 确保坐标在合理范围内
+  const std::uint64_t x_bits =
+      static_cast<std::uint64_t>(static_cast<std::uint32_t>(ix)) & kBitMask;
+  const std::uint64_t y_bits =
+      static_cast<std::uint64_t>(static_cast<std::uint32_t>(iy)) & kBitMask;
+  const std::uint64_t z_bits =
+      static_cast<std::uint64_t>(static_cast<std::uint32_t>(iz)) & kBitMask;
+
+  return (z_bits << static_cast<unsigned>(kZShift))
+      | (y_bits << static_cast<unsigned>(kYShift)) | x_bits;
+}
+
 // 实现估计体素数量的方法
 template<typename DataType>
 std::size_t voxel_grid_downsampling_t<DataType>::estimate_voxel_count() const
@@ -363,23 +395,14 @@ voxel_grid_downsampling_t<DataType>::filter_impl()
 }
 
 template<typename DataType>
-void voxel_grid_downsampling_t<DataType>::filter_impl(point_cloud_ptr output)
+void voxel_grid_downsampling_t<DataType>::accumulate_hash(
+    voxel_data_soa_t& merged_voxel_data)
 {
-  if (!output) {
-    return;
-  }
-  if (!m_cloud || m_cloud->empty()) {
-    output->clear();
-    return;
-  }
-
   // 定义常量
   constexpr std::size_t k_parallel_threshold = 1024;
   constexpr std::size_t kMaxVoxelsPerThread = 1000;
 
   const std::size_t total_points = m_cloud->size();
-  const bool has_normals = !m_cloud->normals.empty();
-  const bool has_colors = !m_cloud->colors.empty();
 
   // 确定线程数量
   const std::size_t num_threads =
@@ -427,8 +450,6 @@ void voxel_grid_downsampling_t<DataType>::filter_impl(point_cloud_ptr output)
            thread_id,
            start_idx,
            end_idx,
-           has_normals,
-           has_colors,
            &thread_voxel_maps,
            &thread_voxel_data]()
           {
@@ -458,7 +479,6 @@ void voxel_grid_downsampling_t<DataType>::filter_impl(point_cloud_ptr output)
 
   // 合并所有线程的结果
   std::unordered_map<voxel_key_t, std::size_t, key_hash> merged_voxel_map;
-  voxel_data_soa_t merged_voxel_data;
 
   // 估计合并后的体素数量
   std::size_t total_voxels = 0;
@@ -472,6 +492,160 @@ void voxel_grid_downsampling_t<DataType>::filter_impl(point_cloud_ptr output)
                     thread_voxel_data,
                     merged_voxel_map,
                     merged_voxel_data);
+}
+
+template<typename DataType>
+void voxel_grid_downsampling_t<DataType>::accumulate_sorted(
+    voxel_data_soa_t& merged_voxel_data)
+{
+  constexpr std::size_t k_parallel_threshold = 1024;
+
+  const std::size_t total_points = m_cloud->size();
+  const bool has_normals = !m_cloud->normals.empty();
+  const bool has_colors = !m_cloud->colors.empty();
+  const auto& points = m_cloud->points;
+
+  // 点数决定是否并行，之后各步按块执行时不再比较阈值
+  const bool parallel = m_enable_parallel && total_points > k_parallel_threshold;
+
+  // 计算体素键：边界已知时循环体无分支，便于编译器向量化
+  std::vector<voxel_key_t> keys(total_points);
+  std::vector<std::size_t> order(total_points);
+  if (m_bounds_computed) {
+    const auto voxel_size = static_cast<DataType>(m_voxel_size);
+    const auto span_x = static_cast<voxel_key_t>(m_span_x);
+    const auto span_xy = span_x * static_cast<voxel_key_t>(m_span_y);
+    const int min_ix = m_min_ix;
+    const int min_iy = m_min_iy;
+    const int min_iz = m_min_iz;
+    toolbox::concurrent::parallel_for_chunks(
+        total_points,
+        0,
+        parallel,
+        [&](std::size_t start_idx, std::size_t end_idx)
+        {
+          for (std::size_t i = start_idx; i < end_idx; ++i) {
+            const auto& point = points[i];
+            const int rel_x =
+                static_cast<int>(std::floor(point.x / voxel_size)) - min_ix;
+            const int rel_y =
+                static_cast<int>(std::floor(point.y / voxel_size)) - min_iy;
+            const int rel_z =
+                static_cast<int>(std::floor(point.z / voxel_size)) - min_iz;
+            keys[i] = static_cast<voxel_key_t>(rel_z) * span_xy
+                + static_cast<voxel_key_t>(rel_y) * span_x
+                + static_cast<voxel_key_t>(rel_x);
+            order[i] = i;
+          }
+        });
+  } else {
+    toolbox::concurrent::parallel_for_chunks(
+        total_points,
+        0,
+        parallel,
+        [&](std::size_t start_idx, std::size_t end_idx)
+        {
+          for (std::size_t i = start_idx; i < end_idx; ++i) {
+            const auto& point = points[i];
+            keys[i] = compute_voxel_key(
+                static_cast<int>(std::floor(point.x / m_voxel_size)),
+                static_cast<int>(std::floor(point.y / m_voxel_size)),
+                static_cast<int>(std::floor(point.z / m_voxel_size)));
+            order[i] = i;
+          }
+        });
+  }
+
+  // 键的有效位数决定基数排序的轮数
+  unsigned key_bits = sizeof(voxel_key_t) * 8;
+  if (m_bounds_computed) {
+    const voxel_key_t max_key = compute_voxel_key(m_max_ix, m_max_iy, m_max_iz);
+    key_bits = 0;
+    for (voxel_key_t remaining = max_key; remaining != 0; remaining >>= 1U) {
+      ++key_bits;
+    }
+  }
+  toolbox::concurrent::parallel_radix_sort_pairs(keys, order, key_bits, parallel);
+
+  // 相同键的点连续排列，每段对应一个体素
+  std::vector<std::size_t> segment_begins;
+  segment_begins.reserve(estimate_voxel_count() + 1);
+  segment_begins.push_back(0);
+  for (std::size_t i = 1; i < total_points; ++i) {
+    if (keys[i] != keys[i - 1]) {
+      segment_begins.push_back(i);
+    }
+  }
+  const std::size_t num_voxels = segment_begins.size();
+  segment_begins.push_back(total_points);
+
+  // 每个体素只属于一个分块，分段累加无需同步
+  merged_voxel_data.resize(num_voxels);
+  toolbox::concurrent::parallel_for_chunks(
+      num_voxels,
+      0,
+      parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t v = start_idx; v < end_idx; ++v) {
+          for (std::size_t i = segment_begins[v];
+               i < segment_begins[v + 1];
+               ++i)
+          {
+            const std::size_t idx = order[i];
+            merged_voxel_data.sum_x[v] += points[idx].x;
+            merged_voxel_data.sum_y[v] += points[idx].y;
+            merged_voxel_data.sum_z[v] += points[idx].z;
+            if (has_normals) {
+              const auto& normal = m_cloud->normals[idx];
+              merged_voxel_data.sum_nx[v] += normal.x;
+              merged_voxel_data.sum_ny[v] += normal.y;
+              merged_voxel_data.sum_nz[v] += normal.z;
+            }
+            if (has_colors) {
+              const auto& color = m_cloud->colors[idx];
+              merged_voxel_data.sum_r[v] += color.x;
+              merged_voxel_data.sum_g[v] += color.y;
+              merged_voxel_data.sum_b[v] += color.z;
+            }
+          }
+          merged_voxel_data.counts[v] =
+              segment_begins[v + 1] - segment_begins[v];
+        }
+      });
+}
+
+template<typename DataType>
+void voxel_grid_downsampling_t<DataType>::filter_impl(point_cloud_ptr output)
+{
+  if (!output) {
+    return;
+  }
+  if (!m_cloud || m_cloud->empty()) {
+    output->clear();
+    return;
+  }
+
+  // 定义常量
+  constexpr std::size_t k_parallel_threshold = 1024;
+
+  const std::size_t total_points = m_cloud->size();
+  const bool has_normals = !m_cloud->normals.empty();
+  const bool has_colors = !m_cloud->colors.empty();
+
+  // 确定线程数量
+  const std::size_t num_threads =
+      m_enable_parallel && total_points > k_parallel_threshold
+      ? std::thread::hardware_concurrency()
+      : 1;
+
+  // 累加每个体素的坐标、法线和颜色
+  voxel_data_soa_t merged_voxel_data;
+  if (m_engine == engine_t::sort) {
+    accumulate_sorted(merged_voxel_data);
+  } else {
+    accumulate_hash(merged_voxel_data);
+  }
 
   // 生成输出点云
   const std::size_t num_voxels = merged_voxel_data.size();
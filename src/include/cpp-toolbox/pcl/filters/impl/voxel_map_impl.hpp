@@ -0,0 +1,343 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <cpp-toolbox/concurrent/parallel.hpp>
+#include <cpp-toolbox/logger/thread_logger.hpp>
+
+namespace toolbox::pcl
+{
+
+template<typename DataType>
+std::size_t voxel_map_t<DataType>::insert(const point_cloud& cloud)
+{
+  return insert_single(cloud, nullptr);
+}
+
+template<typename DataType>
+std::size_t voxel_map_t<DataType>::insert(const point_cloud& cloud,
+                                          const transform_t& transform)
+{
+  return insert_single(cloud, &transform);
+}
+
+template<typename DataType>
+std::size_t voxel_map_t<DataType>::insert_single(const point_cloud& cloud,
+                                                 const transform_t* transform)
+{
+  if (!(m_voxel_size > 0.0F)) {
+    LOG_ERROR_S << "voxel_map_t: Voxel size must be positive, got " << m_voxel_size;
+    return 0;
+  }
+  const bool has_normals = cloud.normals.size() == cloud.size();
+  const bool has_colors = cloud.colors.size() == cloud.size();
+  m_staging.points.resize(cloud.size());
+  m_staging.normals.resize(has_normals ? cloud.size() : 0);
+  m_staging.colors.resize(has_colors ? cloud.size() : 0);
+  stage_cloud(cloud, transform, 0, has_normals, has_colors);
+  return accumulate_staged(has_normals, has_colors);
+}
+
+template<typename DataType>
+std::size_t voxel_map_t<DataType>::insert(const std::vector<point_cloud>& clouds,
+                                          const std::vector<transform_t>& transforms)
+{
+  if (!(m_voxel_size > 0.0F)) {
+    LOG_ERROR_S << "voxel_map_t: Voxel size must be positive, got " << m_voxel_size;
+    return 0;
+  }
+  if (!transforms.empty() && transforms.size() != clouds.size()) {
+    LOG_ERROR_S << "voxel_map_t: Got " << transforms.size() << " transforms for "
+                << clouds.size() << " clouds";
+    return 0;
+  }
+
+  std::size_t total_points = 0;
+  bool has_normals = true;
+  bool has_colors = true;
+  for (const auto& cloud : clouds) {
+    total_points += cloud.size();
+    has_normals = has_normals && cloud.normals.size() == cloud.size();
+    has_colors = has_colors && cloud.colors.size() == cloud.size();
+  }
+
+  m_staging.points.resize(total_points);
+  m_staging.normals.resize(has_normals ? total_points : 0);
+  m_staging.colors.resize(has_colors ? total_points : 0);
+  std::size_t offset = 0;
+  for (std::size_t c = 0; c < clouds.size(); ++c) {
+    stage_cloud(clouds[c],
+                transforms.empty() ? nullptr : &transforms[c],
+                offset,
+                has_normals,
+                has_colors);
+    offset += clouds[c].size();
+  }
+  return accumulate_staged(has_normals, has_colors);
+}
+
+template<typename DataType>
+void voxel_map_t<DataType>::stage_cloud(const point_cloud& cloud,
+                                        const transform_t* transform,
+                                        std::size_t offset,
+                                        bool has_normals,
+                                        bool has_colors)
+{
+  toolbox::concurrent::parallel_for_chunks(
+      cloud.size(),
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t i = start_idx; i < end_idx; ++i) {
+          auto& point = m_staging.points[offset + i];
+          point = cloud.points[i];
+          if (has_normals) {
+            m_staging.normals[offset + i] = cloud.normals[i];
+          }
+          if (has_colors) {
+            m_staging.colors[offset + i] = cloud.colors[i];
+          }
+          if (transform == nullptr) {
+            continue;
+          }
+
+          const auto& t = *transform;
+          const toolbox::types::point_t<data_type> src = point;
+          point.x = t(0, 0) * src.x + t(0, 1) * src.y + t(0, 2) * src.z + t(0, 3);
+          point.y = t(1, 0) * src.x + t(1, 1) * src.y + t(1, 2) * src.z + t(1, 3);
+          point.z = t(2, 0) * src.x + t(2, 1) * src.y + t(2, 2) * src.z + t(2, 3);
+          if (has_normals) {
+            auto& normal = m_staging.normals[offset + i];
+            const toolbox::types::point_t<data_type> n = normal;
+            normal.x = t(0, 0) * n.x + t(0, 1) * n.y + t(0, 2) * n.z;
+            normal.y = t(1, 0) * n.x + t(1, 1) * n.y + t(1, 2) * n.z;
+            normal.z = t(2, 0) * n.x + t(2, 1) * n.y + t(2, 2) * n.z;
+          }
+        }
+      });
+}
+
+template<typename DataType>
+std::size_t voxel_map_t<DataType>::accumulate_staged(bool has_normals, bool has_colors)
+{
+  const auto& points = m_staging.points;
+  const std::size_t total_points = points.size();
+  if (total_points == 0) {
+    return 0;
+  }
+
+  // 法线和颜色只有在每次插入都提供时才有意义 / Normals and colors are only
+  // meaningful when every insertion provides them
+  if (empty()) {
+    m_has_normals = has_normals;
+    m_has_colors = has_colors;
+  } else {
+    m_has_normals = m_has_normals && has_normals;
+    m_has_colors = m_has_colors && has_colors;
+  }
+  const bool add_normals = m_has_normals;
+  const bool add_colors = m_has_colors;
+
+  // 计算体素键 / Compute voxel keys
+  std::vector<voxel_key_t> keys(total_points);
+  std::vector<std::size_t> order(total_points);
+  const auto voxel_size = static_cast<data_type>(m_voxel_size);
+  toolbox::concurrent::parallel_for_chunks(
+      total_points,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t i = start_idx; i < end_idx; ++i) {
+          keys[i] = voxel_grid_downsampling_t<DataType>::pack_voxel_key(
+              static_cast<int>(std::floor(points[i].x / voxel_size)),
+              static_cast<int>(std::floor(points[i].y / voxel_size)),
+              static_cast<int>(std::floor(points[i].z / voxel_size)));
+          order[i] = i;
+        }
+      });
+
+  // 21位 x 3 的键只需63位 / Keys of 3 x 21 bits need 63 bits
+  toolbox::concurrent::parallel_radix_sort_pairs(keys, order, 63, m_enable_parallel);
+
+  std::vector<std::size_t> segment_begins;
+  segment_begins.push_back(0);
+  for (std::size_t i = 1; i < total_points; ++i) {
+    if (keys[i] != keys[i - 1]) {
+      segment_begins.push_back(i);
+    }
+  }
+  const std::size_t num_segments = segment_begins.size();
+  segment_begins.push_back(total_points);
+
+  // 每个不同的键只查一次哈希表，新体素追加到末尾 / One hash lookup per distinct
+  // key, new voxels are appended
+  std::vector<std::size_t> segment_slots(num_segments);
+  m_slots.reserve(m_slots.size() + num_segments);
+  std::size_t num_slots = m_slot_keys.size();
+  for (std::size_t s = 0; s < num_segments; ++s) {
+    const voxel_key_t key = keys[segment_begins[s]];
+    auto [iter, inserted] = m_slots.try_emplace(key, num_slots);
+    if (inserted) {
+      m_slot_keys.push_back(key);
+      ++num_slots;
+    }
+    segment_slots[s] = iter->second;
+  }
+  m_voxels.resize(num_slots);
+
+  // 每个体素只属于一段，分段累加无需同步 / Each voxel belongs to one segment, so
+  // the segmented accumulation needs no synchronization
+  const std::size_t max_points = m_max_points_per_voxel == 0
+      ? std::numeric_limits<std::size_t>::max()
+      : m_max_points_per_voxel;
+  std::vector<std::size_t> added(num_segments, 0);
+  toolbox::concurrent::parallel_for_chunks(
+      num_segments,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t s = start_idx; s < end_idx; ++s) {
+          const std::size_t slot = segment_slots[s];
+          const std::size_t current = m_voxels.counts[slot];
+          const std::size_t room = current < max_points ? max_points - current : 0;
+          const std::size_t count =
+              std::min(room, segment_begins[s + 1] - segment_begins[s]);
+
+          for (std::size_t i = segment_begins[s]; i < segment_begins[s] + count; ++i) {
+            const std::size_t idx = order[i];
+            m_voxels.sum_x[slot] += points[idx].x;
+            m_voxels.sum_y[slot] += points[idx].y;
+            m_voxels.sum_z[slot] += points[idx].z;
+            if (add_normals) {
+              m_voxels.sum_nx[slot] += m_staging.normals[idx].x;
+              m_voxels.sum_ny[slot] += m_staging.normals[idx].y;
+              m_voxels.sum_nz[slot] += m_staging.normals[idx].z;
+            }
+            if (add_colors) {
+              m_voxels.sum_r[slot] += m_staging.colors[idx].x;
+              m_voxels.sum_g[slot] += m_staging.colors[idx].y;
+              m_voxels.sum_b[slot] += m_staging.colors[idx].z;
+            }
+          }
+          m_voxels.counts[slot] += count;
+          added[s] = count;
+        }
+      });
+
+  std::size_t total_added = 0;
+  for (const auto count : added) {
+    total_added += count;
+  }
+  return total_added;
+}
+
+template<typename DataType>
+std::size_t voxel_map_t<DataType>::remove_outside(
+    const toolbox::types::point_t<data_type>& center, data_type radius)
+{
+  const data_type radius_sq = radius * radius;
+  std::size_t slot = 0;
+  std::size_t removed = 0;
+
+  // 把末尾的体素移到被删除的位置 / Move the last voxel into each removed slot
+  while (slot < m_slot_keys.size()) {
+    const data_type inv_count = static_cast<data_type>(1.0) / m_voxels.counts[slot];
+    const data_type dx = m_voxels.sum_x[slot] * inv_count - center.x;
+    const data_type dy = m_voxels.sum_y[slot] * inv_count - center.y;
+    const data_type dz = m_voxels.sum_z[slot] * inv_count - center.z;
+    if (dx * dx + dy * dy + dz * dz <= radius_sq) {
+      ++slot;
+      continue;
+    }
+
+    const std::size_t last = m_slot_keys.size() - 1;
+    m_slots.erase(m_slot_keys[slot]);
+    if (slot != last) {
+      m_slot_keys[slot] = m_slot_keys[last];
+      m_slots[m_slot_keys[slot]] = slot;
+      m_voxels.sum_x[slot] = m_voxels.sum_x[last];
+      m_voxels.sum_y[slot] = m_voxels.sum_y[last];
+      m_voxels.sum_z[slot] = m_voxels.sum_z[last];
+      m_voxels.sum_nx[slot] = m_voxels.sum_nx[last];
+      m_voxels.sum_ny[slot] = m_voxels.sum_ny[last];
+      m_voxels.sum_nz[slot] = m_voxels.sum_nz[last];
+      m_voxels.sum_r[slot] = m_voxels.sum_r[last];
+      m_voxels.sum_g[slot] = m_voxels.sum_g[last];
+      m_voxels.sum_b[slot] = m_voxels.sum_b[last];
+      m_voxels.counts[slot] = m_voxels.counts[last];
+    }
+    m_slot_keys.pop_back();
+    m_voxels.resize(last);
+    ++removed;
+  }
+  return removed;
+}
+
+template<typename DataType>
+typename voxel_map_t<DataType>::point_cloud voxel_map_t<DataType>::extract() const
+{
+  auto output = std::make_shared<point_cloud>();
+  extract(output);
+  return *output;
+}
+
+template<typename DataType>
+void voxel_map_t<DataType>::extract(point_cloud_ptr output) const
+{
+  if (!output) {
+    return;
+  }
+
+  const std::size_t num_voxels = size();
+  output->clear();
+  output->points.resize(num_voxels);
+  if (m_has_normals && num_voxels > 0) {
+    output->normals.resize(num_voxels);
+  }
+  if (m_has_colors && num_voxels > 0) {
+    output->colors.resize(num_voxels);
+  }
+
+  toolbox::concurrent::parallel_for_chunks(
+      num_voxels,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t i = start_idx; i < end_idx; ++i) {
+          const data_type inv_count =
+              static_cast<data_type>(1.0) / m_voxels.counts[i];
+          output->points[i].x = m_voxels.sum_x[i] * inv_count;
+          output->points[i].y = m_voxels.sum_y[i] * inv_count;
+          output->points[i].z = m_voxels.sum_z[i] * inv_count;
+          if (!output->normals.empty()) {
+            output->normals[i].x = m_voxels.sum_nx[i] * inv_count;
+            output->normals[i].y = m_voxels.sum_ny[i] * inv_count;
+            output->normals[i].z = m_voxels.sum_nz[i] * inv_count;
+          }
+          if (!output->colors.empty()) {
+            output->colors[i].x = m_voxels.sum_r[i] * inv_count;
+            output->colors[i].y = m_voxels.sum_g[i] * inv_count;
+            output->colors[i].z = m_voxels.sum_b[i] * inv_count;
+          }
+        }
+      });
+}
+
+template<typename DataType>
+void voxel_map_t<DataType>::clear()
+{
+  m_voxels.clear();
+  m_slot_keys.clear();
+  m_slots.clear();
+  m_has_normals = true;
+  m_has_colors = true;
+}
+
+}  // namespace toolbox::pcl
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <cpp-toolbox/cpp-toolbox_export.hpp>
+#include <cpp-toolbox/pcl/filters/filters.hpp>
+#include <cpp-toolbox/pcl/knn/kdtree.hpp>
+#include <cpp-toolbox/pcl/knn/neighborhood_graph.hpp>
+#include <cpp-toolbox/types/point.hpp>
+
+namespace toolbox::pcl
+{
+
+/**
+ * @brief 统计离群点去除滤波器 / Statistical outlier removal filter
+ *
+ * 对每个点求到其k个最近邻的平均距离，再对所有点的平均距离求均值μ和标准差σ，平均距离大于
+ * μ + std_mul·σ 的点视为离群点。近邻按块调用kneighbors_batch，块在线程池上并行处理，每块同时
+ * 累加距离和与平方和，因此不需要额外的归约遍历，也不产生中间点云。
+ * Computes each point's mean distance to its k nearest neighbors, then the mean μ
+ * and standard deviation σ of those values over the cloud; points whose mean
+ * distance exceeds μ + std_mul·σ are outliers. Neighbors are fetched through
+ * kneighbors_batch in blocks processed in parallel on the thread pool, and each
+ * block accumulates its sum and sum of squares on the way, so no separate
+ * reduction pass or intermediate cloud is needed.
+ *
+ * @tparam DataType 数据类型（如float或double） / Data type (e.g., float or double)
+ * @tparam KNN KNN搜索算法类型，默认为kdtree_t / KNN search algorithm type, kdtree_t by default
+ *
+ * @code
+ * statistical_outlier_removal_t<float> sor(20, 1.0f);
+ * sor.set_input(cloud);
+ * sor.enable_parallel(true);
+ * auto denoised = sor.filter();
+ * const auto inliers = sor.filter_indices();  // 只要索引 / Indices only
+ * @endcode
+ */
+template<typename DataType,
+         typename KNN = kdtree_generic_t<point_t<DataType>,
+                                         toolbox::metrics::L2Metric<DataType>>>
+class CPP_TOOLBOX_EXPORT statistical_outlier_removal_t
+    : public filter_t<statistical_outlier_removal_t<DataType, KNN>, DataType>
+{
+public:
+  using data_type = DataType;
+  using base_type = filter_t<statistical_outlier_removal_t<DataType, KNN>, DataType>;
+  using point_cloud = toolbox::types::point_cloud_t<data_type>;
+  using point_cloud_ptr =
+      std::shared_ptr<toolbox::types::point_cloud_t<data_type>>;
+  using knn_type = KNN;
+
+  /**
+   * @param num_neighbors 用于平均距离的近邻数（不含自身） / Neighbors used for the
+   * mean distance, excluding the point itself
+   * @param std_mul 标准差倍数阈值 / Standard deviation multiplier
+   */
+  statistical_outlier_removal_t(std::size_t num_neighbors, data_type std_mul)
+      : m_num_neighbors(num_neighbors), m_std_mul(std_mul)
+  {
+  }
+  ~statistical_outlier_removal_t() = default;
+
+public:
+  statistical_outlier_removal_t(const statistical_outlier_removal_t&) = delete;
+  statistical_outlier_removal_t& operator=(const statistical_outlier_removal_t&) =
+      delete;
+  statistical_outlier_removal_t(statistical_outlier_removal_t&&) = delete;
+  statistical_outlier_removal_t& operator=(statistical_outlier_removal_t&&) = delete;
+
+  std::size_t set_input_impl(const point_cloud& cloud);
+  std::size_t set_input_impl(const point_cloud_ptr& cloud);
+  void enable_parallel_impl(bool enable);
+  point_cloud filter_impl();
+  void filter_impl(point_cloud_ptr output);
+
+  /**
+   * @brief 只计算保留点的索引，按输入顺序排列 / Compute only the kept indices, in input
+   * order
+   */
+  std::vector<std::size_t> filter_indices();
+
+  /**
+   * @brief 反转结果，只保留离群点 / Invert the result and keep only the outliers
+   */
+  void set_negative(bool negative) { m_negative = negative; }
+
+  void set_num_neighbors(std::size_t num_neighbors) { m_num_neighbors = num_neighbors; }
+  [[nodiscard]] std::size_t get_num_neighbors() const noexcept { return m_num_neighbors; }
+  void set_std_mul(data_type std_mul) { m_std_mul = std_mul; }
+  [[nodiscard]] data_type get_std_mul() const noexcept { return m_std_mul; }
+
+  /// 上一次过滤的平均距离阈值 / Mean-distance threshold of the last run
+  [[nodiscard]] data_type get_threshold() const noexcept { return m_threshold; }
+
+private:
+  std::size_t m_num_neighbors = 0;
+  data_type m_std_mul = data_type(1);
+  data_type m_threshold = data_type(0);
+  bool m_enable_parallel = false;
+  bool m_negative = false;
+  point_cloud_ptr m_cloud;
+  knn_type m_knn;
+};
+
+/**
+ * @brief 半径离群点去除滤波器 / Radius outlier removal filter
+ *
+ * 半径内（不含自身）少于min_neighbors个邻居的点视为离群点。判定等价于第min_neighbors + 1个
+ * 最近邻（含自身）的距离不超过半径，因此同样使用按块的kneighbors_batch，每个点只取固定数量的
+ * 近邻，而不必收集半径内的全部点。
+ * Points with fewer than min_neighbors neighbors (excluding themselves) within the
+ * radius are outliers. This is equivalent to the (min_neighbors + 1)-th nearest
+ * neighbor, the point itself included, lying within the radius, so the filter
+ * also uses blocked kneighbors_batch and fetches a fixed number of neighbors per
+ * point instead of collecting everything inside the radius.
+ *
+ * @tparam DataType 数据类型（如float或double） / Data type (e.g., float or double)
+ * @tparam KNN KNN搜索算法类型，默认为kdtree_t / KNN search algorithm type, kdtree_t by default
+ *
+ * @code
+ * radius_outlier_removal_t<float> ror(0.5f, 5);
+ * ror.set_input(cloud);
+ * ror.enable_parallel(true);
+ * auto denoised = ror.filter();
+ * @endcode
+ */
+template<typename DataType,
+         typename KNN = kdtree_generic_t<point_t<DataType>,
+                                         toolbox::metrics::L2Metric<DataType>>>
+class CPP_TOOLBOX_EXPORT radius_outlier_removal_t
+    : public filter_t<radius_outlier_removal_t<DataType, KNN>, DataType>
+{
+public:
+  using data_type = DataType;
+  using base_type = filter_t<radius_outlier_removal_t<DataType, KNN>, DataType>;
+  using point_cloud = toolbox::types::point_cloud_t<data_type>;
+  using point_cloud_ptr =
+      std::shared_ptr<toolbox::types::point_cloud_t<data_type>>;
+  using knn_type = KNN;
+
+  /**
+   * @param radius 搜索半径 / Search radius
+   * @param min_neighbors 半径内至少需要的邻居数（不含自身） / Minimum neighbors within
+   * the radius, excluding the point itself
+   */
+  radius_outlier_removal_t(data_type radius, std::size_t min_neighbors)
+      : m_radius(radius), m_min_neighbors(min_neighbors)
+  {
+  }
+  ~radius_outlier_removal_t() = default;
+
+public:
+  radius_outlier_removal_t(const radius_outlier_removal_t&) = delete;
+  radius_outlier_removal_t& operator=(const radius_outlier_removal_t&) = delete;
+  radius_outlier_removal_t(radius_outlier_removal_t&&) = delete;
+  radius_outlier_removal_t& operator=(radius_outlier_removal_t&&) = delete;
+
+  std::size_t set_input_impl(const point_cloud& cloud);
+  std::size_t set_input_impl(const point_cloud_ptr& cloud);
+  void enable_parallel_impl(bool enable);
+  point_cloud filter_impl();
+  void filter_impl(point_cloud_ptr output);
+
+  /**
+   * @brief 只计算保留点的索引，按输入顺序排列 / Compute only the kept indices, in input
+   * order
+   */
+  std::vector<std::size_t> filter_indices();
+
+  /**
+   * @brief 反转结果，只保留离群点 / Invert the result and keep only the outliers
+   */
+  void set_negative(bool negative) { m_negative = negative; }
+
+  void set_radius(data_type radius) { m_radius = radius; }
+  [[nodiscard]] data_type get_radius() const noexcept { return m_radius; }
+  void set_min_neighbors(std::size_t min_neighbors) { m_min_neighbors = min_neighbors; }
+  [[nodiscard]] std::size_t get_min_neighbors() const noexcept { return m_min_neighbors; }
+
+private:
+  data_type m_radius = data_type(1);
+  std::size_t m_min_neighbors = 1;
+  bool m_enable_parallel = false;
+  bool m_negative = false;
+  point_cloud_ptr m_cloud;
+  knn_type m_knn;
+};
+
+}  // namespace toolbox::pcl
+
+#include <cpp-toolbox/pcl/filters/impl/outlier_removal_impl.hpp>
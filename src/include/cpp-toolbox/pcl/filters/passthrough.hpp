@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <cpp-toolbox/cpp-toolbox_export.hpp>
+#include <cpp-toolbox/pcl/filters/filters.hpp>
+#include <cpp-toolbox/types/point.hpp>
+
+namespace toolbox::pcl
+{
+
+/**
+ * @brief 直通滤波可用的字段 / Fields usable by the passthrough filter
+ */
+enum class passthrough_field_t
+{
+  x,
+  y,
+  z,
+  normal_x,
+  normal_y,
+  normal_z,
+  r,
+  g,
+  b
+};
+
+/**
+ * @brief 按字段取值范围过滤的直通滤波器 / Passthrough filter on per-field value ranges
+ *
+ * 可以对坐标、法线或颜色的多个字段设置范围，所有范围按与组合。每个范围对一块数据做一次无分支
+ * 的遍历，掩码并行压缩为索引。含NaN的点在任何范围下都视为不满足。
+ * Ranges can be set on several coordinate, normal or color fields and are
+ * combined with a logical and. Each range is one branch-free pass over a chunk,
+ * and the mask is compacted into indices in parallel. Points with NaN values
+ * never satisfy a range.
+ *
+ * @tparam DataType 数据类型（如float或double） / Data type (e.g., float or double)
+ *
+ * @code
+ * passthrough_t<float> pass;
+ * pass.set_range(passthrough_field_t::z, -1.0f, 3.0f);
+ * pass.set_range(passthrough_field_t::x, 0.0f, 50.0f);
+ * pass.set_input(cloud);
+ * auto roi = pass.filter();
+ * @endcode
+ */
+template<typename DataType>
+class CPP_TOOLBOX_EXPORT passthrough_t
+    : public filter_t<passthrough_t<DataType>, DataType>
+{
+public:
+  using data_type = DataType;
+  using base_type = filter_t<passthrough_t<DataType>, DataType>;
+  using point_cloud = toolbox::types::point_cloud_t<data_type>;
+  using point_cloud_ptr =
+      std::shared_ptr<toolbox::types::point_cloud_t<data_type>>;
+
+  /// 单个字段的闭区间 / Closed range on one field
+  struct range_t
+  {
+    passthrough_field_t field;
+    data_type min;
+    data_type max;
+  };
+
+  passthrough_t() = default;
+  passthrough_t(passthrough_field_t field, data_type min_value, data_type max_value)
+  {
+    set_range(field, min_value, max_value);
+  }
+  ~passthrough_t() = default;
+
+public:
+  passthrough_t(const passthrough_t&) = delete;
+  passthrough_t& operator=(const passthrough_t&) = delete;
+  passthrough_t(passthrough_t&&) = delete;
+  passthrough_t& operator=(passthrough_t&&) = delete;
+
+  std::size_t set_input_impl(const point_cloud& cloud);
+  std::size_t set_input_impl(const point_cloud_ptr& cloud);
+  void enable_parallel_impl(bool enable);
+  point_cloud filter_impl();
+  void filter_impl(point_cloud_ptr output);
+
+  /**
+   * @brief 只计算保留点的索引，按输入顺序排列 / Compute only the kept indices, in input
+   * order
+   * @return 索引；请求的法线或颜色不存在时返回空 / Indices, empty when a requested
+   * normal or color channel is missing
+   */
+  std::vector<std::size_t> filter_indices();
+
+  /**
+   * @brief 设置字段范围，已有同一字段的范围时替换 / Set a field range, replacing an
+   * existing range on the same field
+   */
+  void set_range(passthrough_field_t field, data_type min_value, data_type max_value);
+  void clear_ranges() { m_ranges.clear(); }
+  [[nodiscard]] const std::vector<range_t>& get_ranges() const noexcept { return m_ranges; }
+
+  /**
+   * @brief 反转结果，只保留范围外的点 / Invert the result and keep the points outside
+   */
+  void set_negative(bool negative) { m_negative = negative; }
+
+private:
+  std::vector<range_t> m_ranges;
+  bool m_negative = false;
+  bool m_enable_parallel = false;
+  point_cloud_ptr m_cloud;
+};
+
+}  // namespace toolbox::pcl
+
+#include <cpp-toolbox/pcl/filters/impl/passthrough_impl.hpp>
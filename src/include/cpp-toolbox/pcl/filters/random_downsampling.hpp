@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstdint>
+#include <random>
+#include <vector>
+
 #include <cpp-toolbox/pcl/filters/filters.hpp>
 #include <cpp-toolbox/types/point.hpp>
 #include <cpp-toolbox/utils/random.hpp>
@@ -7,6 +11,43 @@
 namespace toolbox::pcl
 {
 
+/**
+ * @brief 随机下采样滤波器 / Random downsampling filter
+ *
+ * 按比例随机保留点。索引选择与线程数无关：点云按固定大小的块划分，先用主随机流按超几何
+ * 分布把采样数分配到各块，每块再用由种子和块号派生的独立随机流选择不重复的索引，因此结果是
+ * 均匀的无放回样本，且同一种子在串行和并行下得到相同结果。块内使用Floyd算法和位图，只需与
+ * 采样数成正比的随机数。
+ * Keeps a random fraction of the points. Index selection does not depend on the
+ * thread count: the cloud is split into fixed-size blocks, a master stream
+ * splits the sample count across blocks with sequential hypergeometric draws, so
+ * the result is a uniform sample without replacement, and every block picks
+ * distinct indices from its own stream derived from the seed and block number,
+ * so a seed gives the same result serially and in parallel. Blocks use Floyd's
+ * algorithm over a bitmap and need random numbers in proportion to the sample
+ * count only.
+ *
+ * 分层模式把点按边长为stratum_size的网格分层，再在按单元排序的序列上做系统抽样，每个单元
+ * 得到按比例的份额（向下或向上取整），空间覆盖更均匀。坐标非有限的点不参与分层抽样。
+ * The stratified mode bins points into a grid with cell edge stratum_size and
+ * draws a systematic sample over the cell-sorted sequence, so every cell gets
+ * its proportional share rounded down or up and coverage is more even. Points
+ * with non-finite coordinates are left out of the stratified sample.
+ *
+ * @tparam DataType 数据类型（如float或double） / Data type (e.g., float or double)
+ *
+ * @code
+ * random_downsampling_t<float> filter(0.1F);
+ * filter.set_seed(7);
+ * filter.enable_parallel(true);
+ * filter.set_input(cloud);
+ * auto indices = filter.filter_indices();  // 不复制点云 / No cloud copy
+ *
+ * filter.set_mode(random_downsampling_t<float>::sampling_mode_t::stratified);
+ * filter.set_stratum_size(2.0F);
+ * auto even = filter.filter();
+ * @endcode
+ */
 template<typename DataType>
 class CPP_TOOLBOX_EXPORT random_downsampling_t
     : public filter_t<random_downsampling_t<DataType>, DataType>
@@ -18,6 +59,15 @@ public:
   using point_cloud_ptr =
       std::shared_ptr<toolbox::types::point_cloud_t<data_type>>;
 
+  /**
+   * @brief 采样方式 / Sampling mode
+   */
+  enum class sampling_mode_t
+  {
+    uniform,    ///< 均匀随机采样 / Uniform random sampling
+    stratified  ///< 按空间网格分层采样 / Spatially stratified sampling
+  };
+
   explicit random_downsampling_t(float ration)
       : m_ration(ration)
   {
@@ -36,12 +86,111 @@ public:
   point_cloud filter_impl();
   void filter_impl(point_cloud_ptr output);
 
+  /**
+   * @brief 只计算被采样点的索引，按输入顺序排列 / Compute only the sampled indices, in
+   * input order
+   */
+  std::vector<std::size_t> filter_indices();
+
+  void set_mode(sampling_mode_t mode) { m_mode = mode; }
+  [[nodiscard]] sampling_mode_t get_mode() const noexcept { return m_mode; }
+
+  /**
+   * @brief 固定随机种子；未设置时每次过滤从全局random_t取一个种子 / Fix the seed;
+   * without one every run draws a seed from the global random_t
+   */
+  void set_seed(std::uint64_t seed)
+  {
+    m_seed = seed;
+    m_has_seed = true;
+  }
+
+  /// 分层模式的网格边长 / Cell edge length of the stratified mode
+  void set_stratum_size(float stratum_size) { m_stratum_size = stratum_size; }
+  [[nodiscard]] float get_stratum_size() const noexcept { return m_stratum_size; }
+
 private:
+  std::vector<std::size_t> uniform_indices(std::size_t sample_count, std::uint64_t seed);
+  std::vector<std::size_t> stratified_indices(std::size_t sample_count,
+                                              std::uint64_t seed);
+
   float m_ration = 1.0F;
+  float m_stratum_size = 1.0F;
+  sampling_mode_t m_mode = sampling_mode_t::uniform;
+  std::uint64_t m_seed = 0;
+  bool m_has_seed = false;
   bool m_enable_parallel = false;
   point_cloud_ptr m_cloud;
+
+  /// 固定的块大小保证结果与线程数无关 / A fixed block size keeps results independent of
+  /// the thread count
+  static constexpr std::size_t k_block_size = 65536;
+  static constexpr std::size_t k_parallel_threshold = 1024;
+};
+
+/**
+ * @brief 分块到达的点云流上的蓄水池采样 / Reservoir sampling over a cloud that arrives
+ * in chunks
+ *
+ * 保持一个容量为capacity的均匀样本，任意时刻都等价于从已见的全部点中无放回均匀抽取。使用
+ * Algorithm L按几何分布跳过点，每块的代价与被替换的点数成正比而不是与块大小成正比。
+ * Keeps a uniform sample of at most capacity points that at any time is
+ * equivalent to drawing without replacement from every point seen so far.
+ * Algorithm L skips ahead geometrically, so a chunk costs time proportional to
+ * the replacements it causes rather than to its size.
+ *
+ * @code
+ * reservoir_sampler_t<float> reservoir(100000, 42);
+ * for (const auto& chunk : stream) {
+ *   reservoir.add(chunk);
+ * }
+ * auto sample = reservoir.sample();
+ * const auto& stream_indices = reservoir.indices();  // 在流中的全局索引 / Global stream indices
+ * @endcode
+ */
+template<typename DataType>
+class CPP_TOOLBOX_EXPORT reservoir_sampler_t
+{
+public:
+  using data_type = DataType;
+  using point_cloud = toolbox::types::point_cloud_t<data_type>;
+
+  explicit reservoir_sampler_t(std::size_t capacity, std::uint64_t seed = 0);
+
+  /**
+   * @brief 添加一块点 / Add a chunk of points
+   *
+   * 法线和颜色只有在每一块都提供时才保留 / Normals and colors are kept only when
+   * every chunk provides them
+   */
+  void add(const point_cloud& chunk);
+
+  /// 当前样本 / Current sample
+  [[nodiscard]] point_cloud sample() const;
+  /// 样本中每个点在流中的全局索引 / Global stream index of every sampled point
+  [[nodiscard]] const std::vector<std::size_t>& indices() const noexcept { return m_indices; }
+  /// 已见的点数 / Number of points seen
+  [[nodiscard]] std::size_t seen() const noexcept { return m_seen; }
+  [[nodiscard]] std::size_t capacity() const noexcept { return m_capacity; }
+
+  /// 清空样本并用新种子重新开始 / Clear the sample and restart with a new seed
+  void reset(std::uint64_t seed);
+
+private:
+  /// 抽取下一个被接受的全局索引 / Draw the next accepted global index
+  void advance();
+
+  std::size_t m_capacity = 0;
+  std::size_t m_seen = 0;
+  std::size_t m_next = 0;
+  double m_weight = 1.0;
+  bool m_has_normals = true;
+  bool m_has_colors = true;
+  std::mt19937_64 m_engine;
+  point_cloud m_sample;
+  std::vector<std::size_t> m_indices;
 };
 
 }  // namespace toolbox::pcl
 
-#include <cpp-toolbox/pcl/filters/impl/random_downsampling_impl.hpp>
\ No newline at end of file
+#include <cpp-toolbox/pcl/filters/impl/random_downsampling_impl.hpp>
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include <cpp-toolbox/pcl/filters/filters.hpp>
 #include <cpp-toolbox/types/point.hpp>
 #include <cpp-toolbox/utils/random.hpp>
@@ -7,6 +9,31 @@
 namespace toolbox::pcl
 {
 
+/**
+ * @brief 均匀网格子采样滤波器 / Uniform grid subsampling filter
+ *
+ * 每个非空网格单元保留距离单元中心最近的原始点，与体素平均不同，输出点都来自输入点云，
+ * 法线和颜色也随点一起保留。点先按单元键做并行基数排序，再对每段相同键的点求距离中心最近者。
+ * Keeps, for every occupied grid cell, the original point nearest to the cell
+ * center. Unlike voxel averaging every output point is an input point, and its
+ * normal and color are kept with it. Points are radix-sorted by cell key in
+ * parallel, then each run of equal keys is reduced to its point nearest the
+ * center.
+ *
+ * @tparam DataType 数据类型（如float或double） / Data type (e.g., float or double)
+ *
+ * @code
+ * uniform_grid_subsampling_t<float> filter(0.1f);
+ * filter.set_input(cloud);
+ * filter.enable_parallel(true);
+ * auto subsampled = filter.filter();
+ * @endcode
+ *
+ * @note 输出按单元键排序（先x、再y、最后z），与输入顺序无关；网格与坐标原点对齐，和
+ * voxel_grid_downsampling_t相同 / Output is ordered by cell key (x fastest, then
+ * y, then z), not by input order; the grid is aligned to the coordinate origin
+ * like voxel_grid_downsampling_t
+ */
 template<typename DataType>
 class CPP_TOOLBOX_EXPORT uniform_grid_subsampling_t
     : public filter_t<uniform_grid_subsampling_t<DataType>, DataType>
@@ -37,10 +64,21 @@ public:
   point_cloud filter_impl();
   void filter_impl(point_cloud_ptr output);
 
+  /**
+   * @brief 只计算保留点的索引 / Compute only the indices of the kept points
+   * @return 输入点云中的索引，每个非空单元一个 / Input point indices, one per
+   * occupied cell
+   */
+  std::vector<std::size_t> filter_indices();
+
 private:
   float m_grid_size = 1.0F;
   bool m_enable_parallel = false;
   point_cloud_ptr m_cloud;
+
+  static constexpr std::size_t k_parallel_threshold = 1024;
 };
 
-}  // namespace toolbox::pcl
\ No newline at end of file
+}  // namespace toolbox::pcl
+
+#include <cpp-toolbox/pcl/filters/impl/uniform_grid_subsampling_impl.hpp>
@@ -20,6 +20,18 @@ public:
   // 体素坐标键类型 - 使用整数代替元组以提高性能
   using voxel_key_t = std::uint64_t;
 
+  /**
+   * @brief 体素累加引擎 / Voxel accumulation engine
+   */
+  enum class engine_t
+  {
+    /// 每线程一个哈希表，最后串行合并 / One hash map per thread, merged serially
+    hash,
+    /// 并行基数排序(键, 索引)后分段归约，适合百万级点云 / Parallel radix sort of
+    /// (key, index) pairs followed by a segmented reduction, suited to 1M+ points
+    sort
+  };
+
   // 体素数据的SoA (Structure of Arrays)结构
   struct voxel_data_soa_t
   {
@@ -45,6 +57,9 @@ public:
     // 添加新体素
     std::size_t add_voxel();
 
+    // 调整体素数量，新体素的累加值为0
+    void resize(std::size_t new_size);
+
     // 获取体素数量
     [[nodiscard]] std::size_t size() const;
 
@@ -81,7 +96,33 @@ public:
   point_cloud filter_impl();
   void filter_impl(point_cloud_ptr output);
 
+  /**
+   * @brief 选择体素累加引擎 / Select the voxel accumulation engine
+   * @param engine 累加引擎，默认为hash / Accumulation engine, hash by default
+   *
+   * @note 两种引擎的质心相同，但输出顺序不同：sort引擎按体素键排序 / Both engines
+   * produce the same centroids in a different order: the sort engine orders
+   * voxels by key
+   */
+  void set_engine(engine_t engine) { m_engine = engine; }
+  [[nodiscard]] engine_t get_engine() const noexcept { return m_engine; }
+
+  /**
+   * @brief 不依赖点云边界的体素键：x、y、z各取低21位 / Voxel key independent of
+   * the cloud bounds: the low 21 bits of x, y and z
+   *
+   * 用于边界未知或会增长的场景，坐标在±2^20个体素内唯一 / Used when the bounds are
+   * unknown or grow over time; unique within ±2^20 voxels of the origin
+   */
+  [[nodiscard]] static voxel_key_t pack_voxel_key(int ix, int iy, int iz) noexcept;
+
 private:
+  // 哈希引擎：每线程哈希表累加后合并
+  void accumulate_hash(voxel_data_soa_t& merged_data);
+
+  // 排序引擎：按体素键基数排序后分段累加
+  void accumulate_sorted(voxel_data_soa_t& merged_data);
+
   // 处理点云数据，将点添加到体素中
   void process_point(
       std::size_t idx,
@@ -108,6 +149,7 @@ private:
   // 成员变量
   float m_voxel_size = 1.0F;
   bool m_enable_parallel = false;
+  engine_t m_engine = engine_t::hash;
   point_cloud_ptr m_cloud;
 
   // 点云边界相关变量
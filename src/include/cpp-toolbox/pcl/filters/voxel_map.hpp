@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <cpp-toolbox/cpp-toolbox_export.hpp>
+#include <cpp-toolbox/pcl/filters/voxel_grid_downsampling.hpp>
+#include <cpp-toolbox/types/point.hpp>
+
+namespace toolbox::pcl
+{
+
+/**
+ * @brief 跨帧累加的增量体素地图 / Incremental voxel map accumulated across frames
+ *
+ * 每个体素保存坐标、法线和颜色的累加值及点数，新扫描只更新它落入的体素，因此融合大量扫描的
+ * 代价与扫描点数成正比，而不是对不断增长的拼接点云反复做体素滤波。体素数据沿用
+ * voxel_grid_downsampling_t的voxel_data_soa_t和与边界无关的体素键。
+ * Every voxel keeps running sums of coordinates, normals and colors plus a point
+ * count. A new scan only touches the voxels it falls into, so fusing many scans
+ * costs time proportional to the scan sizes instead of re-filtering an ever
+ * growing concatenated cloud. Voxel data reuses voxel_data_soa_t and the
+ * bounds-free key of voxel_grid_downsampling_t.
+ *
+ * 批量插入流程：并行变换并计算体素键 -> 并行基数排序(键, 索引) -> 每个不同的键查一次哈希表
+ * -> 并行分段累加。/ Batch insertion: transform and key points in parallel ->
+ * parallel radix sort of (key, index) pairs -> one hash lookup per distinct key
+ * -> parallel segmented accumulation.
+ *
+ * @tparam DataType 数据类型（如float或double） / Data type (e.g., float or double)
+ *
+ * @code
+ * voxel_map_t<float> map(0.2f, 20);  // 每个体素最多累加20个点 / At most 20 points per voxel
+ * map.enable_parallel(true);
+ * for (const auto& [scan, pose] : frames) {
+ *   map.insert(scan, pose);
+ *   map.remove_outside(current_position, 100.0f);  // 只保留局部地图 / Keep a local map
+ * }
+ * auto downsampled = map.extract();
+ * @endcode
+ */
+template<typename DataType>
+class CPP_TOOLBOX_EXPORT voxel_map_t
+{
+public:
+  using data_type = DataType;
+  using point_cloud = toolbox::types::point_cloud_t<data_type>;
+  using point_cloud_ptr = std::shared_ptr<point_cloud>;
+  using transform_t = Eigen::Matrix<data_type, 4, 4>;
+  using voxel_key_t = typename voxel_grid_downsampling_t<DataType>::voxel_key_t;
+  using voxel_data_soa_t = typename voxel_grid_downsampling_t<DataType>::voxel_data_soa_t;
+
+  /**
+   * @param voxel_size 体素边长 / Voxel edge length
+   * @param max_points_per_voxel 每个体素最多累加的点数，0表示不限制；体素满后新点被忽略，
+   * 均值保持稳定 / Maximum points accumulated per voxel, 0 means unlimited; once
+   * a voxel is full new points are ignored so its mean stays stable
+   */
+  explicit voxel_map_t(float voxel_size, std::size_t max_points_per_voxel = 0)
+      : m_voxel_size(voxel_size), m_max_points_per_voxel(max_points_per_voxel)
+  {
+  }
+
+  void enable_parallel(bool enable) { m_enable_parallel = enable; }
+
+  /**
+   * @brief 插入一帧扫描 / Insert one scan
+   * @param cloud 扫描点云，已在地图坐标系下 / Scan already in the map frame
+   * @return 实际累加的点数 / Number of points accumulated
+   */
+  std::size_t insert(const point_cloud& cloud);
+
+  /**
+   * @brief 变换后插入一帧扫描 / Insert one scan after transforming it
+   * @param cloud 传感器坐标系下的扫描 / Scan in the sensor frame
+   * @param transform 传感器到地图的4x4变换，法线只做旋转 / 4x4 sensor-to-map
+   * transform, normals are only rotated
+   * @return 实际累加的点数 / Number of points accumulated
+   */
+  std::size_t insert(const point_cloud& cloud, const transform_t& transform);
+
+  /**
+   * @brief 批量插入多帧扫描，所有点在一次排序中处理 / Insert several scans at once,
+   * all points go through a single sort
+   * @param clouds 扫描点云 / Scans
+   * @param transforms 每帧的变换，为空时视为已在地图坐标系 / Per-scan transforms,
+   * empty when the scans are already in the map frame
+   * @return 实际累加的点数，数量不匹配时返回0 / Number of points accumulated, 0 on a
+   * size mismatch
+   */
+  std::size_t insert(const std::vector<point_cloud>& clouds,
+                     const std::vector<transform_t>& transforms);
+
+  /**
+   * @brief 删除质心离中心超过半径的体素 / Remove voxels whose centroid is farther
+   * than a radius from a center
+   * @return 删除的体素数 / Number of removed voxels
+   */
+  std::size_t remove_outside(const toolbox::types::point_t<data_type>& center,
+                             data_type radius);
+
+  /**
+   * @brief 输出每个体素的均值，耗时与体素数成正比 / Output the mean of every voxel,
+   * in time proportional to the voxel count
+   */
+  point_cloud extract() const;
+  void extract(point_cloud_ptr output) const;
+
+  void clear();
+
+  /// 体素数 / Number of voxels
+  [[nodiscard]] std::size_t size() const noexcept { return m_slot_keys.size(); }
+  [[nodiscard]] bool empty() const noexcept { return m_slot_keys.empty(); }
+  [[nodiscard]] float voxel_size() const noexcept { return m_voxel_size; }
+  [[nodiscard]] std::size_t max_points_per_voxel() const noexcept
+  {
+    return m_max_points_per_voxel;
+  }
+  void set_max_points_per_voxel(std::size_t max_points)
+  {
+    m_max_points_per_voxel = max_points;
+  }
+
+  /// 体素累加数据，第i个体素的键为keys()[i] / Voxel sums, voxel i has key keys()[i]
+  [[nodiscard]] const voxel_data_soa_t& voxel_data() const noexcept { return m_voxels; }
+  [[nodiscard]] const std::vector<voxel_key_t>& keys() const noexcept { return m_slot_keys; }
+
+private:
+  /// 待插入点的临时缓冲 / Staging buffer for points being inserted
+  struct staging_t
+  {
+    std::vector<toolbox::types::point_t<data_type>> points;
+    std::vector<toolbox::types::point_t<data_type>> normals;
+    std::vector<toolbox::types::point_t<data_type>> colors;
+  };
+
+  std::size_t insert_single(const point_cloud& cloud, const transform_t* transform);
+
+  /// 把一帧扫描变换后写入缓冲的[offset, offset + size) / Transform a scan into
+  /// [offset, offset + size) of the staging buffer
+  void stage_cloud(const point_cloud& cloud,
+                   const transform_t* transform,
+                   std::size_t offset,
+                   bool has_normals,
+                   bool has_colors);
+
+  /// 排序、查表并累加缓冲中的点 / Sort, look up and accumulate the staged points
+  std::size_t accumulate_staged(bool has_normals, bool has_colors);
+
+  float m_voxel_size = 1.0F;
+  std::size_t m_max_points_per_voxel = 0;
+  bool m_enable_parallel = false;
+  bool m_has_normals = true;
+  bool m_has_colors = true;
+
+  voxel_data_soa_t m_voxels;
+  std::vector<voxel_key_t> m_slot_keys;
+  std::unordered_map<voxel_key_t, std::size_t> m_slots;
+  staging_t m_staging;
+
+  static constexpr std::size_t k_parallel_threshold = 1024;
+};
+
+}  // namespace toolbox::pcl
+
+#include <cpp-toolbox/pcl/filters/impl/voxel_map_impl.hpp>
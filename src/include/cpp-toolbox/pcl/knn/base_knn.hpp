@@ -214,10 +214,54 @@ public:
         query, radius, indices, distances);
   }
 
+  /**
+   * @brief 批量K近邻搜索 / Batch K-nearest neighbors search
+   * @param queries 查询点集合 / Query points
+   * @param num_neighbors 每个查询的最近邻数量 / Number of nearest neighbors per query
+   * @param indices [out] 每个查询的近邻索引 / Neighbor indices of each query
+   * @param distances [out] 每个查询的近邻距离 / Neighbor distances of each query
+   * @return 是否成功 / Whether successful
+   *
+   * @code
+   * // 一次匹配所有描述子 / Match all descriptors at once
+   * std::vector<std::vector<std::size_t>> indices;
+   * std::vector<std::vector<float>> distances;
+   * knn.kneighbors_batch(src_descriptors, 2, indices, distances);
+   * @endcode
+   */
+  bool kneighbors_batch(const container_type& queries,
+                        std::size_t num_neighbors,
+                        std::vector<std::vector<std::size_t>>& indices,
+                        std::vector<std::vector<distance_type>>& distances)
+  {
+    return static_cast<Derived*>(this)->kneighbors_batch_impl(
+        queries, num_neighbors, indices, distances);
+  }
+
 protected:
   base_knn_generic_t() = default;
   ~base_knn_generic_t() = default;
 
+  /**
+   * @brief 批量搜索的默认实现：逐个调用kneighbors / Default batch implementation: calls kneighbors per query
+   */
+  bool kneighbors_batch_impl(const container_type& queries,
+                             std::size_t num_neighbors,
+                             std::vector<std::vector<std::size_t>>& indices,
+                             std::vector<std::vector<distance_type>>& distances)
+  {
+    indices.resize(queries.size());
+    distances.resize(queries.size());
+    for (std::size_t i = 0; i < queries.size(); ++i)
+    {
+      if (!kneighbors(queries[i], num_neighbors, indices[i], distances[i]))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
 public:
   base_knn_generic_t(const base_knn_generic_t&) = delete;
   base_knn_generic_t& operator=(const base_knn_generic_t&) = delete;
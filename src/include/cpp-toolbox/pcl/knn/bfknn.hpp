@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cpp-toolbox/pcl/knn/base_knn.hpp>
+#include <cpp-toolbox/pcl/knn/detail/blocked_knn_kernel.hpp>
 #include <cpp-toolbox/metrics/metric_factory.hpp>
 #include <cpp-toolbox/metrics/vector_metrics.hpp>
 
@@ -123,8 +124,39 @@ public:
                              std::vector<std::size_t>& indices,
                              std::vector<distance_type>& distances);
 
+  /**
+   * @brief 批量K近邻搜索的实现 / Implementation of batch K-nearest neighbors search
+   *
+   * L2度量时使用分块内核（查询块×数据块），每个查询只维护有界堆。
+   * With the L2 metric this uses the tiled kernel (query block × data block), keeping
+   * only a bounded heap per query.
+   */
+  bool kneighbors_batch_impl(const container_type& queries,
+                             std::size_t num_neighbors,
+                             std::vector<std::vector<std::size_t>>& indices,
+                             std::vector<std::vector<distance_type>>& distances);
+
 private:
+  /// L2度量可以走分块内核 / The L2 metric can use the tiled kernel
+  static constexpr bool k_blocked_l2 = std::is_same_v<Metric, toolbox::metrics::L2Metric<value_type>>;
+
+  [[nodiscard]] bool use_runtime_metric() const noexcept
+  {
+    return m_use_runtime_metric && m_runtime_metric;
+  }
+
+  [[nodiscard]] bool use_blocked_kernel() const noexcept
+  {
+    return k_blocked_l2 && !use_runtime_metric();
+  }
+
+  distance_type compute_distance(const element_type& query, std::size_t index) const;
+  void rebuild_blocked_data();
+  void rebuild_packed_data();
+
   container_ptr m_data;  ///< 存储的数据点 / Stored data points
+  detail::blocked_points_t<value_type> m_blocked_data;  ///< 分块转置的数据（仅L2） / Blocked transposed data (L2 only)
+  detail::packed_rows_t<value_type> m_packed_data;  ///< 连续的行数据（仅运行时度量） / Contiguous rows (runtime metrics only)
   metric_type m_compile_time_metric;  ///< 编译时度量对象 / Compile-time metric object
   std::shared_ptr<toolbox::metrics::IMetric<typename Element::value_type>> m_runtime_metric;  ///< 运行时度量对象 / Runtime metric object
   bool m_use_runtime_metric = false;  ///< 是否使用运行时度量 / Whether to use runtime metric
@@ -2,6 +2,7 @@
 
 #include <cpp-toolbox/concurrent/parallel.hpp>
 #include <cpp-toolbox/pcl/knn/base_knn.hpp>
+#include <cpp-toolbox/pcl/knn/detail/blocked_knn_kernel.hpp>
 #include <cpp-toolbox/metrics/metric_factory.hpp>
 #include <cpp-toolbox/metrics/vector_metrics.hpp>
 
@@ -49,11 +50,56 @@ public:
                              std::vector<std::size_t>& indices,
                              std::vector<distance_type>& distances);
 
+  /**
+   * @brief 批量K近邻搜索，按查询划分到各线程 / Batch KNN search, splitting queries across threads
+   */
+  bool kneighbors_batch_impl(const container_type& queries,
+                             std::size_t num_neighbors,
+                             std::vector<std::vector<std::size_t>>& indices,
+                             std::vector<std::vector<distance_type>>& distances);
+
   void enable_parallel(bool enable) { m_parallel_enabled = enable; }
   [[nodiscard]] bool is_parallel_enabled() const noexcept { return m_parallel_enabled; }
 
 private:
+  static constexpr bool k_blocked_l2 = std::is_same_v<Metric, toolbox::metrics::L2Metric<value_type>>;
+
+  [[nodiscard]] bool use_runtime_metric() const noexcept
+  {
+    return m_use_runtime_metric && m_runtime_metric;
+  }
+
+  [[nodiscard]] bool use_blocked_kernel() const noexcept
+  {
+    return k_blocked_l2 && !use_runtime_metric();
+  }
+
+  void rebuild_blocked_data();
+  void rebuild_packed_data();
+
+  /**
+   * @brief 在数据区间[begin, end)上执行K近邻搜索 / Run KNN search over data range [begin, end)
+   * @param packed_query 连续存放的查询，仅运行时度量使用 / Contiguous query, only used by runtime metrics
+   */
+  void search_range(const element_type& query,
+                    const value_type* packed_query,
+                    std::size_t begin,
+                    std::size_t end,
+                    detail::top_k_heap_t<distance_type>& heap) const;
+
+  /**
+   * @brief 在数据区间[begin, end)上执行半径搜索 / Run radius search over data range [begin, end)
+   */
+  void radius_range(const element_type& query,
+                    const value_type* packed_query,
+                    distance_type radius,
+                    std::size_t begin,
+                    std::size_t end,
+                    std::vector<std::pair<distance_type, std::size_t>>& results) const;
+
   container_ptr m_data;
+  detail::blocked_points_t<value_type> m_blocked_data;
+  detail::packed_rows_t<value_type> m_packed_data;
   metric_type m_compile_time_metric;
   std::shared_ptr<toolbox::metrics::IMetric<typename Element::value_type>> m_runtime_metric;
   bool m_use_runtime_metric = false;
@@ -0,0 +1,395 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cpp-toolbox/metrics/metric_factory.hpp>
+#include <cpp-toolbox/types/point.hpp>
+
+namespace toolbox::pcl::detail
+{
+
+/**
+ * @brief 有界的前K小堆 / Bounded top-k heap
+ *
+ * 只保留当前最好的K个(距离, 索引)对，每个查询只需O(K)内存。
+ * Keeps only the best K (distance, index) pairs, so each query needs O(K) memory.
+ */
+template<typename T>
+class top_k_heap_t
+{
+public:
+  using item_type = std::pair<T, std::size_t>;
+
+  explicit top_k_heap_t(std::size_t k = 0) { reset(k); }
+
+  void reset(std::size_t k)
+  {
+    m_k = k;
+    m_items.clear();
+    m_items.reserve(k);
+  }
+
+  /**
+   * @brief 当前的接受阈值，未满时为最大值，K为0时为最小值 / Current acceptance threshold,
+   * max value while not full and lowest value when K is 0
+   */
+  [[nodiscard]] T threshold() const noexcept
+  {
+    if (m_k == 0) {
+      return std::numeric_limits<T>::lowest();
+    }
+    return m_items.size() < m_k ? std::numeric_limits<T>::max() : m_items.front().first;
+  }
+
+  void push(T distance, std::size_t index)
+  {
+    if (m_items.size() < m_k) {
+      m_items.emplace_back(distance, index);
+      std::push_heap(m_items.begin(), m_items.end());
+    } else if (m_k > 0 && item_type(distance, index) < m_items.front()) {
+      std::pop_heap(m_items.begin(), m_items.end());
+      m_items.back() = item_type(distance, index);
+      std::push_heap(m_items.begin(), m_items.end());
+    }
+  }
+
+  void merge(const top_k_heap_t& other)
+  {
+    for (const auto& [distance, index] : other.m_items) {
+      push(distance, index);
+    }
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return m_items.size(); }
+
+  /**
+   * @brief 按距离升序导出结果 / Export results sorted by ascending distance
+   * @param transform 应用于每个距离的变换（如平方距离开方） / Transform applied to every
+   * distance (e.g. square root of squared distances)
+   */
+  template<typename Distance, typename Transform>
+  void extract(std::vector<std::size_t>& indices,
+               std::vector<Distance>& distances,
+               Transform&& transform)
+  {
+    std::sort_heap(m_items.begin(), m_items.end());
+    indices.resize(m_items.size());
+    distances.resize(m_items.size());
+    for (std::size_t i = 0; i < m_items.size(); ++i) {
+      distances[i] = static_cast<Distance>(transform(m_items[i].first));
+      indices[i] = m_items[i].second;
+    }
+    m_items.clear();
+  }
+
+private:
+  std::size_t m_k = 0;
+  std::vector<item_type> m_items;
+};
+
+/**
+ * @brief 元素的维度 / Dimensionality of an element
+ */
+template<typename T, typename Element>
+std::size_t element_dims(const Element& element)
+{
+  if constexpr (std::is_same_v<Element, toolbox::types::point_t<T>>) {
+    return 3;
+  } else {
+    return element.size();
+  }
+}
+
+/**
+ * @brief 把元素的坐标复制到连续缓冲区 / Copy an element's coordinates into a contiguous buffer
+ */
+template<typename T, typename Element>
+void load_element(const Element& element, T* out)
+{
+  if constexpr (std::is_same_v<Element, toolbox::types::point_t<T>>) {
+    out[0] = element.x;
+    out[1] = element.y;
+    out[2] = element.z;
+  } else {
+    const auto* values = element.data();
+    for (std::size_t d = 0; d < element.size(); ++d) {
+      out[d] = static_cast<T>(values[d]);
+    }
+  }
+}
+
+/**
+ * @brief 用度量对象计算两个元素的距离 / Evaluate a metric object on two elements
+ *
+ * 优先使用operator()，否则退回到容器接口distance(a, b)。
+ * Prefers operator(), falling back to the container interface distance(a, b).
+ */
+template<typename Metric, typename Element>
+auto evaluate_metric(const Metric& metric, const Element& a, const Element& b)
+{
+  if constexpr (std::is_invocable_v<const Metric&, const Element&, const Element&>) {
+    return metric(a, b);
+  } else {
+    return metric.distance(a, b);
+  }
+}
+
+/**
+ * @brief 分块转置存储的数据矩阵 / Data matrix stored in transposed blocks
+ *
+ * 每块block_size个点按[维度][通道]排列，内层循环在同一维度的连续通道上进行，
+ * 编译器可以直接向量化，无需重排浮点归约。
+ * Each block of block_size points is laid out as [dim][lane], so the inner loop runs
+ * over contiguous lanes of one dimension and auto-vectorizes without reassociating
+ * floating-point reductions.
+ */
+template<typename T>
+struct blocked_points_t
+{
+  static constexpr std::size_t block_size = 64;
+
+  std::size_t count = 0;
+  std::size_t dims = 0;
+  std::size_t num_blocks = 0;
+  std::vector<T> values;  ///< [块][维度][通道] / [block][dim][lane]
+
+  void clear()
+  {
+    count = dims = num_blocks = 0;
+    values.clear();
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return count == 0; }
+
+  [[nodiscard]] const T* block(std::size_t b) const noexcept
+  {
+    return values.data() + b * dims * block_size;
+  }
+
+  [[nodiscard]] std::size_t block_count(std::size_t b) const noexcept
+  {
+    return std::min(block_size, count - b * block_size);
+  }
+
+  template<typename Element>
+  void assign(const std::vector<Element>& data)
+  {
+    clear();
+    if (data.empty()) return;
+
+    count = data.size();
+    dims = element_dims<T>(data.front());
+    num_blocks = (count + block_size - 1) / block_size;
+    values.assign(num_blocks * dims * block_size, T(0));
+
+    std::vector<T> row(dims);
+    for (std::size_t i = 0; i < count; ++i) {
+      load_element<T>(data[i], row.data());
+      T* base = values.data() + (i / block_size) * dims * block_size + (i % block_size);
+      for (std::size_t d = 0; d < dims; ++d) {
+        base[d * block_size] = row[d];
+      }
+    }
+  }
+};
+
+/**
+ * @brief 行优先存储的连续矩阵（查询或运行时度量的数据） / Contiguous row-major matrix (queries,
+ * or data for runtime metrics)
+ */
+template<typename T>
+struct packed_rows_t
+{
+  std::size_t count = 0;
+  std::size_t dims = 0;
+  std::vector<T> values;
+
+  void clear()
+  {
+    count = dims = 0;
+    values.clear();
+  }
+
+  template<typename Element>
+  void assign(const Element* rows, std::size_t num_rows, std::size_t num_dims)
+  {
+    count = num_rows;
+    dims = num_dims;
+    values.resize(count * dims);
+    for (std::size_t i = 0; i < count; ++i) {
+      load_element<T>(rows[i], values.data() + i * dims);
+    }
+  }
+
+  template<typename Element>
+  void assign(const std::vector<Element>& rows)
+  {
+    if (rows.empty()) {
+      clear();
+      return;
+    }
+    assign(rows.data(), rows.size(), element_dims<T>(rows.front()));
+  }
+
+  [[nodiscard]] const T* row(std::size_t i) const noexcept { return values.data() + i * dims; }
+};
+
+/**
+ * @brief 计算一个查询到一个数据块的平方L2距离 / Squared L2 distances from one query to one data block
+ *
+ * 使用差值形式而不是||a||²+||b||²−2a·b，高维时也不会出现抵消误差。
+ * Uses the difference form instead of ||a||²+||b||²−2a·b, so there is no cancellation
+ * error even in high dimensions.
+ *
+ * @param out [out] 长度为block_size的输出 / Output of length block_size
+ */
+template<typename T>
+inline void squared_l2_block(const T* query,
+                             const blocked_points_t<T>& data,
+                             std::size_t b,
+                             T* out)
+{
+  constexpr std::size_t lanes = blocked_points_t<T>::block_size;
+  const T* block = data.block(b);
+  for (std::size_t lane = 0; lane < lanes; ++lane) {
+    out[lane] = T(0);
+  }
+
+  for (std::size_t d = 0; d < data.dims; ++d) {
+    const T q = query[d];
+    const T* column = block + d * lanes;
+    for (std::size_t lane = 0; lane < lanes; ++lane) {
+      const T diff = column[lane] - q;
+      out[lane] += diff * diff;
+    }
+  }
+}
+
+/**
+ * @brief 分块的暴力K近邻内核 / Tiled brute-force KNN kernel
+ *
+ * 按查询块×数据块的顺序遍历，使一个数据块在缓存中被一组查询复用，每个查询维护有界堆。
+ * Iterates query blocks × data blocks so a data block stays in cache while a group of
+ * queries reuses it; each query keeps a bounded heap.
+ *
+ * @param heaps 每个查询一个堆，已按K重置 / One heap per query, already reset to K
+ * @param block_begin 数据块起始（用于按数据划分并行） / First data block (for data-parallel splits)
+ * @param block_end 数据块结束 / One past the last data block
+ */
+template<typename T>
+void blocked_squared_l2_knn(const blocked_points_t<T>& data,
+                            const packed_rows_t<T>& queries,
+                            std::size_t query_begin,
+                            std::size_t query_end,
+                            top_k_heap_t<T>* heaps,
+                            std::size_t block_begin,
+                            std::size_t block_end)
+{
+  constexpr std::size_t query_block = 16;
+  constexpr std::size_t lanes = blocked_points_t<T>::block_size;
+  T tile[lanes];
+
+  for (std::size_t q0 = query_begin; q0 < query_end; q0 += query_block) {
+    const std::size_t q1 = std::min(q0 + query_block, query_end);
+    for (std::size_t b = block_begin; b < block_end; ++b) {
+      const std::size_t valid = data.block_count(b);
+      const std::size_t base_index = b * lanes;
+      for (std::size_t q = q0; q < q1; ++q) {
+        squared_l2_block(queries.row(q), data, b, tile);
+        auto& heap = heaps[q - query_begin];
+        T threshold = heap.threshold();
+        for (std::size_t lane = 0; lane < valid; ++lane) {
+          if (tile[lane] <= threshold) {
+            heap.push(tile[lane], base_index + lane);
+            threshold = heap.threshold();
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @brief 分块的半径搜索内核（平方距离） / Tiled radius search kernel (squared distances)
+ */
+template<typename T>
+void blocked_squared_l2_radius(const blocked_points_t<T>& data,
+                               const T* query,
+                               T squared_radius,
+                               std::vector<std::pair<T, std::size_t>>& results)
+{
+  constexpr std::size_t lanes = blocked_points_t<T>::block_size;
+  T tile[lanes];
+  for (std::size_t b = 0; b < data.num_blocks; ++b) {
+    squared_l2_block(query, data, b, tile);
+    const std::size_t valid = data.block_count(b);
+    for (std::size_t lane = 0; lane < valid; ++lane) {
+      if (tile[lane] <= squared_radius) {
+        results.emplace_back(tile[lane], b * lanes + lane);
+      }
+    }
+  }
+}
+
+/// 运行时度量每次批量计算的点数 / Points scored per batched runtime-metric call
+inline constexpr std::size_t k_runtime_metric_chunk = 256;
+
+/**
+ * @brief 运行时度量的K近邻搜索，每块数据只做一次虚调用 / KNN search with a runtime metric,
+ * one virtual call per chunk of data
+ * @param begin 数据起始行 / First data row
+ * @param end 数据结束行 / One past the last data row
+ */
+template<typename T>
+void batched_metric_knn(const toolbox::metrics::IMetric<T>& metric,
+                        const T* query,
+                        const packed_rows_t<T>& data,
+                        std::size_t begin,
+                        std::size_t end,
+                        top_k_heap_t<T>& heap)
+{
+  T distances[k_runtime_metric_chunk];
+  for (std::size_t i = begin; i < end; i += k_runtime_metric_chunk) {
+    const std::size_t n = std::min(k_runtime_metric_chunk, end - i);
+    metric.distance_batch(query, data.row(i), n, data.dims, distances);
+    T threshold = heap.threshold();
+    for (std::size_t j = 0; j < n; ++j) {
+      if (distances[j] <= threshold) {
+        heap.push(distances[j], i + j);
+        threshold = heap.threshold();
+      }
+    }
+  }
+}
+
+/**
+ * @brief 运行时度量的半径搜索 / Radius search with a runtime metric
+ */
+template<typename T>
+void batched_metric_radius(const toolbox::metrics::IMetric<T>& metric,
+                           const T* query,
+                           const packed_rows_t<T>& data,
+                           std::size_t begin,
+                           std::size_t end,
+                           T radius,
+                           std::vector<std::pair<T, std::size_t>>& results)
+{
+  T distances[k_runtime_metric_chunk];
+  for (std::size_t i = begin; i < end; i += k_runtime_metric_chunk) {
+    const std::size_t n = std::min(k_runtime_metric_chunk, end - i);
+    metric.distance_batch(query, data.row(i), n, data.dims, distances);
+    for (std::size_t j = 0; j < n; ++j) {
+      if (distances[j] <= radius) {
+        results.emplace_back(distances[j], i + j);
+      }
+    }
+  }
+}
+
+}  // namespace toolbox::pcl::detail
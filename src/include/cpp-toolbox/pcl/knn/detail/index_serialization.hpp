@@ -0,0 +1,215 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <cpp-toolbox/file/memory_mapped_file.hpp>
+#include <cpp-toolbox/logger/thread_logger.hpp>
+#include <cpp-toolbox/types/point.hpp>
+
+namespace toolbox::pcl::detail
+{
+
+/**
+ * @brief 空间索引文件的版本 / Version of the spatial index file layout
+ *
+ * 布局 / Layout:
+ *   index_file_header_t
+ *   point_count × 3 × scalar_size 字节的坐标（x, y, z） / coordinates (x, y, z)
+ *   payload_size 字节的索引数据 / bytes of index specific data
+ */
+inline constexpr std::uint32_t k_index_file_version = 1;
+inline constexpr std::uint32_t k_index_byte_order_tag = 0x01020304u;
+
+struct index_file_header_t
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byte_order;
+  std::uint32_t scalar_size;
+  std::uint32_t index_size;  ///< sizeof(std::size_t)，节点数组依赖它 / the node array depends on it
+  std::uint64_t point_count;
+  std::uint64_t payload_size;
+};
+
+/**
+ * @brief 只读内存区间上的输入流缓冲区 / Input stream buffer over a read-only memory range
+ *
+ * 让基于std::istream的加载代码直接读取映射内存，不经过额外的文件缓冲。
+ * Lets std::istream based loaders read mapped memory directly, without an extra file
+ * buffer.
+ */
+class memory_streambuf_t : public std::streambuf
+{
+public:
+  memory_streambuf_t(const unsigned char* data, std::size_t size)
+  {
+    // streambuf只需要读指针，不会写入 / streambuf only reads through these pointers
+    char* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+    setg(begin, begin, begin + size);
+  }
+};
+
+/**
+ * @brief 向索引数据追加平凡类型的值 / Append trivially copyable values to index data
+ */
+template<typename T>
+void append_pod(std::string& out, const T* values, std::size_t count = 1)
+{
+  static_assert(std::is_trivially_copyable_v<T>, "index data must be trivially copyable");
+  out.append(reinterpret_cast<const char*>(values), count * sizeof(T));
+}
+
+/**
+ * @brief 在映射内存上顺序读取索引数据，越界时失败 / Sequential reader over mapped index data,
+ * failing on out-of-range reads
+ */
+class payload_reader_t
+{
+public:
+  payload_reader_t(const unsigned char* data, std::size_t size) : m_data(data), m_size(size) {}
+
+  template<typename T>
+  bool read(T* values, std::size_t count = 1)
+  {
+    static_assert(std::is_trivially_copyable_v<T>, "index data must be trivially copyable");
+    const std::size_t bytes = count * sizeof(T);
+    if (bytes > m_size - m_offset) {
+      return false;
+    }
+    std::memcpy(values, m_data + m_offset, bytes);
+    m_offset += bytes;
+    return true;
+  }
+
+  [[nodiscard]] bool at_end() const noexcept { return m_offset == m_size; }
+
+private:
+  const unsigned char* m_data;
+  std::size_t m_size;
+  std::size_t m_offset = 0;
+};
+
+/**
+ * @brief 写入索引文件 / Write an index file
+ * @param magic 8字节的索引类型标识 / 8-byte tag identifying the index type
+ * @param payload 索引相关的数据 / Index specific data
+ * @return 是否成功 / Whether successful
+ */
+template<typename T>
+bool write_index_file(const std::filesystem::path& path,
+                      const char (&magic)[9],
+                      const std::vector<toolbox::types::point_t<T>>& points,
+                      const std::string& payload)
+{
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    LOG_ERROR_S << "write_index_file: Failed to open file for writing: " << path;
+    return false;
+  }
+
+  index_file_header_t header {};
+  std::memcpy(header.magic, magic, sizeof(header.magic));
+  header.version = k_index_file_version;
+  header.byte_order = k_index_byte_order_tag;
+  header.scalar_size = static_cast<std::uint32_t>(sizeof(T));
+  header.index_size = static_cast<std::uint32_t>(sizeof(std::size_t));
+  header.point_count = points.size();
+  header.payload_size = payload.size();
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  std::vector<T> coordinates(points.size() * 3);
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    coordinates[3 * i] = points[i].x;
+    coordinates[3 * i + 1] = points[i].y;
+    coordinates[3 * i + 2] = points[i].z;
+  }
+  file.write(reinterpret_cast<const char*>(coordinates.data()),
+             static_cast<std::streamsize>(coordinates.size() * sizeof(T)));
+  file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+
+  if (!file) {
+    LOG_ERROR_S << "write_index_file: Error writing index data to " << path;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief 通过内存映射读取的索引文件 / Index file read through a memory mapping
+ *
+ * 头部在映射内存上原地校验，坐标一次性复制，索引数据以指针形式暴露，调用者直接在映射内存上解析。
+ * The header is validated in place on the mapping, coordinates are copied in one pass
+ * and the index data is exposed as a pointer for the caller to parse straight from
+ * mapped memory.
+ */
+class mapped_index_file_t
+{
+public:
+  template<typename T>
+  bool open(const std::filesystem::path& path,
+            const char (&magic)[9],
+            std::vector<toolbox::types::point_t<T>>& points)
+  {
+    if (!m_file.open(path)) {
+      LOG_ERROR_S << "mapped_index_file_t: Failed to memory map file: " << path;
+      return false;
+    }
+    if (m_file.size() < sizeof(index_file_header_t)) {
+      LOG_ERROR_S << "mapped_index_file_t: File too small for an index header: " << path;
+      return false;
+    }
+
+    index_file_header_t header;
+    std::memcpy(&header, m_file.data(), sizeof(header));
+    if (std::memcmp(header.magic, magic, sizeof(header.magic)) != 0) {
+      LOG_ERROR_S << "mapped_index_file_t: Unexpected index type in " << path;
+      return false;
+    }
+    if (header.version != k_index_file_version || header.byte_order != k_index_byte_order_tag
+        || header.scalar_size != sizeof(T) || header.index_size != sizeof(std::size_t)) {
+      LOG_ERROR_S << "mapped_index_file_t: Incompatible index file (version " << header.version
+                  << ", scalar size " << header.scalar_size << ") : " << path;
+      return false;
+    }
+
+    const std::size_t available = m_file.size() - sizeof(header);
+    const std::size_t coordinate_bytes = header.point_count * 3 * sizeof(T);
+    if (header.point_count > available / (3 * sizeof(T))
+        || header.payload_size > available - coordinate_bytes) {
+      LOG_ERROR_S << "mapped_index_file_t: Truncated index file: " << path;
+      return false;
+    }
+
+    const unsigned char* coordinates = m_file.data() + sizeof(header);
+    points.resize(header.point_count);
+    for (std::size_t i = 0; i < points.size(); ++i) {
+      T xyz[3];
+      std::memcpy(xyz, coordinates + i * 3 * sizeof(T), sizeof(xyz));
+      points[i].x = xyz[0];
+      points[i].y = xyz[1];
+      points[i].z = xyz[2];
+    }
+
+    m_payload = coordinates + coordinate_bytes;
+    m_payload_size = header.payload_size;
+    return true;
+  }
+
+  [[nodiscard]] const unsigned char* payload() const noexcept { return m_payload; }
+  [[nodiscard]] std::size_t payload_size() const noexcept { return m_payload_size; }
+
+private:
+  toolbox::file::memory_mapped_file_t m_file;
+  const unsigned char* m_payload = nullptr;
+  std::size_t m_payload_size = 0;
+};
+
+}  // namespace toolbox::pcl::detail
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <cpp-toolbox/pcl/knn/base_knn.hpp>
+#include <cpp-toolbox/metrics/metric_factory.hpp>
+#include <cpp-toolbox/metrics/vector_metrics.hpp>
+
+namespace toolbox::pcl
+{
+
+/**
+ * @brief 基于HNSW图的近似K近邻搜索 / Approximate K-nearest neighbors search based on an HNSW graph
+ *
+ * 分层可导航小世界图（Hierarchical Navigable Small World）把每个元素插入到多层近邻图中，
+ * 查询时从最高层贪心下降，在底层做有界的最佳优先搜索，复杂度接近对数级。与kdtree_generic_t
+ * 不同，它只依赖度量本身，因此适用于FPFH（33维）、SHOT（352维）、3DSC等高维描述子。
+ * Hierarchical Navigable Small World graphs insert every element into a multi-layer
+ * proximity graph. Queries descend greedily from the top layer and run a bounded
+ * best-first search on the bottom layer, giving near-logarithmic complexity. Unlike
+ * kdtree_generic_t it only relies on the metric itself, so it works for high-dimensional
+ * descriptors such as FPFH (33-D), SHOT (352-D) and 3DSC.
+ *
+ * @tparam Element 元素类型（point_t或描述子签名） / Element type (point_t or descriptor signature)
+ * @tparam Metric 度量类型（默认为L2度量） / Metric type (default is L2 metric)
+ *
+ * @code
+ * // 描述子匹配 / Descriptor matching
+ * using knn_type = hnsw_generic_t<fpfh_signature_t<float>, FPFHMetric<float>>;
+ * auto knn = std::make_shared<knn_type>();
+ * knn->set_max_connections(16);
+ * knn->set_ef_construction(200);
+ * knn->set_ef_search(64);  // 提高ef以提高召回率 / Raise ef for higher recall
+ *
+ * knn_correspondence_generator_t<float, fpfh_signature_t<float>, knn_type> corr_gen;
+ * corr_gen.set_knn(knn);
+ * @endcode
+ *
+ * @code
+ * // 批量插入 / Batch insertion
+ * hnsw_t<float> index;
+ * index.set_input(first_scan.points);
+ * index.add_points(second_scan.points);  // 增量插入，不重建 / Incremental, no rebuild
+ * index.kneighbors(query, 10, indices, distances);
+ * @endcode
+ *
+ * @note 内部使用32位索引，数据量不能超过2^32-1 / Uses 32-bit indices internally, the data size
+ * must not exceed 2^32-1
+ */
+template<typename Element, typename Metric = toolbox::metrics::L2Metric<typename Element::value_type>>
+class CPP_TOOLBOX_EXPORT hnsw_generic_t : public base_knn_generic_t<hnsw_generic_t<Element, Metric>, Element, Metric>
+{
+public:
+  using base_type = base_knn_generic_t<hnsw_generic_t<Element, Metric>, Element, Metric>;
+  using traits_type = typename base_type::traits_type;
+  using element_type = typename traits_type::element_type;
+  using metric_type = typename traits_type::metric_type;
+  using distance_type = typename traits_type::distance_type;
+  using container_type = typename base_type::container_type;
+  using container_ptr = typename base_type::container_ptr;
+  using value_type = typename Element::value_type;
+  using index_type = std::uint32_t;
+
+  hnsw_generic_t() = default;
+  ~hnsw_generic_t() = default;
+
+  hnsw_generic_t(const hnsw_generic_t&) = delete;
+  hnsw_generic_t& operator=(const hnsw_generic_t&) = delete;
+  hnsw_generic_t(hnsw_generic_t&&) = delete;
+  hnsw_generic_t& operator=(hnsw_generic_t&&) = delete;
+
+  /**
+   * @brief 设置输入数据并构建图 / Set input data and build the graph
+   * @param data 输入数据容器 / Input data container
+   * @return 数据点的数量 / Number of data points
+   */
+  std::size_t set_input_impl(const container_type& data);
+
+  /**
+   * @brief 设置输入数据并构建图（智能指针版本） / Set input data and build the graph (smart pointer version)
+   * @param data 输入数据容器的智能指针 / Smart pointer to input data container
+   * @return 数据点的数量 / Number of data points
+   */
+  std::size_t set_input_impl(const container_ptr& data);
+
+  /**
+   * @brief 设置编译时度量，已有数据时重建图 / Set compile-time metric, rebuilding the graph if data exists
+   * @param metric 度量对象 / Metric object
+   */
+  void set_metric_impl(const metric_type& metric);
+
+  /**
+   * @brief 设置运行时度量，已有数据时重建图 / Set runtime metric, rebuilding the graph if data exists
+   * @param metric 度量接口的智能指针 / Smart pointer to metric interface
+   */
+  void set_metric_impl(std::shared_ptr<toolbox::metrics::IMetric<value_type>> metric);
+
+  bool kneighbors_impl(const element_type& query,
+                       std::size_t num_neighbors,
+                       std::vector<std::size_t>& indices,
+                       std::vector<distance_type>& distances);
+
+  /**
+   * @brief 近似半径搜索 / Approximate radius search
+   *
+   * 先用底层最佳优先搜索找到入口，再沿底层图扩展半径内的节点。
+   * Finds entry nodes with the bottom-layer best-first search, then expands
+   * along the bottom-layer graph through nodes inside the radius.
+   */
+  bool radius_neighbors_impl(const element_type& query,
+                             distance_type radius,
+                             std::vector<std::size_t>& indices,
+                             std::vector<distance_type>& distances);
+
+  /**
+   * @brief 批量插入新元素（不重建已有的图） / Batch insert new elements (without rebuilding the existing graph)
+   * @param points 要插入的元素 / Elements to insert
+   * @return 插入后的数据点总数 / Total number of data points after insertion
+   *
+   * @note 如果数据通过智能指针共享，插入前会复制一份，调用者的容器不会被修改 /
+   * If the data is shared through a smart pointer it is copied first, the caller's
+   * container is never modified
+   */
+  std::size_t add_points(const container_type& points);
+
+  /**
+   * @brief 设置每层的最大连接数M（底层为2M） / Set max connections per layer M (2M on the bottom layer)
+   * @note 仅对之后的构建生效 / Only affects subsequent builds
+   */
+  void set_max_connections(std::size_t m) { m_max_connections = std::max<std::size_t>(m, 2); }
+  [[nodiscard]] std::size_t get_max_connections() const noexcept { return m_max_connections; }
+
+  /**
+   * @brief 设置构建时的候选列表大小 / Set candidate list size used during construction
+   */
+  void set_ef_construction(std::size_t ef) { m_ef_construction = std::max<std::size_t>(ef, 1); }
+  [[nodiscard]] std::size_t get_ef_construction() const noexcept { return m_ef_construction; }
+
+  /**
+   * @brief 设置查询时的候选列表大小，越大召回率越高、速度越慢 / Set candidate list size used during
+   * queries, larger values trade speed for recall
+   */
+  void set_ef_search(std::size_t ef) { m_ef_search = std::max<std::size_t>(ef, 1); }
+  [[nodiscard]] std::size_t get_ef_search() const noexcept { return m_ef_search; }
+
+  /**
+   * @brief 启用精确重排 / Enable exact re-ranking
+   *
+   * 启用后把候选集的底层一阶邻居也纳入精确距离计算再取前K个，用少量额外的距离计算换取更高召回率。
+   * When enabled, the bottom-layer one-hop neighbors of the candidate set are also
+   * evaluated with the exact metric before taking the top K, trading a few extra
+   * distance computations for higher recall.
+   */
+  void set_exact_rerank(bool enable) { m_exact_rerank = enable; }
+  [[nodiscard]] bool is_exact_rerank_enabled() const noexcept { return m_exact_rerank; }
+
+  /**
+   * @brief 设置层级抽样的随机种子 / Set random seed used for level sampling
+   */
+  void set_random_seed(unsigned int seed) { m_seed = seed; }
+
+  void enable_parallel(bool enable) { m_parallel_enabled = enable; }
+  [[nodiscard]] bool is_parallel_enabled() const noexcept { return m_parallel_enabled; }
+
+  [[nodiscard]] std::size_t size() const noexcept { return m_data ? m_data->size() : 0; }
+  [[nodiscard]] int get_max_level() const noexcept { return m_max_level; }
+
+  /**
+   * @brief 把点和图保存到二进制文件（仅point_t元素） / Save the points and the graph to a binary
+   * file (point_t elements only)
+   * @return 是否成功 / Whether successful
+   */
+  bool save_index(const std::filesystem::path& path) const;
+
+  /**
+   * @brief 从save_index写入的文件加载点和图，不重新插入 / Load points and graph from a file
+   * written by save_index, without re-inserting
+   *
+   * 通过内存映射读取，邻接表直接从映射内存复制。度量不保存，加载后使用当前设置的度量。
+   * Read through a memory mapping, adjacency lists are copied straight from mapped
+   * memory. The metric is not stored; the currently configured metric is used.
+   *
+   * @return 是否成功 / Whether successful
+   */
+  bool load_index(const std::filesystem::path& path);
+
+private:
+  using candidate_t = std::pair<distance_type, index_type>;
+
+  /**
+   * @brief 每线程复用的访问标记 / Per-thread reusable visited marks
+   */
+  struct visited_list_t
+  {
+    std::vector<std::uint32_t> marks;
+    std::uint32_t epoch = 0;
+
+    void reset(std::size_t size)
+    {
+      if (marks.size() < size) marks.resize(size, 0);
+      if (++epoch == 0) {
+        std::fill(marks.begin(), marks.end(), 0);
+        epoch = 1;
+      }
+    }
+
+    bool visit(index_type idx)
+    {
+      if (marks[idx] == epoch) return false;
+      marks[idx] = epoch;
+      return true;
+    }
+  };
+
+  void rebuild();
+  void insert_new_points(std::size_t first);
+  void insert_point(index_type idx);
+
+  distance_type compute_distance(const element_type& a, const element_type& b) const;
+  index_type greedy_descend(const element_type& query, index_type entry, int from_level, int to_level) const;
+  std::vector<candidate_t> search_layer(const element_type& query,
+                                        index_type entry,
+                                        std::size_t ef,
+                                        int level) const;
+  void select_neighbors(std::vector<candidate_t>& candidates, std::size_t max_count) const;
+  void copy_links(index_type node, int level, std::vector<index_type>& out) const;
+  void refine_candidates(const element_type& query, std::vector<candidate_t>& candidates) const;
+  [[nodiscard]] std::size_t max_links(int level) const noexcept
+  {
+    return level == 0 ? 2 * m_max_connections : m_max_connections;
+  }
+
+  container_ptr m_data;
+  metric_type m_compile_time_metric;
+  std::shared_ptr<toolbox::metrics::IMetric<value_type>> m_runtime_metric;
+  bool m_use_runtime_metric = false;
+
+  std::vector<int> m_levels;  ///< 每个节点的最高层 / Top level of each node
+  std::vector<std::vector<std::vector<index_type>>> m_links;  ///< [节点][层] -> 邻居 / [node][level] -> neighbors
+  mutable std::vector<std::mutex> m_node_locks;  ///< 并行构建时的节点锁 / Node locks used by parallel build
+  mutable std::mutex m_entry_mutex;
+  index_type m_entry_point = 0;
+  int m_max_level = -1;
+  bool m_concurrent_build = false;
+
+  std::size_t m_max_connections = 16;
+  std::size_t m_ef_construction = 200;
+  std::size_t m_ef_search = 64;
+  bool m_exact_rerank = false;
+  bool m_parallel_enabled = true;
+  unsigned int m_seed = 42;
+  static constexpr std::size_t k_parallel_threshold = 1024;
+  static constexpr char k_index_magic[9] = "CTBHNSW1";
+};
+
+/**
+ * @brief 用于点云的HNSW类型别名 / Type alias for HNSW with point clouds
+ * @tparam DataType 数据类型（如float或double） / Data type (e.g., float or double)
+ */
+template<typename DataType>
+using hnsw_t = hnsw_generic_t<point_t<DataType>, toolbox::metrics::L2Metric<DataType>>;
+
+}  // namespace toolbox::pcl
+
+#include <cpp-toolbox/pcl/knn/impl/hnsw_impl.hpp>
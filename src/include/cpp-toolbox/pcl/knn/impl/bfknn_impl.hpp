@@ -15,6 +15,8 @@ template<typename Element, typename Metric>
 std::size_t bfknn_generic_t<Element, Metric>::set_input_impl(const container_type& data)
 {
   m_data = std::make_shared<container_type>(data);
+  rebuild_blocked_data();
+  rebuild_packed_data();
   return m_data->size();
 }
 
@@ -22,14 +24,40 @@ template<typename Element, typename Metric>
 std::size_t bfknn_generic_t<Element, Metric>::set_input_impl(const container_ptr& data)
 {
   m_data = data;
+  rebuild_blocked_data();
+  rebuild_packed_data();
   return m_data ? m_data->size() : 0;
 }
 
+template<typename Element, typename Metric>
+void bfknn_generic_t<Element, Metric>::rebuild_blocked_data()
+{
+  if constexpr (k_blocked_l2) {
+    if (m_data) {
+      m_blocked_data.assign(*m_data);
+    } else {
+      m_blocked_data.clear();
+    }
+  }
+}
+
+template<typename Element, typename Metric>
+void bfknn_generic_t<Element, Metric>::rebuild_packed_data()
+{
+  // 运行时度量按行批量计算，需要连续的数据 / Runtime metrics score contiguous rows in batches
+  if (use_runtime_metric() && m_data) {
+    m_packed_data.assign(*m_data);
+  } else {
+    m_packed_data.clear();
+  }
+}
+
 template<typename Element, typename Metric>
 void bfknn_generic_t<Element, Metric>::set_metric_impl(const metric_type& metric)
 {
   m_compile_time_metric = metric;
   m_use_runtime_metric = false;
+  rebuild_packed_data();
 }
 
 template<typename Element, typename Metric>
@@ -44,6 +72,7 @@ void bfknn_generic_t<Element, Metric>::set_metric_impl(
     m_runtime_metric = metric;
   }
   m_use_runtime_metric = true;
+  rebuild_packed_data();
 }
 
 template<typename Element, typename Metric>
@@ -56,6 +85,14 @@ void bfknn_generic_t<Element, Metric>::set_metric_impl(
   set_metric_impl(shared_metric);
 }
 
+template<typename Element, typename Metric>
+typename bfknn_generic_t<Element, Metric>::distance_type
+bfknn_generic_t<Element, Metric>::compute_distance(const element_type& query,
+                                                   std::size_t index) const
+{
+  return detail::evaluate_metric(m_compile_time_metric, query, (*m_data)[index]);
+}
+
 template<typename Element, typename Metric>
 bool bfknn_generic_t<Element, Metric>::kneighbors_impl(
     const element_type& query,
@@ -71,47 +108,84 @@ bool bfknn_generic_t<Element, Metric>::kneighbors_impl(
   const std::size_t data_size = m_data->size();
   num_neighbors = std::min(num_neighbors, data_size);
 
-  // Compute all distances
-  std::vector<std::pair<distance_type, std::size_t>> distance_index_pairs;
-  distance_index_pairs.reserve(data_size);
-
-  for (std::size_t i = 0; i < data_size; ++i)
+  if constexpr (k_blocked_l2)
   {
-    distance_type dist;
-    if (m_use_runtime_metric && m_runtime_metric)
+    if (use_blocked_kernel())
     {
-      if constexpr (std::is_same_v<Element, toolbox::types::point_t<typename Element::value_type>>) {
-        // For point types, convert to arrays and use distance method
-        value_type arr_query[3] = {query.x, query.y, query.z};
-        value_type arr_data[3] = {(*m_data)[i].x, (*m_data)[i].y, (*m_data)[i].z};
-        dist = m_runtime_metric->distance(arr_query, arr_data, 3);
-      } else {
-        // For generic types, assume they have data() and size() methods
-        dist = m_runtime_metric->distance(query, (*m_data)[i]);
-      }
+      detail::packed_rows_t<value_type> packed_query;
+      packed_query.assign(&query, 1, m_blocked_data.dims);
+      detail::top_k_heap_t<value_type> heap(num_neighbors);
+      detail::blocked_squared_l2_knn(m_blocked_data, packed_query, 0, 1, &heap,
+                                     0, m_blocked_data.num_blocks);
+      heap.extract(indices, distances, [](value_type d) { return std::sqrt(d); });
+      return true;
     }
-    else
+  }
+
+  // 有界堆，只保留K个候选 / Bounded heap keeping only K candidates
+  detail::top_k_heap_t<distance_type> heap(num_neighbors);
+  if (use_runtime_metric())
+  {
+    // 每块数据一次虚调用 / One virtual call per chunk of data
+    detail::packed_rows_t<value_type> packed_query;
+    packed_query.assign(&query, 1, m_packed_data.dims);
+    detail::batched_metric_knn(*m_runtime_metric, packed_query.row(0), m_packed_data, 0,
+                               data_size, heap);
+  }
+  else
+  {
+    for (std::size_t i = 0; i < data_size; ++i)
     {
-      dist = m_compile_time_metric(query, (*m_data)[i]);
+      heap.push(compute_distance(query, i), i);
     }
-    distance_index_pairs.emplace_back(dist, i);
+  }
+  heap.extract(indices, distances, [](distance_type d) { return d; });
+
+  return true;
+}
+
+template<typename Element, typename Metric>
+bool bfknn_generic_t<Element, Metric>::kneighbors_batch_impl(
+    const container_type& queries,
+    std::size_t num_neighbors,
+    std::vector<std::vector<std::size_t>>& indices,
+    std::vector<std::vector<distance_type>>& distances)
+{
+  if (!m_data || m_data->empty())
+  {
+    return false;
   }
 
-  // Partial sort to get k nearest neighbors
-  std::partial_sort(distance_index_pairs.begin(),
-                    distance_index_pairs.begin() + num_neighbors,
-                    distance_index_pairs.end(),
-                    [](const auto& a, const auto& b) { return a.first < b.first; });
+  const std::size_t num_queries = queries.size();
+  indices.resize(num_queries);
+  distances.resize(num_queries);
+  num_neighbors = std::min(num_neighbors, m_data->size());
 
-  // Extract results
-  indices.resize(num_neighbors);
-  distances.resize(num_neighbors);
-  for (std::size_t i = 0; i < num_neighbors; ++i)
+  if constexpr (k_blocked_l2)
   {
-    distances[i] = distance_index_pairs[i].first;
-    indices[i] = distance_index_pairs[i].second;
+    if (use_blocked_kernel())
+    {
+      detail::packed_rows_t<value_type> packed_queries;
+      packed_queries.assign(queries.data(), num_queries, m_blocked_data.dims);
+      std::vector<detail::top_k_heap_t<value_type>> heaps(num_queries);
+      for (auto& heap : heaps)
+      {
+        heap.reset(num_neighbors);
+      }
+      detail::blocked_squared_l2_knn(m_blocked_data, packed_queries, 0, num_queries,
+                                     heaps.data(), 0, m_blocked_data.num_blocks);
+      for (std::size_t q = 0; q < num_queries; ++q)
+      {
+        heaps[q].extract(indices[q], distances[q], [](value_type d) { return std::sqrt(d); });
+      }
+      return true;
+    }
   }
 
+  for (std::size_t q = 0; q < num_queries; ++q)
+  {
+    kneighbors_impl(queries[q], num_neighbors, indices[q], distances[q]);
+  }
   return true;
 }
 
@@ -133,29 +207,40 @@ bool bfknn_generic_t<Element, Metric>::radius_neighbors_impl(
   const std::size_t data_size = m_data->size();
   std::vector<std::pair<distance_type, std::size_t>> distance_index_pairs;
 
-  for (std::size_t i = 0; i < data_size; ++i)
+  bool searched = false;
+  if constexpr (k_blocked_l2)
   {
-    distance_type dist;
-    if (m_use_runtime_metric && m_runtime_metric)
+    if (use_blocked_kernel())
     {
-      if constexpr (std::is_same_v<Element, toolbox::types::point_t<typename Element::value_type>>) {
-        // For point types, convert to arrays and use distance method
-        value_type arr_query[3] = {query.x, query.y, query.z};
-        value_type arr_data[3] = {(*m_data)[i].x, (*m_data)[i].y, (*m_data)[i].z};
-        dist = m_runtime_metric->distance(arr_query, arr_data, 3);
-      } else {
-        // For generic types, assume they have data() and size() methods
-        dist = m_runtime_metric->distance(query, (*m_data)[i]);
+      detail::packed_rows_t<value_type> packed_query;
+      packed_query.assign(&query, 1, m_blocked_data.dims);
+      detail::blocked_squared_l2_radius(m_blocked_data, packed_query.row(0),
+                                        radius * radius,
+                                        distance_index_pairs);
+      for (auto& pair : distance_index_pairs)
+      {
+        pair.first = std::sqrt(pair.first);
       }
+      searched = true;
     }
-    else
-    {
-      dist = m_compile_time_metric(query, (*m_data)[i]);
-    }
-    
-    if (dist <= radius)
+  }
+
+  if (!searched && use_runtime_metric())
+  {
+    detail::packed_rows_t<value_type> packed_query;
+    packed_query.assign(&query, 1, m_packed_data.dims);
+    detail::batched_metric_radius(*m_runtime_metric, packed_query.row(0), m_packed_data, 0,
+                                  data_size, radius, distance_index_pairs);
+  }
+  else if (!searched)
+  {
+    for (std::size_t i = 0; i < data_size; ++i)
     {
-      distance_index_pairs.emplace_back(dist, i);
+      const distance_type dist = compute_distance(query, i);
+      if (dist <= radius)
+      {
+        distance_index_pairs.emplace_back(dist, i);
+      }
     }
   }
 
@@ -175,4 +260,4 @@ bool bfknn_generic_t<Element, Metric>::radius_neighbors_impl(
   return true;
 }
 
-}  // namespace toolbox::pcl
\ No newline at end of file
+}  // namespace toolbox::pcl
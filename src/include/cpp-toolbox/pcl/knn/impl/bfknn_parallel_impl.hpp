@@ -17,6 +17,8 @@ template<typename Element, typename Metric>
 std::size_t bfknn_parallel_generic_t<Element, Metric>::set_input_impl(const container_type& data)
 {
   m_data = std::make_shared<container_type>(data);
+  rebuild_blocked_data();
+  rebuild_packed_data();
   return m_data->size();
 }
 
@@ -24,14 +26,40 @@ template<typename Element, typename Metric>
 std::size_t bfknn_parallel_generic_t<Element, Metric>::set_input_impl(const container_ptr& data)
 {
   m_data = data;
+  rebuild_blocked_data();
+  rebuild_packed_data();
   return m_data ? m_data->size() : 0;
 }
 
+template<typename Element, typename Metric>
+void bfknn_parallel_generic_t<Element, Metric>::rebuild_blocked_data()
+{
+  if constexpr (k_blocked_l2) {
+    if (m_data) {
+      m_blocked_data.assign(*m_data);
+    } else {
+      m_blocked_data.clear();
+    }
+  }
+}
+
+template<typename Element, typename Metric>
+void bfknn_parallel_generic_t<Element, Metric>::rebuild_packed_data()
+{
+  // 运行时度量按行批量计算，需要连续的数据 / Runtime metrics score contiguous rows in batches
+  if (use_runtime_metric() && m_data) {
+    m_packed_data.assign(*m_data);
+  } else {
+    m_packed_data.clear();
+  }
+}
+
 template<typename Element, typename Metric>
 void bfknn_parallel_generic_t<Element, Metric>::set_metric_impl(const metric_type& metric)
 {
   m_compile_time_metric = metric;
   m_use_runtime_metric = false;
+  rebuild_packed_data();
 }
 
 template<typename Element, typename Metric>
@@ -40,6 +68,51 @@ void bfknn_parallel_generic_t<Element, Metric>::set_metric_impl(
 {
   m_runtime_metric = metric;
   m_use_runtime_metric = true;
+  rebuild_packed_data();
+}
+
+template<typename Element, typename Metric>
+void bfknn_parallel_generic_t<Element, Metric>::search_range(
+    const element_type& query,
+    const value_type* packed_query,
+    std::size_t begin,
+    std::size_t end,
+    detail::top_k_heap_t<distance_type>& heap) const
+{
+  if (use_runtime_metric())
+  {
+    detail::batched_metric_knn(*m_runtime_metric, packed_query, m_packed_data, begin, end, heap);
+    return;
+  }
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    heap.push(detail::evaluate_metric(m_compile_time_metric, query, (*m_data)[i]), i);
+  }
+}
+
+template<typename Element, typename Metric>
+void bfknn_parallel_generic_t<Element, Metric>::radius_range(
+    const element_type& query,
+    const value_type* packed_query,
+    distance_type radius,
+    std::size_t begin,
+    std::size_t end,
+    std::vector<std::pair<distance_type, std::size_t>>& results) const
+{
+  if (use_runtime_metric())
+  {
+    detail::batched_metric_radius(*m_runtime_metric, packed_query, m_packed_data, begin, end,
+                                  radius, results);
+    return;
+  }
+  for (std::size_t i = begin; i < end; ++i)
+  {
+    const distance_type dist = detail::evaluate_metric(m_compile_time_metric, query, (*m_data)[i]);
+    if (dist <= radius)
+    {
+      results.emplace_back(dist, i);
+    }
+  }
 }
 
 template<typename Element, typename Metric>
@@ -57,112 +130,176 @@ bool bfknn_parallel_generic_t<Element, Metric>::kneighbors_impl(
   const std::size_t data_size = m_data->size();
   num_neighbors = std::min(num_neighbors, data_size);
 
+  bool blocked = false;
+  if constexpr (k_blocked_l2)
+  {
+    blocked = use_blocked_kernel();
+  }
+  detail::packed_rows_t<value_type> packed_query;
+  if (blocked || use_runtime_metric())
+  {
+    packed_query.assign(&query, 1, detail::element_dims<value_type>(query));
+  }
+
   // For small datasets or when parallel is disabled, use sequential version
   if (!m_parallel_enabled || data_size < k_parallel_threshold)
   {
-    // Sequential implementation (same as non-parallel version)
-    std::vector<std::pair<distance_type, std::size_t>> distance_index_pairs;
-    distance_index_pairs.reserve(data_size);
-
-    for (std::size_t i = 0; i < data_size; ++i)
+    detail::top_k_heap_t<distance_type> heap(num_neighbors);
+    if constexpr (k_blocked_l2)
     {
-      distance_type dist;
-      if (m_use_runtime_metric && m_runtime_metric)
+      if (blocked)
       {
-        // For point types, convert to arrays and use distance method
-        value_type arr_query[3] = {query.x, query.y, query.z};
-        value_type arr_data[3] = {(*m_data)[i].x, (*m_data)[i].y, (*m_data)[i].z};
-        dist = m_runtime_metric->distance(arr_query, arr_data, 3);
+        detail::blocked_squared_l2_knn(m_blocked_data, packed_query, 0, 1, &heap,
+                                       0, m_blocked_data.num_blocks);
+        heap.extract(indices, distances, [](distance_type d) { return std::sqrt(d); });
+        return true;
       }
-      else
-      {
-        dist = m_compile_time_metric(query, (*m_data)[i]);
-      }
-      distance_index_pairs.emplace_back(dist, i);
     }
+    search_range(query, packed_query.row(0), 0, data_size, heap);
+    heap.extract(indices, distances, [](distance_type d) { return d; });
+    return true;
+  }
 
-    std::partial_sort(distance_index_pairs.begin(),
-                      distance_index_pairs.begin() + num_neighbors,
-                      distance_index_pairs.end(),
-                      [](const auto& a, const auto& b) { return a.first < b.first; });
+  // Parallel implementation: every task keeps its own bounded heap, merged at the end
+  auto& thread_pool = toolbox::base::thread_pool_singleton_t::instance();
+  const std::size_t num_threads = thread_pool.get_thread_count();
 
-    indices.resize(num_neighbors);
-    distances.resize(num_neighbors);
-    for (std::size_t i = 0; i < num_neighbors; ++i)
-    {
-      distances[i] = distance_index_pairs[i].first;
-      indices[i] = distance_index_pairs[i].second;
-    }
+  // 按数据块划分，使分块内核的块边界与任务边界一致 / Split by data blocks so task boundaries
+  // line up with the tiled kernel's blocks
+  const std::size_t num_units = blocked ? m_blocked_data.num_blocks : data_size;
+  const std::size_t chunk_size = (num_units + num_threads - 1) / num_threads;
+
+  std::vector<detail::top_k_heap_t<distance_type>> thread_heaps(
+      num_threads, detail::top_k_heap_t<distance_type>(num_neighbors));
+  std::vector<std::future<void>> futures;
+
+  for (std::size_t t = 0; t < num_threads; ++t)
+  {
+    const std::size_t start = t * chunk_size;
+    const std::size_t end = std::min(start + chunk_size, num_units);
+
+    if (start >= num_units) break;
+
+    futures.emplace_back(thread_pool.submit(
+        [this, &query, &packed_query, blocked, start, end, t, &thread_heaps]() {
+          if constexpr (k_blocked_l2)
+          {
+            if (blocked)
+            {
+              detail::blocked_squared_l2_knn(m_blocked_data, packed_query, 0, 1,
+                                             &thread_heaps[t], start, end);
+              return;
+            }
+          }
+          search_range(query, packed_query.row(0), start, end, thread_heaps[t]);
+        }));
+  }
+
+  for (auto& future : futures)
+  {
+    future.wait();
+  }
+
+  auto& result_heap = thread_heaps.front();
+  for (std::size_t t = 1; t < thread_heaps.size(); ++t)
+  {
+    result_heap.merge(thread_heaps[t]);
+  }
+
+  if (blocked)
+  {
+    result_heap.extract(indices, distances, [](distance_type d) { return std::sqrt(d); });
   }
   else
   {
-    // Parallel implementation
-    auto& thread_pool = toolbox::base::thread_pool_singleton_t::instance();
-    const std::size_t num_threads = thread_pool.get_thread_count();
-    const std::size_t chunk_size = (data_size + num_threads - 1) / num_threads;
+    result_heap.extract(indices, distances, [](distance_type d) { return d; });
+  }
 
-    // Thread-local storage for distance-index pairs
-    std::vector<std::vector<std::pair<distance_type, std::size_t>>> thread_results(num_threads);
-    std::vector<std::future<void>> futures;
+  return true;
+}
 
-    // Launch parallel tasks
-    for (std::size_t t = 0; t < num_threads; ++t)
-    {
-      const std::size_t start = t * chunk_size;
-      const std::size_t end = std::min(start + chunk_size, data_size);
-      
-      if (start >= data_size) break;
+template<typename Element, typename Metric>
+bool bfknn_parallel_generic_t<Element, Metric>::kneighbors_batch_impl(
+    const container_type& queries,
+    std::size_t num_neighbors,
+    std::vector<std::vector<std::size_t>>& indices,
+    std::vector<std::vector<distance_type>>& distances)
+{
+  if (!m_data || m_data->empty())
+  {
+    return false;
+  }
+
+  const std::size_t num_queries = queries.size();
+  indices.resize(num_queries);
+  distances.resize(num_queries);
+  num_neighbors = std::min(num_neighbors, m_data->size());
 
-      futures.emplace_back(thread_pool.submit([this, &query, start, end, t, &thread_results]() {
-        auto& local_results = thread_results[t];
-        local_results.reserve(end - start);
+  bool blocked = false;
+  if constexpr (k_blocked_l2)
+  {
+    blocked = use_blocked_kernel();
+  }
+  detail::packed_rows_t<value_type> packed_queries;
+  if ((blocked || use_runtime_metric()) && num_queries > 0)
+  {
+    packed_queries.assign(queries.data(), num_queries,
+                          detail::element_dims<value_type>(queries.front()));
+  }
 
-        for (std::size_t i = start; i < end; ++i)
+  // 每个任务处理一段连续的查询，结果直接写入各自的位置 / Each task handles a contiguous run
+  // of queries and writes its results in place
+  auto process = [&](std::size_t begin, std::size_t end) {
+    if constexpr (k_blocked_l2)
+    {
+      if (blocked)
+      {
+        std::vector<detail::top_k_heap_t<distance_type>> heaps(
+            end - begin, detail::top_k_heap_t<distance_type>(num_neighbors));
+        detail::blocked_squared_l2_knn(m_blocked_data, packed_queries, begin, end,
+                                       heaps.data(), 0, m_blocked_data.num_blocks);
+        for (std::size_t q = begin; q < end; ++q)
         {
-          distance_type dist;
-          if (m_use_runtime_metric && m_runtime_metric)
-          {
-            // For point types, convert to arrays and use distance method
-        value_type arr_query[3] = {query.x, query.y, query.z};
-        value_type arr_data[3] = {(*m_data)[i].x, (*m_data)[i].y, (*m_data)[i].z};
-        dist = m_runtime_metric->distance(arr_query, arr_data, 3);
-          }
-          else
-          {
-            dist = m_compile_time_metric(query, (*m_data)[i]);
-          }
-          local_results.emplace_back(dist, i);
+          heaps[q - begin].extract(indices[q], distances[q],
+                                   [](distance_type d) { return std::sqrt(d); });
         }
-      }));
+        return;
+      }
     }
-
-    // Wait for all tasks to complete
-    for (auto& future : futures)
+    detail::top_k_heap_t<distance_type> heap;
+    for (std::size_t q = begin; q < end; ++q)
     {
-      future.wait();
+      heap.reset(num_neighbors);
+      search_range(queries[q], packed_queries.row(q), 0, m_data->size(), heap);
+      heap.extract(indices[q], distances[q], [](distance_type d) { return d; });
     }
+  };
 
-    // Merge results from all threads
-    std::vector<std::pair<distance_type, std::size_t>> all_results;
-    all_results.reserve(data_size);
-    for (const auto& thread_result : thread_results)
-    {
-      all_results.insert(all_results.end(), thread_result.begin(), thread_result.end());
-    }
+  const std::size_t total_work = num_queries * m_data->size();
+  if (!m_parallel_enabled || total_work < k_parallel_threshold * k_parallel_threshold)
+  {
+    process(0, num_queries);
+    return true;
+  }
 
-    // Find k nearest neighbors
-    std::partial_sort(all_results.begin(),
-                      all_results.begin() + num_neighbors,
-                      all_results.end(),
-                      [](const auto& a, const auto& b) { return a.first < b.first; });
+  auto& thread_pool = toolbox::base::thread_pool_singleton_t::instance();
+  const std::size_t num_threads = thread_pool.get_thread_count();
+  const std::size_t chunk_size = (num_queries + num_threads - 1) / num_threads;
 
-    indices.resize(num_neighbors);
-    distances.resize(num_neighbors);
-    for (std::size_t i = 0; i < num_neighbors; ++i)
-    {
-      distances[i] = all_results[i].first;
-      indices[i] = all_results[i].second;
-    }
+  std::vector<std::future<void>> futures;
+  for (std::size_t t = 0; t < num_threads; ++t)
+  {
+    const std::size_t start = t * chunk_size;
+    const std::size_t end = std::min(start + chunk_size, num_queries);
+
+    if (start >= num_queries) break;
+
+    futures.emplace_back(thread_pool.submit([&process, start, end]() { process(start, end); }));
+  }
+
+  for (auto& future : futures)
+  {
+    future.wait();
   }
 
   return true;
@@ -185,32 +322,38 @@ bool bfknn_parallel_generic_t<Element, Metric>::radius_neighbors_impl(
 
   const std::size_t data_size = m_data->size();
 
+  detail::packed_rows_t<value_type> packed_query;
+  if (use_blocked_kernel() || use_runtime_metric())
+  {
+    packed_query.assign(&query, 1, detail::element_dims<value_type>(query));
+  }
+
   // For small datasets or when parallel is disabled, use sequential version
   if (!m_parallel_enabled || data_size < k_parallel_threshold)
   {
     std::vector<std::pair<distance_type, std::size_t>> distance_index_pairs;
 
-    for (std::size_t i = 0; i < data_size; ++i)
+    bool searched = false;
+    if constexpr (k_blocked_l2)
     {
-      distance_type dist;
-      if (m_use_runtime_metric && m_runtime_metric)
-      {
-        // For point types, convert to arrays and use distance method
-        value_type arr_query[3] = {query.x, query.y, query.z};
-        value_type arr_data[3] = {(*m_data)[i].x, (*m_data)[i].y, (*m_data)[i].z};
-        dist = m_runtime_metric->distance(arr_query, arr_data, 3);
-      }
-      else
+      if (use_blocked_kernel())
       {
-        dist = m_compile_time_metric(query, (*m_data)[i]);
-      }
-      
-      if (dist <= radius)
-      {
-        distance_index_pairs.emplace_back(dist, i);
+        detail::blocked_squared_l2_radius(m_blocked_data, packed_query.row(0),
+                                          radius * radius,
+                                          distance_index_pairs);
+        for (auto& pair : distance_index_pairs)
+        {
+          pair.first = std::sqrt(pair.first);
+        }
+        searched = true;
       }
     }
 
+    if (!searched)
+    {
+      radius_range(query, packed_query.row(0), radius, 0, data_size, distance_index_pairs);
+    }
+
     std::sort(distance_index_pairs.begin(), distance_index_pairs.end(),
               [](const auto& a, const auto& b) { return a.first < b.first; });
 
@@ -238,33 +381,13 @@ bool bfknn_parallel_generic_t<Element, Metric>::radius_neighbors_impl(
     {
       const std::size_t start = t * chunk_size;
       const std::size_t end = std::min(start + chunk_size, data_size);
-      
-      if (start >= data_size) break;
 
-      futures.emplace_back(thread_pool.submit([this, &query, radius, start, end, t, &thread_results]() {
-        auto& local_results = thread_results[t];
+      if (start >= data_size) break;
 
-        for (std::size_t i = start; i < end; ++i)
-        {
-          distance_type dist;
-          if (m_use_runtime_metric && m_runtime_metric)
-          {
-            // For point types, convert to arrays and use distance method
-        value_type arr_query[3] = {query.x, query.y, query.z};
-        value_type arr_data[3] = {(*m_data)[i].x, (*m_data)[i].y, (*m_data)[i].z};
-        dist = m_runtime_metric->distance(arr_query, arr_data, 3);
-          }
-          else
-          {
-            dist = m_compile_time_metric(query, (*m_data)[i]);
-          }
-          
-          if (dist <= radius)
-          {
-            local_results.emplace_back(dist, i);
-          }
-        }
-      }));
+      futures.emplace_back(thread_pool.submit(
+          [this, &query, &packed_query, radius, start, end, t, &thread_results]() {
+            radius_range(query, packed_query.row(0), radius, start, end, thread_results[t]);
+          }));
     }
 
     // Wait for all tasks to complete
@@ -295,4 +418,4 @@ bool bfknn_parallel_generic_t<Element, Metric>::radius_neighbors_impl(
   return true;
 }
 
-}  // namespace toolbox::pcl
\ No newline at end of file
+}  // namespace toolbox::pcl
@@ -0,0 +1,619 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <limits>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include <cpp-toolbox/base/thread_pool_singleton.hpp>
+#include <cpp-toolbox/pcl/knn/detail/index_serialization.hpp>
+
+namespace toolbox::pcl
+{
+
+template<typename Element, typename Metric>
+std::size_t hnsw_generic_t<Element, Metric>::set_input_impl(const container_type& data)
+{
+  return set_input_impl(std::make_shared<container_type>(data));
+}
+
+template<typename Element, typename Metric>
+std::size_t hnsw_generic_t<Element, Metric>::set_input_impl(const container_ptr& data)
+{
+  m_data = data;
+  if (m_data && m_data->size() >= std::numeric_limits<index_type>::max())
+  {
+    m_data.reset();
+  }
+  rebuild();
+  return m_data ? m_data->size() : 0;
+}
+
+template<typename Element, typename Metric>
+void hnsw_generic_t<Element, Metric>::set_metric_impl(const metric_type& metric)
+{
+  m_compile_time_metric = metric;
+  m_use_runtime_metric = false;
+  rebuild();
+}
+
+template<typename Element, typename Metric>
+void hnsw_generic_t<Element, Metric>::set_metric_impl(
+    std::shared_ptr<toolbox::metrics::IMetric<value_type>> metric)
+{
+  m_runtime_metric = metric;
+  m_use_runtime_metric = true;
+  rebuild();
+}
+
+template<typename Element, typename Metric>
+std::size_t hnsw_generic_t<Element, Metric>::add_points(const container_type& points)
+{
+  if (points.empty())
+  {
+    return size();
+  }
+  if (size() + points.size() >= std::numeric_limits<index_type>::max())
+  {
+    return size();
+  }
+
+  // 不修改调用者共享的容器 / Never modify a container shared with the caller
+  if (!m_data || m_data.use_count() > 1)
+  {
+    m_data = m_data ? std::make_shared<container_type>(*m_data)
+                    : std::make_shared<container_type>();
+  }
+
+  const std::size_t first = m_data->size();
+  m_data->insert(m_data->end(), points.begin(), points.end());
+  insert_new_points(first);
+  return m_data->size();
+}
+
+template<typename Element, typename Metric>
+void hnsw_generic_t<Element, Metric>::rebuild()
+{
+  m_levels.clear();
+  m_links.clear();
+  m_node_locks = std::vector<std::mutex>();
+  m_entry_point = 0;
+  m_max_level = -1;
+
+  if (!m_data || m_data->empty())
+  {
+    return;
+  }
+  insert_new_points(0);
+}
+
+template<typename Element, typename Metric>
+bool hnsw_generic_t<Element, Metric>::save_index(const std::filesystem::path& path) const
+{
+  static_assert(std::is_same_v<Element, toolbox::types::point_t<value_type>>,
+                "save_index stores point coordinates and requires point_t elements");
+  if (!m_data || m_data->empty() || m_max_level < 0)
+  {
+    LOG_ERROR_S << "hnsw_generic_t::save_index: No graph has been built";
+    return false;
+  }
+
+  // 参数、入口、每个节点的层级，然后按节点和层写入邻接表
+  // Parameters, entry point and node levels, then adjacency lists per node and level
+  std::string payload;
+  const std::uint64_t params[3] = {m_max_connections, m_ef_construction, m_ef_search};
+  const std::int32_t max_level = m_max_level;
+  detail::append_pod(payload, params, 3);
+  detail::append_pod(payload, &m_entry_point);
+  detail::append_pod(payload, &max_level);
+
+  std::vector<std::int32_t> levels(m_levels.begin(), m_levels.end());
+  detail::append_pod(payload, levels.data(), levels.size());
+  for (const auto& node_links : m_links)
+  {
+    for (const auto& links : node_links)
+    {
+      const auto count = static_cast<std::uint32_t>(links.size());
+      detail::append_pod(payload, &count);
+      detail::append_pod(payload, links.data(), links.size());
+    }
+  }
+  return detail::write_index_file(path, k_index_magic, *m_data, payload);
+}
+
+template<typename Element, typename Metric>
+bool hnsw_generic_t<Element, Metric>::load_index(const std::filesystem::path& path)
+{
+  static_assert(std::is_same_v<Element, toolbox::types::point_t<value_type>>,
+                "load_index reads point coordinates and requires point_t elements");
+
+  detail::mapped_index_file_t file;
+  auto data = std::make_shared<container_type>();
+  if (!file.open(path, k_index_magic, *data))
+  {
+    return false;
+  }
+
+  const std::size_t total = data->size();
+  detail::payload_reader_t reader(file.payload(), file.payload_size());
+  std::uint64_t params[3];
+  index_type entry_point = 0;
+  std::int32_t max_level = -1;
+  std::vector<std::int32_t> levels(total);
+  bool ok = reader.read(params, 3) && reader.read(&entry_point) && reader.read(&max_level)
+      && reader.read(levels.data(), levels.size()) && entry_point < total;
+
+  std::vector<std::vector<std::vector<index_type>>> links(total);
+  for (std::size_t i = 0; ok && i < total; ++i)
+  {
+    ok = levels[i] >= 0 && levels[i] <= max_level;
+    if (!ok) break;
+    links[i].resize(static_cast<std::size_t>(levels[i]) + 1);
+    for (auto& level_links : links[i])
+    {
+      std::uint32_t count = 0;
+      ok = reader.read(&count) && count <= total;
+      if (!ok) break;
+      level_links.resize(count);
+      ok = reader.read(level_links.data(), count);
+      if (!ok) break;
+      ok = std::all_of(level_links.begin(), level_links.end(),
+                       [total](index_type neighbor) { return neighbor < total; });
+      if (!ok) break;
+    }
+  }
+
+  if (!ok || !reader.at_end())
+  {
+    LOG_ERROR_S << "hnsw_generic_t::load_index: Corrupted graph data in " << path;
+    return false;
+  }
+
+  m_data = std::move(data);
+  m_max_connections = static_cast<std::size_t>(params[0]);
+  m_ef_construction = static_cast<std::size_t>(params[1]);
+  m_ef_search = static_cast<std::size_t>(params[2]);
+  m_entry_point = entry_point;
+  m_max_level = max_level;
+  m_levels.assign(levels.begin(), levels.end());
+  m_links = std::move(links);
+  m_node_locks = std::vector<std::mutex>(total);
+  return true;
+}
+
+template<typename Element, typename Metric>
+void hnsw_generic_t<Element, Metric>::insert_new_points(std::size_t first)
+{
+  const std::size_t total = m_data->size();
+
+  // 先顺序抽样层级，保证相同种子得到相同的层级分布 / Sample levels sequentially first so the
+  // same seed yields the same level assignment regardless of thread count
+  std::mt19937 rng(m_seed + static_cast<unsigned int>(first));
+  std::uniform_real_distribution<double> uniform(std::numeric_limits<double>::min(), 1.0);
+  const double level_mult = 1.0 / std::log(static_cast<double>(m_max_connections));
+
+  m_levels.resize(total);
+  m_links.resize(total);
+  for (std::size_t i = first; i < total; ++i)
+  {
+    const int level = static_cast<int>(-std::log(uniform(rng)) * level_mult);
+    m_levels[i] = level;
+    m_links[i].assign(static_cast<std::size_t>(level) + 1, std::vector<index_type>());
+    m_links[i][0].reserve(max_links(0) + 1);
+  }
+  m_node_locks = std::vector<std::mutex>(total);
+
+  std::size_t next = first;
+  // 图为空时先顺序插入第一个点 / Insert the first point sequentially when the graph is empty
+  if (m_max_level < 0)
+  {
+    insert_point(static_cast<index_type>(next++));
+  }
+
+  const std::size_t remaining = total - next;
+  if (!m_parallel_enabled || remaining < k_parallel_threshold)
+  {
+    for (; next < total; ++next)
+    {
+      insert_point(static_cast<index_type>(next));
+    }
+    return;
+  }
+
+  auto& thread_pool = toolbox::base::thread_pool_singleton_t::instance();
+  const std::size_t num_threads = std::max<std::size_t>(thread_pool.get_thread_count(), 1);
+  // 交错分配任务，使各线程同时填充图的不同区域 / Interleave work so threads grow the graph together
+  const std::size_t num_tasks = num_threads * 4;
+  const std::size_t chunk_size = (remaining + num_tasks - 1) / num_tasks;
+
+  m_concurrent_build = true;
+  std::vector<std::future<void>> futures;
+  futures.reserve(num_tasks);
+  for (std::size_t start = next; start < total; start += chunk_size)
+  {
+    const std::size_t end = std::min(start + chunk_size, total);
+    futures.emplace_back(thread_pool.submit([this, start, end]() {
+      for (std::size_t i = start; i < end; ++i)
+      {
+        insert_point(static_cast<index_type>(i));
+      }
+    }));
+  }
+  for (auto& future : futures)
+  {
+    future.get();
+  }
+  m_concurrent_build = false;
+}
+
+template<typename Element, typename Metric>
+void hnsw_generic_t<Element, Metric>::insert_point(index_type idx)
+{
+  const element_type& element = (*m_data)[idx];
+  const int level = m_levels[idx];
+
+  std::unique_lock<std::mutex> entry_lock(m_entry_mutex);
+  const int max_level = m_max_level;
+  const index_type entry_point = m_entry_point;
+  if (max_level < 0)
+  {
+    m_entry_point = idx;
+    m_max_level = level;
+    return;
+  }
+  // 只有提升最高层的插入才需要一直持有入口锁 / Only insertions raising the top level keep the entry lock
+  if (level <= max_level)
+  {
+    entry_lock.unlock();
+  }
+
+  index_type current = greedy_descend(element, entry_point, max_level, level + 1);
+
+  for (int lc = std::min(level, max_level); lc >= 0; --lc)
+  {
+    auto candidates = search_layer(element, current, m_ef_construction, lc);
+    current = candidates.front().second;
+
+    select_neighbors(candidates, m_max_connections);
+    {
+      std::unique_lock<std::mutex> node_lock(m_node_locks[idx], std::defer_lock);
+      if (m_concurrent_build) node_lock.lock();
+      auto& own_links = m_links[idx][lc];
+      own_links.clear();
+      for (const auto& candidate : candidates)
+      {
+        own_links.push_back(candidate.second);
+      }
+    }
+
+    const std::size_t link_limit = max_links(lc);
+    for (const auto& candidate : candidates)
+    {
+      const index_type neighbor = candidate.second;
+      std::unique_lock<std::mutex> neighbor_lock(m_node_locks[neighbor], std::defer_lock);
+      if (m_concurrent_build) neighbor_lock.lock();
+
+      auto& links = m_links[neighbor][lc];
+      if (std::find(links.begin(), links.end(), idx) != links.end())
+      {
+        continue;
+      }
+      if (links.size() < link_limit)
+      {
+        links.push_back(idx);
+        continue;
+      }
+
+      // 邻居已满，用启发式裁剪 / Neighbor is full, shrink with the heuristic
+      const element_type& neighbor_element = (*m_data)[neighbor];
+      std::vector<candidate_t> pool;
+      pool.reserve(links.size() + 1);
+      pool.emplace_back(candidate.first, idx);
+      for (const auto link : links)
+      {
+        pool.emplace_back(compute_distance(neighbor_element, (*m_data)[link]), link);
+      }
+      std::sort(pool.begin(), pool.end());
+      select_neighbors(pool, link_limit);
+      links.clear();
+      for (const auto& item : pool)
+      {
+        links.push_back(item.second);
+      }
+    }
+  }
+
+  if (level > max_level)
+  {
+    m_entry_point = idx;
+    m_max_level = level;
+  }
+}
+
+template<typename Element, typename Metric>
+typename hnsw_generic_t<Element, Metric>::distance_type
+hnsw_generic_t<Element, Metric>::compute_distance(const element_type& a, const element_type& b) const
+{
+  if (m_use_runtime_metric && m_runtime_metric)
+  {
+    if constexpr (std::is_same_v<Element, toolbox::types::point_t<value_type>>) {
+      value_type arr_a[3] = {a.x, a.y, a.z};
+      value_type arr_b[3] = {b.x, b.y, b.z};
+      return m_runtime_metric->distance(arr_a, arr_b, 3);
+    } else {
+      return m_runtime_metric->distance(a, b);
+    }
+  }
+  return m_compile_time_metric(a, b);
+}
+
+template<typename Element, typename Metric>
+void hnsw_generic_t<Element, Metric>::copy_links(index_type node,
+                                                 int level,
+                                                 std::vector<index_type>& out) const
+{
+  if (m_concurrent_build)
+  {
+    std::lock_guard<std::mutex> lock(m_node_locks[node]);
+    out = m_links[node][level];
+  }
+  else
+  {
+    out = m_links[node][level];
+  }
+}
+
+template<typename Element, typename Metric>
+typename hnsw_generic_t<Element, Metric>::index_type
+hnsw_generic_t<Element, Metric>::greedy_descend(const element_type& query,
+                                                index_type entry,
+                                                int from_level,
+                                                int to_level) const
+{
+  index_type current = entry;
+  distance_type current_dist = compute_distance(query, (*m_data)[current]);
+  std::vector<index_type> links;
+
+  for (int lc = from_level; lc >= to_level; --lc)
+  {
+    bool changed = true;
+    while (changed)
+    {
+      changed = false;
+      copy_links(current, lc, links);
+      for (const auto link : links)
+      {
+        const distance_type dist = compute_distance(query, (*m_data)[link]);
+        if (dist < current_dist)
+        {
+          current_dist = dist;
+          current = link;
+          changed = true;
+        }
+      }
+    }
+  }
+  return current;
+}
+
+template<typename Element, typename Metric>
+std::vector<typename hnsw_generic_t<Element, Metric>::candidate_t>
+hnsw_generic_t<Element, Metric>::search_layer(const element_type& query,
+                                              index_type entry,
+                                              std::size_t ef,
+                                              int level) const
+{
+  static thread_local visited_list_t visited;
+  visited.reset(m_data->size());
+
+  // 候选为最小堆，结果为最大堆 / Candidates form a min-heap, results a max-heap
+  std::priority_queue<candidate_t, std::vector<candidate_t>, std::greater<candidate_t>> candidates;
+  std::priority_queue<candidate_t> results;
+
+  const distance_type entry_dist = compute_distance(query, (*m_data)[entry]);
+  visited.visit(entry);
+  candidates.emplace(entry_dist, entry);
+  results.emplace(entry_dist, entry);
+
+  std::vector<index_type> links;
+  while (!candidates.empty())
+  {
+    const candidate_t closest = candidates.top();
+    if (closest.first > results.top().first && results.size() >= ef)
+    {
+      break;
+    }
+    candidates.pop();
+
+    copy_links(closest.second, level, links);
+    for (const auto link : links)
+    {
+      if (!visited.visit(link))
+      {
+        continue;
+      }
+      const distance_type dist = compute_distance(query, (*m_data)[link]);
+      if (results.size() < ef || dist < results.top().first)
+      {
+        candidates.emplace(dist, link);
+        results.emplace(dist, link);
+        if (results.size() > ef)
+        {
+          results.pop();
+        }
+      }
+    }
+  }
+
+  std::vector<candidate_t> sorted(results.size());
+  for (std::size_t i = sorted.size(); i > 0; --i)
+  {
+    sorted[i - 1] = results.top();
+    results.pop();
+  }
+  return sorted;
+}
+
+template<typename Element, typename Metric>
+void hnsw_generic_t<Element, Metric>::select_neighbors(std::vector<candidate_t>& candidates,
+                                                       std::size_t max_count) const
+{
+  if (candidates.size() <= max_count)
+  {
+    return;
+  }
+
+  // 启发式：只保留比已选邻居更靠近查询点的候选，使连接分布在不同方向
+  // Heuristic: keep a candidate only if it is closer to the query than to every
+  // selected neighbor, which spreads the connections over different directions
+  std::vector<candidate_t> selected;
+  selected.reserve(max_count);
+  for (const auto& candidate : candidates)
+  {
+    if (selected.size() >= max_count)
+    {
+      break;
+    }
+    const element_type& element = (*m_data)[candidate.second];
+    bool keep = true;
+    for (const auto& chosen : selected)
+    {
+      if (compute_distance(element, (*m_data)[chosen.second]) < candidate.first)
+      {
+        keep = false;
+        break;
+      }
+    }
+    if (keep)
+    {
+      selected.push_back(candidate);
+    }
+  }
+  candidates = std::move(selected);
+}
+
+template<typename Element, typename Metric>
+void hnsw_generic_t<Element, Metric>::refine_candidates(const element_type& query,
+                                                        std::vector<candidate_t>& candidates) const
+{
+  static thread_local visited_list_t visited;
+  visited.reset(m_data->size());
+  for (const auto& candidate : candidates)
+  {
+    visited.visit(candidate.second);
+  }
+
+  const std::size_t original_size = candidates.size();
+  for (std::size_t i = 0; i < original_size; ++i)
+  {
+    for (const auto link : m_links[candidates[i].second][0])
+    {
+      if (visited.visit(link))
+      {
+        candidates.emplace_back(compute_distance(query, (*m_data)[link]), link);
+      }
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+}
+
+template<typename Element, typename Metric>
+bool hnsw_generic_t<Element, Metric>::kneighbors_impl(
+    const element_type& query,
+    std::size_t num_neighbors,
+    std::vector<std::size_t>& indices,
+    std::vector<distance_type>& distances)
+{
+  if (!m_data || m_data->empty() || m_max_level < 0)
+  {
+    return false;
+  }
+
+  num_neighbors = std::min(num_neighbors, m_data->size());
+
+  const index_type entry = greedy_descend(query, m_entry_point, m_max_level, 1);
+  auto candidates = search_layer(query, entry, std::max(m_ef_search, num_neighbors), 0);
+  if (m_exact_rerank)
+  {
+    refine_candidates(query, candidates);
+  }
+
+  num_neighbors = std::min(num_neighbors, candidates.size());
+  indices.resize(num_neighbors);
+  distances.resize(num_neighbors);
+  for (std::size_t i = 0; i < num_neighbors; ++i)
+  {
+    distances[i] = candidates[i].first;
+    indices[i] = candidates[i].second;
+  }
+  return true;
+}
+
+template<typename Element, typename Metric>
+bool hnsw_generic_t<Element, Metric>::radius_neighbors_impl(
+    const element_type& query,
+    distance_type radius,
+    std::vector<std::size_t>& indices,
+    std::vector<distance_type>& distances)
+{
+  if (!m_data || m_data->empty() || m_max_level < 0 || radius <= 0)
+  {
+    return false;
+  }
+
+  indices.clear();
+  distances.clear();
+
+  const index_type entry = greedy_descend(query, m_entry_point, m_max_level, 1);
+  auto seeds = search_layer(query, entry, m_ef_search, 0);
+
+  static thread_local visited_list_t visited;
+  visited.reset(m_data->size());
+
+  // 沿底层图做广度优先扩展 / Breadth-first expansion along the bottom layer
+  std::vector<candidate_t> found;
+  std::vector<index_type> frontier;
+  for (const auto& seed : seeds)
+  {
+    visited.visit(seed.second);
+    if (seed.first <= radius)
+    {
+      found.push_back(seed);
+      frontier.push_back(seed.second);
+    }
+  }
+  while (!frontier.empty())
+  {
+    const index_type node = frontier.back();
+    frontier.pop_back();
+    for (const auto link : m_links[node][0])
+    {
+      if (!visited.visit(link))
+      {
+        continue;
+      }
+      const distance_type dist = compute_distance(query, (*m_data)[link]);
+      if (dist <= radius)
+      {
+        found.emplace_back(dist, link);
+        frontier.push_back(link);
+      }
+    }
+  }
+
+  std::sort(found.begin(), found.end());
+  indices.reserve(found.size());
+  distances.reserve(found.size());
+  for (const auto& [dist, idx] : found)
+  {
+    distances.push_back(dist);
+    indices.push_back(idx);
+  }
+  return true;
+}
+
+}  // namespace toolbox::pcl
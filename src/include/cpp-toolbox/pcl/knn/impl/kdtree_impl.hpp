@@ -2,12 +2,105 @@
 
 #include <algorithm>
 #include <cmath>
+#include <exception>
+#include <future>
+#include <sstream>
 #include <vector>
+
+#include <cpp-toolbox/base/thread_pool_singleton.hpp>
 #include <cpp-toolbox/pcl/knn/bfknn.hpp>
+#include <cpp-toolbox/pcl/knn/detail/index_serialization.hpp>
 
 namespace toolbox::pcl
 {
 
+namespace detail
+{
+
+/**
+ * @brief 检查nanoflann树数据是否完整且与点数一致 / Check that nanoflann tree data is
+ * complete and consistent with the point count
+ *
+ * nanoflann按数据中的长度分配内存，并按节点中的子指针是否为空递归读取，损坏的数据会导致
+ * 巨大的分配、无限递归或查询时越界。这里先在映射内存上走一遍同样的布局，检查点数、维数、
+ * 每个索引和每个叶节点区间。
+ * nanoflann allocates from sizes read from the data and recurses on whether the child
+ * pointers of a node are null, so corrupt data leads to huge allocations, unbounded
+ * recursion or out-of-range reads at query time. This walks the same layout over mapped
+ * memory first and checks the point count, the dimension, every index and every leaf
+ * range.
+ */
+template<typename Tree>
+bool validate_kdtree_payload(const unsigned char* data,
+                             std::size_t size,
+                             std::size_t point_count,
+                             int dimensions)
+{
+  using size_type = typename Tree::Size;
+  using node_type = typename Tree::Node;
+  using index_type = typename Tree::IndexType;
+
+  payload_reader_t reader(data, size);
+  size_type tree_size = 0;
+  typename Tree::Dimension tree_dimensions = 0;
+  decltype(std::declval<Tree&>().root_bbox_) root_bbox {};
+  size_type leaf_max_size = 0;
+  std::size_t num_indices = 0;
+  if (!reader.read(&tree_size) || !reader.read(&tree_dimensions) || !reader.read(&root_bbox)
+      || !reader.read(&leaf_max_size) || !reader.read(&num_indices))
+  {
+    return false;
+  }
+  if (tree_size != point_count || tree_dimensions != dimensions || num_indices != point_count)
+  {
+    return false;
+  }
+
+  for (std::size_t i = 0; i < num_indices; ++i)
+  {
+    index_type index {};
+    if (!reader.read(&index) || static_cast<std::size_t>(index) >= point_count)
+    {
+      return false;
+    }
+  }
+
+  // 前序排列的节点：每读一个节点，待读数减一再加上非空子节点数 / Nodes in preorder:
+  // every node read settles one pending node and adds its non-null children
+  std::size_t pending = 1;
+  while (pending > 0)
+  {
+    node_type node;
+    if (!reader.read(&node))
+    {
+      return false;
+    }
+    --pending;
+    const bool has_child1 = node.child1 != nullptr;
+    const bool has_child2 = node.child2 != nullptr;
+    if (has_child1 != has_child2)
+    {
+      return false;
+    }
+    if (has_child1)
+    {
+      if (node.node_type.sub.divfeat < 0 || node.node_type.sub.divfeat >= dimensions)
+      {
+        return false;
+      }
+      pending += 2;
+    }
+    else if (node.node_type.lr.left > node.node_type.lr.right
+             || node.node_type.lr.right > num_indices)
+    {
+      return false;
+    }
+  }
+  return reader.at_end();
+}
+
+}  // namespace detail
+
 // Generic KD-tree implementation
 template<typename Element, typename Metric>
 std::size_t kdtree_generic_t<Element, Metric>::set_input_impl(const container_type& data)
@@ -17,6 +110,7 @@ std::size_t kdtree_generic_t<Element, Metric>::set_input_impl(const container_ty
   {
     build_tree();
   }
+  rebuild_fallback();
   return m_data->size();
 }
 
@@ -28,6 +122,7 @@ std::size_t kdtree_generic_t<Element, Metric>::set_input_impl(const container_pt
   {
     build_tree();
   }
+  rebuild_fallback();
   return m_data ? m_data->size() : 0;
 }
 
@@ -40,6 +135,7 @@ void kdtree_generic_t<Element, Metric>::set_metric_impl(const metric_type& metri
   {
     build_tree();
   }
+  rebuild_fallback();
 }
 
 template<typename Element, typename Metric>
@@ -50,6 +146,28 @@ void kdtree_generic_t<Element, Metric>::set_metric_impl(
   m_use_runtime_metric = true;
   // Note: Runtime metrics are not supported by nanoflann KD-tree
   // This will use brute-force fallback in kneighbors/radius_neighbors
+  rebuild_fallback();
+}
+
+template<typename Element, typename Metric>
+void kdtree_generic_t<Element, Metric>::rebuild_fallback()
+{
+  // 先清空旧数据，换度量时不会重新打包将被替换的点 / Drop the old data first so a
+  // metric change does not repack points that are about to be replaced
+  m_fallback.set_input(container_ptr {});
+  if (!m_data || m_data->empty() || validate_metric())
+  {
+    return;
+  }
+  if (m_use_runtime_metric)
+  {
+    m_fallback.set_metric(m_runtime_metric);
+  }
+  else
+  {
+    m_fallback.set_metric(m_compile_time_metric);
+  }
+  m_fallback.set_input(m_data);
 }
 
 template<typename Element, typename Metric>
@@ -79,16 +197,160 @@ void kdtree_generic_t<Element, Metric>::build_tree()
   // Create adaptor
   m_adaptor = std::make_unique<data_adaptor_t>(m_data);
 
-  // Create and build KD-tree
+  unsigned int num_build_threads = 1;
+  if (m_parallel_enabled && m_data->size() >= k_parallel_threshold)
+  {
+    num_build_threads = static_cast<unsigned int>(std::max<std::size_t>(
+        toolbox::base::thread_pool_singleton_t::instance().get_thread_count(), 1));
+    compute_bounding_box_parallel();
+  }
+
+  // Create KD-tree without the implicit build in the constructor, then build once
   m_kdtree = std::make_unique<kd_tree_t>(
       3,  // dimensions
       *m_adaptor,
-      nanoflann::KDTreeSingleIndexAdaptorParams(m_max_leaf_size)
+      nanoflann::KDTreeSingleIndexAdaptorParams(
+          m_max_leaf_size,
+          nanoflann::KDTreeSingleIndexAdaptorFlags::SkipInitialBuildIndex,
+          num_build_threads)
   );
 
   m_kdtree->buildIndex();
 }
 
+template<typename Element, typename Metric>
+void kdtree_generic_t<Element, Metric>::compute_bounding_box_parallel()
+{
+  using bbox_type = std::array<std::pair<value_type, value_type>, 3>;
+
+  auto& thread_pool = toolbox::base::thread_pool_singleton_t::instance();
+  const std::size_t data_size = m_data->size();
+  const std::size_t num_threads = std::max<std::size_t>(thread_pool.get_thread_count(), 1);
+  const std::size_t chunk_size = (data_size + num_threads - 1) / num_threads;
+
+  std::vector<bbox_type> thread_boxes(num_threads);
+  std::vector<std::future<void>> futures;
+
+  for (std::size_t t = 0; t < num_threads; ++t)
+  {
+    const std::size_t start = t * chunk_size;
+    const std::size_t end = std::min(start + chunk_size, data_size);
+
+    if (start >= data_size) break;
+
+    futures.emplace_back(thread_pool.submit([this, start, end, t, &thread_boxes]() {
+      const auto& points = *m_data;
+      bbox_type box;
+      box[0] = {points[start].x, points[start].x};
+      box[1] = {points[start].y, points[start].y};
+      box[2] = {points[start].z, points[start].z};
+      for (std::size_t i = start + 1; i < end; ++i)
+      {
+        const auto& p = points[i];
+        box[0] = {std::min(box[0].first, p.x), std::max(box[0].second, p.x)};
+        box[1] = {std::min(box[1].first, p.y), std::max(box[1].second, p.y)};
+        box[2] = {std::min(box[2].first, p.z), std::max(box[2].second, p.z)};
+      }
+      thread_boxes[t] = box;
+    }));
+  }
+
+  for (auto& future : futures)
+  {
+    future.wait();
+  }
+
+  auto& bbox = m_adaptor->bbox;
+  bbox = thread_boxes.front();
+  for (std::size_t t = 1; t < futures.size(); ++t)
+  {
+    for (std::size_t d = 0; d < 3; ++d)
+    {
+      bbox[d].first = std::min(bbox[d].first, thread_boxes[t][d].first);
+      bbox[d].second = std::max(bbox[d].second, thread_boxes[t][d].second);
+    }
+  }
+  m_adaptor->has_bbox = true;
+}
+
+template<typename Element, typename Metric>
+bool kdtree_generic_t<Element, Metric>::save_index(const std::filesystem::path& path) const
+{
+  if (!m_kdtree || !m_data || m_data->empty())
+  {
+    LOG_ERROR_S << "kdtree_generic_t::save_index: No KD-tree has been built";
+    return false;
+  }
+
+  std::ostringstream payload(std::ios::binary);
+  m_kdtree->saveIndex(payload);
+  return detail::write_index_file(path, k_index_magic, *m_data, payload.str());
+}
+
+template<typename Element, typename Metric>
+bool kdtree_generic_t<Element, Metric>::load_index(const std::filesystem::path& path)
+{
+  // 任何失败都让对象回到未设置输入的状态 / Any failure leaves the object without input
+  m_kdtree.reset();
+  m_adaptor.reset();
+  m_data.reset();
+  rebuild_fallback();
+
+  detail::mapped_index_file_t file;
+  auto data = std::make_shared<container_type>();
+  if (!file.open(path, k_index_magic, *data))
+  {
+    return false;
+  }
+
+  if (!detail::validate_kdtree_payload<kd_tree_t>(
+          file.payload(), file.payload_size(), data->size(), 3))
+  {
+    LOG_ERROR_S << "kdtree_generic_t::load_index: Corrupted tree data in " << path;
+    return false;
+  }
+
+  // 适配器引用m_data，须先设置 / The adaptor refers to m_data, so set it first
+  m_data = std::move(data);
+  m_adaptor = std::make_unique<data_adaptor_t>(m_data);
+  bool loaded = false;
+  try
+  {
+    m_kdtree = std::make_unique<kd_tree_t>(
+        3,  // dimensions
+        *m_adaptor,
+        nanoflann::KDTreeSingleIndexAdaptorParams(
+            m_max_leaf_size, nanoflann::KDTreeSingleIndexAdaptorFlags::SkipInitialBuildIndex));
+
+    detail::memory_streambuf_t buffer(file.payload(), file.payload_size());
+    std::istream stream(&buffer);
+    m_kdtree->loadIndex(stream);
+    loaded = static_cast<bool>(stream);
+    if (!loaded)
+    {
+      LOG_ERROR_S << "kdtree_generic_t::load_index: Corrupted tree data in " << path;
+    }
+  }
+  catch (const std::exception& e)
+  {
+    LOG_ERROR_S << "kdtree_generic_t::load_index: Failed to load tree from " << path << ": "
+                << e.what();
+  }
+
+  if (!loaded)
+  {
+    m_kdtree.reset();
+    m_adaptor.reset();
+    m_data.reset();
+    return false;
+  }
+
+  // 加载的树总是按L2构建的 / A loaded tree is always an L2 tree
+  m_use_runtime_metric = false;
+  rebuild_fallback();
+  return true;
+}
+
 template<typename Element, typename Metric>
 bool kdtree_generic_t<Element, Metric>::kneighbors_impl(
     const element_type& query,
@@ -104,17 +366,7 @@ bool kdtree_generic_t<Element, Metric>::kneighbors_impl(
   // If metric is not supported by KD-tree, fall back to brute-force
   if (!validate_metric())
   {
-    bfknn_generic_t<Element, Metric> bfknn;
-    bfknn.set_input(m_data);
-    if (m_use_runtime_metric)
-    {
-      bfknn.set_metric(m_runtime_metric);
-    }
-    else
-    {
-      bfknn.set_metric(m_compile_time_metric);
-    }
-    return bfknn.kneighbors(query, num_neighbors, indices, distances);
+    return m_fallback.kneighbors(query, num_neighbors, indices, distances);
   }
 
   if (!m_kdtree)
@@ -166,17 +418,7 @@ bool kdtree_generic_t<Element, Metric>::radius_neighbors_impl(
   // If metric is not supported by KD-tree, fall back to brute-force
   if (!validate_metric())
   {
-    bfknn_generic_t<Element, Metric> bfknn;
-    bfknn.set_input(m_data);
-    if (m_use_runtime_metric)
-    {
-      bfknn.set_metric(m_runtime_metric);
-    }
-    else
-    {
-      bfknn.set_metric(m_compile_time_metric);
-    }
-    return bfknn.radius_neighbors(query, radius, indices, distances);
+    return m_fallback.radius_neighbors(query, radius, indices, distances);
   }
 
   if (!m_kdtree)
@@ -227,4 +469,24 @@ bool kdtree_generic_t<Element, Metric>::radius_neighbors_impl(
   return true;
 }
 
+template<typename Element, typename Metric>
+bool kdtree_generic_t<Element, Metric>::kneighbors_batch_impl(
+    const container_type& queries,
+    std::size_t num_neighbors,
+    std::vector<std::vector<std::size_t>>& indices,
+    std::vector<std::vector<distance_type>>& distances)
+{
+  if (!m_data || m_data->empty())
+  {
+    return false;
+  }
+
+  // 后备的暴力搜索有自己的批量内核 / The brute-force fallback has its own batch kernel
+  if (!validate_metric())
+  {
+    return m_fallback.kneighbors_batch(queries, num_neighbors, indices, distances);
+  }
+  return base_type::kneighbors_batch_impl(queries, num_neighbors, indices, distances);
+}
+
 }  // namespace toolbox::pcl
\ No newline at end of file
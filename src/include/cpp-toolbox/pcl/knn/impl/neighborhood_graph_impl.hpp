@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+#include <cpp-toolbox/concurrent/parallel.hpp>
+#include <cpp-toolbox/logger/thread_logger.hpp>
+
+namespace toolbox::pcl
+{
+
+template<typename DataType>
+template<typename Derived, typename Element, typename Metric>
+bool neighborhood_graph_t<DataType>::build_radius(
+    base_knn_generic_t<Derived, Element, Metric>& knn,
+    const std::vector<Element>& queries,
+    data_type radius,
+    std::size_t max_neighbors,
+    bool parallel)
+{
+  if (radius <= data_type(0))
+  {
+    LOG_ERROR_S << "neighborhood_graph_t: Radius must be positive, got " << radius;
+    return false;
+  }
+
+  using distance_type = typename base_knn_generic_t<Derived, Element, Metric>::distance_type;
+  static_assert(std::is_same_v<distance_type, data_type>,
+                "neighborhood_graph_t stores distances as its data type");
+  if constexpr (detail::searches_on_thread_pool<Derived>::value)
+  {
+    parallel = parallel && !static_cast<Derived&>(knn).is_parallel_enabled();
+  }
+  const bool built = build_rows(
+      queries, max_neighbors, parallel,
+      [&knn, radius](const Element& query,
+                     std::vector<std::size_t>& indices,
+                     std::vector<distance_type>& distances)
+      { return knn.radius_neighbors(query, static_cast<distance_type>(radius), indices, distances); });
+  if (built)
+  {
+    m_radius = radius;
+    m_max_neighbors = max_neighbors;
+  }
+  return built;
+}
+
+template<typename DataType>
+template<typename Derived, typename Element, typename Metric>
+bool neighborhood_graph_t<DataType>::build_knn(
+    base_knn_generic_t<Derived, Element, Metric>& knn,
+    const std::vector<Element>& queries,
+    std::size_t num_neighbors,
+    bool parallel)
+{
+  if (num_neighbors == 0)
+  {
+    LOG_ERROR_S << "neighborhood_graph_t: Number of neighbors must be positive";
+    return false;
+  }
+
+  using distance_type = typename base_knn_generic_t<Derived, Element, Metric>::distance_type;
+  static_assert(std::is_same_v<distance_type, data_type>,
+                "neighborhood_graph_t stores distances as its data type");
+  if constexpr (detail::searches_on_thread_pool<Derived>::value)
+  {
+    parallel = parallel && !static_cast<Derived&>(knn).is_parallel_enabled();
+  }
+  const bool built = build_rows(
+      queries, num_neighbors, parallel,
+      [&knn, num_neighbors](const Element& query,
+                            std::vector<std::size_t>& indices,
+                            std::vector<distance_type>& distances)
+      { return knn.kneighbors(query, num_neighbors, indices, distances); });
+  if (built)
+  {
+    m_radius = data_type(0);
+    m_max_neighbors = num_neighbors;
+  }
+  return built;
+}
+
+template<typename DataType>
+template<typename Element, typename Search>
+bool neighborhood_graph_t<DataType>::build_rows(const std::vector<Element>& queries,
+                                                std::size_t row_limit,
+                                                bool parallel,
+                                                Search search)
+{
+  clear();
+  if (queries.empty())
+  {
+    return false;
+  }
+
+  // 每块独立收集邻居，最后按块顺序拼接 / Each chunk collects its rows independently,
+  // the chunks are stitched in order afterwards
+  struct chunk_rows_t
+  {
+    std::vector<std::size_t> counts;
+    std::vector<std::size_t> indices;
+    std::vector<data_type> distances;
+    std::size_t begin = 0;
+    bool ok = true;
+  };
+
+  auto process_range = [&](std::size_t begin, std::size_t end, chunk_rows_t& chunk)
+  {
+    chunk.begin = begin;
+    std::vector<std::size_t> row_indices;
+    std::vector<data_type> row_distances;
+    std::vector<std::pair<data_type, std::size_t>> pairs;
+    chunk.counts.resize(end - begin);
+
+    for (std::size_t q = begin; q < end; ++q)
+    {
+      row_indices.clear();
+      row_distances.clear();
+      if (!search(queries[q], row_indices, row_distances))
+      {
+        chunk.ok = false;
+        return;
+      }
+
+      // 保证行内按距离升序，截断时保留最近的邻居 / Keep rows sorted by distance so
+      // truncation keeps the nearest neighbors
+      if (!std::is_sorted(row_distances.begin(), row_distances.end()))
+      {
+        pairs.clear();
+        for (std::size_t j = 0; j < row_indices.size(); ++j)
+        {
+          pairs.emplace_back(row_distances[j], row_indices[j]);
+        }
+        std::sort(pairs.begin(), pairs.end());
+        for (std::size_t j = 0; j < pairs.size(); ++j)
+        {
+          row_distances[j] = pairs[j].first;
+          row_indices[j] = pairs[j].second;
+        }
+      }
+
+      std::size_t count = row_indices.size();
+      if (row_limit > 0)
+      {
+        count = std::min(count, row_limit);
+      }
+      chunk.counts[q - begin] = count;
+      chunk.indices.insert(chunk.indices.end(), row_indices.begin(), row_indices.begin() + count);
+      chunk.distances.insert(
+          chunk.distances.end(), row_distances.begin(), row_distances.begin() + count);
+    }
+  };
+
+  const std::size_t num_queries = queries.size();
+  std::vector<chunk_rows_t> chunks(
+      toolbox::concurrent::parallel_chunk_count(num_queries, k_parallel_threshold, parallel));
+  toolbox::concurrent::parallel_for_chunks(
+      num_queries,
+      k_parallel_threshold,
+      parallel,
+      [&](std::size_t c, std::size_t begin, std::size_t end)
+      { process_range(begin, end, chunks[c]); });
+
+  std::size_t total_edges = 0;
+  for (const auto& chunk : chunks)
+  {
+    if (!chunk.ok)
+    {
+      LOG_ERROR_S << "neighborhood_graph_t: Neighbor search failed, is the KNN input set?";
+      return false;
+    }
+    total_edges += chunk.indices.size();
+  }
+
+  m_offsets.resize(num_queries + 1);
+  m_offsets[0] = 0;
+  m_indices.reserve(total_edges);
+  m_distances.reserve(total_edges);
+  for (std::size_t c = 0; c < chunks.size(); ++c)
+  {
+    const auto& chunk = chunks[c];
+    for (std::size_t r = 0; r < chunk.counts.size(); ++r)
+    {
+      const std::size_t row = chunk.begin + r;
+      m_offsets[row + 1] = m_offsets[row] + chunk.counts[r];
+    }
+    m_indices.insert(m_indices.end(), chunk.indices.begin(), chunk.indices.end());
+    m_distances.insert(m_distances.end(), chunk.distances.begin(), chunk.distances.end());
+  }
+  return true;
+}
+
+template<typename DataType>
+typename neighborhood_graph_t<DataType>::neighbor_range_t
+neighborhood_graph_t<DataType>::neighbors(std::size_t i,
+                                          data_type radius,
+                                          std::size_t max_neighbors) const noexcept
+{
+  neighbor_range_t row = neighbors(i);
+  // 行内按距离升序，前缀即半径内的邻居 / Rows are sorted, so the radius cut is a prefix
+  row.size = static_cast<std::size_t>(
+      std::upper_bound(row.distances, row.distances + row.size, radius) - row.distances);
+  if (max_neighbors > 0)
+  {
+    row.size = std::min(row.size, max_neighbors);
+  }
+  return row;
+}
+
+template<typename DataType>
+bool neighborhood_graph_t<DataType>::neighbors(std::size_t i,
+                                               data_type radius,
+                                               std::size_t max_neighbors,
+                                               std::vector<std::size_t>& indices,
+                                               std::vector<data_type>& distances) const
+{
+  if (i >= size())
+  {
+    return false;
+  }
+  const neighbor_range_t row = neighbors(i, radius, max_neighbors);
+  indices.assign(row.indices, row.indices + row.size);
+  distances.assign(row.distances, row.distances + row.size);
+  return true;
+}
+
+template<typename DataType>
+void neighborhood_graph_t<DataType>::clear()
+{
+  m_offsets.clear();
+  m_indices.clear();
+  m_distances.clear();
+  m_radius = data_type(0);
+  m_max_neighbors = 0;
+}
+
+}  // namespace toolbox::pcl
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <array>
+#include <filesystem>
+#include <utility>
+
 #include <cpp-toolbox/pcl/knn/base_knn.hpp>
+#include <cpp-toolbox/pcl/knn/bfknn.hpp>
 #include <cpp-toolbox/metrics/metric_factory.hpp>
 #include <cpp-toolbox/metrics/vector_metrics.hpp>
 #include <nanoflann.hpp>
@@ -49,9 +54,57 @@ public:
                              std::vector<std::size_t>& indices,
                              std::vector<distance_type>& distances);
 
+  bool kneighbors_batch_impl(const container_type& queries,
+                             std::size_t num_neighbors,
+                             std::vector<std::vector<std::size_t>>& indices,
+                             std::vector<std::vector<distance_type>>& distances);
+
   void set_max_leaf_size(std::size_t max_leaf_size) { m_max_leaf_size = max_leaf_size; }
   [[nodiscard]] std::size_t get_max_leaf_size() const noexcept { return m_max_leaf_size; }
 
+  /**
+   * @brief 启用或禁用并行构建 / Enable or disable parallel tree construction
+   *
+   * 启用后，点数超过阈值时包围盒在线程池中分块计算，左右子树并发划分；树的结构与串行构建相同。
+   * When enabled and the cloud exceeds the threshold, the bounding box is computed in
+   * chunks on the thread pool and left/right subtrees are split concurrently; the tree
+   * structure is identical to the serial build.
+   */
+  void enable_parallel(bool enable) { m_parallel_enabled = enable; }
+  [[nodiscard]] bool is_parallel_enabled() const noexcept { return m_parallel_enabled; }
+
+  /**
+   * @brief 把点和已构建的树保存到二进制文件 / Save the points and the built tree to a binary file
+   * @param path 文件路径 / File path
+   * @return 是否成功，没有可用的树时返回false / Whether successful, false when no tree is built
+   *
+   * @code
+   * kdtree_t<float> tree;
+   * tree.set_input(prior_map);
+   * tree.save_index("prior_map.kdt");
+   *
+   * // 下次启动时直接加载，无需重建 / Load on the next start instead of rebuilding
+   * kdtree_t<float> loaded;
+   * loaded.load_index("prior_map.kdt");
+   * @endcode
+   */
+  bool save_index(const std::filesystem::path& path) const;
+
+  /**
+   * @brief 从save_index写入的文件加载点和树 / Load points and tree from a file written by save_index
+   *
+   * 文件通过内存映射读取：坐标一次复制，节点按顺序从映射内存中重新链接，不做任何划分或排序。
+   * The file is read through a memory mapping: coordinates are copied once and nodes are
+   * relinked in order straight from mapped memory, without any splitting or sorting.
+   * 树数据先整体校验（点数、维数、每个索引和叶节点区间），失败时对象不保留任何输入。
+   * The tree data is validated first (point count, dimension, every index and leaf
+   * range); on failure the object is left without any input.
+   *
+   * @param path 文件路径 / File path
+   * @return 是否成功 / Whether successful
+   */
+  bool load_index(const std::filesystem::path& path);
+
 private:
   // Dataset adaptor for nanoflann - generic version
   struct data_adaptor_t
@@ -71,8 +124,22 @@ private:
       else return element.z;
     }
 
+    // 预先计算的包围盒，未计算时由nanoflann自己遍历 / Precomputed bounding box, nanoflann
+    // scans the data itself when absent
+    std::array<std::pair<value_type, value_type>, 3> bbox {};
+    bool has_bbox = false;
+
     template<class BBOX>
-    bool kdtree_get_bbox(BBOX& /*bb*/) const { return false; }
+    bool kdtree_get_bbox(BBOX& bb) const
+    {
+      if (!has_bbox) return false;
+      for (std::size_t d = 0; d < dims; ++d)
+      {
+        bb[d].low = bbox[d].first;
+        bb[d].high = bbox[d].second;
+      }
+      return true;
+    }
   };
 
   // Metric adaptor to bridge between our metrics and nanoflann
@@ -105,15 +172,23 @@ private:
   >;
 
   void build_tree();
+  void compute_bounding_box_parallel();
   bool validate_metric() const;
+  // 度量不被树支持时，按当前数据和度量重建暴力搜索后备 / Rebuild the brute-force
+  // fallback from the current data and metric when the tree cannot serve the metric
+  void rebuild_fallback();
 
   container_ptr m_data;
   std::unique_ptr<data_adaptor_t> m_adaptor;
   std::unique_ptr<kd_tree_t> m_kdtree;
+  bfknn_generic_t<Element, Metric> m_fallback;
   metric_type m_compile_time_metric;
   std::shared_ptr<toolbox::metrics::IMetric<value_type>> m_runtime_metric;
   bool m_use_runtime_metric = false;
   std::size_t m_max_leaf_size = 10;
+  bool m_parallel_enabled = true;
+  static constexpr std::size_t k_parallel_threshold = 50000;
+  static constexpr char k_index_magic[9] = "CTBKDTRE";
 };
 
 // Type aliases for common use cases
@@ -51,6 +51,8 @@
 #include <cpp-toolbox/pcl/knn/bfknn.hpp>
 #include <cpp-toolbox/pcl/knn/bfknn_parallel.hpp>
 #include <cpp-toolbox/pcl/knn/kdtree.hpp>
+#include <cpp-toolbox/pcl/knn/hnsw.hpp>
+#include <cpp-toolbox/pcl/knn/neighborhood_graph.hpp>
 
 namespace toolbox::pcl
 {
@@ -72,6 +74,9 @@ namespace toolbox::pcl
  * - bfknn_parallel_t: 适用于中等规模数据集需要加速的场景 / 
  *   Suitable for medium-sized datasets requiring acceleration
  * 
+ * - hnsw_generic_t: 适用于高维描述子（FPFH、SHOT等）的近似搜索 / 
+ *   Suitable for approximate search over high-dimensional descriptors (FPFH, SHOT, ...)
+ * 
  * @code
  * // 根据数据规模选择算法 / Choose algorithm based on data size
  * template<typename T>
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include <cpp-toolbox/cpp-toolbox_export.hpp>
+#include <cpp-toolbox/pcl/knn/base_knn.hpp>
+#include <cpp-toolbox/pcl/knn/bfknn_parallel.hpp>
+
+namespace toolbox::pcl
+{
+
+namespace detail
+{
+
+/// 单次搜索本身就在线程池上并行的KNN / KNN types whose single searches already fan out over the thread pool
+template<typename Derived>
+struct searches_on_thread_pool : std::false_type
+{
+};
+
+template<typename Element, typename Metric>
+struct searches_on_thread_pool<bfknn_parallel_generic_t<Element, Metric>> : std::true_type
+{
+};
+
+}  // namespace detail
+
+/**
+ * @brief 预计算的近邻图（CSR格式） / Precomputed neighborhood graph in CSR layout
+ *
+ * 对每个查询点只做一次近邻搜索，把结果按行压缩存储（offsets / indices / distances），
+ * 行内按距离升序排列。法向量、关键点和描述子提取器可以共享同一张图，而不是各自重复做半径搜索。
+ * Runs the neighbor search once per query point and stores the results row-compressed
+ * (offsets / indices / distances), each row sorted by ascending distance. Normal, keypoint
+ * and descriptor extractors can share one graph instead of repeating the same radius
+ * searches.
+ *
+ * @tparam DataType 数据类型（如float或double） / Data type (e.g., float or double)
+ *
+ * @code
+ * kdtree_t<float> kdtree;
+ * kdtree.set_input(cloud);
+ *
+ * // 一次搜索，服务整个前端 / One search pass serves the whole front-end
+ * neighborhood_graph_t<float> graph;
+ * graph.build_radius(kdtree, cloud.points, 0.1f, 64);
+ *
+ * pca_norm_extractor_t<float> normals;
+ * normals.set_input(cloud);
+ * normals.set_num_neighbors(30);
+ * normals.set_neighborhood_graph(graph);
+ *
+ * fpfh_extractor_t<float> fpfh;
+ * fpfh.set_input(cloud);
+ * fpfh.set_search_radius(0.1f);
+ * fpfh.set_neighborhood_graph(graph);
+ * @endcode
+ *
+ * @note 使用图的提取器只会读取每行中满足自身半径/数量限制的前缀，因此建图时的半径应不小于
+ * 各提取器使用的最大半径 / Extractors using the graph only read the prefix of each row that
+ * satisfies their own radius/count limits, so the graph should be built with a radius no
+ * smaller than the largest radius used downstream
+ */
+template<typename DataType>
+class CPP_TOOLBOX_EXPORT neighborhood_graph_t
+{
+public:
+  using data_type = DataType;
+
+  /**
+   * @brief 一行邻居的只读视图 / Read-only view of one row of neighbors
+   */
+  struct neighbor_range_t
+  {
+    const std::size_t* indices = nullptr;  ///< 邻居索引 / Neighbor indices
+    const data_type* distances = nullptr;  ///< 对应的距离 / Corresponding distances
+    std::size_t size = 0;  ///< 邻居数量 / Number of neighbors
+  };
+
+  neighborhood_graph_t() = default;
+
+  /**
+   * @brief 用半径搜索建图 / Build the graph with radius searches
+   * @param knn 已设置输入数据的KNN搜索器 / KNN searcher with input data already set
+   * @param queries 查询点，第i行对应queries[i] / Query points, row i belongs to queries[i]
+   * @param radius 搜索半径 / Search radius
+   * @param max_neighbors 每行最多保留的邻居数，0表示不限制 / Maximum neighbors kept per row,
+   * 0 means unlimited
+   * @param parallel 是否并行搜索 / Whether to search in parallel
+   * @return 是否成功 / Whether successful
+   */
+  template<typename Derived, typename Element, typename Metric>
+  bool build_radius(base_knn_generic_t<Derived, Element, Metric>& knn,
+                    const std::vector<Element>& queries,
+                    data_type radius,
+                    std::size_t max_neighbors = 0,
+                    bool parallel = true);
+
+  /**
+   * @brief 用K近邻搜索建图 / Build the graph with K-nearest neighbor searches
+   * @param knn 已设置输入数据的KNN搜索器 / KNN searcher with input data already set
+   * @param queries 查询点，第i行对应queries[i] / Query points, row i belongs to queries[i]
+   * @param num_neighbors 每行的邻居数 / Neighbors per row
+   * @param parallel 是否并行搜索 / Whether to search in parallel
+   * @return 是否成功 / Whether successful
+   */
+  template<typename Derived, typename Element, typename Metric>
+  bool build_knn(base_knn_generic_t<Derived, Element, Metric>& knn,
+                 const std::vector<Element>& queries,
+                 std::size_t num_neighbors,
+                 bool parallel = true);
+
+  /**
+   * @brief 获取第i行的全部邻居 / Get all neighbors of row i
+   */
+  [[nodiscard]] neighbor_range_t neighbors(std::size_t i) const noexcept
+  {
+    const std::size_t begin = m_offsets[i];
+    return {m_indices.data() + begin, m_distances.data() + begin, m_offsets[i + 1] - begin};
+  }
+
+  /**
+   * @brief 获取第i行中满足半径和数量限制的前缀 / Get the prefix of row i within a radius
+   * and count limit
+   * @param radius 半径上限 / Radius limit
+   * @param max_neighbors 数量上限，0表示不限制 / Count limit, 0 means unlimited
+   */
+  [[nodiscard]] neighbor_range_t neighbors(std::size_t i,
+                                           data_type radius,
+                                           std::size_t max_neighbors = 0) const noexcept;
+
+  /**
+   * @brief 把第i行的前缀复制到向量中，接口与radius_neighbors相同 / Copy the prefix of row i
+   * into vectors, mirroring radius_neighbors
+   * @return 是否成功 / Whether successful
+   */
+  bool neighbors(std::size_t i,
+                 data_type radius,
+                 std::size_t max_neighbors,
+                 std::vector<std::size_t>& indices,
+                 std::vector<data_type>& distances) const;
+
+  /**
+   * @brief 清空图 / Clear the graph
+   */
+  void clear();
+
+  /// 行数（查询点数） / Number of rows (query points)
+  [[nodiscard]] std::size_t size() const noexcept
+  {
+    return m_offsets.empty() ? 0 : m_offsets.size() - 1;
+  }
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+  /// 边的总数 / Total number of edges
+  [[nodiscard]] std::size_t num_edges() const noexcept { return m_indices.size(); }
+  /// 建图半径，K近邻图为0 / Build radius, 0 for K-nearest neighbor graphs
+  [[nodiscard]] data_type radius() const noexcept { return m_radius; }
+  /// 每行的邻居上限，0表示不限制 / Per-row neighbor cap, 0 means unlimited
+  [[nodiscard]] std::size_t max_neighbors() const noexcept { return m_max_neighbors; }
+  [[nodiscard]] bool is_radius_graph() const noexcept { return m_radius > data_type(0); }
+
+  [[nodiscard]] const std::vector<std::size_t>& offsets() const noexcept { return m_offsets; }
+  [[nodiscard]] const std::vector<std::size_t>& indices() const noexcept { return m_indices; }
+  [[nodiscard]] const std::vector<data_type>& distances() const noexcept { return m_distances; }
+
+private:
+  /**
+   * @brief 分块执行搜索并拼接成CSR / Run the search in chunks and stitch the rows into CSR
+   * @param search search(query, indices, distances) -> bool
+   */
+  template<typename Element, typename Search>
+  bool build_rows(const std::vector<Element>& queries, std::size_t row_limit, bool parallel, Search search);
+
+  std::vector<std::size_t> m_offsets;  ///< 行偏移，大小为行数+1 / Row offsets, size is rows + 1
+  std::vector<std::size_t> m_indices;  ///< 邻居索引 / Neighbor indices
+  std::vector<data_type> m_distances;  ///< 邻居距离 / Neighbor distances
+  data_type m_radius = data_type(0);  ///< 建图半径 / Build radius
+  std::size_t m_max_neighbors = 0;  ///< 每行的邻居上限 / Per-row neighbor cap
+
+  /// 少于该数量的查询不并行 / Fewer queries than this are not parallelized
+  static constexpr std::size_t k_parallel_threshold = 1024;
+};
+
+}  // namespace toolbox::pcl
+
+#include <cpp-toolbox/pcl/knn/impl/neighborhood_graph_impl.hpp>
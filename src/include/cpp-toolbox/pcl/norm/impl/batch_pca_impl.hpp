@@ -0,0 +1,439 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <cpp-toolbox/concurrent/parallel.hpp>
+
+namespace toolbox::pcl
+{
+
+namespace detail
+{
+
+template<typename Scalar>
+using vec3_t = std::array<Scalar, 3>;
+
+template<typename Scalar>
+inline vec3_t<Scalar> cross3(const vec3_t<Scalar>& a, const vec3_t<Scalar>& b)
+{
+  return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+}
+
+template<typename Scalar>
+inline Scalar dot3(const vec3_t<Scalar>& a, const vec3_t<Scalar>& b)
+{
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+/// 与v正交的任意单位向量，v为零时返回z轴 / Any unit vector orthogonal to v, the z
+/// axis when v is zero
+template<typename Scalar>
+vec3_t<Scalar> any_orthogonal3(const vec3_t<Scalar>& v)
+{
+  // 与分量绝对值最小的坐标轴做叉积 / Cross with the axis of the smallest component
+  const Scalar ax = std::abs(v[0]);
+  const Scalar ay = std::abs(v[1]);
+  const Scalar az = std::abs(v[2]);
+  vec3_t<Scalar> axis {Scalar(0), Scalar(0), Scalar(0)};
+  if (ax <= ay && ax <= az) {
+    axis[0] = Scalar(1);
+  } else if (ay <= az) {
+    axis[1] = Scalar(1);
+  } else {
+    axis[2] = Scalar(1);
+  }
+  auto result = cross3(v, axis);
+  const Scalar norm = std::sqrt(dot3(result, result));
+  if (!(norm > std::numeric_limits<Scalar>::min())) {
+    return {Scalar(0), Scalar(0), Scalar(1)};
+  }
+  for (auto& c : result) {
+    c /= norm;
+  }
+  return result;
+}
+
+/**
+ * @brief (A - λI)零空间中的单位向量 / Unit vector in the null space of (A - λI)
+ *
+ * 取三对行向量叉积中最长的一个；特征值为重根时叉积全部退化，改取与最长行正交的方向。
+ * Takes the longest of the three pairwise row cross products; for a repeated
+ * eigenvalue they all vanish and a direction orthogonal to the longest row is used
+ * instead.
+ */
+template<typename Scalar>
+vec3_t<Scalar> null_vector3(const symmetric3_t<Scalar>& m, Scalar lambda)
+{
+  const vec3_t<Scalar> r0 {m.xx - lambda, m.xy, m.xz};
+  const vec3_t<Scalar> r1 {m.xy, m.yy - lambda, m.yz};
+  const vec3_t<Scalar> r2 {m.xz, m.yz, m.zz - lambda};
+
+  const auto c01 = cross3(r0, r1);
+  const auto c02 = cross3(r0, r2);
+  const auto c12 = cross3(r1, r2);
+  const Scalar n01 = dot3(c01, c01);
+  const Scalar n02 = dot3(c02, c02);
+  const Scalar n12 = dot3(c12, c12);
+
+  // 矩阵已缩放到单位量级，叉积的舍入噪声约为eps / The matrix is scaled to unit
+  // magnitude, so cross product round-off is about eps
+  constexpr Scalar k_tolerance = Scalar(64) * std::numeric_limits<Scalar>::epsilon();
+  const Scalar best = std::max({n01, n02, n12});
+  if (best > k_tolerance * k_tolerance) {
+    const auto& c = n01 >= n02 && n01 >= n12 ? c01 : (n02 >= n12 ? c02 : c12);
+    const Scalar inv_norm = Scalar(1) / std::sqrt(best);
+    return {c[0] * inv_norm, c[1] * inv_norm, c[2] * inv_norm};
+  }
+
+  const Scalar l0 = dot3(r0, r0);
+  const Scalar l1 = dot3(r1, r1);
+  const Scalar l2 = dot3(r2, r2);
+  const auto& row = l0 >= l1 && l0 >= l2 ? r0 : (l1 >= l2 ? r1 : r2);
+  return any_orthogonal3(row);
+}
+
+}  // namespace detail
+
+template<typename Scalar>
+eigen3_t<Scalar> solve_symmetric3(const symmetric3_t<Scalar>& matrix)
+{
+  using detail::vec3_t;
+  eigen3_t<Scalar> result;
+  result.vectors = {vec3_t<Scalar> {Scalar(1), Scalar(0), Scalar(0)},
+                    vec3_t<Scalar> {Scalar(0), Scalar(1), Scalar(0)},
+                    vec3_t<Scalar> {Scalar(0), Scalar(0), Scalar(1)}};
+
+  // 缩放到最大元素为1，避免立方时上溢或下溢 / Scale the largest entry to 1 so the
+  // cubic terms neither overflow nor underflow
+  const Scalar scale = std::max({std::abs(matrix.xx),
+                                 std::abs(matrix.xy),
+                                 std::abs(matrix.xz),
+                                 std::abs(matrix.yy),
+                                 std::abs(matrix.yz),
+                                 std::abs(matrix.zz)});
+  if (!(scale > std::numeric_limits<Scalar>::min())) {
+    return result;
+  }
+  const Scalar inv_scale = Scalar(1) / scale;
+  const symmetric3_t<Scalar> m {matrix.xx * inv_scale,
+                                matrix.xy * inv_scale,
+                                matrix.xz * inv_scale,
+                                matrix.yy * inv_scale,
+                                matrix.yz * inv_scale,
+                                matrix.zz * inv_scale};
+
+  // 特征值：B = (A - qI) / p 的特征值为 2cos(φ + 2πk/3) / Eigenvalues: those of
+  // B = (A - qI) / p are 2cos(φ + 2πk/3)
+  const Scalar q = (m.xx + m.yy + m.zz) / Scalar(3);
+  const Scalar bxx = m.xx - q;
+  const Scalar byy = m.yy - q;
+  const Scalar bzz = m.zz - q;
+  const Scalar off = m.xy * m.xy + m.xz * m.xz + m.yz * m.yz;
+  const Scalar p2 = bxx * bxx + byy * byy + bzz * bzz + Scalar(2) * off;
+  const Scalar eps = std::numeric_limits<Scalar>::epsilon();
+  if (!(p2 > eps * eps)) {
+    // 各向同性 / Isotropic
+    result.values = {matrix.xx, matrix.xx, matrix.xx};
+    return result;
+  }
+  const Scalar p = std::sqrt(p2 / Scalar(6));
+  const Scalar det = bxx * (byy * bzz - m.yz * m.yz) - m.xy * (m.xy * bzz - m.yz * m.xz)
+      + m.xz * (m.xy * m.yz - byy * m.xz);
+  const Scalar r = std::clamp(det / (Scalar(2) * p * p * p), Scalar(-1), Scalar(1));
+  const Scalar phi = std::acos(r) / Scalar(3);
+  constexpr Scalar k_two_pi_3 = Scalar(2.0943951023931954923);
+  const Scalar lambda2 = q + Scalar(2) * p * std::cos(phi);
+  const Scalar lambda0 = q + Scalar(2) * p * std::cos(phi + k_two_pi_3);
+
+  auto v0 = detail::null_vector3(m, lambda0);
+  auto v2 = detail::null_vector3(m, lambda2);
+  const Scalar overlap = detail::dot3(v2, v0);
+  for (int i = 0; i < 3; ++i) {
+    v2[i] -= overlap * v0[i];
+  }
+  const Scalar v2_norm = std::sqrt(detail::dot3(v2, v2));
+  if (v2_norm > Scalar(0.5)) {
+    for (auto& c : v2) {
+      c /= v2_norm;
+    }
+  } else {
+    v2 = detail::any_orthogonal3(v0);
+  }
+  const auto v1 = detail::cross3(v2, v0);
+  result.vectors = {v0, v1, v2};
+
+  // 瑞利商比三角解更准确，尤其是接近0的最小特征值 / Rayleigh quotients are more
+  // accurate than the trigonometric roots, especially for a near-zero smallest one
+  for (std::size_t i = 0; i < 3; ++i) {
+    const auto& v = result.vectors[i];
+    const vec3_t<Scalar> mv {m.xx * v[0] + m.xy * v[1] + m.xz * v[2],
+                             m.xy * v[0] + m.yy * v[1] + m.yz * v[2],
+                             m.xz * v[0] + m.yz * v[1] + m.zz * v[2]};
+    result.values[i] = detail::dot3(v, mv) * scale;
+  }
+  return result;
+}
+
+template<typename DataType>
+template<typename Accum, bool Weighted>
+void batch_pca_t<DataType>::compute_rows(std::size_t num_rows,
+                                         const std::size_t* offsets,
+                                         const std::size_t* indices,
+                                         const data_type* weights,
+                                         const point_type* centers,
+                                         std::size_t max_per_row,
+                                         result_type* results) const
+{
+  constexpr std::size_t k_lanes = 8;
+  const auto& points = *m_points;
+  std::vector<Accum> xs;
+  std::vector<Accum> ys;
+  std::vector<Accum> zs;
+  std::vector<Accum> ws;
+
+  for (std::size_t row = 0; row < num_rows; ++row) {
+    const std::size_t begin = offsets[row];
+    std::size_t count = offsets[row + 1] - begin;
+    if (max_per_row > 0) {
+      count = std::min(count, max_per_row);
+    }
+
+    result_type& out = results[row];
+    out = result_type {};
+    out.num_points = count;
+    out.eigenvectors = {point_type(0, 0, 1), point_type(1, 0, 0), point_type(0, 1, 0)};
+    if (count == 0 || count < m_min_points) {
+      continue;
+    }
+
+    // 收集为连续的平移坐标 / Gather into contiguous shifted coordinates
+    const point_type origin = centers ? centers[row] : points[indices[begin]];
+    const Accum ox = static_cast<Accum>(origin.x);
+    const Accum oy = static_cast<Accum>(origin.y);
+    const Accum oz = static_cast<Accum>(origin.z);
+    if (xs.size() < count) {
+      xs.resize(count);
+      ys.resize(count);
+      zs.resize(count);
+      if constexpr (Weighted) {
+        ws.resize(count);
+      }
+    }
+    for (std::size_t j = 0; j < count; ++j) {
+      const auto& pt = points[indices[begin + j]];
+      xs[j] = static_cast<Accum>(pt.x) - ox;
+      ys[j] = static_cast<Accum>(pt.y) - oy;
+      zs[j] = static_cast<Accum>(pt.z) - oz;
+      if constexpr (Weighted) {
+        ws[j] = static_cast<Accum>(weights[begin + j]);
+      }
+    }
+
+    // 多路部分和，内层按通道的循环可被向量化 / Partial sums over several lanes; the
+    // inner per-lane loop vectorizes
+    Accum s_w[k_lanes] = {};
+    Accum s_x[k_lanes] = {};
+    Accum s_y[k_lanes] = {};
+    Accum s_z[k_lanes] = {};
+    Accum s_xx[k_lanes] = {};
+    Accum s_xy[k_lanes] = {};
+    Accum s_xz[k_lanes] = {};
+    Accum s_yy[k_lanes] = {};
+    Accum s_yz[k_lanes] = {};
+    Accum s_zz[k_lanes] = {};
+    auto accumulate = [&](std::size_t lane, std::size_t j)
+    {
+      const Accum x = xs[j];
+      const Accum y = ys[j];
+      const Accum z = zs[j];
+      Accum wx = x;
+      Accum wy = y;
+      Accum wz = z;
+      if constexpr (Weighted) {
+        const Accum w = ws[j];
+        s_w[lane] += w;
+        wx *= w;
+        wy *= w;
+        wz *= w;
+      }
+      s_x[lane] += wx;
+      s_y[lane] += wy;
+      s_z[lane] += wz;
+      s_xx[lane] += wx * x;
+      s_xy[lane] += wx * y;
+      s_xz[lane] += wx * z;
+      s_yy[lane] += wy * y;
+      s_yz[lane] += wy * z;
+      s_zz[lane] += wz * z;
+    };
+    const std::size_t full = count - count % k_lanes;
+    for (std::size_t j = 0; j < full; j += k_lanes) {
+      for (std::size_t lane = 0; lane < k_lanes; ++lane) {
+        accumulate(lane, j + lane);
+      }
+    }
+    for (std::size_t j = full; j < count; ++j) {
+      accumulate(j - full, j);
+    }
+
+    Accum sum_w = Weighted ? Accum(0) : static_cast<Accum>(count);
+    symmetric3_t<Accum> moment;
+    Accum sx = 0;
+    Accum sy = 0;
+    Accum sz = 0;
+    for (std::size_t lane = 0; lane < k_lanes; ++lane) {
+      if constexpr (Weighted) {
+        sum_w += s_w[lane];
+      }
+      sx += s_x[lane];
+      sy += s_y[lane];
+      sz += s_z[lane];
+      moment.xx += s_xx[lane];
+      moment.xy += s_xy[lane];
+      moment.xz += s_xz[lane];
+      moment.yy += s_yy[lane];
+      moment.yz += s_yz[lane];
+      moment.zz += s_zz[lane];
+    }
+    if (!(sum_w > Accum(0))) {
+      continue;
+    }
+
+    symmetric3_t<Accum> covariance;
+    Accum denominator = sum_w;
+    Accum mx = 0;
+    Accum my = 0;
+    Accum mz = 0;
+    if (centers) {
+      covariance = moment;
+    } else {
+      // 平移后的二阶矩减去均值项 / Remove the mean from the shifted second moments
+      mx = sx / sum_w;
+      my = sy / sum_w;
+      mz = sz / sum_w;
+      covariance.xx = moment.xx - sx * mx;
+      covariance.xy = moment.xy - sx * my;
+      covariance.xz = moment.xz - sx * mz;
+      covariance.yy = moment.yy - sy * my;
+      covariance.yz = moment.yz - sy * mz;
+      covariance.zz = moment.zz - sz * mz;
+      if constexpr (!Weighted) {
+        denominator = static_cast<Accum>(std::max<std::size_t>(count - 1, 1));
+      }
+    }
+    const Accum inv_denominator = Accum(1) / denominator;
+    covariance.xx *= inv_denominator;
+    covariance.xy *= inv_denominator;
+    covariance.xz *= inv_denominator;
+    covariance.yy *= inv_denominator;
+    covariance.yz *= inv_denominator;
+    covariance.zz *= inv_denominator;
+
+    const auto eigen = solve_symmetric3(covariance);
+    out.centroid = point_type(static_cast<data_type>(ox + mx),
+                              static_cast<data_type>(oy + my),
+                              static_cast<data_type>(oz + mz));
+    for (std::size_t i = 0; i < 3; ++i) {
+      out.eigenvalues[i] = static_cast<data_type>(eigen.values[i]);
+      out.eigenvectors[i] = point_type(static_cast<data_type>(eigen.vectors[i][0]),
+                                       static_cast<data_type>(eigen.vectors[i][1]),
+                                       static_cast<data_type>(eigen.vectors[i][2]));
+    }
+    out.valid = true;
+  }
+}
+
+template<typename DataType>
+void batch_pca_t<DataType>::compute(std::size_t num_rows,
+                                    const std::size_t* offsets,
+                                    const std::size_t* indices,
+                                    const data_type* weights,
+                                    const point_type* centers,
+                                    std::size_t max_per_row,
+                                    result_type* results) const
+{
+  if (num_rows == 0) {
+    return;
+  }
+  if (!m_points) {
+    for (std::size_t row = 0; row < num_rows; ++row) {
+      results[row] = result_type {};
+    }
+    return;
+  }
+
+  const bool single = m_precision == pca_precision_t::single_precision;
+  if (weights) {
+    if (single) {
+      compute_rows<float, true>(
+          num_rows, offsets, indices, weights, centers, max_per_row, results);
+    } else {
+      compute_rows<double, true>(
+          num_rows, offsets, indices, weights, centers, max_per_row, results);
+    }
+  } else {
+    if (single) {
+      compute_rows<float, false>(
+          num_rows, offsets, indices, weights, centers, max_per_row, results);
+    } else {
+      compute_rows<double, false>(
+          num_rows, offsets, indices, weights, centers, max_per_row, results);
+    }
+  }
+}
+
+template<typename DataType>
+typename batch_pca_t<DataType>::result_type batch_pca_t<DataType>::compute(
+    const std::vector<std::size_t>& indices) const
+{
+  const std::size_t offsets[2] = {0, indices.size()};
+  result_type result;
+  compute(1, offsets, indices.data(), nullptr, nullptr, 0, &result);
+  return result;
+}
+
+template<typename DataType>
+typename batch_pca_t<DataType>::result_type batch_pca_t<DataType>::compute(
+    const std::vector<std::size_t>& indices,
+    const std::vector<data_type>& weights,
+    const point_type& center) const
+{
+  const std::size_t offsets[2] = {0, std::min(indices.size(), weights.size())};
+  result_type result;
+  compute(1, offsets, indices.data(), weights.data(), &center, 0, &result);
+  return result;
+}
+
+template<typename DataType>
+std::vector<typename batch_pca_t<DataType>::result_type> batch_pca_t<DataType>::compute(
+    const neighborhood_graph_t<data_type>& graph, std::size_t max_neighbors, bool parallel) const
+{
+  constexpr std::size_t k_parallel_threshold = 1024;
+  const std::size_t num_rows = graph.size();
+  std::vector<result_type> results(num_rows);
+  if (num_rows == 0) {
+    return results;
+  }
+  const std::size_t* offsets = graph.offsets().data();
+  const std::size_t* indices = graph.indices().data();
+
+  toolbox::concurrent::parallel_for_chunks(
+      num_rows,
+      k_parallel_threshold,
+      parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        compute(end_idx - start_idx,
+                offsets + start_idx,
+                indices,
+                nullptr,
+                nullptr,
+                max_neighbors,
+                results.data() + start_idx);
+      });
+  return results;
+}
+
+}  // namespace toolbox::pcl
@@ -0,0 +1,332 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <cpp-toolbox/concurrent/parallel.hpp>
+#include <cpp-toolbox/logger/thread_logger.hpp>
+
+namespace toolbox::pcl
+{
+
+template<typename DataType>
+std::size_t integral_image_norm_extractor_t<DataType>::set_input(const point_cloud& cloud)
+{
+  return set_input(std::make_shared<point_cloud>(cloud));
+}
+
+template<typename DataType>
+std::size_t integral_image_norm_extractor_t<DataType>::set_input(const point_cloud_ptr& cloud)
+{
+  m_cloud = cloud;
+  return m_cloud ? m_cloud->size() : 0U;
+}
+
+template<typename DataType>
+typename integral_image_norm_extractor_t<DataType>::point_cloud
+integral_image_norm_extractor_t<DataType>::extract()
+{
+  auto output = std::make_shared<point_cloud>();
+  extract(output);
+  return *output;
+}
+
+template<typename DataType>
+void integral_image_norm_extractor_t<DataType>::extract(point_cloud_ptr output)
+{
+  if (!output || !m_cloud || !m_image) {
+    return;
+  }
+  const auto& image = *m_image;
+  const auto& points = m_cloud->points;
+  const std::size_t num_points = points.size();
+  if (image.point_pixels().size() != num_points) {
+    LOG_ERROR_S << "integral_image_norm_extractor_t: Range image covers "
+                << image.point_pixels().size() << " points but the input cloud has "
+                << num_points;
+    return;
+  }
+
+  const std::size_t rows = image.height();
+  const std::size_t cols = image.width();
+  const std::size_t stride = cols + 1;
+  const auto& pixel_points = image.indices();
+  const auto& ranges = image.ranges();
+  constexpr std::size_t k_empty = range_image::k_empty;
+  // 球面图像覆盖整周方位角，首末两列相邻 / A spherical image covers the full azimuth,
+  // so the first and last columns are neighbors
+  const bool wrap = image.projection() == range_projection_t::spherical && cols > 1;
+
+  // 1. 深度突变两侧的像素标记为边缘 / Mark pixels on both sides of a depth jump as edges
+  std::vector<std::uint8_t> edges(rows * cols, 0);
+  const double max_change = static_cast<double>(m_max_depth_change);
+  auto is_jump = [&](std::size_t a, std::size_t b)
+  {
+    if (pixel_points[a] == k_empty || pixel_points[b] == k_empty) {
+      return false;
+    }
+    const double ra = static_cast<double>(ranges[a]);
+    const double rb = static_cast<double>(ranges[b]);
+    return std::abs(ra - rb) > max_change * std::min(ra, rb);
+  };
+  toolbox::concurrent::parallel_for_chunks(
+      rows,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_row, std::size_t end_row)
+      {
+        for (std::size_t r = start_row; r < end_row; ++r) {
+          for (std::size_t c = 0; c < cols; ++c) {
+            const std::size_t p = r * cols + c;
+            const std::size_t row_begin = r * cols;
+            const bool has_left = c > 0 || wrap;
+            const bool has_right = c + 1 < cols || wrap;
+            const std::size_t left = c > 0 ? p - 1 : row_begin + cols - 1;
+            const std::size_t right = c + 1 < cols ? p + 1 : row_begin;
+            const bool jump = (has_left && is_jump(p, left)) || (has_right && is_jump(p, right))
+                || (r > 0 && is_jump(p, p - cols)) || (r + 1 < rows && is_jump(p, p + cols));
+            edges[p] = jump ? 1 : 0;
+          }
+        }
+      });
+
+  // 2. 到最近边缘的棋盘距离，截断到最大窗口半径；先按行求水平距离，再在列上取最小。
+  // 列方向每个像素看上下cap行，耗时O(N * cap)，cap只是窗口半径，通常为个位数。
+  // Chessboard distance to the nearest edge, capped at the largest half size: a
+  // horizontal distance per row first, then a minimum along the columns. The column
+  // step looks cap rows up and down, O(N * cap), with cap only the window half size
+  // and usually a single digit.
+  // 环绕时列窗口不能超过整行 / With wrapping a column window cannot exceed a full row
+  const std::size_t max_half_cols = wrap ? std::min(m_half_cols, (cols - 1) / 2) : m_half_cols;
+  const std::size_t cap = std::max(m_half_rows, max_half_cols);
+  std::vector<std::size_t> row_distance(rows * cols, cap);
+  toolbox::concurrent::parallel_for_chunks(
+      rows,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_row, std::size_t end_row)
+      {
+        for (std::size_t r = start_row; r < end_row; ++r) {
+          std::size_t* dist = row_distance.data() + r * cols;
+          const std::uint8_t* row_edges = edges.data() + r * cols;
+          // 环绕时先扫过接缝另一侧的cap列 / With wrapping, first run over the cap
+          // columns on the other side of the seam
+          const std::size_t lead = wrap ? std::min(cap, cols) : 0;
+          std::size_t last = cap;
+          for (std::size_t c = cols - lead; c < cols; ++c) {
+            last = row_edges[c] ? 0 : std::min(cap, last + 1);
+          }
+          for (std::size_t c = 0; c < cols; ++c) {
+            last = row_edges[c] ? 0 : std::min(cap, last + 1);
+            dist[c] = last;
+          }
+          last = cap;
+          for (std::size_t c = lead; c-- > 0;) {
+            last = row_edges[c] ? 0 : std::min(cap, last + 1);
+          }
+          for (std::size_t c = cols; c-- > 0;) {
+            last = row_edges[c] ? 0 : std::min(cap, last + 1);
+            dist[c] = std::min(dist[c], last);
+          }
+        }
+      });
+  std::vector<std::size_t> distance(rows * cols, cap);
+  toolbox::concurrent::parallel_for_chunks(
+      rows,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_row, std::size_t end_row)
+      {
+        for (std::size_t r = start_row; r < end_row; ++r) {
+          const std::size_t r_begin = r >= cap ? r - cap : 0;
+          const std::size_t r_end = std::min(rows, r + cap + 1);
+          for (std::size_t c = 0; c < cols; ++c) {
+            std::size_t best = cap;
+            for (std::size_t rr = r_begin; rr < r_end && best > 0; ++rr) {
+              const std::size_t dr = rr > r ? rr - r : r - rr;
+              best = std::min(best, std::max(dr, row_distance[rr * cols + c]));
+            }
+            distance[r * cols + c] = best;
+          }
+        }
+      });
+
+  // 3. 积分图：先按行做前缀和，再按列块累加各行 / Integral image: prefix sums by rows,
+  // then rows are accumulated in column blocks
+  m_integral.assign((rows + 1) * stride, moments_t {});
+  toolbox::concurrent::parallel_for_chunks(
+      rows,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_row, std::size_t end_row)
+      {
+        for (std::size_t r = start_row; r < end_row; ++r) {
+          moments_t running;
+          moments_t* out = m_integral.data() + (r + 1) * stride;
+          for (std::size_t c = 0; c < cols; ++c) {
+            const std::size_t idx = pixel_points[r * cols + c];
+            if (idx != k_empty) {
+              const double x = static_cast<double>(points[idx].x);
+              const double y = static_cast<double>(points[idx].y);
+              const double z = static_cast<double>(points[idx].z);
+              running.n += 1.0;
+              running.x += x;
+              running.y += y;
+              running.z += z;
+              running.xx += x * x;
+              running.xy += x * y;
+              running.xz += x * z;
+              running.yy += y * y;
+              running.yz += y * z;
+              running.zz += z * z;
+            }
+            out[c + 1] = running;
+          }
+        }
+      });
+  const auto add_moments = [](moments_t& a, const moments_t& b)
+  {
+    a.n += b.n;
+    a.x += b.x;
+    a.y += b.y;
+    a.z += b.z;
+    a.xx += b.xx;
+    a.xy += b.xy;
+    a.xz += b.xz;
+    a.yy += b.yy;
+    a.yz += b.yz;
+    a.zz += b.zz;
+  };
+  toolbox::concurrent::parallel_for_chunks(
+      stride,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_col, std::size_t end_col)
+      {
+        for (std::size_t r = 2; r <= rows; ++r) {
+          moments_t* current = m_integral.data() + r * stride;
+          const moments_t* previous = current - stride;
+          for (std::size_t c = start_col; c < end_col; ++c) {
+            add_moments(current[c], previous[c]);
+          }
+        }
+      });
+
+  // 4. 每个像素的窗口协方差与特征分解；跨接缝的窗口拆成两个矩形 / Window covariance
+  // and eigen decomposition per pixel; a window across the seam splits into two boxes
+  const auto add_box =
+      [&](std::size_t r0, std::size_t r1, std::size_t c0, std::size_t c1, moments_t& sum)
+  {
+    const moments_t& a = m_integral[r1 * stride + c1];
+    const moments_t& b = m_integral[r0 * stride + c1];
+    const moments_t& d = m_integral[r1 * stride + c0];
+    const moments_t& e = m_integral[r0 * stride + c0];
+    sum.n += a.n - b.n - d.n + e.n;
+    sum.x += a.x - b.x - d.x + e.x;
+    sum.y += a.y - b.y - d.y + e.y;
+    sum.z += a.z - b.z - d.z + e.z;
+    sum.xx += a.xx - b.xx - d.xx + e.xx;
+    sum.xy += a.xy - b.xy - d.xy + e.xy;
+    sum.xz += a.xz - b.xz - d.xz + e.xz;
+    sum.yy += a.yy - b.yy - d.yy + e.yy;
+    sum.yz += a.yz - b.yz - d.yz + e.yz;
+    sum.zz += a.zz - b.zz - d.zz + e.zz;
+  };
+  std::vector<point_t<data_type>> pixel_normals(rows * cols, point_t<data_type>(0, 0, 1));
+  std::vector<normal_geometry_t<data_type>> pixel_geometry(rows * cols);
+  toolbox::concurrent::parallel_for_chunks(
+      rows,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_row, std::size_t end_row)
+      {
+        for (std::size_t r = start_row; r < end_row; ++r) {
+          for (std::size_t c = 0; c < cols; ++c) {
+            const std::size_t p = r * cols + c;
+            const std::size_t idx = pixel_points[p];
+            if (idx == k_empty) {
+              continue;
+            }
+            const std::size_t half_r = std::min(m_half_rows, distance[p]);
+            const std::size_t half_c = std::min(max_half_cols, distance[p]);
+            if (half_r == 0 && half_c == 0) {
+              continue;
+            }
+            const std::size_t r0 = r >= half_r ? r - half_r : 0;
+            const std::size_t r1 = std::min(rows, r + half_r + 1);
+            moments_t window;
+            if (wrap && c < half_c) {
+              add_box(r0, r1, 0, c + half_c + 1, window);
+              add_box(r0, r1, cols - (half_c - c), cols, window);
+            } else if (wrap && c + half_c >= cols) {
+              add_box(r0, r1, c - half_c, cols, window);
+              add_box(r0, r1, 0, c + half_c + 1 - cols, window);
+            } else {
+              const std::size_t c0 = c >= half_c ? c - half_c : 0;
+              const std::size_t c1 = std::min(cols, c + half_c + 1);
+              add_box(r0, r1, c0, c1, window);
+            }
+
+            const double n = window.n;
+            if (n < 3.0) {
+              continue;
+            }
+            const double mx = window.x / n;
+            const double my = window.y / n;
+            const double mz = window.z / n;
+            const double inv = 1.0 / (n - 1.0);
+            const symmetric3_t<double> covariance {(window.xx - n * mx * mx) * inv,
+                                                   (window.xy - n * mx * my) * inv,
+                                                   (window.xz - n * mx * mz) * inv,
+                                                   (window.yy - n * my * my) * inv,
+                                                   (window.yz - n * my * mz) * inv,
+                                                   (window.zz - n * mz * mz) * inv};
+            const auto eigen = solve_symmetric3(covariance);
+
+            // 朝向传感器原点 / Face the sensor origin
+            const auto& pt = points[idx];
+            double nx = eigen.vectors[0][0];
+            double ny = eigen.vectors[0][1];
+            double nz = eigen.vectors[0][2];
+            if (nx * static_cast<double>(pt.x) + ny * static_cast<double>(pt.y)
+                    + nz * static_cast<double>(pt.z)
+                > 0.0)
+            {
+              nx = -nx;
+              ny = -ny;
+              nz = -nz;
+            }
+            pixel_normals[p] = point_t<data_type>(
+                static_cast<data_type>(nx), static_cast<data_type>(ny), static_cast<data_type>(nz));
+
+            auto& geometry = pixel_geometry[p];
+            const double l0 = std::max(0.0, eigen.values[0]);
+            const double l1 = std::max(0.0, eigen.values[1]);
+            const double l2 = std::max(0.0, eigen.values[2]);
+            geometry.eigenvalues = {static_cast<data_type>(l0),
+                                    static_cast<data_type>(l1),
+                                    static_cast<data_type>(l2)};
+            const double sum = l0 + l1 + l2;
+            geometry.curvature = sum > 0.0 ? static_cast<data_type>(l0 / sum) : data_type(0);
+          }
+        }
+      });
+
+  // 5. 每个点取其像素的结果 / Every point takes the result of its pixel
+  output->clear();
+  output->points = points;
+  output->normals.assign(num_points, point_t<data_type>(0, 0, 1));
+  m_geometry.assign(num_points, normal_geometry_t<data_type> {});
+  const auto& point_pixels = image.point_pixels();
+  for (std::size_t i = 0; i < num_points; ++i) {
+    const std::size_t p = point_pixels[i];
+    if (p != k_empty) {
+      output->normals[i] = pixel_normals[p];
+      m_geometry[i] = pixel_geometry[p];
+    }
+  }
+}
+
+}  // namespace toolbox::pcl
@@ -1,11 +1,19 @@
 #pragma once
 
-#include <Eigen/Dense>
-#include <Eigen/Eigenvalues>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cpp-toolbox/base/thread_pool_singleton.hpp>
+#include <cpp-toolbox/concurrent/parallel.hpp>
+#include <cpp-toolbox/container/concurrent_union_find.hpp>
+#include <cstdint>
+#include <cstring>
 #include <future>
+#include <limits>
 #include <memory>
 
+#include <cpp-toolbox/logger/thread_logger.hpp>
+
 namespace toolbox::pcl
 {
 
@@ -59,14 +67,28 @@ pca_norm_extractor_t<DataType, KNN>::extract_impl()
 template<typename DataType, typename KNN>
 void pca_norm_extractor_t<DataType, KNN>::extract_impl(point_cloud_ptr output)
 {
-  if (!m_cloud || !m_knn || m_num_neighbors == 0) {
+  if (!m_cloud || (!m_knn && !m_graph) || m_num_neighbors == 0) {
+    return;
+  }
+  if (m_graph && m_graph->size() != m_cloud->size()) {
+    LOG_ERROR_S << "pca_norm_extractor_t: Neighborhood graph has " << m_graph->size()
+                << " rows but the input cloud has " << m_cloud->size() << " points";
     return;
   }
 
   const std::size_t num_points = m_cloud->size();
+  m_pca.set_input(m_cloud->points);
   output->points.clear();
   output->normals.clear();
   output->normals.resize(num_points);
+  m_geometry.assign(num_points, normal_geometry_t<data_type> {});
+  if (m_orientation == normal_orientation_t::minimum_spanning_tree) {
+    m_tree_neighbors.assign(num_points * m_num_neighbors, k_no_neighbor);
+    m_tree_valid.assign(num_points, 0);
+  } else {
+    m_tree_neighbors.clear();
+    m_tree_valid.clear();
+  }
 
   if (m_enable_parallel) {
     // Parallel processing
@@ -99,6 +121,10 @@ void pca_norm_extractor_t<DataType, KNN>::extract_impl(point_cloud_ptr output)
     compute_normals_range(output, 0, num_points);
   }
 
+  if (m_orientation == normal_orientation_t::minimum_spanning_tree) {
+    orient_along_spanning_tree(output);
+  }
+
   // Copy points from input cloud
   output->points = m_cloud->points;
 }
@@ -107,73 +133,285 @@ template<typename DataType, typename KNN>
 void pca_norm_extractor_t<DataType, KNN>::compute_normals_range(
     point_cloud_ptr output, std::size_t start_idx, std::size_t end_idx)
 {
+  constexpr std::size_t k_block_size = 64;
   std::vector<std::size_t> indices;
   std::vector<data_type> distances;
+  std::vector<std::size_t> offsets;
+  std::vector<std::size_t> block_indices;
+  std::vector<pca_result_t<data_type>> results(k_block_size);
 
-  for (std::size_t i = start_idx; i < end_idx; ++i) {
-    const auto& query_point = m_cloud->points[i];
-    
-    // Find k-nearest neighbors
-    indices.clear();
-    distances.clear();
-    
-    if (!m_knn->kneighbors(query_point, m_num_neighbors, indices, distances)) {
-      // If KNN search fails, use default normal (0, 0, 1)
-      output->normals[i] = point_t<data_type>(0, 0, 1);
-      continue;
+  for (std::size_t block_begin = start_idx; block_begin < end_idx; block_begin += k_block_size) {
+    const std::size_t block_end = std::min(block_begin + k_block_size, end_idx);
+
+    // 收集整块的邻域 / Gather the neighborhoods of the whole block
+    offsets.assign(1, 0);
+    block_indices.clear();
+    for (std::size_t i = block_begin; i < block_end; ++i) {
+      indices.clear();
+      distances.clear();
+      if (m_graph) {
+        m_graph->neighbors(i, std::numeric_limits<data_type>::max(), m_num_neighbors, indices,
+                           distances);
+      } else if (!m_knn->kneighbors(m_cloud->points[i], m_num_neighbors, indices, distances)) {
+        // 搜索失败时该行为空，得到默认法线 / A failed search leaves the row empty and
+        // yields the default normal
+        indices.clear();
+      }
+      block_indices.insert(block_indices.end(), indices.begin(), indices.end());
+      offsets.push_back(block_indices.size());
     }
 
-    // Compute normal using PCA
-    output->normals[i] = compute_pca_normal(indices);
+    const std::size_t block_count = block_end - block_begin;
+    m_pca.compute(block_count, offsets.data(), block_indices.data(), nullptr, nullptr, 0,
+                  results.data());
+
+    const bool face_point = m_orientation == normal_orientation_t::viewpoint
+        || m_orientation == normal_orientation_t::sensor_origin;
+    const point_t<data_type> target = m_orientation == normal_orientation_t::viewpoint
+        ? m_viewpoint
+        : point_t<data_type>(0, 0, 0);
+    for (std::size_t j = 0; j < block_count; ++j) {
+      const std::size_t i = block_begin + j;
+      const auto& result = results[j];
+      if (!result.valid) {
+        // 少于3个邻居时使用默认法线(0, 0, 1) / Fewer than 3 neighbors give the default
+        // normal (0, 0, 1)
+        output->normals[i] = point_t<data_type>(0, 0, 1);
+        continue;
+      }
+
+      auto normal = result.normal();
+      if (face_point) {
+        const auto& pt = m_cloud->points[i];
+        const data_type dot = normal.x * (target.x - pt.x) + normal.y * (target.y - pt.y)
+            + normal.z * (target.z - pt.z);
+        if (dot < data_type(0)) {
+          normal = point_t<data_type>(-normal.x, -normal.y, -normal.z);
+        }
+      }
+      output->normals[i] = normal;
+
+      auto& geometry = m_geometry[i];
+      geometry.eigenvalues = result.eigenvalues;
+      const data_type sum = result.eigenvalues[0] + result.eigenvalues[1] + result.eigenvalues[2];
+      geometry.curvature = sum > data_type(0) ? result.eigenvalues[0] / sum : data_type(0);
+
+      if (!m_tree_neighbors.empty()) {
+        m_tree_valid[i] = 1;
+        const std::size_t row_size = offsets[j + 1] - offsets[j];
+        std::copy_n(block_indices.begin() + static_cast<std::ptrdiff_t>(offsets[j]),
+                    std::min(row_size, m_num_neighbors),
+                    m_tree_neighbors.begin() + static_cast<std::ptrdiff_t>(i * m_num_neighbors));
+      }
+    }
   }
 }
 
 template<typename DataType, typename KNN>
-point_t<typename pca_norm_extractor_t<DataType, KNN>::data_type>
-pca_norm_extractor_t<DataType, KNN>::compute_pca_normal(
-    const std::vector<std::size_t>& indices)
+void pca_norm_extractor_t<DataType, KNN>::orient_along_spanning_tree(point_cloud_ptr output)
 {
-  if (indices.size() < 3) {
-    // Need at least 3 points for PCA
-    return point_t<data_type>(0, 0, 1);
-  }
-
-  // Compute centroid
-  Eigen::Vector3d centroid = Eigen::Vector3d::Zero();
-  for (const auto& idx : indices) {
-    const auto& pt = m_cloud->points[idx];
-    centroid += Eigen::Vector3d(static_cast<double>(pt.x), 
-                               static_cast<double>(pt.y), 
-                               static_cast<double>(pt.z));
-  }
-  centroid /= static_cast<double>(indices.size());
-
-  // Compute covariance matrix
-  Eigen::Matrix3d covariance = Eigen::Matrix3d::Zero();
-  for (const auto& idx : indices) {
-    const auto& pt = m_cloud->points[idx];
-    Eigen::Vector3d point_vec(static_cast<double>(pt.x), 
-                             static_cast<double>(pt.y), 
-                             static_cast<double>(pt.z));
-    Eigen::Vector3d centered = point_vec - centroid;
-    covariance += centered * centered.transpose();
-  }
-  covariance /= static_cast<double>(indices.size() - 1);
-
-  // Compute eigenvalues and eigenvectors
-  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> eigen_solver(covariance);
-  if (eigen_solver.info() != Eigen::Success) {
-    // If eigenvalue computation fails, use default normal
-    return point_t<data_type>(0, 0, 1);
-  }
-
-  // The normal is the eigenvector corresponding to the smallest eigenvalue
-  const Eigen::Vector3d& normal_vec = eigen_solver.eigenvectors().col(0);
-
-  // Convert back to data_type and create point_t
-  return point_t<data_type>(static_cast<data_type>(normal_vec.x()),
-                           static_cast<data_type>(normal_vec.y()),
-                           static_cast<data_type>(normal_vec.z()));
+  constexpr std::size_t k_parallel_threshold = 4096;
+  constexpr std::uint64_t k_no_edge = std::numeric_limits<std::uint64_t>::max();
+  const std::size_t num_points = m_cloud->size();
+  const std::size_t width = m_num_neighbors;
+  // 边编号占键的低32位 / Edge ids take the low 32 bits of a key
+  if (num_points * width >= (std::size_t(1) << 32)) {
+    LOG_ERROR_S << "pca_norm_extractor_t: Too many neighbor edges for spanning tree "
+                   "orientation, normals are left unoriented";
+    return;
+  }
+  auto& normals = output->normals;
+  const auto& neighbors = m_tree_neighbors;
+  // 有效标记来自PCA结果本身，而不是近邻表的内容 / Validity comes from the PCA result
+  // itself rather than from the contents of the neighbor table
+  const auto& valid = m_tree_valid;
+
+  // 边带着(权重位, 边编号)键只建立一次；权重非负时浮点位序即数值序，边编号同时用来打破平局
+  // Edges are built once with a (weight bits, edge id) key; for non-negative floats
+  // the bit order is the numeric order, and the edge id breaks ties
+  struct edge_t
+  {
+    std::uint64_t key;
+    std::uint32_t a;
+    std::uint32_t b;
+  };
+  std::vector<edge_t> edges;
+  edges.reserve(num_points * width);
+  for (std::size_t i = 0; i < num_points; ++i) {
+    if (valid[i] == 0) {
+      continue;
+    }
+    const auto& ni = normals[i];
+    for (std::size_t j = 0; j < width; ++j) {
+      const std::size_t edge = i * width + j;
+      const std::size_t nb = neighbors[edge];
+      if (nb == k_no_neighbor || nb == i || valid[nb] == 0) {
+        continue;
+      }
+      const auto& nn = normals[nb];
+      const float weight = static_cast<float>(
+          data_type(1) - std::min(data_type(1), std::abs(ni.x * nn.x + ni.y * nn.y + ni.z * nn.z)));
+      std::uint32_t bits = 0;
+      std::memcpy(&bits, &weight, sizeof(bits));
+      edges.push_back({(static_cast<std::uint64_t>(bits) << 32) | edge,
+                       static_cast<std::uint32_t>(i),
+                       static_cast<std::uint32_t>(nb)});
+    }
+  }
+
+  // Borůvka：每轮每个分量取最轻的外连边，分量内部的边随即从列表中删去
+  // Borůvka: every round each component takes its lightest outgoing edge, and edges
+  // inside a component are dropped from the list on the way
+  toolbox::container::concurrent_union_find_t components(num_points);
+  std::vector<std::atomic<std::uint64_t>> lightest(num_points);
+  for (auto& key : lightest) {
+    key.store(k_no_edge, std::memory_order_relaxed);
+  }
+  std::vector<std::uint32_t> labels(num_points);
+  std::vector<std::uint8_t> internal;
+  std::vector<std::size_t> tree_edges;
+  auto atomic_min = [](std::atomic<std::uint64_t>& target, std::uint64_t key)
+  {
+    std::uint64_t current = target.load(std::memory_order_relaxed);
+    while (key < current
+           && !target.compare_exchange_weak(current, key, std::memory_order_relaxed))
+    {
+    }
+  };
+
+  while (!edges.empty()) {
+    // 先把每个点的根压平成标签，扫描边时不再走父指针 / Flatten every point's root
+    // into a label first so the edge scan never walks parent pointers
+    toolbox::concurrent::parallel_for_chunks(
+        num_points,
+        k_parallel_threshold,
+        m_enable_parallel,
+        [&](std::size_t, std::size_t begin, std::size_t end)
+        {
+          for (std::size_t i = begin; i < end; ++i) {
+            labels[i] = static_cast<std::uint32_t>(components.find(i));
+          }
+        });
+    internal.assign(edges.size(), 0);
+    toolbox::concurrent::parallel_for_chunks(
+        edges.size(),
+        k_parallel_threshold,
+        m_enable_parallel,
+        [&](std::size_t, std::size_t begin, std::size_t end)
+        {
+          for (std::size_t e = begin; e < end; ++e) {
+            const std::uint32_t root_a = labels[edges[e].a];
+            const std::uint32_t root_b = labels[edges[e].b];
+            if (root_a == root_b) {
+              internal[e] = 1;
+              continue;
+            }
+            atomic_min(lightest[root_a], edges[e].key);
+            atomic_min(lightest[root_b], edges[e].key);
+          }
+        });
+
+    std::size_t kept = 0;
+    for (std::size_t e = 0; e < edges.size(); ++e) {
+      if (internal[e] == 0) {
+        edges[kept++] = edges[e];
+      }
+    }
+    edges.resize(kept);
+
+    std::size_t added = 0;
+    for (std::size_t root = 0; root < num_points; ++root) {
+      if (lightest[root].load(std::memory_order_relaxed) == k_no_edge) {
+        continue;
+      }
+      const std::uint64_t key = lightest[root].exchange(k_no_edge, std::memory_order_relaxed);
+      const std::size_t edge = static_cast<std::size_t>(key & 0xFFFFFFFFULL);
+      if (components.unite(edge / width, neighbors[edge])) {
+        tree_edges.push_back(edge);
+        ++added;
+      }
+    }
+    if (added == 0) {
+      break;
+    }
+  }
+
+  // 生成森林的邻接表 / Adjacency of the spanning forest
+  std::vector<std::size_t> adjacency_offsets(num_points + 1, 0);
+  for (const std::size_t edge : tree_edges) {
+    ++adjacency_offsets[edge / width + 1];
+    ++adjacency_offsets[neighbors[edge] + 1];
+  }
+  for (std::size_t i = 0; i < num_points; ++i) {
+    adjacency_offsets[i + 1] += adjacency_offsets[i];
+  }
+  std::vector<std::size_t> adjacency(adjacency_offsets.back());
+  std::vector<std::size_t> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+  for (const std::size_t edge : tree_edges) {
+    const std::size_t a = edge / width;
+    const std::size_t b = neighbors[edge];
+    adjacency[fill[a]++] = b;
+    adjacency[fill[b]++] = a;
+  }
+
+  // 按层传播：树中每个点只有一个已访问的邻居（父节点），同层内没有写冲突
+  // Level-synchronous propagation: in a tree every point has exactly one visited
+  // neighbor, its parent, so a level has no conflicting writes
+  std::vector<std::uint8_t> visited(num_points, 0);
+  std::vector<std::size_t> frontier;
+  std::vector<std::vector<std::size_t>> next_levels;
+  for (std::size_t root = 0; root < num_points; ++root) {
+    if (visited[root] || valid[root] == 0) {
+      continue;
+    }
+    visited[root] = 1;
+    auto& root_normal = normals[root];
+    const auto& root_point = m_cloud->points[root];
+    if (root_normal.x * (m_viewpoint.x - root_point.x) + root_normal.y * (m_viewpoint.y - root_point.y)
+            + root_normal.z * (m_viewpoint.z - root_point.z)
+        < data_type(0))
+    {
+      root_normal = point_t<data_type>(-root_normal.x, -root_normal.y, -root_normal.z);
+    }
+
+    frontier.assign(1, root);
+    while (!frontier.empty()) {
+      next_levels.assign(toolbox::concurrent::parallel_chunk_count(
+                             frontier.size(), k_parallel_threshold, m_enable_parallel),
+                         {});
+      toolbox::concurrent::parallel_for_chunks(
+          frontier.size(),
+          k_parallel_threshold,
+          m_enable_parallel,
+          [&](std::size_t task, std::size_t begin, std::size_t end)
+          {
+            auto& next = next_levels[task];
+            for (std::size_t f = begin; f < end; ++f) {
+              const std::size_t parent = frontier[f];
+              const auto& np = normals[parent];
+              for (std::size_t e = adjacency_offsets[parent];
+                   e < adjacency_offsets[parent + 1];
+                   ++e)
+              {
+                const std::size_t child = adjacency[e];
+                if (visited[child]) {
+                  continue;
+                }
+                visited[child] = 1;
+                auto& nc = normals[child];
+                if (nc.x * np.x + nc.y * np.y + nc.z * np.z < data_type(0)) {
+                  nc = point_t<data_type>(-nc.x, -nc.y, -nc.z);
+                }
+                next.push_back(child);
+              }
+            }
+          });
+      frontier.clear();
+      for (const auto& next : next_levels) {
+        frontier.insert(frontier.end(), next.begin(), next.end());
+      }
+    }
+  }
 }
 
 }  // namespace toolbox::pcl
\ No newline at end of file
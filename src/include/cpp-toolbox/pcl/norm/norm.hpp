@@ -33,6 +33,8 @@
  */
 
 #include <cpp-toolbox/pcl/norm/base_norm.hpp>
+#include <cpp-toolbox/pcl/norm/batch_pca.hpp>
+#include <cpp-toolbox/pcl/norm/integral_image_norm.hpp>
 #include <cpp-toolbox/pcl/norm/pca_norm.hpp>
 
 namespace toolbox::pcl
@@ -49,6 +51,12 @@ namespace toolbox::pcl
  * 当前实现：
  * - pca_norm_extractor_t: 基于PCA的法向量提取，最常用和稳定的方法 /
  *   PCA-based normal extraction, the most commonly used and stable method
+ * - batch_pca_t: 法线和关键点共用的批量协方差与3x3解析特征分解内核 /
+ *   Batched covariance and analytic 3x3 eigen decomposition kernel shared by normals
+ *   and keypoints
+ * - integral_image_norm_extractor_t: 有序点云（距离图像）上基于积分图的O(N)法向量，
+ *   不做树查询 / O(N) integral-image normals on organized clouds (range images)
+ *   without tree queries
  * 
  * 参数选择建议 / Parameter selection recommendations:
  * - 近邻数量：通常选择10-50个点，取决于点云密度和噪声水平 /
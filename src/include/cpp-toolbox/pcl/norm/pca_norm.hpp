@@ -1,13 +1,67 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
 #include <cpp-toolbox/cpp-toolbox_export.hpp>
 #include <cpp-toolbox/pcl/knn/bfknn_parallel.hpp>
 #include <cpp-toolbox/pcl/knn/kdtree.hpp>
+#include <cpp-toolbox/pcl/knn/neighborhood_graph.hpp>
 #include <cpp-toolbox/pcl/norm/base_norm.hpp>
+#include <cpp-toolbox/pcl/norm/batch_pca.hpp>
 
 namespace toolbox::pcl
 {
 
+/**
+ * @brief 法向量定向方式 / Normal orientation mode
+ */
+enum class normal_orientation_t
+{
+  none,  ///< 不定向，符号任意 / Unoriented, arbitrary sign
+  viewpoint,  ///< 朝向set_viewpoint给定的视点 / Toward the viewpoint given by set_viewpoint
+  sensor_origin,  ///< 朝向原点(0, 0, 0)，适用于传感器坐标系下的LiDAR扫描 / Toward the
+                  ///< origin, for LiDAR scans in the sensor frame
+  minimum_spanning_tree  ///< 沿最小生成树传播得到全局一致的方向 / Propagate along a
+                         ///< minimum spanning tree for globally consistent orientation
+};
+
+/**
+ * @brief 每个点的局部几何量 / Local geometry of one point
+ *
+ * 特征值升序 λ0 <= λ1 <= λ2，比率沿用Demantke等人的维度特征。
+ * Eigenvalues are ascending λ0 <= λ1 <= λ2; the ratios follow the dimensionality
+ * features of Demantke et al.
+ */
+template<typename DataType>
+struct normal_geometry_t
+{
+  std::array<DataType, 3> eigenvalues {};  ///< 协方差特征值 / Covariance eigenvalues
+  DataType curvature = DataType(0);  ///< 表面变化 λ0 / (λ0 + λ1 + λ2) / Surface variation
+
+  /// (λ2 - λ1) / λ2，线状结构接近1 / Close to 1 on linear structures
+  [[nodiscard]] DataType linearity() const noexcept
+  {
+    return eigenvalues[2] > DataType(0) ? (eigenvalues[2] - eigenvalues[1]) / eigenvalues[2]
+                                        : DataType(0);
+  }
+
+  /// (λ1 - λ0) / λ2，平面接近1 / Close to 1 on planes
+  [[nodiscard]] DataType planarity() const noexcept
+  {
+    return eigenvalues[2] > DataType(0) ? (eigenvalues[1] - eigenvalues[0]) / eigenvalues[2]
+                                        : DataType(0);
+  }
+
+  /// λ0 / λ2，散乱点接近1 / Close to 1 on scattered points
+  [[nodiscard]] DataType sphericity() const noexcept
+  {
+    return eigenvalues[2] > DataType(0) ? eigenvalues[0] / eigenvalues[2] : DataType(0);
+  }
+};
+
 /**
  * @brief 基于PCA的法向量提取器 / PCA-based normal extractor
  * 
@@ -47,6 +101,15 @@ namespace toolbox::pcl
  * 
  * auto normals = norm_extractor.extract();
  * @endcode
+ *
+ * @code
+ * // LiDAR扫描：法线朝向传感器，同时输出曲率 / LiDAR scan: normals face the sensor and
+ * // curvature comes out of the same pass
+ * norm_extractor.set_orientation(normal_orientation_t::sensor_origin);
+ * auto oriented = norm_extractor.extract();
+ * const auto& geometry = norm_extractor.get_geometry();
+ * bool flat = geometry[0].curvature < 0.01f;
+ * @endcode
  */
 template<typename DataType, typename KNN = kdtree_generic_t<point_t<DataType>, toolbox::metrics::L2Metric<DataType>>>
 class CPP_TOOLBOX_EXPORT pca_norm_extractor_t
@@ -119,26 +182,92 @@ public:
    */
   void enable_parallel(bool enable) { m_enable_parallel = enable; }
 
+  /**
+   * @brief 使用预计算的近邻图代替KNN搜索 / Use a precomputed neighborhood graph instead of KNN searches
+   * @param graph 以输入点云为查询建立的近邻图 / Neighborhood graph built with the input cloud as queries
+   *
+   * 每个点取图中该行最近的num_neighbors个邻居；设置后不再需要KNN对象。
+   * Each point takes the nearest num_neighbors entries of its graph row; no KNN object is
+   * needed once a graph is set.
+   *
+   * @code
+   * neighborhood_graph_t<float> graph;
+   * graph.build_knn(kdtree, cloud.points, 30);
+   * norm_extractor.set_neighborhood_graph(graph);
+   * @endcode
+   */
+  void set_neighborhood_graph(const neighborhood_graph_t<data_type>& graph) { m_graph = &graph; }
+
+  /**
+   * @brief 设置协方差累加和特征分解的精度 / Set the precision of covariance accumulation
+   * and eigen decomposition
+   * @param precision 默认double；single_precision全程使用float，更快但最小特征值精度较低 /
+   * double by default; single_precision stays in float, faster but with a less accurate
+   * smallest eigenvalue
+   */
+  void set_precision(pca_precision_t precision) { m_pca.set_precision(precision); }
+  [[nodiscard]] pca_precision_t get_precision() const noexcept { return m_pca.get_precision(); }
+
+  /**
+   * @brief 设置法向量定向方式 / Set the normal orientation mode
+   *
+   * 视点和传感器原点定向在计算法线的同一遍中完成。最小生成树定向以1 - |n_i·n_j|为边权，
+   * 在同一遍收集的近邻上用并行Borůvka算法求最小生成森林，再从每棵树的根（朝向视点）按层
+   * 并行传播。无效邻域的默认法线(0, 0, 1)不参与定向。
+   * Viewpoint and sensor-origin orientation happen in the pass that computes the
+   * normals. Minimum spanning tree orientation weights edges with 1 - |n_i·n_j|,
+   * builds a minimum spanning forest with parallel Borůvka rounds over the
+   * neighbors gathered in that pass, then propagates level by level from each
+   * tree root, which faces the viewpoint. Default normals (0, 0, 1) of invalid
+   * neighborhoods are left alone.
+   */
+  void set_orientation(normal_orientation_t orientation) { m_orientation = orientation; }
+  [[nodiscard]] normal_orientation_t get_orientation() const noexcept { return m_orientation; }
+
+  /// 视点，默认原点 / Viewpoint, the origin by default
+  void set_viewpoint(const point_t<data_type>& viewpoint) { m_viewpoint = viewpoint; }
+  [[nodiscard]] const point_t<data_type>& get_viewpoint() const noexcept { return m_viewpoint; }
+
+  /**
+   * @brief 上一次提取得到的每点特征值和曲率 / Per-point eigenvalues and curvature of
+   * the last extraction
+   */
+  [[nodiscard]] const std::vector<normal_geometry_t<data_type>>& get_geometry() const noexcept
+  {
+    return m_geometry;
+  }
+
 private:
   /**
    * @brief 计算指定范围内点的法向量 / Compute normals for points in specified range
    * @param output 输出点云 / Output point cloud
    * @param start_idx 起始索引 / Start index
    * @param end_idx 结束索引 / End index
+   *
+   * 邻域按块收集成CSR形式后交给batch_pca_t一次处理。
+   * Neighborhoods are gathered into CSR blocks and handed to batch_pca_t together.
    */
   void compute_normals_range(point_cloud_ptr output, std::size_t start_idx, std::size_t end_idx);
-  
+
   /**
-   * @brief 使用PCA计算单个点的法向量 / Compute normal for a single point using PCA
-   * @param indices 近邻点的索引 / Indices of neighbor points
-   * @return 计算得到的法向量 / Computed normal vector
+   * @brief 沿最小生成森林统一法向量方向 / Make normal directions consistent along a
+   * minimum spanning forest
    */
-  point_t<data_type> compute_pca_normal(const std::vector<std::size_t>& indices);
+  void orient_along_spanning_tree(point_cloud_ptr output);
+
+  static constexpr std::size_t k_no_neighbor = std::numeric_limits<std::size_t>::max();
 
   bool m_enable_parallel = false;  ///< 是否启用并行计算 / Whether to enable parallel computation
   std::size_t m_num_neighbors = 0;  ///< 近邻数量 / Number of neighbors
   point_cloud_ptr m_cloud;  ///< 输入点云 / Input point cloud
   knn_type* m_knn = nullptr;  ///< KNN搜索算法指针 / Pointer to KNN search algorithm
+  const neighborhood_graph_t<data_type>* m_graph = nullptr;  ///< 预计算的近邻图 / Precomputed neighborhood graph
+  batch_pca_t<data_type> m_pca;  ///< 批量PCA内核 / Batch PCA kernel
+  normal_orientation_t m_orientation = normal_orientation_t::none;  ///< 定向方式 / Orientation mode
+  point_t<data_type> m_viewpoint {0, 0, 0};  ///< 视点 / Viewpoint
+  std::vector<normal_geometry_t<data_type>> m_geometry;  ///< 每点几何量 / Per-point geometry
+  std::vector<std::size_t> m_tree_neighbors;  ///< 每点num_neighbors个近邻，供生成树使用 / num_neighbors entries per point for the spanning tree
+  std::vector<std::uint8_t> m_tree_valid;  ///< 每点法线是否有效，供生成树使用 / Per-point normal validity for the spanning tree
 };  // class pca_norm_extractor_t
 
 }  // namespace toolbox::pcl
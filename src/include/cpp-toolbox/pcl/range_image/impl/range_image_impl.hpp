@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <cpp-toolbox/concurrent/parallel.hpp>
+#include <cpp-toolbox/logger/thread_logger.hpp>
+
+namespace toolbox::pcl
+{
+
+template<typename DataType>
+void range_image_t<DataType>::clear()
+{
+  m_width = 0;
+  m_height = 0;
+  m_num_valid = 0;
+  m_indices.clear();
+  m_ranges.clear();
+  m_point_pixels.clear();
+}
+
+template<typename DataType>
+template<typename Locate>
+void range_image_t<DataType>::fill(const point_cloud& cloud, Locate locate)
+{
+  constexpr std::uint64_t k_no_point = std::numeric_limits<std::uint64_t>::max();
+  const std::size_t num_points = cloud.size();
+  const std::size_t num_pixels = m_width * m_height;
+  m_point_pixels.assign(num_points, k_empty);
+  m_indices.assign(num_pixels, k_empty);
+  m_ranges.assign(num_pixels, data_type(0));
+  m_num_valid = 0;
+
+  // 针孔投影存深度，球面投影存距离，两者都由locate给出 / Pinhole stores depth and
+  // spherical stores range, both given by locate
+  std::vector<data_type> point_ranges(num_points, data_type(0));
+
+  // 键为(距离位, 点索引)，距离为正时浮点位序即数值序 / Keys are (range bits, point
+  // index); for positive floats the bit order is the numeric order
+  std::vector<std::atomic<std::uint64_t>> nearest(num_pixels);
+  toolbox::concurrent::parallel_for_chunks(
+      num_pixels,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t p = start_idx; p < end_idx; ++p) {
+          nearest[p].store(k_no_point, std::memory_order_relaxed);
+        }
+      });
+
+  toolbox::concurrent::parallel_for_chunks(
+      num_points,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t i = start_idx; i < end_idx; ++i) {
+          const auto [pixel, range] = locate(cloud.points[i]);
+          if (pixel == k_empty) {
+            continue;
+          }
+          m_point_pixels[i] = pixel;
+          point_ranges[i] = range;
+          const float range_f = static_cast<float>(range);
+          std::uint32_t bits = 0;
+          std::memcpy(&bits, &range_f, sizeof(bits));
+          const std::uint64_t key =
+              (static_cast<std::uint64_t>(bits) << 32) | static_cast<std::uint64_t>(i);
+          auto& slot = nearest[pixel];
+          std::uint64_t current = slot.load(std::memory_order_relaxed);
+          while (key < current
+                 && !slot.compare_exchange_weak(current, key, std::memory_order_relaxed))
+          {
+          }
+        }
+      });
+
+  toolbox::concurrent::parallel_for_chunks(
+      num_pixels,
+      k_parallel_threshold,
+      m_enable_parallel,
+      [&](std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t p = start_idx; p < end_idx; ++p) {
+          const std::uint64_t key = nearest[p].load(std::memory_order_relaxed);
+          if (key == k_no_point) {
+            continue;
+          }
+          const auto index = static_cast<std::size_t>(key & 0xFFFFFFFFULL);
+          m_indices[p] = index;
+          m_ranges[p] = point_ranges[index];
+        }
+      });
+  m_num_valid = static_cast<std::size_t>(std::count_if(
+      m_indices.begin(), m_indices.end(), [](std::size_t idx) { return idx != k_empty; }));
+}
+
+template<typename DataType>
+bool range_image_t<DataType>::project_spherical(const point_cloud& cloud,
+                                                std::size_t width,
+                                                std::size_t height,
+                                                data_type fov_up_deg,
+                                                data_type fov_down_deg)
+{
+  clear();
+  if (width == 0 || height == 0 || !(fov_up_deg > fov_down_deg)) {
+    LOG_ERROR_S << "range_image_t: Invalid spherical projection " << width << "x" << height
+                << ", fov [" << fov_down_deg << ", " << fov_up_deg << "]";
+    return false;
+  }
+  if (cloud.size() >= (std::size_t(1) << 32)) {
+    LOG_ERROR_S << "range_image_t: Clouds are limited to 2^32 points";
+    return false;
+  }
+
+  m_width = width;
+  m_height = height;
+  m_projection = range_projection_t::spherical;
+
+  constexpr double k_pi = 3.14159265358979323846;
+  const double fov_up = static_cast<double>(fov_up_deg) * k_pi / 180.0;
+  const double fov = (static_cast<double>(fov_up_deg) - static_cast<double>(fov_down_deg))
+      * k_pi / 180.0;
+  const double cols = static_cast<double>(width);
+  const double rows = static_cast<double>(height);
+
+  fill(cloud,
+       [&](const auto& p) -> std::pair<std::size_t, data_type>
+       {
+         const double x = static_cast<double>(p.x);
+         const double y = static_cast<double>(p.y);
+         const double z = static_cast<double>(p.z);
+         const double range = std::sqrt(x * x + y * y + z * z);
+         if (!(range > 1e-6) || !std::isfinite(range)) {
+           return {k_empty, data_type(0)};
+         }
+         const double v = (fov_up - std::asin(z / range)) / fov * rows;
+         if (!(v >= 0.0 && v < rows)) {
+           return {k_empty, data_type(0)};
+         }
+         const double u = 0.5 * (1.0 - std::atan2(y, x) / k_pi) * cols;
+         const auto col = std::min(static_cast<std::size_t>(std::max(u, 0.0)), width - 1);
+         const auto row = std::min(static_cast<std::size_t>(v), height - 1);
+         return {row * width + col, static_cast<data_type>(range)};
+       });
+  return true;
+}
+
+template<typename DataType>
+bool range_image_t<DataType>::project_pinhole(const point_cloud& cloud,
+                                              std::size_t width,
+                                              std::size_t height,
+                                              data_type fx,
+                                              data_type fy,
+                                              data_type cx,
+                                              data_type cy)
+{
+  clear();
+  if (width == 0 || height == 0 || !(fx > data_type(0)) || !(fy > data_type(0))) {
+    LOG_ERROR_S << "range_image_t: Invalid pinhole projection " << width << "x" << height
+                << ", fx " << fx << ", fy " << fy;
+    return false;
+  }
+  if (cloud.size() >= (std::size_t(1) << 32)) {
+    LOG_ERROR_S << "range_image_t: Clouds are limited to 2^32 points";
+    return false;
+  }
+
+  m_width = width;
+  m_height = height;
+  m_projection = range_projection_t::pinhole;
+
+  const double cols = static_cast<double>(width);
+  const double rows = static_cast<double>(height);
+  fill(cloud,
+       [&](const auto& p) -> std::pair<std::size_t, data_type>
+       {
+         const double z = static_cast<double>(p.z);
+         if (!(z > 1e-6) || !std::isfinite(z)) {
+           return {k_empty, data_type(0)};
+         }
+         const double u = static_cast<double>(fx) * static_cast<double>(p.x) / z
+             + static_cast<double>(cx) + 0.5;
+         const double v = static_cast<double>(fy) * static_cast<double>(p.y) / z
+             + static_cast<double>(cy) + 0.5;
+         if (!(u >= 0.0 && u < cols && v >= 0.0 && v < rows)) {
+           return {k_empty, data_type(0)};
+         }
+         return {static_cast<std::size_t>(v) * width + static_cast<std::size_t>(u), p.z};
+       });
+  return true;
+}
+
+}  // namespace toolbox::pcl
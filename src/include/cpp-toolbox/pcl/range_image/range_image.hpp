@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include <cpp-toolbox/cpp-toolbox_export.hpp>
+#include <cpp-toolbox/types/point.hpp>
+
+namespace toolbox::pcl
+{
+
+/**
+ * @brief 距离图像的投影模型 / Projection model of a range image
+ */
+enum class range_projection_t
+{
+  spherical,  ///< 球面投影，用于旋转式LiDAR / Spherical, for spinning LiDARs
+  pinhole  ///< 针孔投影，用于深度相机 / Pinhole, for depth cameras
+};
+
+/**
+ * @brief 点云的距离图像投影 / Range image projection of a point cloud
+ *
+ * 把无序点云投影到二维网格，得到有序点云的像素邻接关系。每个像素保存落入其中最近的点，
+ * 每个点记录自己所在的像素，因此被遮挡的点仍能通过像素找到邻居。投影按块并行，像素冲突用
+ * (距离位, 点索引)键的原子最小值解决，结果与线程数无关。
+ * Projects an unorganized cloud onto a 2D grid, which gives the pixel adjacency of
+ * an organized cloud. Every pixel keeps the nearest point falling into it and every
+ * point remembers its pixel, so occluded points still reach their neighbors
+ * through it. Projection runs in parallel chunks and pixel collisions are settled
+ * by an atomic minimum over (range bits, point index) keys, so the result does
+ * not depend on the thread count.
+ *
+ * 球面投影：第0行对应fov_up，第0列对应正后方，方位角沿列递减，即x轴正方向位于中间列。
+ * 针孔投影：点位于相机坐标系（z向前，x向右，y向下），像素值为深度z。
+ * Spherical: row 0 is fov_up and column 0 looks backwards, azimuth decreasing
+ * along the columns so +x lies in the middle column. Pinhole: points are in the
+ * camera frame (z forward, x right, y down) and the stored value is the depth z.
+ *
+ * @tparam DataType 数据类型（如float或double） / Data type (e.g., float or double)
+ *
+ * @code
+ * range_image_t<float> image;
+ * image.enable_parallel(true);
+ * image.project_spherical(scan, 2048, 64, 3.0f, -25.0f);  // HDL-64E
+ * const std::size_t idx = image.index(row, col);
+ * if (idx != range_image_t<float>::k_empty) {
+ *   const auto& p = scan.points[idx];
+ * }
+ * @endcode
+ */
+template<typename DataType>
+class CPP_TOOLBOX_EXPORT range_image_t
+{
+public:
+  using data_type = DataType;
+  using point_cloud = toolbox::types::point_cloud_t<data_type>;
+
+  /// 空像素或未投影点的标记 / Marker of empty pixels and unprojected points
+  static constexpr std::size_t k_empty = std::numeric_limits<std::size_t>::max();
+
+  range_image_t() = default;
+
+  void enable_parallel(bool enable) { m_enable_parallel = enable; }
+
+  /**
+   * @brief 球面投影 / Spherical projection
+   * @param cloud 传感器坐标系下的点云 / Cloud in the sensor frame
+   * @param width 方位角方向的列数 / Columns over the full azimuth
+   * @param height 行数（通常为线数） / Rows, usually the number of rings
+   * @param fov_up_deg 视场上边界（度） / Upper edge of the field of view in degrees
+   * @param fov_down_deg 视场下边界（度） / Lower edge of the field of view in degrees
+   * @return 参数是否有效 / Whether the parameters were valid
+   */
+  bool project_spherical(const point_cloud& cloud,
+                         std::size_t width,
+                         std::size_t height,
+                         data_type fov_up_deg,
+                         data_type fov_down_deg);
+
+  /**
+   * @brief 针孔投影 / Pinhole projection
+   * @param cloud 相机坐标系下的点云 / Cloud in the camera frame
+   * @param width 图像宽度 / Image width
+   * @param height 图像高度 / Image height
+   * @param fx 焦距x / Focal length x
+   * @param fy 焦距y / Focal length y
+   * @param cx 主点x / Principal point x
+   * @param cy 主点y / Principal point y
+   * @return 参数是否有效 / Whether the parameters were valid
+   */
+  bool project_pinhole(const point_cloud& cloud,
+                       std::size_t width,
+                       std::size_t height,
+                       data_type fx,
+                       data_type fy,
+                       data_type cx,
+                       data_type cy);
+
+  void clear();
+
+  [[nodiscard]] std::size_t width() const noexcept { return m_width; }
+  [[nodiscard]] std::size_t height() const noexcept { return m_height; }
+  [[nodiscard]] bool empty() const noexcept { return m_indices.empty(); }
+  [[nodiscard]] range_projection_t projection() const noexcept { return m_projection; }
+
+  /// 像素中的点索引，空像素为k_empty / Point index of a pixel, k_empty if empty
+  [[nodiscard]] std::size_t index(std::size_t row, std::size_t col) const noexcept
+  {
+    return m_indices[row * m_width + col];
+  }
+
+  /// 像素的距离（针孔为深度），空像素为0 / Range of a pixel (depth for pinhole), 0 if empty
+  [[nodiscard]] data_type range(std::size_t row, std::size_t col) const noexcept
+  {
+    return m_ranges[row * m_width + col];
+  }
+
+  /// 点所在的像素（行 * 宽 + 列），未投影为k_empty / Pixel of a point (row * width +
+  /// col), k_empty if not projected
+  [[nodiscard]] std::size_t pixel(std::size_t point_index) const noexcept
+  {
+    return m_point_pixels[point_index];
+  }
+
+  /// 行优先的像素点索引 / Row-major pixel point indices
+  [[nodiscard]] const std::vector<std::size_t>& indices() const noexcept { return m_indices; }
+  /// 行优先的像素距离 / Row-major pixel ranges
+  [[nodiscard]] const std::vector<data_type>& ranges() const noexcept { return m_ranges; }
+  /// 每个点的像素 / Pixel of every point
+  [[nodiscard]] const std::vector<std::size_t>& point_pixels() const noexcept
+  {
+    return m_point_pixels;
+  }
+
+  /// 非空像素数 / Number of occupied pixels
+  [[nodiscard]] std::size_t num_valid() const noexcept { return m_num_valid; }
+
+private:
+  /**
+   * @brief 根据每个点的像素和距离填充图像 / Fill the image from every point's pixel
+   * and range
+   * @param locate locate(point) -> (pixel, range)，不可投影时pixel为k_empty /
+   * pixel is k_empty when the point cannot be projected
+   */
+  template<typename Locate>
+  void fill(const point_cloud& cloud, Locate locate);
+
+  std::size_t m_width = 0;
+  std::size_t m_height = 0;
+  std::size_t m_num_valid = 0;
+  range_projection_t m_projection = range_projection_t::spherical;
+  bool m_enable_parallel = false;
+  std::vector<std::size_t> m_indices;
+  std::vector<data_type> m_ranges;
+  std::vector<std::size_t> m_point_pixels;
+
+  static constexpr std::size_t k_parallel_threshold = 4096;
+};
+
+}  // namespace toolbox::pcl
+
+#include <cpp-toolbox/pcl/range_image/impl/range_image_impl.hpp>
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <cpp-toolbox/cpp-toolbox_export.hpp>
+#include <cpp-toolbox/pcl/knn/kdtree.hpp>
+#include <cpp-toolbox/pcl/knn/neighborhood_graph.hpp>
+#include <cpp-toolbox/types/point.hpp>
+
+namespace toolbox::pcl
+{
+
+/**
+ * @brief CSR格式的聚类结果 / Clusters in CSR layout
+ *
+ * 第i个聚类的点索引为indices[offsets[i], offsets[i + 1])，聚类内按升序排列。
+ * The point indices of cluster i are indices[offsets[i], offsets[i + 1]),
+ * sorted ascending within the cluster.
+ */
+struct CPP_TOOLBOX_EXPORT clusters_t
+{
+  /**
+   * @brief 一个聚类的只读视图 / Read-only view of one cluster
+   */
+  struct cluster_range_t
+  {
+    const std::size_t* indices = nullptr;  ///< 点索引 / Point indices
+    std::size_t size = 0;  ///< 点数 / Number of points
+
+    [[nodiscard]] const std::size_t* begin() const noexcept { return indices; }
+    [[nodiscard]] const std::size_t* end() const noexcept { return indices + size; }
+  };
+
+  std::vector<std::size_t> offsets;  ///< 聚类偏移，大小为聚类数+1 / Cluster offsets, size is clusters + 1
+  std::vector<std::size_t> indices;  ///< 所有聚类的点索引 / Point indices of all clusters
+
+  /// 聚类数 / Number of clusters
+  [[nodiscard]] std::size_t size() const noexcept
+  {
+    return offsets.empty() ? 0 : offsets.size() - 1;
+  }
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+  [[nodiscard]] cluster_range_t cluster(std::size_t i) const noexcept
+  {
+    return {indices.data() + offsets[i], offsets[i + 1] - offsets[i]};
+  }
+
+  void clear()
+  {
+    offsets.clear();
+    indices.clear();
+  }
+};
+
+/**
+ * @brief 欧氏聚类提取 / Euclidean cluster extraction
+ *
+ * 距离不超过tolerance的点连成边，连通分量即为聚类。每个线程对自己负责的点做半径搜索，把边
+ * 直接合并进共享的无锁并查集，因此不需要先收集边列表或按点加锁；由于并查集的根总是集合中最小的
+ * 索引，结果与线程数和调度无关。聚类按首个点的索引排序，点数不在[min, max]内的聚类被丢弃。
+ * Points no farther apart than tolerance are connected, and each connected
+ * component is a cluster. Every thread runs radius searches for its share of
+ * the points and merges the edges straight into a shared lock-free union-find,
+ * so no edge list or per-point locks are needed. Since the root of every set is
+ * its smallest index, the result does not depend on the thread count or
+ * scheduling. Clusters are ordered by their first point index, and clusters
+ * whose size lies outside [min, max] are dropped.
+ *
+ * 可以用预计算的半径近邻图（半径不小于tolerance，且不限制每行邻居数）代替KNN搜索。
+ * A precomputed radius neighborhood graph, built with a radius of at least
+ * tolerance and no per-row neighbor cap, can replace the KNN searches.
+ *
+ * @tparam DataType 数据类型（如float或double） / Data type (e.g., float or double)
+ * @tparam KNN KNN搜索算法类型，默认为kdtree_t / KNN search algorithm type, kdtree_t by default
+ *
+ * @code
+ * euclidean_cluster_extraction_t<float> clustering(0.5f, 30, 25000);
+ * clustering.enable_parallel(true);
+ * clustering.set_input(obstacles);
+ * clusters_t clusters;
+ * clustering.extract(clusters);
+ * for (std::size_t i = 0; i < clusters.size(); ++i) {
+ *   for (const auto idx : clusters.cluster(i)) {
+ *     // obstacles.points[idx] 属于聚类i / belongs to cluster i
+ *   }
+ * }
+ * @endcode
+ */
+template<typename DataType,
+         typename KNN = kdtree_generic_t<point_t<DataType>,
+                                         toolbox::metrics::L2Metric<DataType>>>
+class CPP_TOOLBOX_EXPORT euclidean_cluster_extraction_t
+{
+public:
+  using data_type = DataType;
+  using point_cloud = toolbox::types::point_cloud_t<data_type>;
+  using point_cloud_ptr = std::shared_ptr<point_cloud>;
+  using knn_type = KNN;
+
+  euclidean_cluster_extraction_t() = default;
+
+  /**
+   * @param tolerance 同一聚类中相邻点的最大距离 / Maximum distance between neighboring
+   * points of a cluster
+   * @param min_cluster_size 最小聚类点数 / Minimum cluster size
+   * @param max_cluster_size 最大聚类点数，0表示不限制 / Maximum cluster size, 0 means
+   * unlimited
+   */
+  euclidean_cluster_extraction_t(data_type tolerance,
+                                 std::size_t min_cluster_size = 1,
+                                 std::size_t max_cluster_size = 0)
+      : m_tolerance(tolerance),
+        m_min_cluster_size(min_cluster_size),
+        m_max_cluster_size(max_cluster_size)
+  {
+  }
+
+  euclidean_cluster_extraction_t(const euclidean_cluster_extraction_t&) = delete;
+  euclidean_cluster_extraction_t& operator=(const euclidean_cluster_extraction_t&) = delete;
+  euclidean_cluster_extraction_t(euclidean_cluster_extraction_t&&) = delete;
+  euclidean_cluster_extraction_t& operator=(euclidean_cluster_extraction_t&&) = delete;
+  ~euclidean_cluster_extraction_t() = default;
+
+  std::size_t set_input(const point_cloud& cloud);
+  std::size_t set_input(const point_cloud_ptr& cloud);
+
+  void enable_parallel(bool enable) { m_enable_parallel = enable; }
+
+  /**
+   * @brief 使用预计算的近邻图代替KNN搜索 / Use a precomputed neighborhood graph instead of
+   * KNN searches
+   * @param graph 以输入点云为查询、半径不小于tolerance且max_neighbors为0建立的近邻图 /
+   * Radius graph built with the input cloud as queries, a radius of at least tolerance
+   * and max_neighbors 0
+   */
+  void set_neighborhood_graph(const neighborhood_graph_t<data_type>& graph) { m_graph = &graph; }
+  void clear_neighborhood_graph() { m_graph = nullptr; }
+
+  /**
+   * @brief 提取聚类 / Extract the clusters
+   * @param clusters [out] CSR格式的聚类 / Clusters in CSR layout
+   * @return 参数有效且搜索成功时返回true / True when the parameters are valid and the
+   * searches succeeded
+   */
+  bool extract(clusters_t& clusters);
+
+  void set_tolerance(data_type tolerance) { m_tolerance = tolerance; }
+  [[nodiscard]] data_type get_tolerance() const noexcept { return m_tolerance; }
+  void set_min_cluster_size(std::size_t min_size) { m_min_cluster_size = min_size; }
+  [[nodiscard]] std::size_t get_min_cluster_size() const noexcept { return m_min_cluster_size; }
+  void set_max_cluster_size(std::size_t max_size) { m_max_cluster_size = max_size; }
+  [[nodiscard]] std::size_t get_max_cluster_size() const noexcept { return m_max_cluster_size; }
+
+private:
+  data_type m_tolerance = data_type(0.5);
+  std::size_t m_min_cluster_size = 1;
+  std::size_t m_max_cluster_size = 0;
+  bool m_enable_parallel = false;
+  bool m_knn_ready = false;
+  point_cloud_ptr m_cloud;
+  knn_type m_knn;
+  const neighborhood_graph_t<data_type>* m_graph = nullptr;
+
+  static constexpr std::size_t k_parallel_threshold = 1024;
+};
+
+}  // namespace toolbox::pcl
+
+#include <cpp-toolbox/pcl/segmentation/impl/euclidean_cluster_extraction_impl.hpp>
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <cpp-toolbox/concurrent/parallel.hpp>
+#include <cpp-toolbox/container/concurrent_union_find.hpp>
+#include <cpp-toolbox/logger/thread_logger.hpp>
+
+namespace toolbox::pcl
+{
+
+template<typename DataType, typename KNN>
+std::size_t euclidean_cluster_extraction_t<DataType, KNN>::set_input(const point_cloud& cloud)
+{
+  return set_input(std::make_shared<point_cloud>(cloud));
+}
+
+template<typename DataType, typename KNN>
+std::size_t euclidean_cluster_extraction_t<DataType, KNN>::set_input(
+    const point_cloud_ptr& cloud)
+{
+  m_cloud = cloud;
+  m_knn_ready = false;
+  return m_cloud ? m_cloud->size() : 0U;
+}
+
+template<typename DataType, typename KNN>
+bool euclidean_cluster_extraction_t<DataType, KNN>::extract(clusters_t& clusters)
+{
+  clusters.clear();
+  if (!m_cloud) {
+    return false;
+  }
+  if (!(m_tolerance > data_type(0))) {
+    LOG_ERROR_S << "euclidean_cluster_extraction_t: Tolerance must be positive, got "
+                << m_tolerance;
+    return false;
+  }
+
+  const auto& points = m_cloud->points;
+  const std::size_t total_points = points.size();
+  clusters.offsets.push_back(0);
+  if (total_points == 0) {
+    return true;
+  }
+
+  bool parallel = m_enable_parallel && total_points > k_parallel_threshold;
+  if (m_graph != nullptr) {
+    // 截断的行会漏掉容差内的邻居，簇可能被拆开 / Capped rows can miss neighbors within
+    // the tolerance and split clusters
+    if (m_graph->size() != total_points || !m_graph->is_radius_graph()
+        || m_graph->max_neighbors() != 0 || m_graph->radius() < m_tolerance)
+    {
+      LOG_ERROR_S << "euclidean_cluster_extraction_t: Neighborhood graph must be an uncapped "
+                     "radius graph over the input with radius >= tolerance";
+      clusters.clear();
+      return false;
+    }
+  } else {
+    if (!m_knn_ready) {
+      m_knn.set_input(m_cloud);
+      m_knn_ready = true;
+    }
+    if constexpr (detail::searches_on_thread_pool<KNN>::value) {
+      parallel = parallel && !m_knn.is_parallel_enabled();
+    }
+  }
+
+  // 第1步：各线程搜索近邻并直接合并进共享并查集
+  toolbox::container::concurrent_union_find_t sets(total_points);
+  std::vector<char> succeeded(
+      toolbox::concurrent::parallel_chunk_count(total_points, k_parallel_threshold, parallel), 1);
+  toolbox::concurrent::parallel_for_chunks(
+      total_points,
+      k_parallel_threshold,
+      parallel,
+      [&](std::size_t task, std::size_t start_idx, std::size_t end_idx)
+      {
+        if (m_graph != nullptr) {
+          for (std::size_t i = start_idx; i < end_idx; ++i) {
+            const auto row = m_graph->neighbors(i, m_tolerance);
+            for (std::size_t j = 0; j < row.size; ++j) {
+              if (row.indices[j] != i) {
+                sets.unite(i, row.indices[j]);
+              }
+            }
+          }
+          return;
+        }
+
+        std::vector<std::size_t> indices;
+        std::vector<typename KNN::distance_type> distances;
+        for (std::size_t i = start_idx; i < end_idx; ++i) {
+          if (!m_knn.radius_neighbors(points[i], m_tolerance, indices, distances)) {
+            succeeded[task] = 0;
+            return;
+          }
+          for (const auto j : indices) {
+            if (j != i) {
+              sets.unite(i, j);
+            }
+          }
+        }
+      });
+  if (!std::all_of(succeeded.begin(), succeeded.end(), [](char ok) { return ok != 0; })) {
+    LOG_ERROR_S << "euclidean_cluster_extraction_t: Neighbor search failed";
+    clusters.clear();
+    return false;
+  }
+
+  // 第2步：求每个点的根；根是集合中最小的索引
+  std::vector<std::size_t> roots(total_points);
+  toolbox::concurrent::parallel_for_chunks(
+      total_points,
+      k_parallel_threshold,
+      parallel,
+      [&](std::size_t /*task*/, std::size_t start_idx, std::size_t end_idx)
+      {
+        for (std::size_t i = start_idx; i < end_idx; ++i) {
+          roots[i] = sets.find(i);
+        }
+      });
+
+  // 第3步：统计大小，按首个点的顺序为满足大小限制的集合编号
+  constexpr auto k_dropped = std::numeric_limits<std::size_t>::max();
+  std::vector<std::size_t> cluster_ids(total_points, 0);
+  for (std::size_t i = 0; i < total_points; ++i) {
+    ++cluster_ids[roots[i]];
+  }
+  const std::size_t max_size =
+      m_max_cluster_size == 0 ? std::numeric_limits<std::size_t>::max() : m_max_cluster_size;
+  std::size_t total_kept = 0;
+  for (std::size_t root = 0; root < total_points; ++root) {
+    const std::size_t size = cluster_ids[root];
+    if (roots[root] != root || size < m_min_cluster_size || size > max_size) {
+      cluster_ids[root] = k_dropped;
+      continue;
+    }
+    cluster_ids[root] = clusters.offsets.size() - 1;
+    total_kept += size;
+    clusters.offsets.push_back(total_kept);
+  }
+
+  // 第4步：按点索引顺序写入，聚类内自然升序
+  clusters.indices.resize(total_kept);
+  std::vector<std::size_t> cursor(clusters.offsets.begin(), clusters.offsets.end() - 1);
+  for (std::size_t i = 0; i < total_points; ++i) {
+    const std::size_t id = cluster_ids[roots[i]];
+    if (id != k_dropped) {
+      clusters.indices[cursor[id]++] = i;
+    }
+  }
+  return true;
+}
+
+}  // namespace toolbox::pcl
@@ -0,0 +1,11 @@
+#pragma once
+
+/**
+ * @file segmentation.hpp
+ * @brief 点云分割算法集合头文件 / Point cloud segmentation algorithms collection header file
+ *
+ * @details 本文件包含了所有可用的点云分割算法 / This file includes all available point cloud
+ * segmentation algorithms
+ */
+
+#include <cpp-toolbox/pcl/segmentation/euclidean_cluster_extraction.hpp>
@@ -3,6 +3,7 @@
 #include <array>
 #include <atomic>
 #include <cmath>  // std::sqrt
+#include <cstdint>
 #include <functional>  // std::plus, std::multiplies
 #include <iostream>  // For potential debug output
 #include <limits>  // std::numeric_limits
@@ -10,6 +11,7 @@
 #include <random>
 #include <stdexcept>  // std::runtime_error
 #include <string>
+#include <thread>
 #include <vector>
 
 // Include the header for the parallel functions under test
@@ -413,3 +415,122 @@ TEST_CASE("Parallel Tim Sort Tests", "[concurrent][parallel_tim_sort]")
     REQUIRE_THAT(data, Equals(expected));
   }
 }
+
+TEST_CASE("Parallel Radix Sort Tests", "[concurrent][parallel_radix_sort]")
+{
+  SECTION("Sort key-value pairs stably")
+  {
+    std::mt19937_64 rng(44);
+    std::uniform_int_distribution<std::uint64_t> dist(0, 5000);
+    std::vector<std::uint64_t> keys(200000);
+    std::vector<std::size_t> values(keys.size());
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      keys[i] = dist(rng) << 20U;  // 低位全为0的轮次会被跳过
+      values[i] = i;
+    }
+
+    std::vector<std::size_t> expected_values = values;
+    std::stable_sort(expected_values.begin(),
+                     expected_values.end(),
+                     [&keys](std::size_t a, std::size_t b)
+                     { return keys[a] < keys[b]; });
+    std::vector<std::uint64_t> expected_keys;
+    for (const auto idx : expected_values) {
+      expected_keys.push_back(keys[idx]);
+    }
+
+    auto serial_keys = keys;
+    auto serial_values = values;
+    parallel_radix_sort_pairs(keys, values);
+    REQUIRE_THAT(keys, Equals(expected_keys));
+    REQUIRE_THAT(values, Equals(expected_values));
+
+    parallel_radix_sort_pairs(serial_keys, serial_values, 64, false);
+    REQUIRE_THAT(serial_keys, Equals(expected_keys));
+    REQUIRE_THAT(serial_values, Equals(expected_values));
+  }
+
+  SECTION("Limited key bits and mismatched sizes")
+  {
+    std::vector<std::uint32_t> keys = {5, 1, 5, 0, 3};
+    std::vector<int> values = {0, 1, 2, 3, 4};
+    parallel_radix_sort_pairs(keys, values, 3);
+    REQUIRE_THAT(keys, Equals(std::vector<std::uint32_t> {0, 1, 3, 5, 5}));
+    REQUIRE_THAT(values, Equals(std::vector<int> {3, 1, 4, 0, 2}));
+
+    std::vector<int> short_values = {0};
+    REQUIRE_THROWS_AS(parallel_radix_sort_pairs(keys, short_values),
+                      std::invalid_argument);
+  }
+}
+
+TEST_CASE("Parallel For Chunks Tests", "[concurrent][parallel_for_chunks]")
+{
+  SECTION("Chunks cover the range exactly once")
+  {
+    std::vector<int> hits(100000, 0);
+    parallel_for_chunks(hits.size(),
+                        1024,
+                        [&hits](std::size_t begin, std::size_t end)
+                        {
+                          for (std::size_t i = begin; i < end; ++i) {
+                            ++hits[i];
+                          }
+                        });
+    REQUIRE(std::all_of(hits.begin(), hits.end(), [](int h) { return h == 1; }));
+  }
+
+  SECTION("Chunk ids index per-chunk buffers")
+  {
+    const std::size_t count = 100000;
+    const std::size_t num_chunks = parallel_chunk_count(count, 1024);
+    REQUIRE(num_chunks >= 1);
+    std::vector<std::size_t> sums(num_chunks, 0);
+    parallel_for_chunks(count,
+                        1024,
+                        [&sums](std::size_t chunk, std::size_t begin, std::size_t end)
+                        {
+                          for (std::size_t i = begin; i < end; ++i) {
+                            sums[chunk] += i;
+                          }
+                        });
+    REQUIRE(std::accumulate(sums.begin(), sums.end(), std::size_t(0))
+            == count * (count - 1) / 2);
+  }
+
+  SECTION("At or below the threshold runs as one chunk")
+  {
+    REQUIRE(parallel_chunk_count(1024, 1024) == 1);
+    REQUIRE(parallel_chunk_count(0, 0) == 1);
+    std::size_t calls = 0;
+    parallel_for_chunks(1024,
+                        1024,
+                        [&calls](std::size_t chunk, std::size_t begin, std::size_t end)
+                        {
+                          REQUIRE(chunk == 0);
+                          REQUIRE(begin == 0);
+                          REQUIRE(end == 1024);
+                          ++calls;
+                        });
+    REQUIRE(calls == 1);
+  }
+
+  SECTION("Disabled runs as one chunk on the calling thread")
+  {
+    REQUIRE(parallel_chunk_count(100000, 0, false) == 1);
+    REQUIRE(parallel_chunk_count(100000, 0, true) == parallel_chunk_count(100000, 0));
+    const auto caller = std::this_thread::get_id();
+    std::size_t calls = 0;
+    parallel_for_chunks(100000,
+                        0,
+                        false,
+                        [&calls, caller](std::size_t begin, std::size_t end)
+                        {
+                          REQUIRE(std::this_thread::get_id() == caller);
+                          REQUIRE(begin == 0);
+                          REQUIRE(end == 100000);
+                          ++calls;
+                        });
+    REQUIRE(calls == 1);
+  }
+}
@@ -0,0 +1,63 @@
+#include <cstddef>
+#include <future>
+#include <vector>
+
+#include "cpp-toolbox/container/concurrent_union_find.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+using toolbox::container::concurrent_union_find_t;
+
+TEST_CASE("ConcurrentUnionFind Single Thread", "[container][union_find]")
+{
+  concurrent_union_find_t sets(10);
+  REQUIRE(sets.size() == 10);
+  for (std::size_t i = 0; i < 10; ++i) {
+    REQUIRE(sets.find(i) == i);
+  }
+
+  REQUIRE(sets.unite(3, 7));
+  REQUIRE(sets.unite(7, 9));
+  REQUIRE_FALSE(sets.unite(9, 3));
+  REQUIRE(sets.same(3, 9));
+  REQUIRE_FALSE(sets.same(3, 4));
+
+  // 根总是集合中最小的元素 / The root is always the smallest element of a set
+  REQUIRE(sets.find(9) == 3);
+  REQUIRE(sets.unite(9, 1));
+  REQUIRE(sets.find(7) == 1);
+
+  sets.reset(4);
+  REQUIRE(sets.size() == 4);
+  REQUIRE(sets.find(3) == 3);
+}
+
+TEST_CASE("ConcurrentUnionFind Concurrent Unions", "[container][union_find]")
+{
+  // 多个线程交错合并同一组链，结果应为每个余数类一个集合 / Several threads unite
+  // interleaved chains; every residue class must end up as one set
+  constexpr std::size_t k_size = 100000;
+  constexpr std::size_t k_classes = 7;
+  constexpr std::size_t k_threads = 4;
+  concurrent_union_find_t sets(k_size);
+
+  std::vector<std::future<void>> futures;
+  for (std::size_t t = 0; t < k_threads; ++t) {
+    futures.push_back(std::async(std::launch::async,
+                                 [&sets, t]()
+                                 {
+                                   for (std::size_t i = t; i + k_classes < k_size;
+                                        i += k_threads)
+                                   {
+                                     sets.unite(i + k_classes, i);
+                                   }
+                                 }));
+  }
+  for (auto& future : futures) {
+    future.get();
+  }
+
+  for (std::size_t i = 0; i < k_size; ++i) {
+    REQUIRE(sets.find(i) == i % k_classes);
+  }
+}
@@ -371,6 +371,40 @@ TEST_CASE("Metric factory creates metrics correctly", "[metrics][factory]")
   {
     REQUIRE_THROWS_AS(create_metric<float>("unknown_metric"), std::invalid_argument);
   }
+
+  SECTION("Batch distances match single distances")
+  {
+    const std::size_t dim = 33;
+    const std::size_t count = 37;  // Not a multiple of the kernel tile
+    const std::size_t num_queries = 3;
+    const auto data = generate_random_histogram<float>(count * dim);
+    const auto queries = generate_random_histogram<float>(num_queries * dim);
+
+    for (const auto* name : {"l1", "l2", "linf", "cosine", "chi_squared", "hellinger"})
+    {
+      auto metric = create_metric<float>(name);
+
+      std::vector<float> batch(count);
+      metric->distance_batch(queries.data(), data.data(), count, dim, batch.data());
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        const float expected = metric->distance(queries.data(), data.data() + i * dim, dim);
+        REQUIRE_THAT(batch[i], WithinAbs(expected, 1e-4f) || WithinRel(expected, 1e-4f));
+      }
+
+      std::vector<float> matrix(num_queries * count);
+      metric->distance_matrix(queries.data(), num_queries, data.data(), count, dim, matrix.data());
+      for (std::size_t q = 0; q < num_queries; ++q)
+      {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+          const float expected =
+              metric->distance(queries.data() + q * dim, data.data() + i * dim, dim);
+          REQUIRE_THAT(matrix[q * count + i], WithinAbs(expected, 1e-4f) || WithinRel(expected, 1e-4f));
+        }
+      }
+    }
+  }
 }
 
 TEST_CASE("Metric properties are correct", "[metrics][traits]")
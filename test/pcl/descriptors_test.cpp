@@ -9,11 +9,17 @@
 #include <cpp-toolbox/pcl/descriptors/3dsc_extractor.hpp>
 #include <cpp-toolbox/pcl/descriptors/cvfh_extractor.hpp>
 #include <cpp-toolbox/pcl/descriptors/rops_extractor.hpp>
+#include <cpp-toolbox/pcl/features/harris3d_keypoints.hpp>
+#include <cpp-toolbox/pcl/features/iss_keypoints.hpp>
+#include <cpp-toolbox/pcl/features/keypoint_descriptor_extractor.hpp>
 #include <cpp-toolbox/pcl/knn/kdtree.hpp>
 #include <cpp-toolbox/pcl/knn/bfknn_parallel.hpp>
+#include <cpp-toolbox/pcl/knn/neighborhood_graph.hpp>
 #include <cpp-toolbox/io/formats/pcd.hpp>
 #include <cpp-toolbox/utils/random.hpp>
 
+#include <numeric>
+
 #include "test_data_dir.hpp"
 
 using namespace toolbox;
@@ -210,6 +216,287 @@ TEST_CASE("FPFH descriptor extractor", "[pcl][descriptors]")
   }
 }
 
+TEST_CASE("FPFH descriptor extractor with neighborhood graph", "[pcl][descriptors]")
+{
+  using data_type = float;
+  using fpfh_extractor = fpfh_extractor_t<data_type, kdtree_t<data_type>>;
+  using fpfh_signature = fpfh_signature_t<data_type>;
+
+  auto cloud = generate_sphere_cloud<data_type>(800, 1.0f);
+  kdtree_t<data_type> kdtree;
+  kdtree.set_input(cloud.points);
+
+  neighborhood_graph_t<data_type> graph;
+  REQUIRE(graph.build_radius(kdtree, cloud.points, 0.3f));
+
+  // 共享法向量，只比较邻居搜索 / Share normals so only the neighbor searches are compared
+  pca_norm_extractor_t<data_type, kdtree_t<data_type>> norm_extractor;
+  norm_extractor.set_input(cloud);
+  norm_extractor.set_knn(kdtree);
+  norm_extractor.set_num_neighbors(20);
+  auto normals = std::make_shared<types::point_cloud_t<data_type>>();
+  normals->points = norm_extractor.extract().normals;
+
+  auto run = [&](std::vector<std::size_t> keypoints, bool use_graph) {
+    fpfh_extractor extractor;
+    extractor.set_input(cloud);
+    extractor.set_normals(normals);
+    if (use_graph) {
+      extractor.set_neighborhood_graph(graph);
+    } else {
+      extractor.set_knn(kdtree);
+    }
+    extractor.set_search_radius(0.3f);
+    extractor.set_num_neighbors(40);
+    std::vector<fpfh_signature> descriptors;
+    extractor.compute(cloud, keypoints, descriptors);
+    return descriptors;
+  };
+
+  // 少量关键点走直接计算，大量关键点走缓存路径 / Few keypoints take the direct path,
+  // many take the cached path
+  std::vector<std::size_t> sparse = {3, 150, 420};
+  std::vector<std::size_t> dense(200);
+  std::iota(dense.begin(), dense.end(), 0);
+
+  for (const auto& keypoints : {sparse, dense}) {
+    auto expected = run(keypoints, false);
+    auto result = run(keypoints, true);
+    REQUIRE(result.size() == expected.size());
+    for (std::size_t i = 0; i < result.size(); ++i) {
+      for (std::size_t j = 0; j < result[i].histogram.size(); ++j) {
+        REQUIRE(result[i].histogram[j] == Catch::Approx(expected[i].histogram[j]).margin(1e-5));
+      }
+    }
+  }
+}
+
+TEST_CASE("FPFH batch computation", "[pcl][descriptors]")
+{
+  using data_type = float;
+  using fpfh_extractor = fpfh_extractor_t<data_type, kdtree_t<data_type>>;
+  using fpfh_signature = fpfh_signature_t<data_type>;
+
+  auto cloud = generate_sphere_cloud<data_type>(600, 1.0f);
+  kdtree_t<data_type> kdtree;
+  kdtree.set_input(cloud.points);
+
+  neighborhood_graph_t<data_type> graph;
+  REQUIRE(graph.build_radius(kdtree, cloud.points, 0.3f));
+
+  pca_norm_extractor_t<data_type, kdtree_t<data_type>> norm_extractor;
+  norm_extractor.set_input(cloud);
+  norm_extractor.set_knn(kdtree);
+  norm_extractor.set_num_neighbors(20);
+  auto normals = std::make_shared<types::point_cloud_t<data_type>>();
+  normals->points = norm_extractor.extract().normals;
+
+  std::vector<std::size_t> all_points(cloud.size());
+  std::iota(all_points.begin(), all_points.end(), 0);
+
+  fpfh_extractor reference;
+  reference.set_input(cloud);
+  reference.set_knn(kdtree);
+  reference.set_normals(normals);
+  reference.set_search_radius(0.25f);
+  reference.set_num_neighbors(30);
+  std::vector<fpfh_signature> expected;
+  reference.compute(cloud, all_points, expected);
+
+  SECTION("Matches the KNN path for every point, serial and parallel")
+  {
+    for (bool parallel : {false, true}) {
+      fpfh_extractor extractor;
+      extractor.set_search_radius(0.25f);
+      extractor.set_num_neighbors(30);
+      extractor.enable_parallel(parallel);
+      std::vector<fpfh_signature> descriptors;
+      REQUIRE(extractor.compute_batch(cloud, *normals, graph, all_points, descriptors));
+      REQUIRE(descriptors.size() == expected.size());
+      for (std::size_t i = 0; i < descriptors.size(); ++i) {
+        for (std::size_t j = 0; j < fpfh_signature::HISTOGRAM_SIZE; ++j) {
+          REQUIRE(descriptors[i].histogram[j]
+                  == Catch::Approx(expected[i].histogram[j]).margin(1e-5));
+        }
+      }
+    }
+  }
+
+  SECTION("Rejects normals, graphs and keypoints that do not fit the cloud")
+  {
+    fpfh_extractor extractor;
+    std::vector<fpfh_signature> descriptors;
+
+    types::point_cloud_t<data_type> short_normals;
+    short_normals.points.assign(normals->points.begin(), normals->points.end() - 1);
+    CHECK_FALSE(extractor.compute_batch(cloud, short_normals, graph, all_points, descriptors));
+
+    neighborhood_graph_t<data_type> empty_graph;
+    CHECK_FALSE(extractor.compute_batch(cloud, *normals, empty_graph, all_points, descriptors));
+
+    CHECK_FALSE(extractor.compute_batch(cloud, *normals, graph, {cloud.size()}, descriptors));
+    CHECK(descriptors.empty());
+  }
+}
+
+TEST_CASE("Fused keypoint and descriptor extraction", "[pcl][descriptors]")
+{
+  using data_type = float;
+  using fpfh_extractor = fpfh_extractor_t<data_type, kdtree_t<data_type>>;
+  using iss_extractor = iss_keypoint_extractor_t<data_type, kdtree_t<data_type>>;
+
+  auto cloud = generate_sphere_cloud<data_type>(800, 1.0f);
+  kdtree_t<data_type> kdtree;
+  kdtree.set_input(cloud.points);
+
+  SECTION("ISS and FPFH match the two separate stages")
+  {
+    iss_extractor iss;
+    iss.set_salient_radius(0.25f);
+    iss.set_non_maxima_radius(0.2f);
+    fpfh_extractor fpfh;
+    fpfh.set_search_radius(0.3f);
+    fpfh.set_num_neighbors(40);
+
+    keypoint_descriptor_extractor_t fused(iss, fpfh);
+    fused.set_search_radius(0.3f);
+    std::vector<std::size_t> keypoints;
+    std::vector<fpfh_signature_t<data_type>> descriptors;
+    REQUIRE(fused.extract(kdtree, cloud, keypoints, descriptors));
+    REQUIRE(!keypoints.empty());
+    REQUIRE(descriptors.size() == keypoints.size());
+    REQUIRE(fused.geometry_cache().size() == cloud.size());
+
+    // 分开运行：检测器用自己的KNN和半径，描述子重新做半径搜索 / Separate stages: the
+    // detector with its own KNN and radius, the descriptor searching the radius again
+    kdtree_t<data_type> detector_kdtree;
+    iss_extractor separate_iss;
+    separate_iss.set_input(cloud);
+    separate_iss.set_knn(detector_kdtree);
+    separate_iss.set_salient_radius(0.25f);
+    separate_iss.set_non_maxima_radius(0.2f);
+    REQUIRE(separate_iss.extract() == keypoints);
+
+    fpfh_extractor separate_fpfh;
+    separate_fpfh.set_input(cloud);
+    separate_fpfh.set_knn(kdtree);
+    separate_fpfh.set_search_radius(0.3f);
+    separate_fpfh.set_num_neighbors(40);
+    separate_fpfh.set_normals(fused.normals());
+    std::vector<fpfh_signature_t<data_type>> expected;
+    separate_fpfh.compute(cloud, keypoints, expected);
+    REQUIRE(expected.size() == descriptors.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+      for (std::size_t j = 0; j < expected[i].histogram.size(); ++j) {
+        REQUIRE(descriptors[i].histogram[j] == Catch::Approx(expected[i].histogram[j]).margin(1e-5));
+      }
+    }
+  }
+
+  SECTION("Harris3D and SHOT agree between serial and parallel runs")
+  {
+    auto run = [&](bool parallel) {
+      harris3d_keypoint_extractor_t<data_type, kdtree_t<data_type>> harris;
+      harris.set_threshold(0.0f);
+      harris.set_suppression_radius(0.2f);
+      shot_extractor_t<data_type, kdtree_t<data_type>> shot;
+      shot.set_search_radius(0.4f);
+
+      keypoint_descriptor_extractor_t fused(harris, shot);
+      fused.set_search_radius(0.4f);
+      fused.enable_parallel(parallel);
+      std::vector<std::size_t> keypoints;
+      std::vector<shot_signature_t<data_type>> descriptors;
+      REQUIRE(fused.extract(kdtree, cloud, keypoints, descriptors));
+      REQUIRE(descriptors.size() == keypoints.size());
+      return std::make_pair(keypoints, descriptors);
+    };
+
+    auto [serial_keypoints, serial_descriptors] = run(false);
+    auto [parallel_keypoints, parallel_descriptors] = run(true);
+    REQUIRE(!serial_keypoints.empty());
+    REQUIRE(parallel_keypoints == serial_keypoints);
+    for (std::size_t i = 0; i < serial_descriptors.size(); ++i) {
+      REQUIRE(parallel_descriptors[i].histogram == serial_descriptors[i].histogram);
+    }
+  }
+
+  SECTION("A detector radius beyond the shared radius is rejected")
+  {
+    iss_extractor iss;
+    iss.set_salient_radius(0.5f);
+    fpfh_extractor fpfh;
+    keypoint_descriptor_extractor_t fused(iss, fpfh);
+    fused.set_search_radius(0.3f);
+    std::vector<std::size_t> keypoints;
+    std::vector<fpfh_signature_t<data_type>> descriptors;
+    REQUIRE_FALSE(fused.extract(kdtree, cloud, keypoints, descriptors));
+    REQUIRE(keypoints.empty());
+  }
+
+  SECTION("Descriptor neighborhoods beyond the shared rows are rejected")
+  {
+    iss_extractor iss;
+    iss.set_salient_radius(0.25f);
+    fpfh_extractor fpfh;
+    fpfh.set_search_radius(0.5f);
+    fpfh.set_num_neighbors(40);
+    keypoint_descriptor_extractor_t fused(iss, fpfh);
+    fused.set_search_radius(0.3f);
+    std::vector<std::size_t> keypoints;
+    std::vector<fpfh_signature_t<data_type>> descriptors;
+    REQUIRE_FALSE(fused.extract(kdtree, cloud, keypoints, descriptors));
+    REQUIRE(keypoints.empty());
+
+    // 描述子半径合适但共享行被截断 / The descriptor radius fits but the shared rows
+    // are capped
+    fpfh.set_search_radius(0.3f);
+    fused.set_max_neighbors(20);
+    REQUIRE_FALSE(fused.extract(kdtree, cloud, keypoints, descriptors));
+    REQUIRE(keypoints.empty());
+
+    // 上限覆盖描述子时ISS仍需要完整的行 / ISS still needs full rows when the limit
+    // covers the descriptor
+    fused.set_max_neighbors(40);
+    REQUIRE_FALSE(fused.extract(kdtree, cloud, keypoints, descriptors));
+
+    fused.set_max_neighbors(0);
+    REQUIRE(fused.extract(kdtree, cloud, keypoints, descriptors));
+    REQUIRE(descriptors.size() == keypoints.size());
+  }
+
+  SECTION("A capped graph still serves geometry-cache detectors")
+  {
+    harris3d_keypoint_extractor_t<data_type, kdtree_t<data_type>> harris;
+    harris.set_threshold(0.0f);
+    harris.set_suppression_radius(0.2f);
+    shot_extractor_t<data_type, kdtree_t<data_type>> shot;
+    shot.set_search_radius(0.4f);
+    shot.set_num_neighbors(30);
+    keypoint_descriptor_extractor_t fused(harris, shot);
+    fused.set_search_radius(0.4f);
+    fused.set_max_neighbors(30);
+    std::vector<std::size_t> keypoints;
+    std::vector<shot_signature_t<data_type>> descriptors;
+    REQUIRE(fused.extract(kdtree, cloud, keypoints, descriptors));
+    REQUIRE(descriptors.size() == keypoints.size());
+
+    fused.set_max_neighbors(29);
+    REQUIRE_FALSE(fused.extract(kdtree, cloud, keypoints, descriptors));
+  }
+
+  SECTION("A missing search radius is rejected")
+  {
+    iss_extractor iss;
+    fpfh_extractor fpfh;
+    keypoint_descriptor_extractor_t fused(iss, fpfh);
+    std::vector<std::size_t> keypoints;
+    std::vector<fpfh_signature_t<data_type>> descriptors;
+    REQUIRE_FALSE(fused.extract(kdtree, cloud, keypoints, descriptors));
+    REQUIRE(keypoints.empty());
+  }
+}
+
 TEST_CASE("SHOT descriptor extractor", "[pcl][descriptors]")
 {
   using data_type = float;
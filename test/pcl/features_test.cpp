@@ -5,11 +5,14 @@
 #include <cpp-toolbox/pcl/knn/kdtree.hpp>
 #include <cpp-toolbox/pcl/knn/bfknn.hpp>
 #include <cpp-toolbox/pcl/knn/bfknn_parallel.hpp>
+#include <cpp-toolbox/pcl/knn/neighborhood_graph.hpp>
 #include <cpp-toolbox/utils/random.hpp>
 #include <cpp-toolbox/types/point_utils.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
+#include <random>
 #include <cmath>
 
 using namespace toolbox::pcl;
@@ -303,6 +306,270 @@ TEST_CASE("ISS Keypoint Extractor - Basic Functionality", "[pcl][features][iss]"
   }
 }
 
+TEST_CASE("ISS Keypoint Extractor - Neighborhood Graph", "[pcl][features][iss]")
+{
+  using data_type = float;
+  auto cloud = generate_test_cloud<data_type>(1500);
+  kdtree_t<data_type> kdtree;
+  kdtree.set_input(cloud.points);
+
+  auto configure = [](auto& extractor) {
+    extractor.set_salient_radius(2.0f);
+    extractor.set_non_maxima_radius(1.0f);
+    extractor.set_threshold21(0.9f);
+    extractor.set_threshold32(0.9f);
+  };
+
+  iss_keypoint_extractor_t<data_type, kdtree_t<data_type>> from_knn;
+  from_knn.set_input(cloud);
+  from_knn.set_knn(kdtree);
+  configure(from_knn);
+  auto expected = from_knn.extract();
+  REQUIRE_FALSE(expected.empty());
+
+  // 一张图同时服务显著性和非极大值抑制两个半径 / One graph serves both the saliency
+  // and the non-maxima radius
+  neighborhood_graph_t<data_type> graph;
+  REQUIRE(graph.build_radius(kdtree, cloud.points, 2.0f));
+
+  iss_keypoint_extractor_t<data_type, kdtree_t<data_type>> from_graph;
+  from_graph.set_input(cloud);
+  from_graph.set_neighborhood_graph(graph);
+  configure(from_graph);
+  from_graph.enable_parallel(true);
+  auto result = from_graph.extract();
+
+  REQUIRE(result == expected);
+}
+
+TEST_CASE("Local geometry cache shared by keypoint detectors", "[pcl][features][geometry_cache]")
+{
+  using data_type = float;
+  auto cloud = generate_corner_test_cloud<data_type>(1000);
+  kdtree_t<data_type> kdtree;
+  kdtree.set_input(cloud.points);
+
+  SECTION("Cache matches the batch PCA kernel")
+  {
+    local_geometry_cache_t<data_type> cache;
+    REQUIRE(cache.build_radius(kdtree, cloud, 1.0f));
+    REQUIRE(cache.size() == cloud.size());
+    REQUIRE(cache.radius() == 1.0f);
+
+    const batch_pca_t<data_type> pca(cloud.points);
+    for (std::size_t i = 0; i < cloud.size(); i += 97) {
+      std::vector<std::size_t> indices;
+      std::vector<data_type> distances;
+      kdtree.radius_neighbors(cloud.points[i], 1.0f, indices, distances);
+      REQUIRE(cache.num_neighbors(i) == indices.size());
+      REQUIRE(cache.neighbors(i).size == indices.size());
+
+      const auto expected = pca.compute(indices);
+      REQUIRE(cache[i].valid == expected.valid);
+      for (std::size_t k = 0; k < 3; ++k) {
+        REQUIRE_THAT(cache[i].eigenvalues[k],
+                     Catch::Matchers::WithinAbs(expected.eigenvalues[k], 1e-5f));
+      }
+
+      // 由特征分解重建的协方差应为半正定且迹等于特征值之和 / The rebuilt covariance is
+      // positive semi-definite and its trace is the eigenvalue sum
+      const auto covariance = cache.covariance(i);
+      const data_type trace = covariance.xx + covariance.yy + covariance.zz;
+      REQUIRE_THAT(trace,
+                   Catch::Matchers::WithinAbs(expected.eigenvalues[0] + expected.eigenvalues[1]
+                                                  + expected.eigenvalues[2],
+                                              1e-4f));
+    }
+  }
+
+  SECTION("Harris3D and SIFT3D reproduce their k-neighborhood results")
+  {
+    local_geometry_cache_t<data_type> cache;
+    REQUIRE(cache.build_knn(kdtree, cloud, 30));
+
+    harris3d_keypoint_extractor_t<data_type, kdtree_t<data_type>> harris;
+    harris.set_input(cloud);
+    harris.set_knn(kdtree);
+    harris.set_threshold(0.001f);
+    harris.set_num_neighbors(30);
+    const auto expected_harris = harris.extract();
+    REQUIRE_FALSE(expected_harris.empty());
+
+    harris3d_keypoint_extractor_t<data_type, kdtree_t<data_type>> cached_harris;
+    cached_harris.set_input(cloud);
+    cached_harris.set_geometry_cache(cache);
+    cached_harris.set_threshold(0.001f);
+    cached_harris.enable_parallel(true);
+    REQUIRE(cached_harris.extract() == expected_harris);
+
+    sift3d_keypoint_extractor_t<data_type, kdtree_t<data_type>> sift;
+    sift.set_input(cloud);
+    sift.set_knn(kdtree);
+    sift.set_contrast_threshold(0.005f);
+    sift.set_edge_threshold(15.0f);
+    sift.set_num_neighbors(30);
+    const auto expected_sift = sift.extract();
+    sift.set_geometry_cache(cache);
+    REQUIRE(sift.extract() == expected_sift);
+  }
+
+  SECTION("Curvature and ISS reuse one radius cache across thresholds")
+  {
+    local_geometry_cache_t<data_type> cache;
+    REQUIRE(cache.build_radius(kdtree, cloud, 1.0f));
+
+    curvature_keypoint_extractor_t<data_type, kdtree_t<data_type>> curvature;
+    curvature.set_input(cloud);
+    curvature.set_knn(kdtree);
+    curvature.set_search_radius(1.0f);
+    curvature.set_curvature_threshold(0.001f);
+    curvature.set_non_maxima_radius(0.5f);
+    const auto expected_curvature = curvature.extract();
+    REQUIRE_FALSE(expected_curvature.empty());
+
+    curvature_keypoint_extractor_t<data_type, kdtree_t<data_type>> cached_curvature;
+    cached_curvature.set_input(cloud);
+    cached_curvature.set_geometry_cache(cache);
+    cached_curvature.set_curvature_threshold(0.001f);
+    cached_curvature.set_non_maxima_radius(0.5f);
+    REQUIRE(cached_curvature.extract() == expected_curvature);
+
+    iss_keypoint_extractor_t<data_type, kdtree_t<data_type>> iss;
+    iss.set_input(cloud);
+    iss.set_geometry_cache(cache);
+    iss.set_non_maxima_radius(0.5f);
+    iss.set_threshold21(0.99f);
+    iss.set_threshold32(0.99f);
+    const auto loose = iss.extract();
+    REQUIRE_FALSE(loose.empty());
+    for (const auto idx : loose) {
+      REQUIRE(idx < cloud.size());
+      REQUIRE(cache.num_neighbors(idx) >= iss.get_min_neighbors());
+    }
+
+    // 收紧阈值后的结果应与直接由缓存特征值筛选并抑制的参考一致 / The tightened result must
+    // match a reference screened and suppressed straight from the cached eigenvalues
+    iss.set_threshold21(0.5f);
+    iss.set_threshold32(0.5f);
+    const auto strict = iss.extract();
+    REQUIRE_FALSE(strict.empty());
+    REQUIRE(strict.size() < loose.size());
+
+    std::vector<data_type> scores(cloud.size(), grid_nms_t<data_type>::k_no_score);
+    std::vector<std::uint8_t> candidates(cloud.size(), 0);
+    for (std::size_t i = 0; i < cloud.size(); ++i) {
+      const auto& pca = cache[i];
+      const double lambda1 = pca.eigenvalues[2];
+      const double lambda2 = pca.eigenvalues[1];
+      const double lambda3 = pca.eigenvalues[0];
+      if (!pca.valid || pca.num_points < iss.get_min_neighbors() || lambda1 < 1e-10
+          || lambda2 / lambda1 > 0.5 || (lambda2 > 1e-10 && lambda3 / lambda2 > 0.5))
+      {
+        continue;
+      }
+      scores[i] = pca.eigenvalues[0];
+      candidates[i] = pca.eigenvalues[0] > 0 ? 1 : 0;
+    }
+    grid_nms_t<data_type> nms(0.5f);
+    REQUIRE(strict == nms.suppress(cloud.points, scores, candidates));
+  }
+
+  SECTION("A cache built for another cloud is rejected")
+  {
+    auto other = generate_corner_test_cloud<data_type>(500);
+    kdtree_t<data_type> other_tree;
+    other_tree.set_input(other.points);
+    local_geometry_cache_t<data_type> cache;
+    REQUIRE(cache.build_knn(other_tree, other, 10));
+
+    harris3d_keypoint_extractor_t<data_type, kdtree_t<data_type>> harris;
+    harris.set_input(cloud);
+    harris.set_geometry_cache(cache);
+    REQUIRE(harris.extract().empty());
+
+    iss_keypoint_extractor_t<data_type, kdtree_t<data_type>> iss;
+    iss.set_input(cloud);
+    iss.set_geometry_cache(cache);
+    REQUIRE(iss.extract().empty());
+  }
+}
+
+TEST_CASE("Grid non-maximum suppression", "[pcl][features][grid_nms]")
+{
+  using data_type = float;
+  auto cloud = generate_test_cloud<data_type>(5000);
+  toolbox::utils::random_t rng;
+
+  std::vector<data_type> scores(cloud.size());
+  std::vector<std::uint8_t> candidates(cloud.size());
+  for (std::size_t i = 0; i < cloud.size(); ++i) {
+    scores[i] = rng.random<data_type>(0.0f, 1.0f);
+    candidates[i] = scores[i] > 0.3f ? 1 : 0;
+    // 每隔一段放一个不参与竞争的点 / Every so often a point does not compete
+    if (i % 7 == 0) {
+      scores[i] = grid_nms_t<data_type>::k_no_score;
+    }
+  }
+
+  auto brute_force = [&](data_type radius)
+  {
+    std::vector<std::size_t> kept;
+    for (std::size_t i = 0; i < cloud.size(); ++i) {
+      if (!candidates[i]) {
+        continue;
+      }
+      bool is_maximum = true;
+      for (std::size_t j = 0; j < cloud.size() && is_maximum; ++j) {
+        const auto dx = cloud.points[j].x - cloud.points[i].x;
+        const auto dy = cloud.points[j].y - cloud.points[i].y;
+        const auto dz = cloud.points[j].z - cloud.points[i].z;
+        is_maximum = j == i || !(scores[j] > scores[i])
+            || dx * dx + dy * dy + dz * dz > radius * radius;
+      }
+      if (is_maximum) {
+        kept.push_back(i);
+      }
+    }
+    return kept;
+  };
+
+  for (const data_type radius : {0.5f, 1.5f, 4.0f}) {
+    grid_nms_t<data_type> nms(radius);
+    const auto expected = brute_force(radius);
+    REQUIRE(nms.suppress(cloud.points, scores, candidates) == expected);
+    nms.enable_parallel(true);
+    REQUIRE(nms.suppress(cloud.points, scores, candidates) == expected);
+  }
+
+  SECTION("Local minima through negated scores")
+  {
+    std::vector<data_type> negated(scores);
+    for (auto& score : negated) {
+      score = score == grid_nms_t<data_type>::k_no_score ? score : -score;
+    }
+    grid_nms_t<data_type> nms(1.0f);
+    for (const auto idx : nms.suppress(cloud.points, negated, candidates)) {
+      REQUIRE(candidates[idx]);
+    }
+  }
+
+  SECTION("Degenerate input")
+  {
+    grid_nms_t<data_type> nms;
+    REQUIRE(nms.get_radius() == 0.0f);
+    const auto all = nms.suppress(cloud.points, scores, candidates);
+    REQUIRE(all.size()
+            == static_cast<std::size_t>(std::count(candidates.begin(), candidates.end(), 1)));
+
+    nms.set_radius(1.0f);
+    std::vector<data_type> short_scores(10, 1.0f);
+    REQUIRE(nms.suppress(cloud.points, short_scores, candidates).empty());
+
+    std::vector<point_t<data_type>> duplicates(3, point_t<data_type>(1, 2, 3));
+    REQUIRE(nms.suppress(duplicates, {1.0f, 3.0f, 2.0f}, {1, 1, 1}) == std::vector<std::size_t>{1});
+  }
+}
+
 TEST_CASE("Feature Extraction - Different KNN Algorithms", "[pcl][features][knn]")
 {
   using data_type = float;
@@ -686,6 +953,149 @@ TEST_CASE("SIFT3D Keypoint Extraction", "[pcl][features][sift3d]")
   }
 }
 
+TEST_CASE("SIFT3D voxel pyramid scale space", "[pcl][features][sift3d]")
+{
+  using data_type = float;
+  auto cloud = generate_test_cloud<data_type>(3000);
+
+  SECTION("Levels nest and keep the point mass")
+  {
+    voxel_pyramid_t<data_type> pyramid;
+    REQUIRE(pyramid.build(cloud.points, 0.5f, 4));
+    REQUIRE(pyramid.num_levels() == 4);
+
+    for (std::size_t l = 0; l < pyramid.num_levels(); ++l) {
+      const auto& level = pyramid.level(l);
+      REQUIRE_THAT(level.voxel_size, Catch::Matchers::WithinRel(0.5f * float(1U << l), 1e-6f));
+      double total = 0.0;
+      for (auto weight : level.weights) {
+        total += weight;
+      }
+      REQUIRE_THAT(total, Catch::Matchers::WithinAbs(double(cloud.size()), 1e-6));
+      REQUIRE(std::is_sorted(level.keys.begin(), level.keys.end()));
+      if (l > 0) {
+        REQUIRE(level.size() <= pyramid.level(l - 1).size());
+      }
+
+      // 每个体素的父体素坐标是它自己的坐标各轴右移一位 / Every voxel's parent has the
+      // voxel's own coordinates shifted right by one per axis
+      if (l + 1 < pyramid.num_levels()) {
+        const auto& above = pyramid.level(l + 1);
+        REQUIRE(level.parents.size() == level.size());
+        for (std::size_t v = 0; v < level.size(); ++v) {
+          REQUIRE(level.parents[v] < above.size());
+          std::uint64_t cell[3];
+          toolbox::pcl::detail::unpack_pyramid_key(level.keys[v], cell);
+          REQUIRE(above.keys[level.parents[v]]
+                  == toolbox::pcl::detail::pack_pyramid_key(
+                      cell[0] >> 1U, cell[1] >> 1U, cell[2] >> 1U));
+        }
+      } else {
+        REQUIRE(level.parents.empty());
+      }
+    }
+
+    // 常数插值回点仍为常数 / A constant interpolates back to the same constant
+    std::vector<data_type> values(pyramid.level(2).size(), 3.0f);
+    std::vector<data_type> per_point;
+    REQUIRE(pyramid.interpolate(2, values, cloud.points, per_point));
+    REQUIRE(per_point.size() == cloud.size());
+    for (auto value : per_point) {
+      REQUIRE_THAT(value, Catch::Matchers::WithinAbs(3.0f, 1e-4f));
+    }
+
+    values.pop_back();
+    REQUIRE_FALSE(pyramid.interpolate(2, values, cloud.points, per_point));
+    REQUIRE_FALSE(pyramid.build(cloud.points, 0.0f, 4));
+  }
+
+  SECTION("Serial and parallel pyramids agree")
+  {
+    voxel_pyramid_t<data_type> serial;
+    voxel_pyramid_t<data_type> parallel;
+    parallel.enable_parallel(true);
+    REQUIRE(serial.build(cloud.points, 0.2f, 3));
+    REQUIRE(parallel.build(cloud.points, 0.2f, 3));
+    for (std::size_t l = 0; l < 3; ++l) {
+      REQUIRE(serial.level(l).keys == parallel.level(l).keys);
+      REQUIRE(serial.level(l).weights == parallel.level(l).weights);
+    }
+  }
+
+  SECTION("Both scale space modes find valid keypoints")
+  {
+    using extractor_type = sift3d_keypoint_extractor_t<data_type, kdtree_t<data_type>>;
+    // 四个分离的高斯团，两种尺度空间都应在团上产生关键点
+    // Four separated Gaussian blobs, on which both scale spaces should find keypoints
+    point_cloud_t<data_type> blobs;
+    std::mt19937 engine(7);
+    std::normal_distribution<data_type> spread(0.0f, 0.4f);
+    for (const data_type cx : {-3.0f, 3.0f}) {
+      for (const data_type cy : {-3.0f, 3.0f}) {
+        for (int i = 0; i < 400; ++i) {
+          blobs.points.emplace_back(cx + spread(engine), cy + spread(engine), spread(engine));
+        }
+      }
+    }
+
+    std::vector<std::size_t> serial_keypoints;
+    std::vector<std::size_t> pyramid_keypoints;
+    for (auto mode : {extractor_type::scale_space_mode::voxel_pyramid,
+                      extractor_type::scale_space_mode::radius_search})
+    {
+      for (bool parallel : {false, true}) {
+        auto kdtree = kdtree_t<data_type>{};
+        extractor_type extractor;
+        extractor.set_input(blobs);
+        extractor.set_knn(kdtree);
+        extractor.set_base_scale(0.5f);
+        extractor.set_num_scales(4);
+        extractor.set_contrast_threshold(0.01f);
+        extractor.set_scale_space_mode(mode);
+        extractor.enable_parallel(parallel);
+        REQUIRE(extractor.get_scale_space_mode() == mode);
+
+        auto keypoints = extractor.extract();
+        for (auto idx : keypoints) {
+          REQUIRE(idx < blobs.size());
+        }
+        REQUIRE(std::is_sorted(keypoints.begin(), keypoints.end()));
+        if (!parallel) {
+          serial_keypoints = keypoints;
+        } else {
+          REQUIRE(keypoints == serial_keypoints);
+        }
+      }
+      if (mode == extractor_type::scale_space_mode::voxel_pyramid) {
+        pyramid_keypoints = serial_keypoints;
+      }
+    }
+
+    // 金字塔近似的是同一个尺度空间，多数关键点应落在半径模式关键点的两个基础尺度之内
+    // The pyramid approximates the same scale space, so most of its keypoints should lie
+    // within two base scales of a radius-mode keypoint
+    REQUIRE_FALSE(pyramid_keypoints.empty());
+    REQUIRE_FALSE(serial_keypoints.empty());
+    std::size_t matched = 0;
+    for (auto p : pyramid_keypoints) {
+      const auto& a = blobs.points[p];
+      for (auto r : serial_keypoints) {
+        const auto& b = blobs.points[r];
+        const float dx = a.x - b.x;
+        const float dy = a.y - b.y;
+        const float dz = a.z - b.z;
+        if (dx * dx + dy * dy + dz * dz <= 1.0f) {
+          ++matched;
+          break;
+        }
+      }
+    }
+    INFO("pyramid " << pyramid_keypoints.size() << ", radius " << serial_keypoints.size()
+                    << ", matched " << matched);
+    REQUIRE(matched * 2 >= pyramid_keypoints.size());
+  }
+}
+
 TEST_CASE("LOAM Feature Extractor", "[pcl][features][loam]")
 {
   using data_type = float;
@@ -789,6 +1199,132 @@ TEST_CASE("LOAM Feature Extractor", "[pcl][features][loam]")
   }
 }
 
+TEST_CASE("LOAM scan-line feature extraction", "[pcl][features][loam]")
+{
+  using data_type = float;
+  using extractor_type = loam_feature_extractor_t<data_type, kdtree_t<data_type>>;
+  constexpr double k_pi = 3.14159265358979323846;
+
+  // 16线扫描一个房间角落：墙x = 10和y = 10，地面在传感器下方1.7m /
+  // A 16-ring scan of a room corner: walls x = 10 and y = 10, ground 1.7 m below
+  point_cloud_t<data_type> scan;
+  std::vector<std::uint16_t> rings;
+  for (int beam = 0; beam < 16; ++beam) {
+    const double elevation = (-15.0 + 2.0 * beam) * k_pi / 180.0;
+    for (int step = 0; step < 720; ++step) {
+      const double azimuth = (-179.75 + 0.5 * step) * k_pi / 180.0;
+      const double dx = std::cos(elevation) * std::cos(azimuth);
+      const double dy = std::cos(elevation) * std::sin(azimuth);
+      const double dz = std::sin(elevation);
+      double t = 40.0;
+      if (dz < 0.0) {
+        t = std::min(t, -1.7 / dz);
+      }
+      if (dx > 0.0) {
+        t = std::min(t, 10.0 / dx);
+      }
+      if (dy > 0.0) {
+        t = std::min(t, 10.0 / dy);
+      }
+      if (t < 40.0) {
+        scan.points.emplace_back(static_cast<data_type>(t * dx),
+                                 static_cast<data_type>(t * dy),
+                                 static_cast<data_type>(t * dz));
+        rings.push_back(static_cast<std::uint16_t>(15 - beam));
+      }
+    }
+  }
+
+  auto configure = [](extractor_type& extractor)
+  {
+    extractor.set_edge_threshold(0.01f);
+    extractor.set_planar_threshold(0.005f);
+    extractor.set_curvature_threshold(0.0f);
+  };
+
+  extractor_type extractor;
+  configure(extractor);
+  REQUIRE(extractor.get_curvature_mode() == extractor_type::curvature_mode::knn);
+  extractor.set_input(scan);
+  // 不需要KNN / No KNN needed
+  REQUIRE(extractor.set_scan_rings(rings) == 16);
+  REQUIRE(extractor.get_curvature_mode() == extractor_type::curvature_mode::scan_line);
+  REQUIRE(extractor.get_num_sectors() == 6);
+  REQUIRE(extractor.get_max_edges_per_sector() == 2);
+  REQUIRE(extractor.get_max_planar_per_sector() == 4);
+  const auto result = extractor.extract_labeled_cloud();
+  REQUIRE(result.cloud.size() == scan.size());
+  REQUIRE(result.labels.size() == scan.size());
+
+  SECTION("Features follow the scene geometry")
+  {
+    const auto edges = extractor_type::extract_edge_indices(result.labels);
+    const auto planar = extractor_type::extract_planar_indices(result.labels);
+    REQUIRE(!edges.empty());
+    REQUIRE(edges.size() <= 16 * 6 * 2);
+    REQUIRE(planar.size() > 16 * 6);
+    REQUIRE(planar.size() <= 16 * 6 * 4);
+
+    // 角落可见的线上都有边缘点落在竖直角线上 / Every ring that sees the corner puts an
+    // edge on the vertical corner line
+    std::size_t corner_edges = 0;
+    for (const auto idx : edges) {
+      const auto& p = scan.points[idx];
+      corner_edges += (std::abs(p.x - 10.0f) < 0.5f && std::abs(p.y - 10.0f) < 0.5f) ? 1 : 0;
+    }
+    REQUIRE(corner_edges >= 8);
+    for (const auto idx : planar) {
+      const auto& p = scan.points[idx];
+      REQUIRE((std::abs(p.x - 10.0f) > 0.5f || std::abs(p.y - 10.0f) > 0.5f));
+    }
+
+    const auto feature_indices = extractor.extract();
+    REQUIRE(feature_indices.size() == edges.size() + planar.size());
+  }
+
+  SECTION("Inferred rings, shuffled input and parallel runs agree")
+  {
+    extractor_type inferred;
+    configure(inferred);
+    inferred.set_input(scan);
+    inferred.set_ring_layout(16, 16.0f, -16.0f);
+    REQUIRE(inferred.extract_labeled_cloud().labels == result.labels);
+
+    inferred.enable_parallel(true);
+    REQUIRE(inferred.extract_labeled_cloud().labels == result.labels);
+
+    // 打乱的点云按方位角重新排序 / Shuffled clouds are sorted back by azimuth
+    std::vector<std::size_t> permutation(scan.size());
+    for (std::size_t i = 0; i < permutation.size(); ++i) {
+      permutation[i] = (i * 7919) % permutation.size();
+    }
+    REQUIRE(scan.size() % 7919 != 0);
+    point_cloud_t<data_type> shuffled;
+    std::vector<std::uint16_t> shuffled_rings;
+    for (const auto idx : permutation) {
+      shuffled.points.push_back(scan.points[idx]);
+      shuffled_rings.push_back(rings[idx]);
+    }
+    extractor_type shuffled_extractor;
+    configure(shuffled_extractor);
+    shuffled_extractor.set_input(shuffled);
+    shuffled_extractor.set_scan_rings(shuffled_rings);
+    const auto shuffled_result = shuffled_extractor.extract_labeled_cloud();
+    for (std::size_t i = 0; i < permutation.size(); ++i) {
+      REQUIRE(shuffled_result.labels[i] == result.labels[permutation[i]]);
+    }
+  }
+
+  SECTION("Mismatched rings are rejected")
+  {
+    extractor_type bad;
+    bad.set_input(scan);
+    bad.set_scan_rings(std::vector<std::uint16_t>(10, 0));
+    REQUIRE(bad.extract_labeled_cloud().labels.empty());
+    REQUIRE(bad.extract().empty());
+  }
+}
+
 TEST_CASE("SUSAN Keypoint Extraction", "[pcl][features][susan]")
 {
   using data_type = float;
@@ -1,15 +1,38 @@
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <tuple>
 #include <vector>
 
 #include <catch2/catch_test_macros.hpp>
+#include <cpp-toolbox/pcl/filters/crop_box.hpp>
+#include <cpp-toolbox/pcl/filters/farthest_point_sampling.hpp>
+#include <cpp-toolbox/pcl/filters/frustum_filter.hpp>
+#include <cpp-toolbox/pcl/filters/ground_segmentation.hpp>
+#include <cpp-toolbox/pcl/filters/outlier_removal.hpp>
+#include <cpp-toolbox/pcl/filters/passthrough.hpp>
 #include <cpp-toolbox/pcl/filters/random_downsampling.hpp>
+#include <cpp-toolbox/pcl/filters/uniform_grid_subsampling.hpp>
 #include <cpp-toolbox/pcl/filters/voxel_grid_downsampling.hpp>
+#include <cpp-toolbox/pcl/filters/voxel_map.hpp>
 #include <cpp-toolbox/types/point.hpp>
 #include <cpp-toolbox/utils/random.hpp>
 
+using toolbox::pcl::crop_box_t;
+using toolbox::pcl::farthest_point_sampling_t;
+using toolbox::pcl::frustum_filter_t;
+using toolbox::pcl::ground_method_t;
+using toolbox::pcl::ground_segmentation_t;
+using toolbox::pcl::passthrough_field_t;
+using toolbox::pcl::passthrough_t;
+using toolbox::pcl::radius_outlier_removal_t;
+using toolbox::pcl::statistical_outlier_removal_t;
 using toolbox::pcl::random_downsampling_t;
+using toolbox::pcl::reservoir_sampler_t;
+using toolbox::pcl::uniform_grid_subsampling_t;
 using toolbox::pcl::voxel_grid_downsampling_t;
+using toolbox::pcl::voxel_map_t;
 using toolbox::types::point_cloud_t;
 using toolbox::types::point_t;
 
@@ -54,6 +77,188 @@ TEST_CASE("Random downsampling filter", "[pcl][filter][random]")
   REQUIRE(parallel_result.points == result.points);
 }
 
+TEST_CASE("Random downsampling modes", "[pcl][filter][random]")
+{
+  toolbox::utils::random_t::instance().seed(17);
+  point_cloud_t<float> cloud;
+  for (int i = 0; i < 200000; ++i) {
+    cloud.points.emplace_back(toolbox::utils::random_t::instance().random<float>(0.0f, 10.0f),
+                              toolbox::utils::random_t::instance().random<float>(0.0f, 10.0f),
+                              0.0f);
+  }
+
+  auto is_unique_sorted = [](const std::vector<std::size_t>& indices)
+  {
+    return std::adjacent_find(indices.begin(),
+                              indices.end(),
+                              [](std::size_t a, std::size_t b) { return a >= b; })
+        == indices.end();
+  };
+
+  SECTION("Uniform indices are deterministic across thread counts")
+  {
+    random_downsampling_t<float> filter(0.1F);
+    filter.set_seed(123);
+    filter.set_input(cloud);
+    const auto serial = filter.filter_indices();
+    REQUIRE(serial.size() == 20000);
+    REQUIRE(is_unique_sorted(serial));
+    REQUIRE(serial.back() < cloud.size());
+
+    filter.enable_parallel(true);
+    REQUIRE(filter.filter_indices() == serial);
+
+    // 高采样率走补集分支 / A high ratio takes the complement branch
+    random_downsampling_t<float> dense(0.9F);
+    dense.set_seed(123);
+    dense.set_input(cloud);
+    const auto dense_indices = dense.filter_indices();
+    REQUIRE(dense_indices.size() == 180000);
+    REQUIRE(is_unique_sorted(dense_indices));
+
+    // 前后两半的采样数应接近 / Both halves receive a similar share
+    const auto first_half = static_cast<std::size_t>(
+        std::count_if(serial.begin(), serial.end(), [](std::size_t idx) { return idx < 100000; }));
+    REQUIRE(first_half > 9000);
+    REQUIRE(first_half < 11000);
+
+    filter.set_seed(124);
+    REQUIRE(filter.filter_indices() != serial);
+  }
+
+  SECTION("Uniform block counts follow the hypergeometric distribution")
+  {
+    // 在前一半点中的采样数服从超几何分布，与分块方式无关 / The number of samples in
+    // the first half of the cloud is hypergeometric, whatever the blocking
+    point_cloud_t<float> large;
+    large.points.resize(131072);
+    random_downsampling_t<float> filter(0.999F);
+    filter.set_input(large);
+
+    const double population = 131072.0;
+    const double half = 65536.0;
+    double draws = 0.0;
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    std::size_t whole_first_half = 0;
+    constexpr int k_runs = 200;
+    for (int run = 0; run < k_runs; ++run) {
+      filter.set_seed(static_cast<std::uint64_t>(run));
+      const auto indices = filter.filter_indices();
+      draws = static_cast<double>(indices.size());
+      const auto first_half = static_cast<double>(std::count_if(
+          indices.begin(), indices.end(), [](std::size_t idx) { return idx < 65536; }));
+      sum += first_half;
+      sum_squares += first_half * first_half;
+      whole_first_half += first_half == half ? 1 : 0;
+    }
+
+    const double expected_mean = draws * half / population;
+    const double expected_sd = std::sqrt(draws * (half / population) * (1.0 - half / population)
+                                         * (population - draws) / (population - 1.0));
+    const double mean = sum / k_runs;
+    const double sd = std::sqrt(sum_squares / k_runs - mean * mean);
+    REQUIRE(std::abs(mean - expected_mean) < 4.0 * expected_sd / std::sqrt(k_runs));
+    REQUIRE(sd > 0.7 * expected_sd);
+    REQUIRE(sd < 1.3 * expected_sd);
+    REQUIRE(whole_first_half == 0);
+  }
+
+  SECTION("Stratified sampling skips non-finite points")
+  {
+    point_cloud_t<float> with_invalid = cloud;
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float inf = std::numeric_limits<float>::infinity();
+    for (std::size_t i = 0; i < with_invalid.size(); i += 100) {
+      with_invalid.points[i].x = (i % 200 == 0) ? nan : inf;
+    }
+    random_downsampling_t<float> filter(0.05F);
+    filter.set_mode(random_downsampling_t<float>::sampling_mode_t::stratified);
+    filter.set_stratum_size(1.0F);
+    filter.set_seed(5);
+    filter.set_input(with_invalid);
+    const auto indices = filter.filter_indices();
+    REQUIRE(indices.size() == 9900);
+    REQUIRE(is_unique_sorted(indices));
+    for (const auto idx : indices) {
+      REQUIRE(std::isfinite(with_invalid.points[idx].x));
+    }
+  }
+
+  SECTION("Stratified sampling spreads points across cells")
+  {
+    random_downsampling_t<float> filter(0.05F);
+    filter.set_mode(random_downsampling_t<float>::sampling_mode_t::stratified);
+    filter.set_stratum_size(1.0F);
+    filter.set_seed(5);
+    filter.set_input(cloud);
+    filter.enable_parallel(true);
+    const auto indices = filter.filter_indices();
+    REQUIRE(indices.size() == 10000);
+    REQUIRE(is_unique_sorted(indices));
+
+    // 每个1x1单元约有2000个点，应得到99到101个样本 / Every 1x1 cell holds about
+    // 2000 points and gets its proportional share of about 100 samples
+    std::vector<std::size_t> cell_points(100, 0);
+    std::vector<std::size_t> cell_samples(100, 0);
+    auto cell_of = [&cloud](std::size_t idx)
+    {
+      const auto cx = std::min(9, static_cast<int>(cloud.points[idx].x));
+      const auto cy = std::min(9, static_cast<int>(cloud.points[idx].y));
+      return static_cast<std::size_t>(cy * 10 + cx);
+    };
+    for (std::size_t i = 0; i < cloud.size(); ++i) {
+      ++cell_points[cell_of(i)];
+    }
+    for (const auto idx : indices) {
+      ++cell_samples[cell_of(idx)];
+    }
+    for (std::size_t c = 0; c < cell_points.size(); ++c) {
+      const double share = static_cast<double>(cell_points[c]) * 0.05;
+      REQUIRE(static_cast<double>(cell_samples[c]) >= std::floor(share) - 1.0);
+      REQUIRE(static_cast<double>(cell_samples[c]) <= std::ceil(share) + 1.0);
+    }
+
+    auto result = filter.filter();
+    REQUIRE(result.size() == indices.size());
+  }
+
+  SECTION("Reservoir sampling over chunks")
+  {
+    reservoir_sampler_t<float> reservoir(1000, 9);
+    point_cloud_t<float> chunk;
+    for (std::size_t offset = 0; offset < cloud.size(); offset += 7919) {
+      const std::size_t end = std::min(offset + 7919, cloud.size());
+      chunk.points.assign(cloud.points.begin() + static_cast<std::ptrdiff_t>(offset),
+                          cloud.points.begin() + static_cast<std::ptrdiff_t>(end));
+      reservoir.add(chunk);
+    }
+    REQUIRE(reservoir.seen() == cloud.size());
+    REQUIRE(reservoir.indices().size() == 1000);
+
+    auto sorted = reservoir.indices();
+    std::sort(sorted.begin(), sorted.end());
+    REQUIRE(is_unique_sorted(sorted));
+    // 样本应覆盖整个流，而不只是开头 / The sample covers the whole stream, not just
+    // its beginning
+    const auto late = static_cast<std::size_t>(
+        std::count_if(sorted.begin(), sorted.end(), [](std::size_t idx) { return idx >= 100000; }));
+    REQUIRE(late > 400);
+    REQUIRE(late < 600);
+
+    const auto sample = reservoir.sample();
+    for (std::size_t i = 0; i < sample.size(); ++i) {
+      REQUIRE(sample.points[i].x == cloud.points[reservoir.indices()[i]].x);
+    }
+
+    // 点数不足容量时保留全部 / Fewer points than the capacity are all kept
+    reservoir_sampler_t<float> small(500, 1);
+    chunk.points.assign(cloud.points.begin(), cloud.points.begin() + 100);
+    small.add(chunk);
+    REQUIRE(small.indices().size() == 100);
+  }
+}
+
 TEST_CASE("Voxel grid downsampling filter", "[pcl][filter][voxel]")
 {
   SECTION("Basic voxel grid test")
@@ -331,4 +536,716 @@ TEST_CASE("Voxel grid downsampling filter", "[pcl][filter][voxel]")
     // 所有点都应该能找到匹配
     REQUIRE(matched_points == serial_result.size());
   }
+
+  SECTION("Sort engine matches hash engine")
+  {
+    toolbox::utils::random_t::instance().seed(17);
+    point_cloud_t<float> cloud;
+    for (int i = 0; i < 50000; ++i) {
+      const float x = toolbox::utils::random_t::instance().random<float>(-20.0f, 20.0f);
+      const float y = toolbox::utils::random_t::instance().random<float>(-20.0f, 20.0f);
+      const float z = toolbox::utils::random_t::instance().random<float>(-3.0f, 3.0f);
+      cloud.points.emplace_back(x, y, z);
+      cloud.normals.emplace_back(0.0f, 0.0f, 1.0f);
+      cloud.colors.emplace_back(x, y, z);
+    }
+
+    voxel_grid_downsampling_t<float> filter(1.0f);
+    filter.set_input(cloud);
+    REQUIRE(filter.get_engine() == voxel_grid_downsampling_t<float>::engine_t::hash);
+    auto hash_result = filter.filter();
+
+    filter.set_engine(voxel_grid_downsampling_t<float>::engine_t::sort);
+    auto serial_sorted = filter.filter();
+    filter.enable_parallel(true);
+    auto parallel_sorted = filter.filter();
+
+    REQUIRE(serial_sorted.size() == hash_result.size());
+    REQUIRE(parallel_sorted.size() == hash_result.size());
+    REQUIRE(parallel_sorted.normals.size() == hash_result.size());
+    REQUIRE(parallel_sorted.colors.size() == hash_result.size());
+
+    // 排序引擎按键输出，比较前统一按坐标排序 / The sort engine emits voxels by
+    // key, so order both results by coordinates before comparing
+    auto by_coordinates = [](const point_t<float>& a, const point_t<float>& b)
+    { return std::tie(a.z, a.y, a.x) < std::tie(b.z, b.y, b.x); };
+    std::sort(hash_result.points.begin(), hash_result.points.end(), by_coordinates);
+    std::sort(parallel_sorted.points.begin(), parallel_sorted.points.end(), by_coordinates);
+    for (std::size_t i = 0; i < hash_result.size(); ++i) {
+      REQUIRE(std::fabs(hash_result.points[i].x - parallel_sorted.points[i].x) < 1e-4f);
+      REQUIRE(std::fabs(hash_result.points[i].y - parallel_sorted.points[i].y) < 1e-4f);
+      REQUIRE(std::fabs(hash_result.points[i].z - parallel_sorted.points[i].z) < 1e-4f);
+    }
+
+    for (std::size_t i = 0; i < serial_sorted.size(); ++i) {
+      REQUIRE(serial_sorted.points[i].x == serial_sorted.colors[i].x);
+      REQUIRE(serial_sorted.normals[i].z == 1.0f);
+    }
+  }
+}
+
+TEST_CASE("Farthest point sampling filter", "[pcl][filter][fps]")
+{
+  SECTION("Picks the farthest points on a line")
+  {
+    point_cloud_t<float> cloud;
+    for (int i = 0; i < 10; ++i) {
+      cloud.points.emplace_back(static_cast<float>(i), 0.0f, 0.0f);
+    }
+
+    farthest_point_sampling_t<float> filter(3);
+    filter.set_input(cloud);
+    auto result = filter.filter();
+
+    REQUIRE(result.size() == 3);
+    // 0之后最远的是9，之后4和5距离相同，取较小的索引 / After 0 the farthest is 9, then 4
+    // and 5 tie and the smaller index wins
+    REQUIRE(filter.sampled_indices() == std::vector<std::size_t> {0, 9, 4});
+    REQUIRE(result.points[1].x == 9.0f);
+
+    filter.set_start_index(9);
+    REQUIRE(filter.filter_indices() == std::vector<std::size_t> {9, 0, 4});
+  }
+
+  SECTION("More samples than points and empty input")
+  {
+    point_cloud_t<float> cloud;
+    cloud.points.emplace_back(0.0f, 0.0f, 0.0f);
+    cloud.points.emplace_back(1.0f, 0.0f, 0.0f);
+
+    farthest_point_sampling_t<float> filter(10);
+    filter.set_input(cloud);
+    REQUIRE(filter.filter().size() == 2);
+
+    point_cloud_t<float> empty_cloud;
+    filter.set_input(empty_cloud);
+    REQUIRE(filter.filter().empty());
+    REQUIRE(filter.sampled_indices().empty());
+  }
+
+  SECTION("Parallel and grid modes match the exact serial result")
+  {
+    toolbox::utils::random_t::instance().seed(7);
+    point_cloud_t<float> cloud;
+    for (int i = 0; i < 50000; ++i) {
+      cloud.points.emplace_back(toolbox::utils::random_t::instance().random<float>(-50.0f, 50.0f),
+                                toolbox::utils::random_t::instance().random<float>(-50.0f, 50.0f),
+                                toolbox::utils::random_t::instance().random<float>(-5.0f, 5.0f));
+    }
+
+    farthest_point_sampling_t<float> filter(200);
+    filter.set_input(cloud);
+    const auto serial = filter.filter_indices();
+    REQUIRE(serial.size() == 200);
+
+    filter.enable_parallel(true);
+    REQUIRE(filter.filter_indices() == serial);
+
+    filter.enable_grid_acceleration(true);
+    REQUIRE(filter.filter_indices() == serial);
+
+    filter.enable_grid_acceleration(true, 2.5f);
+    REQUIRE(filter.filter_indices() == serial);
+  }
+
+  SECTION("Grid mode on a planar cloud keeps normals")
+  {
+    toolbox::utils::random_t::instance().seed(11);
+    point_cloud_t<float> cloud;
+    for (int i = 0; i < 10000; ++i) {
+      cloud.points.emplace_back(toolbox::utils::random_t::instance().random<float>(0.0f, 10.0f),
+                                toolbox::utils::random_t::instance().random<float>(0.0f, 10.0f),
+                                0.0f);
+      cloud.normals.emplace_back(0.0f, 0.0f, 1.0f);
+    }
+
+    farthest_point_sampling_t<float> filter(50);
+    filter.set_input(cloud);
+    const auto exact = filter.filter_indices();
+    filter.enable_grid_acceleration(true);
+    auto result = filter.filter();
+
+    REQUIRE(filter.sampled_indices() == exact);
+    REQUIRE(result.normals.size() == 50);
+  }
+}
+
+TEST_CASE("Uniform grid subsampling filter", "[pcl][filter][uniform_grid]")
+{
+  SECTION("Keeps the point nearest each cell center")
+  {
+    point_cloud_t<float> cloud;
+    // 单元[0,1)^3，中心(0.5,0.5,0.5) / Cell [0,1)^3, center (0.5,0.5,0.5)
+    cloud.points.emplace_back(0.1f, 0.1f, 0.1f);
+    cloud.points.emplace_back(0.45f, 0.55f, 0.5f);
+    cloud.points.emplace_back(0.9f, 0.9f, 0.9f);
+    // 单元[1,2)x[0,1)x[0,1) / Cell [1,2)x[0,1)x[0,1)
+    cloud.points.emplace_back(1.9f, 0.1f, 0.1f);
+    cloud.points.emplace_back(1.6f, 0.4f, 0.5f);
+    // 负坐标单元 / Cell with negative coordinates
+    cloud.points.emplace_back(-0.2f, -0.7f, 0.5f);
+    cloud.normals.resize(cloud.points.size());
+    for (std::size_t i = 0; i < cloud.normals.size(); ++i) {
+      cloud.normals[i] = point_t<float>(static_cast<float>(i), 0.0f, 0.0f);
+    }
+
+    uniform_grid_subsampling_t<float> filter(1.0f);
+    filter.set_input(cloud);
+    auto indices = filter.filter_indices();
+    std::sort(indices.begin(), indices.end());
+    REQUIRE(indices == std::vector<std::size_t> {1, 4, 5});
+
+    auto result = filter.filter();
+    REQUIRE(result.size() == 3);
+    REQUIRE(result.normals.size() == 3);
+    for (std::size_t i = 0; i < result.size(); ++i) {
+      // 输出的是原始点，法线随点保留 / Outputs are original points with their normals
+      const auto idx = static_cast<std::size_t>(result.normals[i].x);
+      REQUIRE(result.points[i].x == cloud.points[idx].x);
+      REQUIRE(result.points[i].y == cloud.points[idx].y);
+    }
+  }
+
+  SECTION("Empty input and invalid grid size")
+  {
+    point_cloud_t<float> cloud;
+    uniform_grid_subsampling_t<float> filter(0.5f);
+    filter.set_input(cloud);
+    REQUIRE(filter.filter().empty());
+
+    cloud.points.emplace_back(0.0f, 0.0f, 0.0f);
+    uniform_grid_subsampling_t<float> invalid(0.0f);
+    invalid.set_input(cloud);
+    REQUIRE(invalid.filter().empty());
+  }
+
+  SECTION("Serial and parallel results match")
+  {
+    toolbox::utils::random_t::instance().seed(21);
+    point_cloud_t<float> cloud;
+    for (int i = 0; i < 100000; ++i) {
+      cloud.points.emplace_back(toolbox::utils::random_t::instance().random<float>(-20.0f, 20.0f),
+                                toolbox::utils::random_t::instance().random<float>(-20.0f, 20.0f),
+                                toolbox::utils::random_t::instance().random<float>(-2.0f, 2.0f));
+    }
+
+    uniform_grid_subsampling_t<float> filter(0.5f);
+    filter.set_input(cloud);
+    const auto serial = filter.filter_indices();
+    filter.enable_parallel(true);
+    const auto parallel = filter.filter_indices();
+    REQUIRE(parallel == serial);
+
+    // 每个非空单元恰好一个点 / Exactly one point per occupied cell
+    std::vector<std::tuple<int, int, int>> cells;
+    for (const auto& p : cloud.points) {
+      cells.emplace_back(static_cast<int>(std::floor(p.x / 0.5f)),
+                         static_cast<int>(std::floor(p.y / 0.5f)),
+                         static_cast<int>(std::floor(p.z / 0.5f)));
+    }
+    std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+    REQUIRE(serial.size() == cells.size());
+  }
+}
+
+TEST_CASE("Incremental voxel map", "[pcl][filter][voxel_map]")
+{
+  auto random_cloud = [](std::size_t count, float extent)
+  {
+    point_cloud_t<float> cloud;
+    for (std::size_t i = 0; i < count; ++i) {
+      cloud.points.emplace_back(toolbox::utils::random_t::instance().random<float>(-extent, extent),
+                                toolbox::utils::random_t::instance().random<float>(-extent, extent),
+                                toolbox::utils::random_t::instance().random<float>(-extent, extent));
+    }
+    return cloud;
+  };
+  auto by_coordinates = [](const point_t<float>& a, const point_t<float>& b)
+  { return std::tie(a.z, a.y, a.x) < std::tie(b.z, b.y, b.x); };
+
+  SECTION("Accumulating two halves matches voxel grid downsampling")
+  {
+    toolbox::utils::random_t::instance().seed(31);
+    auto cloud = random_cloud(20000, 10.0f);
+    point_cloud_t<float> first;
+    point_cloud_t<float> second;
+    first.points.assign(cloud.points.begin(), cloud.points.begin() + 8000);
+    second.points.assign(cloud.points.begin() + 8000, cloud.points.end());
+
+    voxel_map_t<float> map(1.0f);
+    map.enable_parallel(true);
+    REQUIRE(map.insert(first) == 8000);
+    REQUIRE(map.insert(second) == 12000);
+    auto accumulated = map.extract();
+
+    voxel_grid_downsampling_t<float> filter(1.0f);
+    filter.set_input(cloud);
+    auto expected = filter.filter();
+
+    REQUIRE(accumulated.size() == expected.size());
+    std::sort(accumulated.points.begin(), accumulated.points.end(), by_coordinates);
+    std::sort(expected.points.begin(), expected.points.end(), by_coordinates);
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+      REQUIRE(std::fabs(accumulated.points[i].x - expected.points[i].x) < 1e-4f);
+      REQUIRE(std::fabs(accumulated.points[i].y - expected.points[i].y) < 1e-4f);
+      REQUIRE(std::fabs(accumulated.points[i].z - expected.points[i].z) < 1e-4f);
+    }
+  }
+
+  SECTION("Points per voxel are capped")
+  {
+    point_cloud_t<float> cloud;
+    for (int i = 0; i < 10; ++i) {
+      cloud.points.emplace_back(0.1f * static_cast<float>(i), 0.5f, 0.5f);
+    }
+
+    voxel_map_t<float> map(1.0f, 4);
+    REQUIRE(map.insert(cloud) == 4);
+    REQUIRE(map.insert(cloud) == 0);
+    REQUIRE(map.size() == 1);
+    REQUIRE(map.voxel_data().counts[0] == 4);
+
+    // 保留输入中最先到达的点 / The earliest points in input order are kept
+    auto result = map.extract();
+    REQUIRE(std::fabs(result.points[0].x - 0.15f) < 1e-5f);
+  }
+
+  SECTION("Transformed and batched insertion")
+  {
+    point_cloud_t<float> scan;
+    scan.points.emplace_back(0.5f, 0.5f, 0.5f);
+    scan.normals.emplace_back(1.0f, 0.0f, 0.0f);
+
+    // 绕z轴旋转90度并平移 / Rotate 90 degrees about z and translate
+    Eigen::Matrix4f pose = Eigen::Matrix4f::Identity();
+    pose(0, 0) = 0.0f;
+    pose(0, 1) = -1.0f;
+    pose(1, 0) = 1.0f;
+    pose(1, 1) = 0.0f;
+    pose(0, 3) = 10.0f;
+
+    voxel_map_t<float> map(1.0f);
+    map.insert(scan, pose);
+    auto result = map.extract();
+    REQUIRE(result.size() == 1);
+    REQUIRE(std::fabs(result.points[0].x - 9.5f) < 1e-5f);
+    REQUIRE(std::fabs(result.points[0].y - 0.5f) < 1e-5f);
+    REQUIRE(std::fabs(result.normals[0].y - 1.0f) < 1e-5f);
+
+    toolbox::utils::random_t::instance().seed(37);
+    std::vector<point_cloud_t<float>> scans = {random_cloud(3000, 5.0f),
+                                               random_cloud(3000, 5.0f)};
+    std::vector<Eigen::Matrix4f> poses = {Eigen::Matrix4f::Identity(), pose};
+
+    voxel_map_t<float> batched(0.5f);
+    REQUIRE(batched.insert(scans, poses) == 6000);
+    voxel_map_t<float> sequential(0.5f);
+    sequential.insert(scans[0], poses[0]);
+    sequential.insert(scans[1], poses[1]);
+    REQUIRE(batched.size() == sequential.size());
+
+    std::vector<std::size_t> batched_counts(batched.voxel_data().counts);
+    std::vector<std::size_t> sequential_counts(sequential.voxel_data().counts);
+    std::sort(batched_counts.begin(), batched_counts.end());
+    std::sort(sequential_counts.begin(), sequential_counts.end());
+    REQUIRE(batched_counts == sequential_counts);
+
+    REQUIRE(batched.insert(scans, {pose}) == 0);
+  }
+
+  SECTION("Voxels outside a radius are evicted")
+  {
+    toolbox::utils::random_t::instance().seed(41);
+    auto near = random_cloud(2000, 2.0f);
+    auto far = random_cloud(2000, 2.0f);
+    for (auto& p : far.points) {
+      p.x += 100.0f;
+    }
+
+    voxel_map_t<float> map(0.5f);
+    map.insert(near);
+    const std::size_t near_voxels = map.size();
+    map.insert(far);
+    REQUIRE(map.size() > near_voxels);
+
+    const std::size_t removed = map.remove_outside(point_t<float>(0.0f, 0.0f, 0.0f), 10.0f);
+    REQUIRE(map.size() == near_voxels);
+    REQUIRE(removed > 0);
+
+    // 删除后键和体素仍一致，再次插入只会累加 / Keys and voxels stay consistent after
+    // eviction, inserting again only accumulates
+    map.insert(near);
+    REQUIRE(map.size() == near_voxels);
+    for (const auto count : map.voxel_data().counts) {
+      REQUIRE(count % 2 == 0);
+    }
+
+    map.clear();
+    REQUIRE(map.empty());
+    REQUIRE(map.extract().empty());
+  }
+}
+
+TEST_CASE("Outlier removal filters", "[pcl][filter][outlier]")
+{
+  // 单位立方体内的稠密点加上远处的孤立点 / Dense points in a unit cube plus isolated
+  // points far away
+  toolbox::utils::random_t::instance().seed(53);
+  point_cloud_t<float> cloud;
+  for (int i = 0; i < 3000; ++i) {
+    cloud.points.emplace_back(toolbox::utils::random_t::instance().random<float>(0.0f, 1.0f),
+                              toolbox::utils::random_t::instance().random<float>(0.0f, 1.0f),
+                              toolbox::utils::random_t::instance().random<float>(0.0f, 1.0f));
+    cloud.colors.emplace_back(1.0f, 0.0f, 0.0f);
+  }
+  std::vector<std::size_t> outliers;
+  for (int i = 0; i < 10; ++i) {
+    outliers.push_back(cloud.size());
+    cloud.points.emplace_back(20.0f + 7.0f * static_cast<float>(i), -30.0f, 10.0f);
+    cloud.colors.emplace_back(0.0f, 1.0f, 0.0f);
+  }
+
+  auto contains = [](const std::vector<std::size_t>& indices, std::size_t value)
+  { return std::find(indices.begin(), indices.end(), value) != indices.end(); };
+
+  SECTION("Statistical outlier removal")
+  {
+    statistical_outlier_removal_t<float> filter(10, 2.0f);
+    filter.set_input(cloud);
+    const auto serial = filter.filter_indices();
+    REQUIRE(filter.get_threshold() > 0.0f);
+    for (const auto idx : outliers) {
+      REQUIRE_FALSE(contains(serial, idx));
+    }
+    REQUIRE(serial.size() > 2900);
+    REQUIRE(std::is_sorted(serial.begin(), serial.end()));
+
+    filter.enable_parallel(true);
+    REQUIRE(filter.filter_indices() == serial);
+
+    auto result = filter.filter();
+    REQUIRE(result.size() == serial.size());
+    REQUIRE(result.colors.size() == serial.size());
+    for (const auto& color : result.colors) {
+      REQUIRE(color.x == 1.0f);
+    }
+
+    // 反转后得到其余的点 / Negative mode returns the remaining points
+    filter.set_negative(true);
+    const auto removed = filter.filter_indices();
+    REQUIRE(removed.size() + serial.size() == cloud.size());
+    for (const auto idx : outliers) {
+      REQUIRE(contains(removed, idx));
+    }
+  }
+
+  SECTION("Radius outlier removal matches a brute-force count")
+  {
+    const float radius = 0.15f;
+    const std::size_t min_neighbors = 6;
+
+    std::vector<std::size_t> expected;
+    for (std::size_t i = 0; i < cloud.size(); ++i) {
+      std::size_t neighbors = 0;
+      for (std::size_t j = 0; j < cloud.size(); ++j) {
+        const float dx = cloud.points[i].x - cloud.points[j].x;
+        const float dy = cloud.points[i].y - cloud.points[j].y;
+        const float dz = cloud.points[i].z - cloud.points[j].z;
+        if (j != i && std::sqrt(dx * dx + dy * dy + dz * dz) <= radius) {
+          ++neighbors;
+        }
+      }
+      if (neighbors >= min_neighbors) {
+        expected.push_back(i);
+      }
+    }
+
+    radius_outlier_removal_t<float> filter(radius, min_neighbors);
+    filter.set_input(cloud);
+    filter.enable_parallel(true);
+    const auto kept = filter.filter_indices();
+    REQUIRE(kept == expected);
+    for (const auto idx : outliers) {
+      REQUIRE_FALSE(contains(kept, idx));
+    }
+
+    filter.set_negative(true);
+    REQUIRE(filter.filter().size() == cloud.size() - kept.size());
+  }
+
+  SECTION("Degenerate inputs")
+  {
+    point_cloud_t<float> tiny;
+    tiny.points.emplace_back(0.0f, 0.0f, 0.0f);
+    tiny.points.emplace_back(0.1f, 0.0f, 0.0f);
+
+    radius_outlier_removal_t<float> radius_filter(1.0f, 5);
+    radius_filter.set_input(tiny);
+    REQUIRE(radius_filter.filter().empty());
+
+    statistical_outlier_removal_t<float> statistical_filter(0, 1.0f);
+    statistical_filter.set_input(tiny);
+    REQUIRE(statistical_filter.filter().empty());
+
+    point_cloud_t<float> empty_cloud;
+    statistical_filter.set_num_neighbors(8);
+    statistical_filter.set_input(empty_cloud);
+    REQUIRE(statistical_filter.filter().empty());
+  }
+}
+
+TEST_CASE("Crop box, passthrough and frustum filters", "[pcl][filter][crop]")
+{
+  // 足够大以走并行压缩路径 / Large enough to take the parallel compaction path
+  toolbox::utils::random_t::instance().seed(61);
+  point_cloud_t<float> cloud;
+  for (int i = 0; i < 40000; ++i) {
+    cloud.points.emplace_back(toolbox::utils::random_t::instance().random<float>(-10.0f, 10.0f),
+                              toolbox::utils::random_t::instance().random<float>(-10.0f, 10.0f),
+                              toolbox::utils::random_t::instance().random<float>(-10.0f, 10.0f));
+    cloud.colors.emplace_back(toolbox::utils::random_t::instance().random<float>(0.0f, 1.0f),
+                              0.5f,
+                              0.5f);
+  }
+
+  auto brute_force = [&cloud](auto inside)
+  {
+    std::vector<std::size_t> expected;
+    for (std::size_t i = 0; i < cloud.size(); ++i) {
+      if (inside(cloud.points[i], cloud.colors[i])) {
+        expected.push_back(i);
+      }
+    }
+    return expected;
+  };
+
+  SECTION("Oriented crop box")
+  {
+    // 盒子绕z轴旋转90度并平移 / Box rotated 90 degrees about z and translated
+    Eigen::Matrix4f pose = Eigen::Matrix4f::Identity();
+    pose(0, 0) = 0.0f;
+    pose(0, 1) = -1.0f;
+    pose(1, 0) = 1.0f;
+    pose(1, 1) = 0.0f;
+    pose(0, 3) = 2.0f;
+    pose(2, 3) = -1.0f;
+
+    crop_box_t<float> crop(point_t<float>(-4.0f, -1.0f, -2.0f), point_t<float>(4.0f, 1.0f, 2.0f));
+    crop.set_transform(pose);
+    crop.set_input(cloud);
+    const auto serial = crop.filter_indices();
+
+    // 盒子坐标 (bx, by, bz) = (y, -(x - 2), z + 1) / Box coordinates
+    const auto expected = brute_force(
+        [](const point_t<float>& p, const point_t<float>& /*color*/)
+        {
+          const float bx = p.y;
+          const float by = -(p.x - 2.0f);
+          const float bz = p.z + 1.0f;
+          return bx >= -4.0f && bx <= 4.0f && by >= -1.0f && by <= 1.0f && bz >= -2.0f
+              && bz <= 2.0f;
+        });
+    REQUIRE_FALSE(expected.empty());
+    REQUIRE(serial == expected);
+
+    crop.enable_parallel(true);
+    REQUIRE(crop.filter_indices() == serial);
+    auto result = crop.filter();
+    REQUIRE(result.size() == serial.size());
+    REQUIRE(result.colors.size() == serial.size());
+
+    crop.set_negative(true);
+    REQUIRE(crop.filter_indices().size() == cloud.size() - serial.size());
+  }
+
+  SECTION("Passthrough on several fields")
+  {
+    passthrough_t<float> pass(passthrough_field_t::z, -1.0f, 3.0f);
+    pass.set_range(passthrough_field_t::x, 0.0f, 10.0f);
+    pass.set_range(passthrough_field_t::r, 0.25f, 0.75f);
+    // 同一字段再次设置会替换 / Setting the same field again replaces it
+    pass.set_range(passthrough_field_t::z, -2.0f, 2.0f);
+    REQUIRE(pass.get_ranges().size() == 3);
+    pass.set_input(cloud);
+    pass.enable_parallel(true);
+
+    const auto expected = brute_force(
+        [](const point_t<float>& p, const point_t<float>& color)
+        {
+          return p.z >= -2.0f && p.z <= 2.0f && p.x >= 0.0f && p.x <= 10.0f
+              && color.x >= 0.25f && color.x <= 0.75f;
+        });
+    REQUIRE_FALSE(expected.empty());
+    REQUIRE(pass.filter_indices() == expected);
+
+    // 缺少法线时请求法线字段会失败 / Asking for normals fails without them
+    pass.set_range(passthrough_field_t::normal_z, 0.0f, 1.0f);
+    REQUIRE(pass.filter_indices().empty());
+
+    pass.clear_ranges();
+    REQUIRE(pass.filter_indices().size() == cloud.size());
+  }
+
+  SECTION("Camera frustum")
+  {
+    // 相机位于(1, 0, 0)，朝向+y / Camera at (1, 0, 0) looking along +y
+    Eigen::Matrix4f pose = Eigen::Matrix4f::Identity();
+    pose(0, 0) = 0.0f;
+    pose(0, 1) = -1.0f;
+    pose(1, 0) = 1.0f;
+    pose(1, 1) = 0.0f;
+    pose(0, 3) = 1.0f;
+
+    frustum_filter_t<float> frustum;
+    frustum.set_camera_pose(pose);
+    frustum.set_horizontal_fov(90.0f);
+    frustum.set_vertical_fov(60.0f);
+    frustum.set_near_plane(1.0f);
+    frustum.set_far_plane(8.0f);
+    frustum.set_input(cloud);
+    frustum.enable_parallel(true);
+
+    const float tan_v = std::tan(30.0f * 3.14159265f / 180.0f);
+    const auto expected = brute_force(
+        [tan_v](const point_t<float>& p, const point_t<float>& /*color*/)
+        {
+          // 相机坐标 (cx, cy, cz) = (y, 1 - x, z) / Camera coordinates
+          const float cx = p.y;
+          const float cy = 1.0f - p.x;
+          const float cz = p.z;
+          return cx >= 1.0f && cx <= 8.0f && std::abs(cy) <= cx
+              && std::abs(cz) <= cx * tan_v;
+        });
+    const auto visible = frustum.filter_indices();
+    // 只允许视锥边界上的舍入差异 / Only rounding differences on the frustum boundary
+    // are allowed
+    REQUIRE_FALSE(expected.empty());
+    REQUIRE(visible.size() + 5 >= expected.size());
+    REQUIRE(visible.size() <= expected.size() + 5);
+    for (const auto idx : visible) {
+      REQUIRE(cloud.points[idx].y >= 0.99f);
+    }
+
+    frustum.set_horizontal_fov(180.0f);
+    REQUIRE(frustum.filter_indices().empty());
+  }
+}
+
+TEST_CASE("Ground segmentation", "[pcl][filter][ground]")
+{
+  // 模拟32线激光雷达：平地加一面墙 / Simulated 32-ring LiDAR: flat ground plus a wall
+  constexpr float k_height = 1.73f;
+  constexpr float k_pi = 3.14159265f;
+  toolbox::utils::random_t::instance().seed(71);
+  point_cloud_t<float> cloud;
+  std::vector<std::uint16_t> rings;
+  std::vector<char> is_ground;
+  std::vector<char> is_obstacle;
+  for (int ring = 0; ring < 32; ++ring) {
+    const float elevation = (-24.0f + static_cast<float>(ring)) * k_pi / 180.0f;
+    for (int step = 0; step < 720; ++step) {
+      const float azimuth = static_cast<float>(step) * 0.5f * k_pi / 180.0f;
+      const float noise = toolbox::utils::random_t::instance().random<float>(-0.02f, 0.02f);
+      const bool towards_wall = step >= 60 && step < 100;
+      // 墙位于x方向10米处 / The wall stands 10 m away
+      const float wall_range = 10.0f / std::cos(azimuth);
+      const float ground_range =
+          elevation < 0.0f ? k_height / std::tan(-elevation) : 1e9f;
+      if (towards_wall && wall_range < ground_range) {
+        const float z = wall_range * std::tan(elevation);
+        cloud.points.emplace_back(10.0f, wall_range * std::sin(azimuth), z + noise);
+        is_ground.push_back(0);
+        is_obstacle.push_back(z > -k_height + 0.5f ? 1 : 0);
+      } else if (ground_range < 60.0f) {
+        cloud.points.emplace_back(ground_range * std::cos(azimuth),
+                                  ground_range * std::sin(azimuth),
+                                  -k_height + noise);
+        is_ground.push_back(1);
+        is_obstacle.push_back(0);
+      } else {
+        continue;
+      }
+      rings.push_back(static_cast<std::uint16_t>(ring));
+    }
+  }
+  const auto total_ground = static_cast<std::size_t>(
+      std::count(is_ground.begin(), is_ground.end(), 1));
+  const auto total_obstacles = static_cast<std::size_t>(
+      std::count(is_obstacle.begin(), is_obstacle.end(), 1));
+  REQUIRE(total_obstacles > 300);
+
+  auto check = [&](ground_segmentation_t<float>& segmentation)
+  {
+    std::vector<std::size_t> ground;
+    std::vector<std::size_t> non_ground;
+    REQUIRE(segmentation.segment(ground, non_ground));
+    REQUIRE(ground.size() + non_ground.size() == cloud.size());
+    REQUIRE(std::is_sorted(ground.begin(), ground.end()));
+    REQUIRE(std::is_sorted(non_ground.begin(), non_ground.end()));
+
+    std::size_t ground_hits = 0;
+    for (const auto idx : ground) {
+      REQUIRE(is_obstacle[idx] == 0);
+      ground_hits += static_cast<std::size_t>(is_ground[idx]);
+    }
+    REQUIRE(static_cast<double>(ground_hits) > 0.95 * static_cast<double>(total_ground));
+    return ground;
+  };
+
+  SECTION("Region-wise plane fit")
+  {
+    ground_segmentation_t<float> segmentation(ground_method_t::region_plane);
+    segmentation.set_sensor_height(k_height);
+    segmentation.set_range(1.0f, 80.0f);
+    segmentation.set_input(cloud);
+    const auto serial = check(segmentation);
+
+    segmentation.enable_parallel(true);
+    std::vector<std::size_t> ground;
+    std::vector<std::size_t> non_ground;
+    REQUIRE(segmentation.segment(ground, non_ground));
+    REQUIRE(ground == serial);
+
+    REQUIRE(segmentation.filter().size() == non_ground.size());
+    segmentation.set_negative(true);
+    REQUIRE(segmentation.filter().size() == ground.size());
+  }
+
+  SECTION("Ray slope filter with and without rings")
+  {
+    ground_segmentation_t<float> segmentation(ground_method_t::ray_slope);
+    segmentation.set_sensor_height(k_height);
+    segmentation.set_range(1.0f, 80.0f);
+    segmentation.set_num_rays(720);
+    segmentation.set_input(cloud);
+    segmentation.enable_parallel(true);
+    const auto by_range = check(segmentation);
+
+    segmentation.set_rings(rings);
+    const auto by_ring = check(segmentation);
+    REQUIRE(by_ring.size() + 100 > by_range.size());
+    REQUIRE(by_ring.size() < by_range.size() + 100);
+
+    // 线号数量不匹配时失败 / A mismatched ring count fails
+    segmentation.set_rings(std::vector<std::uint16_t>(3, 0));
+    std::vector<std::size_t> ground;
+    std::vector<std::size_t> non_ground;
+    REQUIRE_FALSE(segmentation.segment(ground, non_ground));
+  }
+
+  SECTION("Points outside the range are never ground")
+  {
+    ground_segmentation_t<float> segmentation;
+    segmentation.set_sensor_height(k_height);
+    segmentation.set_range(1.0f, 8.0f);
+    segmentation.set_input(cloud);
+    std::vector<std::size_t> ground;
+    std::vector<std::size_t> non_ground;
+    REQUIRE(segmentation.segment(ground, non_ground));
+    for (const auto idx : ground) {
+      const auto& p = cloud.points[idx];
+      REQUIRE(std::sqrt(p.x * p.x + p.y * p.y) <= 8.0f);
+    }
+  }
 }
@@ -4,13 +4,21 @@
 #include <cpp-toolbox/pcl/knn/bfknn.hpp>
 #include <cpp-toolbox/pcl/knn/bfknn_parallel.hpp>
 #include <cpp-toolbox/pcl/knn/kdtree.hpp>
+#include <cpp-toolbox/pcl/knn/hnsw.hpp>
+#include <cpp-toolbox/pcl/knn/neighborhood_graph.hpp>
 #include <cpp-toolbox/utils/random.hpp>
 #include <cpp-toolbox/metrics/vector_metrics.hpp>
 #include <cpp-toolbox/metrics/angular_metrics.hpp>
 #include <cpp-toolbox/metrics/metric_factory.hpp>
 
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 
 using namespace toolbox::pcl;
@@ -252,6 +260,251 @@ TEST_CASE("KNN Algorithms - Different Metrics", "[pcl][knn]")
   }
 }
 
+TEST_CASE("KNN Algorithms - KDTree Parallel Build", "[pcl][knn][kdtree]")
+{
+  using scalar_t = float;
+
+  // 超过并行构建阈值 / Above the parallel build threshold
+  auto cloud = generate_random_cloud<scalar_t>(60000);
+  auto queries = generate_random_cloud<scalar_t>(20);
+
+  kdtree_t<scalar_t> serial;
+  kdtree_t<scalar_t> parallel;
+  serial.enable_parallel(false);
+  REQUIRE(parallel.is_parallel_enabled());
+  REQUIRE(serial.set_input(cloud.points) == 60000);
+  REQUIRE(parallel.set_input(cloud.points) == 60000);
+
+  std::vector<std::size_t> serial_indices, parallel_indices;
+  std::vector<scalar_t> serial_distances, parallel_distances;
+  for (const auto& query : queries.points)
+  {
+    REQUIRE(serial.kneighbors(query, 10, serial_indices, serial_distances));
+    REQUIRE(parallel.kneighbors(query, 10, parallel_indices, parallel_distances));
+    REQUIRE(serial_indices == parallel_indices);
+
+    REQUIRE(serial.radius_neighbors(query, 0.5f, serial_indices, serial_distances));
+    REQUIRE(parallel.radius_neighbors(query, 0.5f, parallel_indices, parallel_distances));
+    REQUIRE(serial_indices.size() == parallel_indices.size());
+  }
+}
+
+TEST_CASE("KNN Algorithms - Neighborhood Graph", "[pcl][knn][graph]")
+{
+  using scalar_t = float;
+
+  // 超过并行阈值 / Above the parallel threshold
+  auto cloud = generate_random_cloud<scalar_t>(3000, -5.0f, 5.0f);
+  kdtree_t<scalar_t> kdtree;
+  REQUIRE(kdtree.set_input(cloud.points) == 3000);
+
+  std::vector<std::size_t> indices;
+  std::vector<scalar_t> distances;
+
+  SECTION("Radius graph matches radius searches")
+  {
+    neighborhood_graph_t<scalar_t> graph;
+    REQUIRE(graph.build_radius(kdtree, cloud.points, 1.0f));
+    REQUIRE(graph.size() == cloud.size());
+    REQUIRE(graph.is_radius_graph());
+    REQUIRE(graph.offsets().back() == graph.num_edges());
+
+    for (std::size_t i = 0; i < cloud.size(); i += 37)
+    {
+      REQUIRE(kdtree.radius_neighbors(cloud.points[i], 1.0f, indices, distances));
+      const auto row = graph.neighbors(i);
+      REQUIRE(row.size == indices.size());
+      for (std::size_t j = 0; j < row.size; ++j)
+      {
+        REQUIRE(row.indices[j] == indices[j]);
+        REQUIRE_THAT(row.distances[j], WithinAbs(distances[j], 1e-6f));
+      }
+
+      // 更小半径取前缀 / A smaller radius takes a prefix
+      REQUIRE(kdtree.radius_neighbors(cloud.points[i], 0.5f, indices, distances));
+      std::vector<std::size_t> graph_indices;
+      std::vector<scalar_t> graph_distances;
+      REQUIRE(graph.neighbors(i, 0.5f, 0, graph_indices, graph_distances));
+      REQUIRE(graph_indices == indices);
+    }
+  }
+
+  SECTION("Parallel and sequential builds agree")
+  {
+    neighborhood_graph_t<scalar_t> parallel;
+    neighborhood_graph_t<scalar_t> sequential;
+    REQUIRE(parallel.build_radius(kdtree, cloud.points, 0.8f, 16, true));
+    REQUIRE(sequential.build_radius(kdtree, cloud.points, 0.8f, 16, false));
+    REQUIRE(parallel.offsets() == sequential.offsets());
+    REQUIRE(parallel.indices() == sequential.indices());
+    REQUIRE(parallel.max_neighbors() == 16);
+    for (std::size_t i = 0; i < parallel.size(); ++i)
+    {
+      REQUIRE(parallel.neighbors(i).size <= 16);
+    }
+  }
+
+  SECTION("K-nearest neighbor graph")
+  {
+    bfknn_parallel_t<scalar_t> bf;
+    bf.set_input(cloud.points);
+
+    neighborhood_graph_t<scalar_t> graph;
+    REQUIRE(graph.build_knn(bf, cloud.points, 8));
+    REQUIRE_FALSE(graph.is_radius_graph());
+    REQUIRE(graph.num_edges() == cloud.size() * 8);
+
+    for (std::size_t i = 0; i < cloud.size(); i += 101)
+    {
+      REQUIRE(kdtree.kneighbors(cloud.points[i], 8, indices, distances));
+      const auto row = graph.neighbors(i);
+      REQUIRE(row.indices[0] == i);
+      REQUIRE_THAT(row.distances[7], WithinAbs(distances[7], 1e-5f));
+    }
+  }
+
+  SECTION("Invalid input")
+  {
+    kdtree_t<scalar_t> empty_tree;
+    neighborhood_graph_t<scalar_t> graph;
+    REQUIRE_FALSE(graph.build_radius(kdtree, cloud.points, 0.0f));
+    REQUIRE_FALSE(graph.build_knn(kdtree, cloud.points, 0));
+    REQUIRE_FALSE(graph.build_radius(empty_tree, cloud.points, 1.0f));
+    REQUIRE(graph.empty());
+  }
+}
+
+TEST_CASE("KNN Algorithms - Index Persistence", "[pcl][knn][persistence]")
+{
+  using scalar_t = float;
+  namespace fs = std::filesystem;
+
+  auto cloud = generate_random_cloud<scalar_t>(5000);
+  auto queries = generate_random_cloud<scalar_t>(20);
+  const fs::path dir = fs::temp_directory_path() / "cpp_toolbox_knn_index_test";
+  fs::create_directories(dir);
+
+  SECTION("KD-tree round trip")
+  {
+    kdtree_t<scalar_t> tree;
+    REQUIRE_FALSE(tree.save_index(dir / "empty.kdt"));
+    tree.set_input(cloud.points);
+    REQUIRE(tree.save_index(dir / "cloud.kdt"));
+
+    kdtree_t<scalar_t> loaded;
+    REQUIRE(loaded.load_index(dir / "cloud.kdt"));
+
+    std::vector<std::size_t> expected_indices, indices;
+    std::vector<scalar_t> expected_distances, distances;
+    for (const auto& query : queries.points)
+    {
+      REQUIRE(tree.kneighbors(query, 8, expected_indices, expected_distances));
+      REQUIRE(loaded.kneighbors(query, 8, indices, distances));
+      REQUIRE(indices == expected_indices);
+      REQUIRE(distances == expected_distances);
+
+      REQUIRE(tree.radius_neighbors(query, 1.0f, expected_indices, expected_distances));
+      REQUIRE(loaded.radius_neighbors(query, 1.0f, indices, distances));
+      REQUIRE(indices.size() == expected_indices.size());
+    }
+  }
+
+  SECTION("HNSW round trip")
+  {
+    hnsw_t<scalar_t> graph;
+    graph.set_max_connections(12);
+    graph.set_input(cloud.points);
+    REQUIRE(graph.save_index(dir / "cloud.hnsw"));
+
+    hnsw_t<scalar_t> loaded;
+    REQUIRE(loaded.load_index(dir / "cloud.hnsw"));
+    REQUIRE(loaded.size() == cloud.size());
+    REQUIRE(loaded.get_max_connections() == 12);
+    REQUIRE(loaded.get_max_level() == graph.get_max_level());
+
+    std::vector<std::size_t> expected_indices, indices;
+    std::vector<scalar_t> expected_distances, distances;
+    for (const auto& query : queries.points)
+    {
+      REQUIRE(graph.kneighbors(query, 8, expected_indices, expected_distances));
+      REQUIRE(loaded.kneighbors(query, 8, indices, distances));
+      REQUIRE(indices == expected_indices);
+    }
+  }
+
+  SECTION("Rejects mismatched and truncated files")
+  {
+    kdtree_t<scalar_t> tree;
+    tree.set_input(cloud.points);
+    REQUIRE(tree.save_index(dir / "mismatch.kdt"));
+
+    hnsw_t<scalar_t> graph;
+    REQUIRE_FALSE(graph.load_index(dir / "mismatch.kdt"));
+
+    kdtree_generic_t<point_t<double>> double_tree;
+    REQUIRE_FALSE(double_tree.load_index(dir / "mismatch.kdt"));
+
+    fs::resize_file(dir / "mismatch.kdt", 64);
+    kdtree_t<scalar_t> truncated;
+    REQUIRE_FALSE(truncated.load_index(dir / "mismatch.kdt"));
+    REQUIRE_FALSE(truncated.load_index(dir / "missing.kdt"));
+  }
+
+  SECTION("Rejects corrupted tree data")
+  {
+    kdtree_t<scalar_t> tree;
+    tree.set_input(cloud.points);
+    REQUIRE(tree.save_index(dir / "tree.kdt"));
+
+    auto read_file = [](const fs::path& path) {
+      std::ifstream in(path, std::ios::binary);
+      return std::vector<char>(std::istreambuf_iterator<char>(in), {});
+    };
+    auto write_file = [](const fs::path& path, const std::vector<char>& bytes) {
+      std::ofstream out(path, std::ios::binary | std::ios::trunc);
+      out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    };
+    const auto original = read_file(dir / "tree.kdt");
+    const std::size_t header_size = sizeof(toolbox::pcl::detail::index_file_header_t);
+    const std::size_t payload_size_offset =
+        offsetof(toolbox::pcl::detail::index_file_header_t, payload_size);
+
+    // 截断树数据并同步修改文件头，只有树数据本身不完整 / Truncate the tree data and patch the
+    // header to match, so only the tree data itself is incomplete
+    auto truncated = original;
+    truncated.resize(truncated.size() - 24);
+    std::uint64_t payload_size = 0;
+    std::memcpy(&payload_size, truncated.data() + payload_size_offset, sizeof(payload_size));
+    payload_size -= 24;
+    std::memcpy(truncated.data() + payload_size_offset, &payload_size, sizeof(payload_size));
+    write_file(dir / "truncated.kdt", truncated);
+
+    // 树数据：size_、dim_、root_bbox_、leaf_max_size_，然后是索引数组的长度和内容 /
+    // Tree data: size_, dim_, root_bbox_, leaf_max_size_, then the length and contents of
+    // the index array
+    auto out_of_range = original;
+    const std::size_t first_index_offset = header_size + cloud.size() * 3 * sizeof(scalar_t)
+        + sizeof(std::size_t) + sizeof(std::int32_t) + 6 * sizeof(scalar_t)
+        + sizeof(std::size_t) + sizeof(std::size_t);
+    const std::size_t bad_index = cloud.size() + 1000;
+    std::memcpy(out_of_range.data() + first_index_offset, &bad_index, sizeof(bad_index));
+    write_file(dir / "out_of_range.kdt", out_of_range);
+
+    kdtree_t<scalar_t> loaded;
+    REQUIRE(loaded.load_index(dir / "tree.kdt"));
+    REQUIRE_FALSE(loaded.load_index(dir / "truncated.kdt"));
+    std::vector<std::size_t> indices;
+    std::vector<scalar_t> distances;
+    REQUIRE_FALSE(loaded.kneighbors(queries.points[0], 4, indices, distances));
+    REQUIRE_FALSE(loaded.load_index(dir / "out_of_range.kdt"));
+    REQUIRE_FALSE(loaded.kneighbors(queries.points[0], 4, indices, distances));
+    REQUIRE(loaded.load_index(dir / "tree.kdt"));
+    REQUIRE(loaded.kneighbors(queries.points[0], 4, indices, distances));
+  }
+
+  fs::remove_all(dir);
+}
+
 TEST_CASE("KNN Algorithms - KDTree Metric Fallback", "[pcl][knn]")
 {
   using scalar_t = float;
@@ -303,6 +556,57 @@ TEST_CASE("KNN Algorithms - KDTree Metric Fallback", "[pcl][knn]")
       REQUIRE_THAT(kdtree_distances[i], WithinRel(bfknn_distances[i], 0.001f));
     }
   }
+
+  SECTION("The brute-force fallback follows input and metric changes")
+  {
+    kdtree.set_metric(MetricFactory<scalar_t>::instance().create("l1"));
+
+    // 换输入后后备搜索看到的是新点 / After new input the fallback searches the new points
+    point_cloud_t<scalar_t> shifted = cloud;
+    for (auto& p : shifted.points)
+    {
+      p.x += 10.0f;
+    }
+    REQUIRE(kdtree.set_input(shifted.points) == 27);
+    bfknn_generic_t<point_t<scalar_t>, L1Metric<scalar_t>> bfknn_l1;
+    REQUIRE(bfknn_l1.set_input(shifted.points) == 27);
+
+    std::vector<std::size_t> kdtree_indices, bfknn_indices;
+    std::vector<scalar_t> kdtree_distances, bfknn_distances;
+    REQUIRE(kdtree.kneighbors(query_point, 5, kdtree_indices, kdtree_distances));
+    REQUIRE(bfknn_l1.kneighbors(query_point, 5, bfknn_indices, bfknn_distances));
+    REQUIRE(kdtree_distances.size() == bfknn_distances.size());
+    for (std::size_t i = 0; i < kdtree_distances.size(); ++i)
+    {
+      REQUIRE_THAT(kdtree_distances[i], WithinRel(bfknn_distances[i], 0.001f));
+    }
+
+    // 批量查询与逐个查询一致 / Batch queries match single queries
+    std::vector<std::vector<std::size_t>> batch_indices;
+    std::vector<std::vector<scalar_t>> batch_distances;
+    REQUIRE(kdtree.kneighbors_batch(cloud.points, 3, batch_indices, batch_distances));
+    REQUIRE(batch_indices.size() == cloud.size());
+    for (std::size_t q = 0; q < cloud.size(); ++q)
+    {
+      REQUIRE(kdtree.kneighbors(cloud.points[q], 3, kdtree_indices, kdtree_distances));
+      REQUIRE(batch_distances[q].size() == kdtree_distances.size());
+      for (std::size_t i = 0; i < kdtree_distances.size(); ++i)
+      {
+        REQUIRE_THAT(batch_distances[q][i], WithinRel(kdtree_distances[i], 0.001f));
+      }
+    }
+
+    // 回到L2后重新用树搜索 / Back on L2 the tree serves the queries again
+    kdtree.set_metric(L2Metric<scalar_t> {});
+    REQUIRE(bfknn.set_input(shifted.points) == 27);
+    REQUIRE(kdtree.kneighbors(query_point, 5, kdtree_indices, kdtree_distances));
+    REQUIRE(bfknn.kneighbors(query_point, 5, bfknn_indices, bfknn_distances));
+    REQUIRE(kdtree_distances.size() == bfknn_distances.size());
+    for (std::size_t i = 0; i < kdtree_distances.size(); ++i)
+    {
+      REQUIRE_THAT(kdtree_distances[i], WithinRel(bfknn_distances[i], 0.001f));
+    }
+  }
 }
 
 TEST_CASE("KNN Algorithms - Performance Comparison", "[pcl][knn][!benchmark]")
@@ -402,4 +706,349 @@ TEST_CASE("KNN Algorithms - Edge Cases", "[pcl][knn]")
     
     REQUIRE_FALSE(knn.radius_neighbors(query, 0, indices, distances));
   }
-}
\ No newline at end of file
+
+  SECTION("Zero neighbors")
+  {
+    auto cloud = create_test_cloud<scalar_t>();
+    point_t<scalar_t> query;
+    query.x = query.y = query.z = 1.5f;
+
+    auto check_empty = [&](auto& knn) {
+      std::vector<std::size_t> indices {1, 2};
+      std::vector<scalar_t> distances {1.0f, 2.0f};
+      REQUIRE(knn.kneighbors(query, 0, indices, distances));
+      CHECK(indices.empty());
+      CHECK(distances.empty());
+
+      std::vector<std::vector<std::size_t>> batch_indices;
+      std::vector<std::vector<scalar_t>> batch_distances;
+      REQUIRE(knn.kneighbors_batch(cloud.points, 0, batch_indices, batch_distances));
+      REQUIRE(batch_indices.size() == cloud.size());
+      for (std::size_t i = 0; i < batch_indices.size(); ++i)
+      {
+        CHECK(batch_indices[i].empty());
+        CHECK(batch_distances[i].empty());
+      }
+    };
+
+    bfknn_t<scalar_t> bfknn;
+    REQUIRE(bfknn.set_input(cloud.points) == 27);
+    check_empty(bfknn);
+
+    bfknn_parallel_t<scalar_t> bfknn_parallel;
+    REQUIRE(bfknn_parallel.set_input(cloud.points) == 27);
+    check_empty(bfknn_parallel);
+
+    // 运行时度量走批量度量路径，kdtree回退到暴力搜索 / A runtime metric takes the batched
+    // metric path and makes the kdtree fall back to brute force
+    bfknn_t<scalar_t> bfknn_l1;
+    REQUIRE(bfknn_l1.set_input(cloud.points) == 27);
+    bfknn_l1.set_metric(MetricFactory<scalar_t>::instance().create("l1"));
+    check_empty(bfknn_l1);
+
+    kdtree_t<scalar_t> kdtree;
+    REQUIRE(kdtree.set_input(cloud.points) == 27);
+    kdtree.set_metric(MetricFactory<scalar_t>::instance().create("l1"));
+    std::vector<std::size_t> indices {1};
+    std::vector<scalar_t> distances {1.0f};
+    REQUIRE(kdtree.kneighbors(query, 0, indices, distances));
+    CHECK(indices.empty());
+    CHECK(distances.empty());
+  }
+}
+
+// 33维描述子，模拟FPFH / 33-D descriptor mimicking FPFH
+struct test_descriptor_t
+{
+  using value_type = float;
+  std::array<float, 33> histogram {};
+
+  const float* data() const { return histogram.data(); }
+  constexpr std::size_t size() const { return 33; }
+};
+
+struct test_descriptor_metric_t
+{
+  using value_type = float;
+  using result_type = float;
+
+  float operator()(const test_descriptor_t& a, const test_descriptor_t& b) const
+  {
+    float sum = 0;
+    for (std::size_t i = 0; i < a.histogram.size(); ++i)
+    {
+      const float diff = a.histogram[i] - b.histogram[i];
+      sum += diff * diff;
+    }
+    return std::sqrt(sum);
+  }
+};
+
+template<typename KNN, typename Query>
+double compute_recall(KNN& approx, bfknn_generic_t<typename KNN::element_type, typename KNN::metric_type>& exact,
+                      const std::vector<Query>& queries, std::size_t k)
+{
+  std::size_t hits = 0;
+  std::vector<std::size_t> approx_indices, exact_indices;
+  std::vector<float> approx_distances, exact_distances;
+  for (const auto& query : queries)
+  {
+    approx.kneighbors(query, k, approx_indices, approx_distances);
+    exact.kneighbors(query, k, exact_indices, exact_distances);
+    for (const auto idx : approx_indices)
+    {
+      if (std::find(exact_indices.begin(), exact_indices.end(), idx) != exact_indices.end())
+      {
+        ++hits;
+      }
+    }
+  }
+  return static_cast<double>(hits) / static_cast<double>(queries.size() * k);
+}
+
+TEST_CASE("KNN Algorithms - HNSW", "[pcl][knn][hnsw]")
+{
+  using scalar_t = float;
+  const std::size_t k = 10;
+
+  SECTION("Point cloud recall against brute force")
+  {
+    auto cloud = generate_random_cloud<scalar_t>(3000);
+    auto queries = generate_random_cloud<scalar_t>(50);
+
+    hnsw_t<scalar_t> hnsw;
+    bfknn_t<scalar_t> exact;
+    REQUIRE(hnsw.set_input(cloud.points) == 3000);
+    REQUIRE(exact.set_input(cloud.points) == 3000);
+
+    REQUIRE(compute_recall(hnsw, exact, queries.points, k) > 0.9);
+
+    std::vector<std::size_t> indices;
+    std::vector<scalar_t> distances;
+    REQUIRE(hnsw.kneighbors(queries.points[0], k, indices, distances));
+    REQUIRE(indices.size() == k);
+    for (std::size_t i = 1; i < distances.size(); ++i)
+    {
+      REQUIRE(distances[i] >= distances[i - 1]);
+    }
+  }
+
+  SECTION("Sequential build, batch insert and exact re-rank")
+  {
+    auto cloud = generate_random_cloud<scalar_t>(2000);
+    auto extra = generate_random_cloud<scalar_t>(500);
+    auto queries = generate_random_cloud<scalar_t>(30);
+
+    hnsw_t<scalar_t> hnsw;
+    hnsw.enable_parallel(false);
+    hnsw.set_ef_search(32);
+    hnsw.set_exact_rerank(true);
+    REQUIRE(hnsw.set_input(cloud.points) == 2000);
+    REQUIRE(hnsw.add_points(extra.points) == 2500);
+
+    auto all_points = cloud.points;
+    all_points.insert(all_points.end(), extra.points.begin(), extra.points.end());
+    bfknn_t<scalar_t> exact;
+    exact.set_input(all_points);
+
+    REQUIRE(compute_recall(hnsw, exact, queries.points, k) > 0.9);
+  }
+
+  SECTION("Radius search")
+  {
+    auto cloud = create_test_cloud<scalar_t>();
+    hnsw_t<scalar_t> hnsw;
+    bfknn_t<scalar_t> exact;
+    hnsw.set_input(cloud.points);
+    exact.set_input(cloud.points);
+
+    point_t<scalar_t> query(1.5f, 1.5f, 1.5f);
+    std::vector<std::size_t> hnsw_indices, exact_indices;
+    std::vector<scalar_t> hnsw_distances, exact_distances;
+    REQUIRE(hnsw.radius_neighbors(query, 1.0f, hnsw_indices, hnsw_distances));
+    REQUIRE(exact.radius_neighbors(query, 1.0f, exact_indices, exact_distances));
+    REQUIRE(hnsw_indices.size() == exact_indices.size());
+  }
+
+  SECTION("High-dimensional descriptors")
+  {
+    toolbox::utils::random_t rng;
+    auto make_descriptors = [&rng](std::size_t count) {
+      std::vector<test_descriptor_t> descriptors(count);
+      for (auto& descriptor : descriptors)
+      {
+        for (auto& bin : descriptor.histogram)
+        {
+          bin = rng.random<float>(0.0f, 100.0f);
+        }
+      }
+      return descriptors;
+    };
+    auto descriptors = make_descriptors(2000);
+    auto queries = make_descriptors(30);
+
+    hnsw_generic_t<test_descriptor_t, test_descriptor_metric_t> hnsw;
+    hnsw.set_ef_search(128);
+    bfknn_generic_t<test_descriptor_t, test_descriptor_metric_t> exact;
+    REQUIRE(hnsw.set_input(descriptors) == 2000);
+    exact.set_input(descriptors);
+
+    REQUIRE(compute_recall(hnsw, exact, queries, 5) > 0.8);
+  }
+}
+
+TEST_CASE("KNN Algorithms - Batch and blocked brute force", "[pcl][knn][batch]")
+{
+  using scalar_t = float;
+  const std::size_t k = 8;
+
+  auto cloud = generate_random_cloud<scalar_t>(2000);
+  auto queries = generate_random_cloud<scalar_t>(40);
+
+  // 参考实现：逐点计算距离后完全排序 / Reference: compute every distance, then fully sort
+  auto reference = [&](const point_t<scalar_t>& query) {
+    std::vector<scalar_t> all;
+    all.reserve(cloud.points.size());
+    for (const auto& p : cloud.points)
+    {
+      const scalar_t dx = p.x - query.x;
+      const scalar_t dy = p.y - query.y;
+      const scalar_t dz = p.z - query.z;
+      all.push_back(std::sqrt(dx * dx + dy * dy + dz * dz));
+    }
+    std::sort(all.begin(), all.end());
+    all.resize(k);
+    return all;
+  };
+
+  SECTION("Blocked single query matches reference")
+  {
+    bfknn_t<scalar_t> knn;
+    bfknn_parallel_t<scalar_t> knn_parallel;
+    knn.set_input(cloud.points);
+    knn_parallel.set_input(cloud.points);
+
+    std::vector<std::size_t> indices, indices_parallel;
+    std::vector<scalar_t> distances, distances_parallel;
+    for (const auto& query : queries.points)
+    {
+      const auto expected = reference(query);
+      REQUIRE(knn.kneighbors(query, k, indices, distances));
+      REQUIRE(knn_parallel.kneighbors(query, k, indices_parallel, distances_parallel));
+      REQUIRE(distances.size() == k);
+      REQUIRE(distances_parallel.size() == k);
+      for (std::size_t i = 0; i < k; ++i)
+      {
+        REQUIRE_THAT(distances[i], WithinAbs(expected[i], 1e-4f));
+        REQUIRE_THAT(distances_parallel[i], WithinAbs(expected[i], 1e-4f));
+      }
+    }
+  }
+
+  SECTION("Batch search matches single queries")
+  {
+    bfknn_t<scalar_t> knn;
+    bfknn_parallel_t<scalar_t> knn_parallel;
+    knn.set_input(cloud.points);
+    knn_parallel.set_input(cloud.points);
+
+    std::vector<std::vector<std::size_t>> batch_indices, parallel_indices;
+    std::vector<std::vector<scalar_t>> batch_distances, parallel_distances;
+    REQUIRE(knn.kneighbors_batch(queries.points, k, batch_indices, batch_distances));
+    REQUIRE(knn_parallel.kneighbors_batch(queries.points, k, parallel_indices, parallel_distances));
+    REQUIRE(batch_indices.size() == queries.size());
+    REQUIRE(parallel_indices.size() == queries.size());
+
+    std::vector<std::size_t> indices;
+    std::vector<scalar_t> distances;
+    for (std::size_t q = 0; q < queries.size(); ++q)
+    {
+      knn.kneighbors(queries.points[q], k, indices, distances);
+      REQUIRE(batch_indices[q] == indices);
+      REQUIRE(parallel_indices[q] == indices);
+      for (std::size_t i = 0; i < k; ++i)
+      {
+        REQUIRE_THAT(batch_distances[q][i], WithinAbs(distances[i], 1e-5f));
+      }
+    }
+  }
+
+  SECTION("Non-L2 metric uses bounded heap fallback")
+  {
+    bfknn_generic_t<point_t<scalar_t>, L1Metric<scalar_t>> knn;
+    knn.set_input(cloud.points);
+
+    std::vector<std::vector<std::size_t>> batch_indices;
+    std::vector<std::vector<scalar_t>> batch_distances;
+    REQUIRE(knn.kneighbors_batch(queries.points, k, batch_indices, batch_distances));
+    for (const auto& distances : batch_distances)
+    {
+      REQUIRE(distances.size() == k);
+      REQUIRE(std::is_sorted(distances.begin(), distances.end()));
+    }
+  }
+
+  SECTION("Runtime metrics match compile-time metrics")
+  {
+    bfknn_generic_t<point_t<scalar_t>, L1Metric<scalar_t>> compile_time;
+    bfknn_t<scalar_t> runtime;
+    bfknn_parallel_t<scalar_t> runtime_parallel;
+    compile_time.set_input(cloud.points);
+    runtime.set_input(cloud.points);
+    runtime_parallel.set_input(cloud.points);
+    runtime.set_metric(MetricFactory<scalar_t>::instance().create("l1"));
+    runtime_parallel.set_metric(
+        std::shared_ptr<IMetric<scalar_t>>(MetricFactory<scalar_t>::instance().create("l1")));
+
+    std::vector<std::size_t> expected_indices, indices, parallel_indices;
+    std::vector<scalar_t> expected_distances, distances, parallel_distances;
+    for (const auto& query : queries.points)
+    {
+      REQUIRE(compile_time.kneighbors(query, k, expected_indices, expected_distances));
+      REQUIRE(runtime.kneighbors(query, k, indices, distances));
+      REQUIRE(runtime_parallel.kneighbors(query, k, parallel_indices, parallel_distances));
+      for (std::size_t i = 0; i < k; ++i)
+      {
+        REQUIRE_THAT(distances[i], WithinAbs(expected_distances[i], 1e-4f));
+        REQUIRE_THAT(parallel_distances[i], WithinAbs(expected_distances[i], 1e-4f));
+      }
+
+      REQUIRE(compile_time.radius_neighbors(query, 3.0f, expected_indices, expected_distances));
+      REQUIRE(runtime.radius_neighbors(query, 3.0f, indices, distances));
+      REQUIRE(runtime_parallel.radius_neighbors(query, 3.0f, parallel_indices, parallel_distances));
+      REQUIRE(indices.size() == expected_indices.size());
+      REQUIRE(parallel_indices.size() == expected_indices.size());
+    }
+  }
+
+  SECTION("High-dimensional descriptors with L2 metric")
+  {
+    toolbox::utils::random_t rng;
+    std::vector<test_descriptor_t> descriptors(500);
+    for (auto& descriptor : descriptors)
+    {
+      for (auto& bin : descriptor.histogram)
+      {
+        bin = rng.random<float>(0.0f, 100.0f);
+      }
+    }
+
+    bfknn_generic_t<test_descriptor_t, L2Metric<float>> knn;
+    bfknn_generic_t<test_descriptor_t, test_descriptor_metric_t> reference_knn;
+    knn.set_input(descriptors);
+    reference_knn.set_input(descriptors);
+
+    std::vector<std::size_t> indices, reference_indices;
+    std::vector<float> distances, reference_distances;
+    for (std::size_t q = 0; q < 20; ++q)
+    {
+      REQUIRE(knn.kneighbors(descriptors[q], 5, indices, distances));
+      REQUIRE(reference_knn.kneighbors(descriptors[q], 5, reference_indices, reference_distances));
+      REQUIRE(indices.front() == q);
+      for (std::size_t i = 0; i < 5; ++i)
+      {
+        REQUIRE_THAT(distances[i], WithinAbs(reference_distances[i], 1e-2f));
+      }
+    }
+  }
+}
@@ -2,13 +2,19 @@
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 #include <catch2/benchmark/catch_benchmark.hpp>
 
+#include <cpp-toolbox/pcl/norm/batch_pca.hpp>
+#include <cpp-toolbox/pcl/norm/integral_image_norm.hpp>
 #include <cpp-toolbox/pcl/norm/pca_norm.hpp>
 #include <cpp-toolbox/pcl/knn/kdtree.hpp>
 #include <cpp-toolbox/pcl/knn/bfknn.hpp>
 #include <cpp-toolbox/pcl/knn/bfknn_parallel.hpp>
+#include <cpp-toolbox/pcl/knn/neighborhood_graph.hpp>
+#include <cpp-toolbox/pcl/range_image/range_image.hpp>
 #include <cpp-toolbox/utils/random.hpp>
 #include <cpp-toolbox/utils/timer.hpp>
 
+#include <Eigen/Eigenvalues>
+
 #include <algorithm>
 #include <chrono>
 #include <cmath>
@@ -134,6 +140,37 @@ TEST_CASE("[pcl][norm] PCA Normal Estimation Basic Functionality", "[pcl][norm]"
     }
   }
   
+  SECTION("Test with Neighborhood Graph")
+  {
+    auto cloud = generate_random_cloud<data_type>(500);
+    auto knn = kdtree_t<data_type>{};
+    knn.set_input(cloud.points);
+
+    neighborhood_graph_t<data_type> graph;
+    REQUIRE(graph.build_knn(knn, cloud.points, 20));
+
+    pca_norm_extractor_t<data_type, kdtree_t<data_type>> from_knn;
+    from_knn.set_input(cloud);
+    from_knn.set_knn(knn);
+    from_knn.set_num_neighbors(10);
+    auto expected = from_knn.extract();
+
+    // 图的行比需要的更长，只取前10个 / Graph rows are longer than needed, only 10 are used
+    pca_norm_extractor_t<data_type, kdtree_t<data_type>> from_graph;
+    from_graph.set_input(cloud);
+    from_graph.set_neighborhood_graph(graph);
+    from_graph.set_num_neighbors(10);
+    from_graph.enable_parallel(true);
+    auto result = from_graph.extract();
+
+    REQUIRE(result.normals.size() == expected.normals.size());
+    for (std::size_t i = 0; i < result.normals.size(); ++i) {
+      REQUIRE_THAT(result.normals[i].x, WithinAbs(expected.normals[i].x, 1e-5f));
+      REQUIRE_THAT(result.normals[i].y, WithinAbs(expected.normals[i].y, 1e-5f));
+      REQUIRE_THAT(result.normals[i].z, WithinAbs(expected.normals[i].z, 1e-5f));
+    }
+  }
+
   SECTION("Test with Brute Force KNN")
   {
     auto cloud = generate_random_cloud<data_type>(50);
@@ -271,6 +308,509 @@ TEST_CASE("[pcl][norm] PCA Normal Estimation Parallel Processing", "[pcl][norm]"
   }
 }
 
+TEST_CASE("[pcl][norm] Batch PCA kernel", "[pcl][norm][batch_pca]")
+{
+  using data_type = float;
+
+  SECTION("Analytic eigen decomposition matches Eigen")
+  {
+    toolbox::utils::random_t rng;
+    // 随机矩阵加上重根和对角情形 / Random matrices plus repeated-root and diagonal cases
+    std::vector<symmetric3_t<double>> matrices = {
+        {2.0, 0.0, 0.0, 2.0, 0.0, 5.0},
+        {1.0, 0.0, 0.0, 3.0, 0.0, 2.0},
+        {4.0, 0.0, 0.0, 4.0, 0.0, 4.0},
+        {1e-6, 0.0, 0.0, 1.0, 0.5, 1.0},
+    };
+    for (int i = 0; i < 200; ++i) {
+      Eigen::Matrix3d a = Eigen::Matrix3d::Zero();
+      for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+          a(r, c) = rng.random<double>(-1.0, 1.0);
+        }
+      }
+      // 半正定的协方差形式 / Positive semi-definite, like a covariance
+      const Eigen::Matrix3d m = a * a.transpose() * rng.random<double>(0.01, 100.0);
+      matrices.push_back({m(0, 0), m(0, 1), m(0, 2), m(1, 1), m(1, 2), m(2, 2)});
+    }
+
+    for (const auto& matrix : matrices) {
+      Eigen::Matrix3d m;
+      m << matrix.xx, matrix.xy, matrix.xz, matrix.xy, matrix.yy, matrix.yz, matrix.xz,
+          matrix.yz, matrix.zz;
+      const Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> reference(m);
+      const auto result = solve_symmetric3(matrix);
+      const double scale = m.cwiseAbs().maxCoeff();
+
+      for (int k = 0; k < 3; ++k) {
+        REQUIRE_THAT(result.values[k], WithinAbs(reference.eigenvalues()(k), 1e-9 * scale));
+        const Eigen::Vector3d v(result.vectors[k][0], result.vectors[k][1], result.vectors[k][2]);
+        REQUIRE_THAT(v.norm(), WithinAbs(1.0, 1e-9));
+        // 重根时特征向量不唯一，只检查残差 / Eigenvectors of repeated roots are not
+        // unique, so check the residual only
+        REQUIRE((m * v - result.values[k] * v).norm() < 1e-7 * scale);
+      }
+      const Eigen::Vector3d v0(result.vectors[0][0], result.vectors[0][1], result.vectors[0][2]);
+      const Eigen::Vector3d v1(result.vectors[1][0], result.vectors[1][1], result.vectors[1][2]);
+      const Eigen::Vector3d v2(result.vectors[2][0], result.vectors[2][1], result.vectors[2][2]);
+      REQUIRE_THAT(v0.cross(v1).dot(v2), WithinAbs(1.0, 1e-9));
+    }
+  }
+
+  SECTION("Weighted scatter around a center")
+  {
+    point_cloud_t<data_type> cloud;
+    cloud.points = {{1, 0, 0}, {-1, 0, 0}, {0, 2, 0}, {0, -2, 0}, {0, 0, 0}};
+    batch_pca_t<data_type> pca(cloud.points);
+    const std::vector<std::size_t> indices = {0, 1, 2, 3, 4};
+    const std::vector<data_type> weights = {1, 1, 0.5f, 0.5f, 1};
+
+    const auto result = pca.compute(indices, weights, point_t<data_type>(0, 0, 0));
+    REQUIRE(result.valid);
+    // Σw·d·dᵀ / Σw = diag(2, 4, 0) / 4
+    REQUIRE_THAT(result.eigenvalues[0], WithinAbs(0.0f, 1e-6f));
+    REQUIRE_THAT(result.eigenvalues[1], WithinAbs(0.5f, 1e-6f));
+    REQUIRE_THAT(result.eigenvalues[2], WithinAbs(1.0f, 1e-6f));
+    REQUIRE_THAT(std::abs(result.normal().z), WithinAbs(1.0f, 1e-6f));
+  }
+
+  SECTION("Graph rows, precision and the normal extractor agree")
+  {
+    // 远离原点的平面检验单次遍历累加没有抵消误差 / A plane far from the origin checks
+    // that the single-pass accumulation has no cancellation
+    const point_t<data_type> known_normal(0.0f, 0.6f, 0.8f);
+    auto cloud = create_planar_cloud(known_normal, point_t<data_type>(1000, -2000, 500), 3000,
+                                     data_type(5));
+    auto knn = kdtree_t<data_type>{};
+    knn.set_input(cloud.points);
+    neighborhood_graph_t<data_type> graph;
+    REQUIRE(graph.build_knn(knn, cloud.points, 16));
+
+    batch_pca_t<data_type> pca(cloud.points);
+    const auto results_double = pca.compute(graph, 12, true);
+    pca.set_precision(pca_precision_t::single_precision);
+    const auto results_single = pca.compute(graph, 12, false);
+    REQUIRE(results_double.size() == cloud.size());
+    REQUIRE(results_single.size() == cloud.size());
+
+    pca_norm_extractor_t<data_type, kdtree_t<data_type>> extractor;
+    extractor.set_input(cloud);
+    extractor.set_neighborhood_graph(graph);
+    extractor.set_num_neighbors(12);
+    extractor.set_precision(pca_precision_t::single_precision);
+    REQUIRE(extractor.get_precision() == pca_precision_t::single_precision);
+    const auto normals = extractor.extract();
+
+    for (std::size_t i = 0; i < cloud.size(); ++i) {
+      REQUIRE(results_double[i].valid);
+      REQUIRE(results_double[i].num_points == 12);
+      REQUIRE(compute_angle(known_normal, results_double[i].normal()) < 0.01f);
+      REQUIRE(compute_angle(known_normal, results_single[i].normal()) < 0.01f);
+      REQUIRE(compute_angle(results_single[i].normal(), normals.normals[i]) < 1e-4f);
+    }
+  }
+
+  SECTION("Too few points give the default normal")
+  {
+    point_cloud_t<data_type> cloud;
+    cloud.points = {{0, 0, 0}, {1, 0, 0}};
+    batch_pca_t<data_type> pca(cloud.points);
+    const auto result = pca.compute(std::vector<std::size_t> {0, 1});
+    REQUIRE_FALSE(result.valid);
+    REQUIRE(result.num_points == 2);
+    REQUIRE_THAT(result.normal().z, WithinAbs(1.0f, 1e-6f));
+  }
+}
+
+TEST_CASE("[pcl][norm] Normal orientation and curvature", "[pcl][norm][orientation]")
+{
+  using data_type = float;
+
+  // 斐波那契球面采样 / Fibonacci sphere sampling
+  auto make_sphere = [](std::size_t num_points, data_type radius)
+  {
+    point_cloud_t<data_type> cloud;
+    const double golden = 3.14159265358979323846 * (3.0 - std::sqrt(5.0));
+    for (std::size_t i = 0; i < num_points; ++i) {
+      const double z = 1.0 - 2.0 * (static_cast<double>(i) + 0.5) / static_cast<double>(num_points);
+      const double r = std::sqrt(1.0 - z * z);
+      const double theta = golden * static_cast<double>(i);
+      cloud.points.emplace_back(static_cast<data_type>(radius * r * std::cos(theta)),
+                                static_cast<data_type>(radius * r * std::sin(theta)),
+                                static_cast<data_type>(radius * z));
+    }
+    return cloud;
+  };
+
+  SECTION("Viewpoint and sensor origin")
+  {
+    auto sphere = make_sphere(2000, 5.0f);
+    auto knn = kdtree_t<data_type>{};
+    pca_norm_extractor_t<data_type, kdtree_t<data_type>> extractor;
+    extractor.set_input(sphere);
+    extractor.set_knn(knn);
+    extractor.set_num_neighbors(10);
+    extractor.set_orientation(normal_orientation_t::viewpoint);
+    extractor.set_viewpoint(point_t<data_type>(0, 0, 20));
+    auto result = extractor.extract();
+    for (std::size_t i = 0; i < sphere.size(); ++i) {
+      const auto& p = sphere.points[i];
+      const auto& n = result.normals[i];
+      REQUIRE(n.x * (0 - p.x) + n.y * (0 - p.y) + n.z * (20 - p.z) >= 0.0f);
+    }
+
+    // 传感器下方1.7m的地面 / Ground 1.7 m below the sensor
+    auto ground = create_planar_cloud(point_t<data_type>(0, 0, 1), point_t<data_type>(0, 0, -1.7f),
+                                      1000, data_type(20));
+    auto ground_knn = kdtree_t<data_type>{};
+    extractor.set_input(ground);
+    extractor.set_knn(ground_knn);
+    extractor.set_orientation(normal_orientation_t::sensor_origin);
+    result = extractor.extract();
+    for (const auto& n : result.normals) {
+      REQUIRE(n.z > 0.99f);
+    }
+  }
+
+  SECTION("Minimum spanning tree gives a consistent orientation")
+  {
+    auto sphere = make_sphere(3000, 5.0f);
+    auto knn = kdtree_t<data_type>{};
+    pca_norm_extractor_t<data_type, kdtree_t<data_type>> extractor;
+    extractor.set_input(sphere);
+    extractor.set_knn(knn);
+    extractor.set_num_neighbors(10);
+    extractor.set_orientation(normal_orientation_t::minimum_spanning_tree);
+    REQUIRE(extractor.get_orientation() == normal_orientation_t::minimum_spanning_tree);
+    // 视点在球外，单纯朝向视点会让背面的法线朝内 / The viewpoint is outside the
+    // sphere, so facing it alone would turn the far side inward
+    extractor.set_viewpoint(point_t<data_type>(0, 0, 50));
+    const auto sequential = extractor.extract();
+
+    extractor.enable_parallel(true);
+    const auto parallel = extractor.extract();
+
+    for (std::size_t i = 0; i < sphere.size(); ++i) {
+      const auto& p = sphere.points[i];
+      const auto& n = sequential.normals[i];
+      // 根节点朝向视点，因此整个球面朝外 / The root faces the viewpoint, so the
+      // whole sphere faces outward
+      REQUIRE(n.x * p.x + n.y * p.y + n.z * p.z > 0.0f);
+      REQUIRE(parallel.normals[i].x == n.x);
+      REQUIRE(parallel.normals[i].y == n.y);
+      REQUIRE(parallel.normals[i].z == n.z);
+    }
+  }
+
+  SECTION("Spanning tree skips points without a valid normal")
+  {
+    auto cloud = make_sphere(3000, 5.0f);
+    // 远处的成对离群点在半径图里只有两个邻居 / Far-away outlier pairs have only two
+    // neighbors in the radius graph
+    const std::size_t first_outlier = cloud.size();
+    for (int i = 0; i < 4; ++i) {
+      const auto x = 20.0f + 10.0f * static_cast<data_type>(i);
+      cloud.points.emplace_back(x, 0.0f, 0.0f);
+      cloud.points.emplace_back(x, 0.1f, 0.0f);
+    }
+    auto knn = kdtree_t<data_type>{};
+    knn.set_input(cloud.points);
+    neighborhood_graph_t<data_type> graph;
+    REQUIRE(graph.build_radius(knn, cloud.points, 1.5f));
+
+    pca_norm_extractor_t<data_type, kdtree_t<data_type>> extractor;
+    extractor.set_input(cloud);
+    extractor.set_neighborhood_graph(graph);
+    extractor.set_num_neighbors(10);
+    extractor.set_orientation(normal_orientation_t::minimum_spanning_tree);
+    extractor.set_viewpoint(point_t<data_type>(0, 0, 50));
+    const auto result = extractor.extract();
+
+    for (std::size_t i = 0; i < cloud.size(); ++i) {
+      const auto& p = cloud.points[i];
+      const auto& n = result.normals[i];
+      if (i >= first_outlier) {
+        REQUIRE(n.x == 0.0f);
+        REQUIRE(n.y == 0.0f);
+        REQUIRE(n.z == 1.0f);
+      } else {
+        REQUIRE(n.x * p.x + n.y * p.y + n.z * p.z > 0.0f);
+      }
+    }
+  }
+
+  SECTION("Curvature and eigenvalue ratios")
+  {
+    auto plane = create_planar_cloud(point_t<data_type>(0, 0, 1), point_t<data_type>(0, 0, 0), 500,
+                                     data_type(5));
+    point_cloud_t<data_type> line;
+    for (int i = 0; i < 200; ++i) {
+      line.points.emplace_back(0.05f * static_cast<data_type>(i), 0.0f, 0.001f * static_cast<data_type>(i % 3));
+    }
+    auto sphere = make_sphere(2000, 1.0f);
+
+    auto geometry_of = [](const point_cloud_t<data_type>& cloud)
+    {
+      auto knn = kdtree_t<data_type>{};
+      pca_norm_extractor_t<data_type, kdtree_t<data_type>> extractor;
+      extractor.set_input(cloud);
+      extractor.set_knn(knn);
+      extractor.set_num_neighbors(20);
+      const auto normals = extractor.extract();
+      REQUIRE(extractor.get_geometry().size() == cloud.size());
+      return extractor.get_geometry();
+    };
+
+    for (const auto& g : geometry_of(plane)) {
+      REQUIRE(g.eigenvalues[0] <= g.eigenvalues[1]);
+      REQUIRE(g.eigenvalues[1] <= g.eigenvalues[2]);
+      REQUIRE(g.curvature < 1e-4f);
+      REQUIRE(g.sphericity() < 1e-3f);
+    }
+    for (const auto& g : geometry_of(line)) {
+      REQUIRE(g.linearity() > 0.99f);
+    }
+    double mean_curvature = 0.0;
+    double mean_planarity = 0.0;
+    const auto sphere_geometry = geometry_of(sphere);
+    for (const auto& g : sphere_geometry) {
+      mean_curvature += g.curvature;
+      mean_planarity += g.planarity();
+    }
+    mean_curvature /= static_cast<double>(sphere_geometry.size());
+    mean_planarity /= static_cast<double>(sphere_geometry.size());
+    // 单位球上的20邻域略微弯曲 / 20-point patches on a unit sphere bend slightly
+    REQUIRE(mean_curvature > 1e-4);
+    REQUIRE(mean_curvature < 0.05);
+    REQUIRE(mean_planarity > 0.5);
+  }
+}
+
+TEST_CASE("[pcl][norm] Integral image normals on range images", "[pcl][norm][integral_image]")
+{
+  using data_type = float;
+  constexpr double k_pi = 3.14159265358979323846;
+
+  SECTION("Range image projection")
+  {
+    point_cloud_t<data_type> cloud;
+    cloud.points.emplace_back(10.0f, 0.0f, 0.0f);
+    cloud.points.emplace_back(5.0f, 0.0f, 0.0f);  // 同一像素中更近 / Nearer, same pixel
+    cloud.points.emplace_back(0.0f, 10.0f, 0.0f);
+    cloud.points.emplace_back(0.0f, 0.0f, 10.0f);  // 超出视场 / Outside the field of view
+    cloud.points.emplace_back(0.0f, 0.0f, 0.0f);
+
+    range_image_t<data_type> image;
+    REQUIRE_FALSE(image.project_spherical(cloud, 0, 16, 16.0f, -16.0f));
+    REQUIRE_FALSE(image.project_spherical(cloud, 360, 16, -16.0f, 16.0f));
+    REQUIRE(image.project_spherical(cloud, 360, 16, 16.0f, -16.0f));
+    REQUIRE(image.width() == 360);
+    REQUIRE(image.height() == 16);
+    REQUIRE(image.projection() == range_projection_t::spherical);
+    REQUIRE(image.num_valid() == 2);
+
+    // +x位于中间列，+y位于四分之一处 / +x lies in the middle column and +y at a quarter
+    REQUIRE(image.pixel(0) == 8 * 360 + 180);
+    REQUIRE(image.pixel(1) == image.pixel(0));
+    REQUIRE(image.index(8, 180) == 1);
+    REQUIRE_THAT(image.range(8, 180), Catch::Matchers::WithinAbs(5.0, 1e-5));
+    REQUIRE(image.pixel(2) == 8 * 360 + 90);
+    REQUIRE(image.pixel(3) == range_image_t<data_type>::k_empty);
+    REQUIRE(image.pixel(4) == range_image_t<data_type>::k_empty);
+
+    REQUIRE(image.project_pinhole(cloud, 64, 48, 50.0f, 50.0f, 32.0f, 24.0f));
+    REQUIRE(image.projection() == range_projection_t::pinhole);
+    REQUIRE(image.num_valid() == 1);
+    REQUIRE(image.index(24, 32) == 3);
+    REQUIRE_THAT(image.range(24, 32), Catch::Matchers::WithinAbs(10.0, 1e-5));
+  }
+
+  SECTION("Simulated LiDAR scan of ground and wall")
+  {
+    // 16线，仰角-15到15度，方位分辨率1度；地面在传感器下方1.7m，墙在x = 10 /
+    // 16 rings from -15 to 15 degrees at 1 degree azimuth; ground 1.7 m below the
+    // sensor and a wall at x = 10
+    point_cloud_t<data_type> scan;
+    for (int ring = 0; ring < 16; ++ring) {
+      const double elevation = (-15.0 + 2.0 * ring) * k_pi / 180.0;
+      for (int step = 0; step < 360; ++step) {
+        const double azimuth = (-179.5 + step) * k_pi / 180.0;
+        const double dx = std::cos(elevation) * std::cos(azimuth);
+        const double dy = std::cos(elevation) * std::sin(azimuth);
+        const double dz = std::sin(elevation);
+        double t = 60.0;
+        if (dz < 0.0) {
+          t = std::min(t, -1.7 / dz);
+        }
+        if (dx > 0.0) {
+          t = std::min(t, 10.0 / dx);
+        }
+        if (t < 60.0) {
+          scan.points.emplace_back(static_cast<data_type>(t * dx),
+                                   static_cast<data_type>(t * dy),
+                                   static_cast<data_type>(t * dz));
+        }
+      }
+    }
+
+    range_image_t<data_type> image;
+    REQUIRE(image.project_spherical(scan, 360, 16, 16.0f, -16.0f));
+    REQUIRE(image.num_valid() == scan.size());
+
+    integral_image_norm_extractor_t<data_type> extractor;
+    extractor.set_input(scan);
+    extractor.set_range_image(image);
+    extractor.set_window_size(1, 2);
+    // 掠射地面上相邻线的距离差很大 / Neighboring rings on grazing ground differ a lot
+    extractor.set_max_depth_change(1.0f);
+    const auto result = extractor.extract();
+    REQUIRE(result.size() == scan.size());
+    REQUIRE(result.normals.size() == scan.size());
+    REQUIRE(extractor.get_geometry().size() == scan.size());
+
+    std::size_t ground = 0;
+    std::size_t ground_ok = 0;
+    std::size_t wall = 0;
+    std::size_t wall_ok = 0;
+    for (std::size_t i = 0; i < scan.size(); ++i) {
+      const auto& p = scan.points[i];
+      const auto& n = result.normals[i];
+      const double range = std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z);
+      if (std::abs(p.z + 1.7f) < 1e-3f && p.x < 5.0f && range < 25.0) {
+        ++ground;
+        ground_ok += n.z > 0.99f ? 1 : 0;
+      } else if (std::abs(p.x - 10.0f) < 1e-3f && p.z > -0.5f) {
+        ++wall;
+        wall_ok += n.x < -0.99f ? 1 : 0;
+      }
+    }
+    REQUIRE(ground > 1000);
+    REQUIRE(wall > 300);
+    REQUIRE(static_cast<double>(ground_ok) > 0.95 * static_cast<double>(ground));
+    REQUIRE(static_cast<double>(wall_ok) > 0.95 * static_cast<double>(wall));
+
+    extractor.enable_parallel(true);
+    const auto parallel = extractor.extract();
+    for (std::size_t i = 0; i < scan.size(); ++i) {
+      REQUIRE(parallel.normals[i].x == result.normals[i].x);
+      REQUIRE(parallel.normals[i].y == result.normals[i].y);
+      REQUIRE(parallel.normals[i].z == result.normals[i].z);
+    }
+  }
+
+  SECTION("Windows do not cross depth jumps")
+  {
+    // 针孔相机前的两级台阶：左半z = 2，右半z = 4 / Two steps in front of a pinhole
+    // camera: z = 2 on the left half and z = 4 on the right half
+    const data_type fx = 50.0f;
+    const data_type cx = 32.0f;
+    const data_type cy = 24.0f;
+    point_cloud_t<data_type> cloud;
+    for (int v = 0; v < 48; ++v) {
+      for (int u = 0; u < 64; ++u) {
+        const data_type z = u < 32 ? 2.0f : 4.0f;
+        cloud.points.emplace_back((static_cast<data_type>(u) - cx) / fx * z,
+                                  (static_cast<data_type>(v) - cy) / fx * z,
+                                  z);
+      }
+    }
+    range_image_t<data_type> image;
+    REQUIRE(image.project_pinhole(cloud, 64, 48, fx, fx, cx, cy));
+    REQUIRE(image.num_valid() == cloud.size());
+
+    integral_image_norm_extractor_t<data_type> extractor;
+    extractor.set_input(cloud);
+    extractor.set_range_image(image);
+    extractor.set_window_size(3, 3);
+    const auto result = extractor.extract();
+    for (std::size_t i = 0; i < cloud.size(); ++i) {
+      const std::size_t u = i % 64;
+      const auto& n = result.normals[i];
+      if (u == 31 || u == 32) {
+        // 边缘像素得到默认法线 / Edge pixels get the default normal
+        REQUIRE(n.z == 1.0f);
+        REQUIRE(extractor.get_geometry()[i].curvature == 0.0f);
+      } else {
+        // 朝向相机 / Facing the camera
+        REQUIRE(n.z < -0.999f);
+        REQUIRE(extractor.get_geometry()[i].curvature < 1e-4f);
+      }
+    }
+  }
+
+  SECTION("Edges and windows wrap across the azimuth seam")
+  {
+    // 关于z轴旋转180度对称的场景：前方墙面在x = 10，y < 0一侧为折面或台阶，后方是它的
+    // 旋转副本，对应结构正好落在接缝上；两侧结果应互为旋转 / A scene symmetric under a
+    // 180 degree turn about z: a wall at x = 10 in front with a crease or a step on the
+    // y < 0 side, and its rotated copy behind, which puts the feature right on the seam;
+    // both sides must give rotated copies of each other
+    for (const bool step : {false, true}) {
+      auto front_range = [step](double dx, double dy)
+      {
+        if (dy >= 0.0) {
+          return 10.0 / dx;
+        }
+        return step ? 14.0 / dx : 10.0 / (dx + 0.5 * dy);
+      };
+
+      point_cloud_t<data_type> scan;
+      std::vector<std::size_t> front;
+      std::vector<std::size_t> back;
+      for (int ring = 0; ring < 16; ++ring) {
+        const double elevation = (-15.0 + 2.0 * ring) * k_pi / 180.0;
+        for (int s = 0; s < 180; ++s) {
+          const double azimuth = (-89.5 + s) * k_pi / 180.0;
+          const double dx = std::cos(elevation) * std::cos(azimuth);
+          const double dy = std::cos(elevation) * std::sin(azimuth);
+          const double dz = std::sin(elevation);
+          const double t = front_range(dx, dy);
+          if (t > 0.0 && t < 60.0) {
+            front.push_back(scan.size());
+            scan.points.emplace_back(static_cast<data_type>(t * dx),
+                                     static_cast<data_type>(t * dy),
+                                     static_cast<data_type>(t * dz));
+            back.push_back(scan.size());
+            scan.points.emplace_back(static_cast<data_type>(-t * dx),
+                                     static_cast<data_type>(-t * dy),
+                                     static_cast<data_type>(t * dz));
+          }
+        }
+      }
+
+      range_image_t<data_type> image;
+      REQUIRE(image.project_spherical(scan, 360, 16, 16.0f, -16.0f));
+      REQUIRE(image.num_valid() == scan.size());
+
+      integral_image_norm_extractor_t<data_type> extractor;
+      extractor.set_input(scan);
+      extractor.set_range_image(image);
+      extractor.set_window_size(1, 3);
+      const auto result = extractor.extract();
+      const auto& geometry = extractor.get_geometry();
+
+      std::size_t creased = 0;
+      std::size_t edges = 0;
+      for (std::size_t k = 0; k < front.size(); ++k) {
+        const auto& nf = result.normals[front[k]];
+        const auto& nb = result.normals[back[k]];
+        REQUIRE_THAT(nb.x, Catch::Matchers::WithinAbs(-nf.x, 1e-4));
+        REQUIRE_THAT(nb.y, Catch::Matchers::WithinAbs(-nf.y, 1e-4));
+        REQUIRE_THAT(nb.z, Catch::Matchers::WithinAbs(nf.z, 1e-4));
+        REQUIRE_THAT(geometry[back[k]].curvature,
+                     Catch::Matchers::WithinAbs(geometry[front[k]].curvature, 1e-4));
+        creased += geometry[back[k]].curvature > 1e-3f ? 1 : 0;
+        edges += nb.z == 1.0f ? 1 : 0;
+      }
+      if (step) {
+        REQUIRE(edges >= 32);
+      } else {
+        REQUIRE(creased >= 32);
+      }
+    }
+  }
+}
+
 TEST_CASE("[pcl][norm] PCA Normal Estimation Edge Cases", "[pcl][norm]")
 {
   using data_type = float;
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <cpp-toolbox/pcl/knn/bfknn_parallel.hpp>
+#include <cpp-toolbox/pcl/knn/kdtree.hpp>
+#include <cpp-toolbox/pcl/knn/neighborhood_graph.hpp>
+#include <cpp-toolbox/pcl/segmentation/euclidean_cluster_extraction.hpp>
+#include <cpp-toolbox/types/point.hpp>
+#include <cpp-toolbox/utils/random.hpp>
+
+using toolbox::pcl::clusters_t;
+using toolbox::pcl::euclidean_cluster_extraction_t;
+using toolbox::pcl::kdtree_t;
+using toolbox::pcl::neighborhood_graph_t;
+using toolbox::types::point_cloud_t;
+using toolbox::types::point_t;
+
+namespace
+{
+
+/// 广度优先搜索得到的参考聚类 / Reference clusters from a breadth-first search
+std::vector<std::vector<std::size_t>> brute_force_clusters(const point_cloud_t<float>& cloud,
+                                                           float tolerance)
+{
+  const std::size_t n = cloud.size();
+  std::vector<char> visited(n, 0);
+  std::vector<std::vector<std::size_t>> clusters;
+  for (std::size_t seed = 0; seed < n; ++seed) {
+    if (visited[seed] != 0) {
+      continue;
+    }
+    std::vector<std::size_t> members {seed};
+    visited[seed] = 1;
+    for (std::size_t head = 0; head < members.size(); ++head) {
+      const auto& p = cloud.points[members[head]];
+      for (std::size_t j = 0; j < n; ++j) {
+        const float dx = p.x - cloud.points[j].x;
+        const float dy = p.y - cloud.points[j].y;
+        const float dz = p.z - cloud.points[j].z;
+        if (visited[j] == 0 && std::sqrt(dx * dx + dy * dy + dz * dz) <= tolerance) {
+          visited[j] = 1;
+          members.push_back(j);
+        }
+      }
+    }
+    std::sort(members.begin(), members.end());
+    clusters.push_back(members);
+  }
+  return clusters;
+}
+
+std::vector<std::vector<std::size_t>> to_vectors(const clusters_t& clusters)
+{
+  std::vector<std::vector<std::size_t>> result;
+  for (std::size_t i = 0; i < clusters.size(); ++i) {
+    const auto cluster = clusters.cluster(i);
+    result.emplace_back(cluster.begin(), cluster.end());
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST_CASE("Euclidean cluster extraction", "[pcl][segmentation][cluster]")
+{
+  // 三个分离的团块加一些孤立点 / Three separated blobs plus isolated points
+  toolbox::utils::random_t::instance().seed(83);
+  auto& rng = toolbox::utils::random_t::instance();
+  point_cloud_t<float> cloud;
+  const float centers[3][3] = {{0.0f, 0.0f, 0.0f}, {10.0f, 0.0f, 0.0f}, {0.0f, 10.0f, 5.0f}};
+  const int blob_sizes[3] = {1500, 800, 300};
+  for (int b = 0; b < 3; ++b) {
+    for (int i = 0; i < blob_sizes[b]; ++i) {
+      cloud.points.emplace_back(centers[b][0] + rng.random<float>(-1.0f, 1.0f),
+                                centers[b][1] + rng.random<float>(-1.0f, 1.0f),
+                                centers[b][2] + rng.random<float>(-1.0f, 1.0f));
+    }
+  }
+  for (int i = 0; i < 5; ++i) {
+    cloud.points.emplace_back(-20.0f - 5.0f * static_cast<float>(i), 30.0f, 0.0f);
+  }
+  // 打乱顺序，使聚类在输入中交错 / Shuffle so the clusters interleave in the input
+  rng.shuffle(cloud.points);
+
+  const float tolerance = 0.7f;
+  const auto expected = brute_force_clusters(cloud, tolerance);
+  REQUIRE(expected.size() == 8);
+
+  SECTION("Matches a breadth-first search")
+  {
+    euclidean_cluster_extraction_t<float> clustering(tolerance);
+    clustering.set_input(cloud);
+    clusters_t clusters;
+    REQUIRE(clustering.extract(clusters));
+    REQUIRE(to_vectors(clusters) == expected);
+    REQUIRE(clusters.offsets.back() == cloud.size());
+
+    clustering.enable_parallel(true);
+    clusters_t parallel_clusters;
+    REQUIRE(clustering.extract(parallel_clusters));
+    REQUIRE(parallel_clusters.offsets == clusters.offsets);
+    REQUIRE(parallel_clusters.indices == clusters.indices);
+  }
+
+  SECTION("Cluster size limits")
+  {
+    euclidean_cluster_extraction_t<float> clustering(tolerance, 2, 1000);
+    clustering.set_input(cloud);
+    clustering.enable_parallel(true);
+    clusters_t clusters;
+    REQUIRE(clustering.extract(clusters));
+    REQUIRE(clusters.size() == 2);
+    std::vector<std::size_t> sizes;
+    for (std::size_t i = 0; i < clusters.size(); ++i) {
+      sizes.push_back(clusters.cluster(i).size);
+    }
+    std::sort(sizes.begin(), sizes.end());
+    REQUIRE(sizes == std::vector<std::size_t> {300, 800});
+  }
+
+  SECTION("Precomputed neighborhood graph")
+  {
+    kdtree_t<float> kdtree;
+    kdtree.set_input(cloud);
+    neighborhood_graph_t<float> graph;
+    REQUIRE(graph.build_radius(kdtree, cloud.points, 0.8f));
+
+    euclidean_cluster_extraction_t<float> clustering(tolerance);
+    clustering.set_input(cloud);
+    clustering.set_neighborhood_graph(graph);
+    clustering.enable_parallel(true);
+    clusters_t clusters;
+    REQUIRE(clustering.extract(clusters));
+    REQUIRE(to_vectors(clusters) == expected);
+
+    // 图的半径小于容差时拒绝 / A graph with a smaller radius is rejected
+    clustering.set_tolerance(1.0f);
+    REQUIRE_FALSE(clustering.extract(clusters));
+    REQUIRE(clusters.empty());
+    clustering.set_tolerance(tolerance);
+
+    // 限制每行邻居数的图会漏边，同样拒绝 / A graph with capped rows can miss edges and is
+    // rejected as well
+    neighborhood_graph_t<float> capped;
+    REQUIRE(capped.build_radius(kdtree, cloud.points, 0.8f, 4));
+    clustering.set_neighborhood_graph(capped);
+    REQUIRE_FALSE(clustering.extract(clusters));
+    REQUIRE(clusters.empty());
+  }
+
+  SECTION("Parallel brute-force KNN")
+  {
+    using bf_clustering_t = euclidean_cluster_extraction_t<
+        float,
+        toolbox::pcl::bfknn_parallel_generic_t<point_t<float>,
+                                               toolbox::metrics::L2Metric<float>>>;
+    bf_clustering_t clustering(tolerance, 10);
+    clustering.set_input(cloud);
+    clustering.enable_parallel(true);
+    clusters_t clusters;
+    REQUIRE(clustering.extract(clusters));
+    REQUIRE(clusters.size() == 3);
+  }
+}